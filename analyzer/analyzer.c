@@ -109,6 +109,7 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_params)
   SUSCAN_PACK(float, self->psd_update_int);
   SUSCAN_PACK(freq,  self->min_freq);
   SUSCAN_PACK(freq,  self->max_freq);
+  SUSCAN_PACK(float, self->channel_spacing);
 
   SUSCAN_PACK_BOILERPLATE_END;
 }
@@ -135,6 +136,11 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_params)
   SUSCAN_UNPACK(freq,   self->min_freq);
   SUSCAN_UNPACK(freq,   self->max_freq);
 
+  /* Older peers do not send the channel spacing */
+  self->channel_spacing = 0;
+  if (grow_buf_avail(buffer) > 0)
+    SUSCAN_UNPACK(float,  self->channel_spacing);
+
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
@@ -508,6 +514,25 @@ suscan_analyzer_register_baseband_filter(
     SUSCAN_ANALYZER_BBFILT_PRIO_DEFAULT);
 }
 
+SUBOOL
+suscan_analyzer_unregister_baseband_filter(
+    suscan_analyzer_t *self,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata)
+{
+  if (self->iface->unregister_baseband_filter == NULL) {
+    SU_ERROR("This type of analyzer object does not support custom baseband filtering\n");
+    return SU_FALSE;
+  }
+
+  CHECK_PERMISSION(self, SUSCAN_ANALYZER_PERM_SET_BB_FILTER);
+
+  return (self->iface->unregister_baseband_filter) (
+    self->impl,
+    func,
+    privdata);
+}
+
 /* Worker-specific methods */
 SUBOOL
 suscan_analyzer_set_sweep_stratrgy(
@@ -82,6 +82,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_params) {
   SUFLOAT  psd_update_int;     /*!< Spectrum update interval (seconds) */
   SUFREQ   min_freq; /*!< Minimum sweep frequency (only in wide spectrum mode) */
   SUFREQ   max_freq; /*!< Maximum sweep frequency (only in wide spectrum mode) */
+  SUFLOAT  channel_spacing; /*!< Raster channelizer spacing in Hz (0 disables) */
 };
 
 #define suscan_analyzer_params_INITIALIZER {                               \
@@ -91,6 +92,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_params) {
   SU_ADDSFX(0.04),                              /* psd_update_int */        \
   0,                                            /* min_freq */              \
   0,                                            /* max_freq */              \
+  0,                                            /* channel_spacing */       \
 }
 
 /*!
@@ -196,6 +198,10 @@ struct suscan_analyzer_interface {
     suscan_analyzer_baseband_filter_func_t func,
     void *privdata,
     int64_t priority);
+  SUBOOL   (*unregister_baseband_filter) (
+    void *,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata);
   
   struct suscan_source_info *(*get_source_info_pointer) (const void *);
   SUBOOL   (*commit_source_info) (void *);
@@ -746,6 +752,20 @@ SUBOOL suscan_analyzer_register_baseband_filter_with_prio(
     void *privdata,
     int64_t prio);
 
+/*!
+ * Removes a baseband filter previously registered with the same processing
+ * function and private data. Once this function returns, the filter
+ * function is no longer being called and will not be called again.
+ * \param analyzer pointer to the analyzer object
+ * \param func pointer to the baseband filter function
+ * \param privdata pointer to its private data
+ * \return SU_TRUE for success or SU_FALSE on failure
+ */
+SUBOOL suscan_analyzer_unregister_baseband_filter(
+    suscan_analyzer_t *analyzer,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata);
+
 
 /************************ Client interface methods ****************************/
 /*
@@ -829,6 +849,23 @@ SUBOOL suscan_analyzer_seek_async(
     const struct timeval *pos,
     uint32_t req_id);
 
+/*!
+ * For file sources with a precomputed overview, requests a tile of it. The
+ * reply is delivered as a SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW message.
+ * \param analyzer pointer to the analyzer object
+ * \param level overview level (0 is the finest)
+ * \param first_row first row of the tile
+ * \param row_count number of rows of the tile
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ */
+SUBOOL suscan_analyzer_get_overview_async(
+    suscan_analyzer_t *analyzer,
+    unsigned int level,
+    SUSCOUNT first_row,
+    SUSCOUNT row_count,
+    uint32_t req_id);
+
 
 /*!
  * For channel analyzers, open a new inspector of a given class at a given
@@ -851,6 +888,27 @@ SUBOOL suscan_analyzer_open_ex_async(
     SUHANDLE parent,
     uint32_t req_id);
 
+/*!
+ * For channel analyzers of multi-channel sources, open a new inspector of a
+ * given class on one of the source channels (asynchronous). Only local
+ * analyzers support channels other than the first one.
+ * \param analyzer pointer to the analyzer object
+ * \param classname inspector class name
+ * \param channel pointer to the channel structure describing the inspector
+ * frequency and bandwidth
+ * \param precise whether to use precise channel centering
+ * \param stream source channel, starting from 0
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ */
+SUBOOL suscan_analyzer_open_stream_async(
+    suscan_analyzer_t *analyzer,
+    const char *classname,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    unsigned int stream,
+    uint32_t req_id);
+
 /*!
  * For channel analyzers, open a new inspector of a given class at a given
  * frequency (asynchronous). Equivalent to suscan_analyzer_open_ex_async(
@@ -1022,6 +1080,42 @@ SUBOOL suscan_analyzer_set_inspector_watermark_async(
     SUSCOUNT watermark,
     uint32_t req_id);
 
+/*!
+ * For channel analyzers, pause or resume an inspector (asynchronous). Paused
+ * inspectors are not fed and their channel is released until they are
+ * resumed, after which their sampler and estimators start from scratch.
+ * \param analyzer pointer to the analyzer object
+ * \param handle inspector handle
+ * \param paused SU_TRUE to pause the inspector, SU_FALSE to resume it
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_inspector_paused_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    SUBOOL paused,
+    uint32_t req_id);
+
+/*!
+ * For channel analyzers, configure the squelch of an inspector
+ * (asynchronous). While enabled, the inspector is paused automatically
+ * whenever the power in its channel stays below the given level.
+ * \param analyzer pointer to the analyzer object
+ * \param handle inspector handle
+ * \param enabled SU_TRUE to enable the squelch, SU_FALSE to disable it
+ * \param level squelch level, in dB (same scale as the PSD)
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_inspector_squelch_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    SUBOOL enabled,
+    SUFLOAT level,
+    uint32_t req_id);
+
 /*!
  * For channel analyzer, enable or disable a channel parameter estimator
  * associated to an inspector (asynchronous).
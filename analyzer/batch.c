@@ -0,0 +1,478 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "batch"
+
+#include <sigutils/log.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "msg.h"
+#include "impl/local.h"
+#include <analyzer/source/impl/file.h>
+
+/* Marks the end of the output of a segment */
+#define SUSCAN_BATCH_MSG_TYPE_SEGMENT_END (SUSCAN_ANALYZER_MESSAGE_TYPE_INVALID + 1)
+
+SUPRIVATE void
+suscan_batch_seconds_to_timeval(SUDOUBLE secs, struct timeval *tv)
+{
+  tv->tv_sec  = (time_t) secs;
+  tv->tv_usec = (suseconds_t) (1e6 * (secs - tv->tv_sec));
+}
+
+SUPRIVATE SUBOOL
+suscan_batch_msg_is_data(uint32_t type, const void *privdata)
+{
+  const struct suscan_analyzer_inspector_msg *msg;
+
+  switch (type) {
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
+      return SU_TRUE;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR:
+      msg = privdata;
+      switch (msg->kind) {
+        case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR:
+        case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SPECTRUM:
+        case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT:
+        case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL:
+          return SU_TRUE;
+
+        default:
+          return SU_FALSE;
+      }
+  }
+
+  return SU_FALSE;
+}
+
+/*************************** Segment processing *******************************/
+SUPRIVATE void
+suscan_batch_segment_finalize(struct suscan_batch_segment *self)
+{
+  if (self->analyzer != NULL)
+    SU_DISPOSE(suscan_analyzer, self->analyzer);
+
+  if (self->analyzer_mq_init) {
+    suscan_analyzer_consume_mq(&self->analyzer_mq);
+    suscan_mq_finalize(&self->analyzer_mq);
+  }
+
+  if (self->out_mq_init) {
+    suscan_analyzer_consume_mq(&self->out_mq);
+    suscan_mq_finalize(&self->out_mq);
+  }
+
+  if (self->config != NULL)
+    suscan_source_config_destroy(self->config);
+
+  if (self->flow_mutex_init)
+    pthread_mutex_destroy(&self->flow_mutex);
+}
+
+/* Called from the segment thread, for every message it queues */
+SUPRIVATE void
+suscan_batch_segment_inc_pending(struct suscan_batch_segment *self)
+{
+  (void) pthread_mutex_lock(&self->flow_mutex);
+
+  ++self->pending;
+  if (!self->held
+    && self->source != NULL
+    && self->pending >= SUSCAN_BATCH_MAX_PENDING) {
+    suscan_source_set_held(self->source, SU_TRUE);
+    self->held = SU_TRUE;
+  }
+
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+}
+
+/* Called from the caller thread, for every message it delivers */
+SUPRIVATE void
+suscan_batch_segment_dec_pending(struct suscan_batch_segment *self)
+{
+  (void) pthread_mutex_lock(&self->flow_mutex);
+
+  if (self->pending > 0)
+    --self->pending;
+
+  if (self->held && self->pending <= SUSCAN_BATCH_MAX_PENDING / 2) {
+    if (self->source != NULL)
+      suscan_source_set_held(self->source, SU_FALSE);
+    self->held = SU_FALSE;
+  }
+
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+}
+
+/* The analyzer may go away at any moment after this */
+SUPRIVATE void
+suscan_batch_segment_release_source(struct suscan_batch_segment *self)
+{
+  (void) pthread_mutex_lock(&self->flow_mutex);
+
+  if (self->source != NULL && self->held)
+    suscan_source_set_held(self->source, SU_FALSE);
+
+  self->source = NULL;
+  self->held   = SU_FALSE;
+
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+}
+
+/*
+ * Returns SU_TRUE if the message must be delivered to the user, and sets
+ * *done if this is the last message the segment is interested in.
+ */
+SUPRIVATE SUBOOL
+suscan_batch_segment_filter(
+  struct suscan_batch_segment *self,
+  const struct suscan_msg *msg,
+  SUBOOL *done)
+{
+  const struct suscan_analyzer_psd_msg *psd;
+  SUBOOL last = self->index == self->batch->segment_count - 1;
+
+  switch (msg->type) {
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
+      psd = msg->privdata;
+      self->last_time = psd->timestamp;
+
+      /* The last segment runs until the end of the capture */
+      if (!last && timercmp(&self->last_time, &self->end, >=)) {
+        *done = SU_TRUE;
+        return SU_FALSE;
+      }
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
+      *done = SU_TRUE;
+      return last;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_READ_ERROR:
+      *done = SU_TRUE;
+      return SU_TRUE;
+
+    case SUSCAN_WORKER_MSG_TYPE_HALT:
+      *done = SU_TRUE;
+      return SU_FALSE;
+  }
+
+  /* Warm-up output is discarded */
+  if (suscan_batch_msg_is_data(msg->type, msg->privdata))
+    return !timercmp(&self->last_time, &self->start, <);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_batch_segment_start(struct suscan_batch_segment *self)
+{
+  struct suscan_batch *batch = self->batch;
+  struct timeval timeout = {SUSCAN_BATCH_READY_TIMEOUT_S, 0};
+  suscan_local_analyzer_t *local;
+  SUBOOL ok = SU_FALSE;
+
+  SU_MAKE(
+    self->analyzer,
+    suscan_analyzer,
+    &batch->analyzer_params,
+    self->config,
+    &self->analyzer_mq);
+
+  if (!suscan_analyzer_is_local(self->analyzer)) {
+    SU_ERROR("Batch analysis requires a local analyzer\n");
+    goto done;
+  }
+
+  if (!suscan_analyzer_wait_until_ready(self->analyzer, &timeout)) {
+    SU_ERROR("Segment %u: analyzer failed to start\n", self->index);
+    goto done;
+  }
+
+  if (self->warmup.tv_sec > 0 || self->warmup.tv_usec > 0)
+    SU_TRY(suscan_analyzer_seek(self->analyzer, &self->warmup));
+
+  if (batch->params.on_segment_start != NULL)
+    SU_TRY(
+      (batch->params.on_segment_start) (
+        batch->params.userdata,
+        self->analyzer,
+        self->index));
+
+  /*
+   * Unthrottle the source directly. The THROTTLE message, or overriding
+   * the throttle, would also change the effective sample rate, and with
+   * it the update rate of the PSD and of inspector spectra and estimators.
+   * These must stay tied to the sample count so that all segments produce
+   * the same output as a single real-time run.
+   */
+  local = SULIMPL(self->analyzer);
+  suscan_source_set_unthrottled(local->source, SU_TRUE);
+
+  (void) pthread_mutex_lock(&self->flow_mutex);
+  self->source = local->source;
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void *
+suscan_batch_segment_thread(void *data)
+{
+  struct suscan_batch_segment *self = data;
+  struct suscan_batch *batch = self->batch;
+  struct timeval poll = {0, 100000};
+  struct suscan_msg *msg = NULL;
+  SUBOOL done = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscan_batch_segment_start(self));
+
+  while (!done && !batch->cancel) {
+    if ((msg = suscan_mq_read_msg_timeout(&self->analyzer_mq, &poll)) == NULL)
+      continue;
+
+    if (suscan_batch_segment_filter(self, msg, &done)) {
+      SU_TRY(suscan_mq_write(&self->out_mq, msg->type, msg->privdata));
+      suscan_batch_segment_inc_pending(self);
+    } else {
+      suscan_analyzer_dispose_message(msg->type, msg->privdata);
+    }
+
+    SU_DISPOSE(suscan_msg, msg);
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL) {
+    suscan_analyzer_dispose_message(msg->type, msg->privdata);
+    SU_DISPOSE(suscan_msg, msg);
+  }
+
+  /* Stop the analyzer as soon as possible, and release its resources */
+  suscan_batch_segment_release_source(self);
+  if (self->analyzer != NULL)
+    SU_DISPOSE(suscan_analyzer, self->analyzer);
+
+  self->ok = ok;
+
+  /* Never fails. */
+  (void) suscan_mq_write(
+    &self->out_mq,
+    SUSCAN_BATCH_MSG_TYPE_SEGMENT_END,
+    NULL);
+
+  return NULL;
+}
+
+/****************************** Batch object **********************************/
+SU_INSTANCER(
+  suscan_batch,
+  const struct suscan_analyzer_params *analyzer_params,
+  const suscan_source_config_t *config,
+  const struct suscan_batch_params *params)
+{
+  suscan_batch_t *new = NULL;
+  struct suscan_batch_segment *seg;
+  struct timeval start, end, diff, tv;
+  SUDOUBLE duration, seg_start, seg_end, warmup;
+  unsigned int i, count;
+  long cores;
+
+  SU_ALLOCATE_FAIL(new, suscan_batch_t);
+
+  new->params          = *params;
+  new->analyzer_params = *analyzer_params;
+
+  if (!suscan_source_config_is_seekable(config)) {
+    SU_ERROR("Batch analysis requires a seekable source\n");
+    goto fail;
+  }
+
+  suscan_source_config_get_start_time(config, &start);
+  if (!suscan_source_config_get_end_time(config, &end)) {
+    SU_ERROR("Cannot determine the duration of the capture\n");
+    goto fail;
+  }
+
+  timersub(&end, &start, &diff);
+  duration = diff.tv_sec + 1e-6 * diff.tv_usec;
+
+  count = params->segments;
+  if (count == 0) {
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    count = cores > 0 ? (unsigned int) cores : 1;
+  }
+
+  new->segment_count = count;
+  SU_TRY_FAIL(
+    new->segment_list = calloc(count, sizeof(struct suscan_batch_segment)));
+
+  for (i = 0; i < count; ++i) {
+    seg = new->segment_list + i;
+
+    seg->batch = new;
+    seg->index = i;
+
+    seg_start  = duration * i / count;
+    seg_end    = duration * (i + 1) / count;
+    warmup     = SU_MAX(0, seg_start - params->overlap);
+
+    /* Analyzer seeks are relative to the beginning of the capture */
+    suscan_batch_seconds_to_timeval(warmup, &seg->warmup);
+
+    suscan_batch_seconds_to_timeval(seg_start, &tv);
+    timeradd(&start, &tv, &seg->start);
+
+    suscan_batch_seconds_to_timeval(seg_end, &tv);
+    timeradd(&start, &tv, &seg->end);
+
+    timeradd(&start, &seg->warmup, &seg->last_time);
+
+    SU_TRY_FAIL(seg->config = suscan_source_config_clone(config));
+    suscan_source_config_set_loop(seg->config, SU_FALSE);
+
+    /* Segments would all race to build the same capture index */
+    SU_TRY_FAIL(
+      suscan_source_config_set_param(
+        seg->config,
+        SUSCAN_SOURCE_FILE_INDEX_PARAM,
+        "false"));
+
+    SU_TRY_FAIL(pthread_mutex_init(&seg->flow_mutex, NULL) == 0);
+    seg->flow_mutex_init = SU_TRUE;
+
+    SU_TRY_FAIL(suscan_mq_init(&seg->analyzer_mq));
+    seg->analyzer_mq_init = SU_TRUE;
+
+    SU_TRY_FAIL(suscan_mq_init(&seg->out_mq));
+    seg->out_mq_init = SU_TRUE;
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_batch_destroy(new);
+
+  return NULL;
+}
+
+SU_METHOD(suscan_batch, void, cancel)
+{
+  self->cancel = SU_TRUE;
+}
+
+SU_METHOD(suscan_batch, SUBOOL, run)
+{
+  struct suscan_batch_segment *seg;
+  struct suscan_msg *msg = NULL;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  for (i = 0; i < self->segment_count; ++i) {
+    seg = self->segment_list + i;
+    if (pthread_create(
+      &seg->thread,
+      NULL,
+      suscan_batch_segment_thread,
+      seg) != 0) {
+      SU_ERROR("Failed to create thread for segment %u\n", i);
+      goto done;
+    }
+
+    seg->running = SU_TRUE;
+  }
+
+  /* Segments are delivered one after another, so output keeps time order */
+  for (i = 0; i < self->segment_count; ++i) {
+    seg = self->segment_list + i;
+
+    for (;;) {
+      SU_TRY(msg = suscan_mq_read_msg(&seg->out_mq));
+
+      if (msg->type == SUSCAN_BATCH_MSG_TYPE_SEGMENT_END) {
+        SU_DISPOSE(suscan_msg, msg);
+        break;
+      }
+
+      if (!self->cancel && self->params.on_message != NULL)
+        if (!(self->params.on_message) (
+          self->params.userdata,
+          i,
+          msg->type,
+          msg->privdata))
+          suscan_batch_cancel(self);
+
+      suscan_analyzer_dispose_message(msg->type, msg->privdata);
+      SU_DISPOSE(suscan_msg, msg);
+
+      suscan_batch_segment_dec_pending(seg);
+    }
+
+    if (!seg->ok) {
+      SU_ERROR("Segment %u failed\n", i);
+      suscan_batch_cancel(self);
+    }
+  }
+
+  ok = !self->cancel;
+
+done:
+  if (!ok)
+    suscan_batch_cancel(self);
+
+  for (i = 0; i < self->segment_count; ++i) {
+    seg = self->segment_list + i;
+    if (seg->running) {
+      pthread_join(seg->thread, NULL);
+      seg->running = SU_FALSE;
+    }
+  }
+
+  return ok;
+}
+
+SU_COLLECTOR(suscan_batch)
+{
+  unsigned int i;
+
+  if (self->segment_list != NULL) {
+    suscan_batch_cancel(self);
+
+    for (i = 0; i < self->segment_count; ++i)
+      if (self->segment_list[i].running)
+        pthread_join(self->segment_list[i].thread, NULL);
+
+    for (i = 0; i < self->segment_count; ++i)
+      suscan_batch_segment_finalize(self->segment_list + i);
+
+    free(self->segment_list);
+  }
+
+  free(self);
+}
@@ -0,0 +1,147 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SUSCAN_BATCH_H
+#define _SUSCAN_BATCH_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <sigutils/util/compat-time.h>
+#include <pthread.h>
+
+#include "analyzer.h"
+#include "mq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_BATCH_DEFAULT_OVERLAP   1.0    /* Seconds */
+#define SUSCAN_BATCH_MAX_PENDING       256    /* Messages per segment */
+#define SUSCAN_BATCH_READY_TIMEOUT_S   10
+
+/*
+ * Batch analysis of seekable file sources. The capture is split in as many
+ * consecutive time segments as requested, and every segment is processed at
+ * full speed by its own local analyzer. Each analyzer starts a little before
+ * its segment (the overlap), so that inspectors and estimators can settle
+ * before any of their output is taken into account.
+ *
+ * Data messages (PSD updates, sample batches and inspector spectrum,
+ * estimator, signal and orbit report messages) are kept only if they fall
+ * inside the segment that produced them, and are delivered to the user in
+ * timestamp order: segment by segment. Timestamps are taken from PSD updates,
+ * so their resolution is the PSD update interval of the analyzer. Any other
+ * message (e.g. inspector open responses) is always delivered, in the same
+ * order.
+ *
+ * Segment sources are read as fast as possible, but a segment whose output
+ * is not being consumed (e.g. because the user is still going through the
+ * previous ones) stops reading once SUSCAN_BATCH_MAX_PENDING messages are
+ * waiting, and resumes when half of them have been delivered.
+ */
+
+struct suscan_batch_params {
+  unsigned int segments;  /* 0: one per core */
+  SUFLOAT      overlap;   /* Warm-up time, in seconds */
+
+  void *userdata;
+
+  /* Called from the segment thread, once its analyzer is ready */
+  SUBOOL (*on_segment_start) (
+    void *userdata,
+    suscan_analyzer_t *analyzer,
+    unsigned int segment);
+
+  /* Called from the caller thread. Messages are disposed afterwards. */
+  SUBOOL (*on_message) (
+    void *userdata,
+    unsigned int segment,
+    uint32_t type,
+    void *msg);
+};
+
+#define suscan_batch_params_INITIALIZER                 \
+{                                                       \
+  0,                             /* segments */         \
+  SUSCAN_BATCH_DEFAULT_OVERLAP,  /* overlap */          \
+  NULL,                          /* userdata */         \
+  NULL,                          /* on_segment_start */ \
+  NULL,                          /* on_message */       \
+}
+
+struct suscan_batch;
+
+struct suscan_batch_segment {
+  struct suscan_batch    *batch;
+  unsigned int            index;
+  struct timeval          warmup;  /* Seek position, relative to capture start */
+  struct timeval          start;   /* Output window, absolute */
+  struct timeval          end;
+  struct timeval          last_time;
+
+  suscan_source_config_t *config;
+  suscan_analyzer_t      *analyzer;
+  struct suscan_mq        analyzer_mq;
+  SUBOOL                  analyzer_mq_init;
+  struct suscan_mq        out_mq;  /* Messages to deliver, in order */
+  SUBOOL                  out_mq_init;
+
+  /* Backpressure. The source is cleared before the analyzer goes away. */
+  pthread_mutex_t         flow_mutex;
+  SUBOOL                  flow_mutex_init;
+  suscan_source_t        *source;
+  unsigned int            pending;
+  SUBOOL                  held;
+
+  pthread_t               thread;
+  SUBOOL                  running;
+  SUBOOL                  ok;
+};
+
+struct suscan_batch {
+  struct suscan_batch_params    params;
+  struct suscan_analyzer_params analyzer_params;
+
+  struct suscan_batch_segment  *segment_list;
+  unsigned int                  segment_count;
+
+  volatile SUBOOL               cancel;
+};
+
+typedef struct suscan_batch suscan_batch_t;
+
+SU_INSTANCER(
+  suscan_batch,
+  const struct suscan_analyzer_params *analyzer_params,
+  const suscan_source_config_t *config,
+  const struct suscan_batch_params *params);
+SU_COLLECTOR(suscan_batch);
+
+/* Starts all segments and delivers their messages until done */
+SU_METHOD(suscan_batch, SUBOOL, run);
+
+/* Can be called from the callbacks to stop processing */
+SU_METHOD(suscan_batch, void, cancel);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _SUSCAN_BATCH_H */
@@ -19,14 +19,29 @@
 #define SU_LOG_DOMAIN "bufpool"
 
 #include <sigutils/log.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "bufpool.h"
 
 #define MIN_POOL 5
-#define NUM_POOLS 16
+#define NUM_POOLS 17
 
 SUPRIVATE struct suscan_pool pools[NUM_POOLS];
+SUPRIVATE pthread_once_t pools_once = PTHREAD_ONCE_INIT;
+SUPRIVATE SUBOOL pools_init = SU_FALSE;
 
+SUPRIVATE void
+suscan_init_pools_once(void)
+{
+  unsigned int i;
+
+  for (i = 0; i < NUM_POOLS; ++i)
+    if (pthread_mutex_init(&pools[i].mutex, NULL) != 0)
+      return;
+
+  pools_init = SU_TRUE;
+}
 
 void
 suscan_buffer_return(SUCOMPLEX *data)
@@ -45,23 +60,34 @@ suscan_buffer_return(SUCOMPLEX *data)
   index = header->pool_index;
 
   pthread_mutex_lock(&pools[index].mutex);
-  header->next = pools[index].first;
-  pools[index].first = header;
-  pthread_mutex_lock(&pools[index].mutex);
+  --pools[index].in_use;
+  if (pools[index].free < SU_MAX(SUSCAN_POOL_MIN_FREE, pools[index].in_use)) {
+    header->next = pools[index].first;
+    pools[index].first = header;
+    ++pools[index].free;
+    header = NULL;
+  } else {
+    --pools[index].allocated;
+  }
+  pthread_mutex_unlock(&pools[index].mutex);
 
+  /* Free list is full, give it back to the system */
+  if (header != NULL)
+    free(header);
 }
 
 SUCOMPLEX *
 suscan_buffer_alloc(unsigned int length)
 {
-  unsigned int i = 0;
+  unsigned int i = MIN_POOL;
   struct suscan_buffer_header *header = NULL;
+  SUBOOL fresh = SU_FALSE;
 
-  while ((length >>= 1) != 0)
-    ++i;
+  SU_TRY_FAIL(suscan_init_pools());
 
-  if (i < MIN_POOL)
-    i = MIN_POOL;
+  /* Smallest pool whose buffers fit length samples */
+  while (i < NUM_POOLS && (1u << i) < length)
+    ++i;
 
   if (i >= NUM_POOLS) {
     SU_ERROR("Pool allocation of %d samples is too big\n", length);
@@ -70,8 +96,10 @@ suscan_buffer_alloc(unsigned int length)
 
   pthread_mutex_lock(&pools[i].mutex);
   header = pools[i].first;
-  if (header != NULL)
+  if (header != NULL) {
     pools[i].first = header->next;
+    --pools[i].free;
+  }
   pthread_mutex_unlock(&pools[i].mutex);
 
   if (header == NULL) {
@@ -79,24 +107,53 @@ suscan_buffer_alloc(unsigned int length)
         header = malloc(
           sizeof(struct suscan_buffer_header) + (sizeof(SUCOMPLEX) << i)),
         return NULL);
+    fresh = SU_TRUE;
   }
 
   header->pool_index = i;
   header->length = length;
 
+  pthread_mutex_lock(&pools[i].mutex);
+  if (fresh)
+    ++pools[i].allocated;
+  ++pools[i].in_use;
+  pthread_mutex_unlock(&pools[i].mutex);
+
   return header->data;
+
+fail:
+  return NULL;
 }
 
-SUBOOL
-suscan_init_pools(void)
+void
+suscan_buffer_get_stats(struct suscan_buffer_stats *stats)
 {
   unsigned int i;
+  size_t size;
+
+  memset(stats, 0, sizeof(struct suscan_buffer_stats));
+
+  if (!suscan_init_pools())
+    return;
 
   for (i = 0; i < NUM_POOLS; ++i) {
-    SU_TRYCATCH(
-        pthread_mutex_init(&pools[i].mutex, NULL) != -1,
-        return SU_FALSE);
+    size = sizeof(struct suscan_buffer_header) + (sizeof(SUCOMPLEX) << i);
+
+    pthread_mutex_lock(&pools[i].mutex);
+    stats->buffers_allocated += pools[i].allocated;
+    stats->buffers_in_use    += pools[i].in_use;
+    stats->buffers_free      += pools[i].free;
+    stats->bytes_allocated   += pools[i].allocated * size;
+    stats->bytes_in_use      += pools[i].in_use * size;
+    stats->bytes_free        += pools[i].free * size;
+    pthread_mutex_unlock(&pools[i].mutex);
   }
+}
+
+SUBOOL
+suscan_init_pools(void)
+{
+  (void) pthread_once(&pools_once, suscan_init_pools_once);
 
-  return SU_TRUE;
+  return pools_init;
 }
@@ -31,7 +31,7 @@ struct suscan_buffer_header {
   union {
     struct {
       uint16_t pool_index;
-      uint16_t length;
+      uint32_t length;
     };
 
     struct suscan_buffer_header *next;
@@ -42,13 +42,33 @@ struct suscan_buffer_header {
 };
 
 
+/*
+ * Returned buffers are kept in a free list for reuse. The free list of a pool
+ * never holds more than SUSCAN_POOL_MIN_FREE buffers or as many buffers as
+ * there are in use, whichever is larger. Buffers returned beyond that are
+ * released to the system, so a burst of allocations does not pin its peak
+ * memory forever.
+ */
+#define SUSCAN_POOL_MIN_FREE 4
+
 struct suscan_pool {
   struct suscan_buffer_header *first;
   unsigned int allocated;
+  unsigned int in_use;
+  unsigned int free;
   pthread_mutex_t mutex;
 };
 
-SUINLINE uint16_t
+struct suscan_buffer_stats {
+  SUSCOUNT buffers_allocated; /* Obtained from the system */
+  SUSCOUNT buffers_in_use;
+  SUSCOUNT buffers_free;      /* Pooled, waiting for reuse */
+  SUSCOUNT bytes_allocated;
+  SUSCOUNT bytes_in_use;
+  SUSCOUNT bytes_free;
+};
+
+SUINLINE uint32_t
 suscan_buffer_get_length(const SUCOMPLEX *data)
 {
   struct suscan_buffer_header *header;
@@ -58,8 +78,21 @@ suscan_buffer_get_length(const SUCOMPLEX *data)
   return header->length;
 }
 
+SUINLINE SUSCOUNT
+suscan_buffer_get_capacity(const SUCOMPLEX *data)
+{
+  struct suscan_buffer_header *header;
+  header = (struct suscan_buffer_header *) (
+      (char *) data - sizeof(struct suscan_buffer_header));
+
+  return 1ul << header->pool_index;
+}
+
 void suscan_buffer_return(SUCOMPLEX *data);
 SUCOMPLEX *suscan_buffer_alloc(unsigned int length);
+void suscan_buffer_get_stats(struct suscan_buffer_stats *stats);
+
+/* Called on first allocation too */
 SUBOOL suscan_init_pools(void);
 
 #ifdef __cplusplus
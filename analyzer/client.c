@@ -138,6 +138,44 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_get_overview_async(
+    suscan_analyzer_t *analyzer,
+    unsigned int level,
+    SUSCOUNT first_row,
+    SUSCOUNT row_count,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_overview_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      msg = suscan_analyzer_overview_msg_new(
+        level,
+        first_row,
+        row_count,
+        req_id),
+      goto done);
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW,
+      msg)) {
+    SU_ERROR("Failed to send overview request\n");
+    goto done;
+  }
+
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_overview_msg_destroy(msg);
+
+  return ok;
+}
+
 SUBOOL
 suscan_analyzer_set_history_size_async(
     suscan_analyzer_t *analyzer,
@@ -207,13 +245,14 @@ done:
 }
 
 /****************************** Inspector methods ****************************/
-SUBOOL
-suscan_analyzer_open_ex_async(
+SUPRIVATE SUBOOL
+suscan_analyzer_open_inspector_async(
     suscan_analyzer_t *analyzer,
     const char *class,
     const struct sigutils_channel *channel,
     SUBOOL precise,
     SUHANDLE parent,
+    unsigned int stream,
     uint32_t req_id)
 {
   struct suscan_analyzer_inspector_msg *req = NULL;
@@ -230,6 +269,7 @@ suscan_analyzer_open_ex_async(
   req->channel = *channel;
   req->precise = precise;
   req->handle  = parent;
+  req->stream  = stream;
 
   if (!suscan_analyzer_write(
       analyzer,
@@ -250,6 +290,50 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_open_ex_async(
+    suscan_analyzer_t *analyzer,
+    const char *class,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    SUHANDLE parent,
+    uint32_t req_id)
+{
+  return suscan_analyzer_open_inspector_async(
+      analyzer,
+      class,
+      channel,
+      precise,
+      parent,
+      0,
+      req_id);
+}
+
+SUBOOL
+suscan_analyzer_open_stream_async(
+    suscan_analyzer_t *analyzer,
+    const char *class,
+    const struct sigutils_channel *channel,
+    SUBOOL precise,
+    unsigned int stream,
+    uint32_t req_id)
+{
+  /* Remote analyzers do not forward the source channel */
+  if (stream != 0 && !suscan_analyzer_is_local(analyzer)) {
+    SU_ERROR("Remote analyzers can only inspect the first source channel\n");
+    return SU_FALSE;
+  }
+
+  return suscan_analyzer_open_inspector_async(
+      analyzer,
+      class,
+      channel,
+      precise,
+      -1,
+      stream,
+      req_id);
+}
+
 SUBOOL
 suscan_analyzer_open_async(
     suscan_analyzer_t *analyzer,
@@ -692,6 +776,84 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_set_inspector_paused_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    SUBOOL paused,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_inspector_msg *req = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      req = suscan_analyzer_inspector_msg_new(
+          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_PAUSED,
+          req_id),
+      goto done);
+
+  req->handle = handle;
+  req->paused = paused;
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+      req)) {
+    SU_ERROR("Failed to send set_paused command\n");
+    goto done;
+  }
+
+  req = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (req != NULL)
+    suscan_analyzer_inspector_msg_destroy(req);
+
+  return ok;
+}
+
+SUBOOL
+suscan_analyzer_set_inspector_squelch_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    SUBOOL enabled,
+    SUFLOAT level,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_inspector_msg *req = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(
+      req = suscan_analyzer_inspector_msg_new(
+          SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_SQUELCH,
+          req_id),
+      goto done);
+
+  req->handle = handle;
+  req->squelch_enabled = enabled;
+  req->squelch_level = level;
+
+  if (!suscan_analyzer_write(
+      analyzer,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+      req)) {
+    SU_ERROR("Failed to send set_squelch command\n");
+    goto done;
+  }
+
+  req = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (req != NULL)
+    suscan_analyzer_inspector_msg_destroy(req);
+
+  return ok;
+}
+
 SUBOOL
 suscan_analyzer_set_inspector_watermark_async(
     suscan_analyzer_t *analyzer,
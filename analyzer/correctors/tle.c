@@ -154,6 +154,161 @@ suscan_frequency_corrector_tle_get_report(
   return SU_TRUE;
 }
 
+/************************** Range rate table ********************************/
+SUPRIVATE SUDOUBLE
+suscan_tle_corrector_propagate_vlos(suscan_tle_corrector_t *self, SUDOUBLE t)
+{
+  struct timeval tv;
+  xyz_t vel_azel;
+
+  tv.tv_sec  = floor(t);
+  tv.tv_usec = (t - tv.tv_sec) * 1e6;
+
+  sgdp4_prediction_update(&self->prediction, &tv);
+  sgdp4_prediction_get_vel_azel(&self->prediction, &vel_azel);
+
+  ++self->table.propagations;
+
+  return vel_azel.distance;
+}
+
+SUINLINE SUDOUBLE
+suscan_tle_corrector_table_node(
+  const struct suscan_tle_corrector_table *table,
+  int64_t n)
+{
+  return table->vlos[n % SUSCAN_TLE_CORRECTOR_TABLE_SIZE];
+}
+
+/* The first interpolation interval starts at t */
+SUPRIVATE void
+suscan_tle_corrector_table_reset(
+  suscan_tle_corrector_t *self,
+  SUDOUBLE t,
+  SUDOUBLE step)
+{
+  self->table.step  = step;
+  self->table.t0    = t - step;
+  self->table.first = 0;
+  self->table.count = 0;
+
+  ++self->table.rebuilds;
+}
+
+/*
+ * Appends the next node. If there are enough nodes, the new one is checked
+ * against the cubic extrapolation of the previous four. For a smooth curve,
+ * the extrapolation error bounds the error of the interpolation (centered
+ * in the same nodes) from above by a factor of about 40. Requiring it to be
+ * below 8 times the tolerance keeps interpolated corrections within it, with
+ * some margin for curves that are not that smooth.
+ */
+SUPRIVATE SUBOOL
+suscan_tle_corrector_table_extend(suscan_tle_corrector_t *self)
+{
+  struct suscan_tle_corrector_table *table = &self->table;
+  int64_t n = table->first + table->count;
+  SUDOUBLE v, p;
+
+  v = suscan_tle_corrector_propagate_vlos(self, table->t0 + n * table->step);
+
+  if (table->count >= 4) {
+    p = -     suscan_tle_corrector_table_node(table, n - 4)
+        + 4 * suscan_tle_corrector_table_node(table, n - 3)
+        - 6 * suscan_tle_corrector_table_node(table, n - 2)
+        + 4 * suscan_tle_corrector_table_node(table, n - 1);
+
+    table->last_error = SU_ABS(p - v);
+
+    if (table->last_error > 8 * SUSCAN_TLE_CORRECTOR_TOLERANCE
+      && table->step > SUSCAN_TLE_CORRECTOR_MIN_STEP)
+      return SU_FALSE;
+  }
+
+  if (table->count == SUSCAN_TLE_CORRECTOR_TABLE_SIZE) {
+    ++table->first;
+    --table->count;
+  }
+
+  table->vlos[n % SUSCAN_TLE_CORRECTOR_TABLE_SIZE] = v;
+  ++table->count;
+
+  return SU_TRUE;
+}
+
+/* Four-point Lagrange interpolation between nodes i and i + 1 */
+SUPRIVATE SUDOUBLE
+suscan_tle_corrector_table_interp(
+  const struct suscan_tle_corrector_table *table,
+  int64_t i,
+  SUDOUBLE u)
+{
+  SUDOUBLE y0 = suscan_tle_corrector_table_node(table, i - 1);
+  SUDOUBLE y1 = suscan_tle_corrector_table_node(table, i);
+  SUDOUBLE y2 = suscan_tle_corrector_table_node(table, i + 1);
+  SUDOUBLE y3 = suscan_tle_corrector_table_node(table, i + 2);
+
+  return -y0 * u * (u - 1) * (u - 2) / 6
+    +     y1 * (u + 1) * (u - 1) * (u - 2) / 2
+    -     y2 * (u + 1) * u * (u - 2) / 2
+    +     y3 * (u + 1) * u * (u - 1) / 6;
+}
+
+SUPRIVATE SUDOUBLE
+suscan_tle_corrector_get_vlos(
+  suscan_tle_corrector_t *self,
+  const struct timeval *tv)
+{
+  struct suscan_tle_corrector_table *table = &self->table;
+  SUDOUBLE t = tv->tv_sec + 1e-6 * tv->tv_usec;
+  SUDOUBLE x;
+  int64_t i;
+
+  if (table->step == 0)
+    suscan_tle_corrector_table_reset(
+      self,
+      t,
+      SUSCAN_TLE_CORRECTOR_DEFAULT_STEP);
+
+  for (;;) {
+    x = (t - table->t0) / table->step;
+    i = SU_FLOOR(x);
+
+    /* Seeks and large gaps: start over rather than catching up */
+    if (i - 1 < table->first
+      || i + 2 >= table->first + table->count + SUSCAN_TLE_CORRECTOR_TABLE_SIZE) {
+      suscan_tle_corrector_table_reset(
+        self,
+        t,
+        SUSCAN_TLE_CORRECTOR_DEFAULT_STEP);
+      continue;
+    }
+
+    /* Curve too sharp for this step (e.g. near culmination) */
+    while (table->first + table->count <= i + 2)
+      if (!suscan_tle_corrector_table_extend(self))
+        break;
+
+    if (table->first + table->count > i + 2)
+      break;
+
+    suscan_tle_corrector_table_reset(self, t, .5 * table->step);
+  }
+
+  /*
+   * Once past the sharp part of the curve, go back to longer steps. The
+   * error grows as step^4, so doubling it will not trigger a halving.
+   */
+  if (table->count == SUSCAN_TLE_CORRECTOR_TABLE_SIZE
+    && table->step < SUSCAN_TLE_CORRECTOR_DEFAULT_STEP
+    && table->last_error < .25 * SUSCAN_TLE_CORRECTOR_TOLERANCE) {
+    suscan_tle_corrector_table_reset(self, t, 2 * table->step);
+    return suscan_tle_corrector_get_vlos(self, tv);
+  }
+
+  return suscan_tle_corrector_table_interp(table, i, x - i);
+}
+
 /* TODO: Use correction reports? */
 SUBOOL
 suscan_tle_corrector_correct_freq(
@@ -162,13 +317,9 @@ suscan_tle_corrector_correct_freq(
   SUFREQ freq,
   SUFLOAT *delta_freq)
 {
-  xyz_t pos_azel, vel_azel;
-
-  sgdp4_prediction_update(&self->prediction, tv);
-  sgdp4_prediction_get_azel(&self->prediction, &pos_azel);
-  sgdp4_prediction_get_vel_azel(&self->prediction, &vel_azel);
+  SUDOUBLE vlos = suscan_tle_corrector_get_vlos(self, tv);
   
-  *delta_freq = -vel_azel.distance / SPEED_OF_LIGHT_KM_S * freq;
+  *delta_freq = -vlos / SPEED_OF_LIGHT_KM_S * freq;
 
   return SU_TRUE;
 }
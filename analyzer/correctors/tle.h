@@ -32,8 +32,32 @@ enum suscan_tle_corrector_mode {
   SUSCAN_TLE_CORRECTOR_MODE_ORBIT
 };
 
+/*
+ * Doppler is smooth over seconds, so corrections are interpolated from a
+ * table of range rates computed every few seconds, instead of propagating
+ * the orbit on every call. The table is a sliding window that is extended
+ * one node at a time as time advances.
+ */
+#define SUSCAN_TLE_CORRECTOR_TABLE_SIZE   32
+#define SUSCAN_TLE_CORRECTOR_DEFAULT_STEP 10.   /* Seconds */
+#define SUSCAN_TLE_CORRECTOR_MIN_STEP     .25   /* Seconds */
+#define SUSCAN_TLE_CORRECTOR_TOLERANCE    1e-5  /* Range rate, km/s */
+
+struct suscan_tle_corrector_table {
+  SUDOUBLE     t0;     /* Time of node 0 (seconds since the epoch) */
+  SUDOUBLE     step;
+  int64_t      first;  /* Index of the oldest node */
+  unsigned int count;
+  SUDOUBLE     vlos[SUSCAN_TLE_CORRECTOR_TABLE_SIZE]; /* By index modulo size */
+  SUDOUBLE     last_error; /* Of the last extrapolation check */
+
+  uint64_t     propagations;
+  uint64_t     rebuilds;
+};
+
 struct suscan_tle_corrector {
   sgdp4_prediction_t prediction;
+  struct suscan_tle_corrector_table table;
 };
 
 typedef struct suscan_tle_corrector suscan_tle_corrector_t;
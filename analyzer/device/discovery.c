@@ -190,6 +190,73 @@ done:
   return dev_count;
 }
 
+SU_GETTER(
+  suscan_device_discovery,
+  struct suscan_device_properties *,
+  lookup_device,
+  uint64_t uuid)
+{
+  suscan_device_discovery_t *mut = (suscan_device_discovery_t *) self;
+  struct suscan_device_properties *dup = NULL;
+  unsigned int i;
+
+  pthread_mutex_lock(&mut->mutex);
+
+  for (i = 0; i < self->device_count; ++i)
+    if (self->device_list[i] != NULL 
+      && self->device_list[i]->uuid == uuid) {
+      dup = suscan_device_properties_dup(self->device_list[i]);
+      break;
+    }
+
+  pthread_mutex_unlock(&mut->mutex);
+
+  return dup;
+}
+
+/*
+ * Devices from the device cache are accepted as the result of a first,
+ * implicit discovery. Ownership of the properties is transferred to the
+ * discovery object (even on failure).
+ */
+SU_METHOD(
+  suscan_device_discovery,
+  SUBOOL,
+  preload,
+  struct suscan_device_properties **list,
+  unsigned int count)
+{
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  pthread_mutex_lock(&self->mutex);
+
+  if (self->epoch != 0 || self->device_count != 0) {
+    SU_ERROR("%s: cannot preload after a discovery\n", self->iface->name);
+    goto done;
+  }
+
+  for (i = 0; i < count; ++i) {
+    suscan_device_properties_set_epoch(list[i], self->epoch);
+    list[i]->discovery = self;
+    SU_TRYC(PTR_LIST_APPEND_CHECK(self->device, list[i]));
+    list[i] = NULL;
+  }
+
+  ++self->epoch;
+
+  ok = SU_TRUE;
+
+done:
+  pthread_mutex_unlock(&self->mutex);
+
+  for (i = 0; i < count; ++i)
+    if (list[i] != NULL)
+      SU_DISPOSE(suscan_device_properties, list[i]);
+
+  return ok;
+}
+
 SU_METHOD(suscan_device_discovery, SUBOOL, start)
 {
   SUBOOL ok = SU_FALSE;
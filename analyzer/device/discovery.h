@@ -32,12 +32,19 @@ extern "C" {
 struct suscan_device_properties;
 struct suscan_device_discovery;
 
+/*
+ * Devices probed less than this many seconds ago are not opened again
+ * during discovery. Their last known properties are reused instead.
+ */
+#define SUSCAN_DEVICE_PROBE_TTL 3600
+
 struct suscan_device_discovery_interface {
   const char *name;
   void  *(*open)      ();
   SUBOOL (*discovery) (void *, struct suscan_device_discovery *);
   SUBOOL (*cancel)    (void *);
   SUBOOL (*close)     (void *);
+  SUBOOL cacheable; /* Results are kept in the device cache across runs */
 };
 
 struct suscan_device_discovery {
@@ -65,11 +72,15 @@ SU_GETTER(suscan_device_discovery, uint32_t, epoch);
 
 SU_GETTER(suscan_device_discovery, int, devices, struct suscan_device_properties ***);
 
+/* Copy of a device found by the last discovery, NULL if not found */
+SU_GETTER(suscan_device_discovery, struct suscan_device_properties *, lookup_device, uint64_t);
+
 SU_METHOD(suscan_device_discovery, SUBOOL, start);
 SU_METHOD(suscan_device_discovery, SUBOOL, cancel);
 SU_METHOD(suscan_device_discovery, SUBOOL, stop);
 SU_METHOD(suscan_device_discovery, SUBOOL, push_device, struct suscan_device_properties *);
 SU_METHOD(suscan_device_discovery, void,   accept);
+SU_METHOD(suscan_device_discovery, SUBOOL, preload, struct suscan_device_properties **, unsigned int);
 SU_METHOD(suscan_device_discovery, void,   discard);
 SU_METHOD(suscan_device_discovery, void,   clear);
 
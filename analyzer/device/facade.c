@@ -28,6 +28,11 @@
 
 #include <analyzer/analyzer.h>
 #include <analyzer/source.h>
+#include <util/compat.h>
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 SUPRIVATE suscan_device_facade_t *g_dev_facade = NULL;
 SUPRIVATE SUBOOL                  g_exiting = SU_FALSE;
@@ -164,19 +169,50 @@ SU_METHOD(suscan_device_discovery_thread, SUBOOL, discovery)
     NULL);
 }
 
+/* Called with disc_lock held */
+SUPRIVATE void
+suscan_device_facade_push_event_unsafe(
+  suscan_device_facade_t *self,
+  enum suscan_device_event_type type,
+  uint64_t uuid,
+  const char *discovery)
+{
+  struct suscan_device_event *event;
+
+  /* Overwrites the oldest event once the list is full */
+  event = self->event_list + self->event_seq % SUSCAN_DEVICE_FACADE_MAX_EVENTS;
+
+  event->type      = type;
+  event->uuid      = uuid;
+  event->discovery = discovery;
+
+  ++self->event_seq;
+}
+
+/*
+ * Devices are compared against the previous round of the same
+ * discovery (thread->last_epoch) to find out what changed.
+ */
 SUPRIVATE SUBOOL
 suscan_device_facade_update_from_discovery(
   suscan_device_facade_t *self,
-  suscan_device_discovery_t *discovery)
+  suscan_device_discovery_thread_t *thread)
 {
+  suscan_device_discovery_t *discovery = thread->discovery;
+  const char *name = thread->iface->name;
   struct rbtree_node *node;
   struct suscan_device_properties *prop = NULL;
   uint64_t uuid;
+  unsigned int epoch;
+  uint64_t prev_events;
   PTR_LIST_LOCAL(struct suscan_device_properties, dev);
   unsigned int i;
   SUBOOL ok = SU_FALSE;
 
   pthread_mutex_lock(&self->list_mutex);
+  pthread_mutex_lock(&self->disc_lock);
+
+  prev_events = self->event_seq;
 
   dev_count = suscan_device_discovery_devices(discovery, &dev_list);
   if (dev_count == -1) {
@@ -186,6 +222,9 @@ suscan_device_facade_update_from_discovery(
     goto done;
   }
 
+  /* Devices are pushed in the epoch previous to the accepted one */
+  epoch = suscan_device_discovery_epoch(discovery) - 1;
+
   for (i = 0; i < dev_count; ++i) {
     uuid = suscan_device_properties_uuid(dev_list[i]);
     node = rbtree_search(self->uuid2device, uuid, RB_EXACT);
@@ -193,6 +232,20 @@ suscan_device_facade_update_from_discovery(
     if (node != NULL && node->data != NULL) {
       /* Already exists. Replace in list. */
       prop = node->data;
+
+      if (prop->discovery != discovery || prop->epoch != thread->last_epoch)
+        suscan_device_facade_push_event_unsafe(
+          self,
+          SUSCAN_DEVICE_EVENT_ADDED,
+          uuid,
+          name);
+      else if (prop->probed != dev_list[i]->probed)
+        suscan_device_facade_push_event_unsafe(
+          self,
+          SUSCAN_DEVICE_EVENT_UPDATED,
+          uuid,
+          name);
+
       suscan_device_properties_swap(dev_list[i], prop);
       prop = NULL;
     } else {
@@ -201,22 +254,40 @@ suscan_device_facade_update_from_discovery(
       SU_TRYC(PTR_LIST_APPEND_CHECK(self->device, prop));
       dev_list[i] = NULL;
       rbtree_insert(self->uuid2device, uuid, prop);
-#if 0
-      char *uri = NULL;
-      uri = suscan_device_make_uri(
-        prop->analyzer->name,
-        prop->source->name,
-        &prop->traits);
-    
-      SU_INFO("FACADE: %s\n", uri);
-      free(uri);
-#endif
+      prop = NULL;
+
+      suscan_device_facade_push_event_unsafe(
+        self,
+        SUSCAN_DEVICE_EVENT_ADDED,
+        uuid,
+        name);
     }
   }
 
+  /* Seen in the previous round, but not in this one */
+  if (epoch != thread->last_epoch)
+    for (i = 0; i < self->device_count; ++i) {
+      prop = self->device_list[i];
+      if (prop->discovery == discovery && prop->epoch == thread->last_epoch)
+        suscan_device_facade_push_event_unsafe(
+          self,
+          SUSCAN_DEVICE_EVENT_REMOVED,
+          prop->uuid,
+          name);
+    }
+
+  prop = NULL;
+
+  thread->last_epoch     = epoch;
+  thread->last_discovery = time(NULL);
+
   ok = SU_TRUE;
 
 done:
+  if (self->event_seq != prev_events)
+    pthread_cond_broadcast(&self->disc_cond);
+
+  pthread_mutex_unlock(&self->disc_lock);
   pthread_mutex_unlock(&self->list_mutex);
 
   if (dev_count > 0) {
@@ -225,9 +296,217 @@ done:
         SU_DISPOSE(suscan_device_properties, dev_list[i]);
   }
 
+  if (dev_list != NULL)
+    free(dev_list);
+
+  return ok;
+}
+
+/*
+ * The device cache keeps the devices found by the last round of every
+ * cacheable discovery, so they can be resolved right after startup
+ * without waiting for (or even starting) a new discovery.
+ */
+SUPRIVATE void
+suscan_device_facade_save_cache(suscan_device_facade_t *self)
+{
+  grow_buf_t buffer = grow_buf_INITIALIZER;
+  suscan_object_t *set = NULL;
+  suscan_object_t *obj = NULL;
+  const suscan_device_discovery_thread_t *thread;
+  const struct suscan_device_properties *prop;
+  char *tmp_path = NULL;
+  unsigned int i, j;
+  size_t size;
+  int fd = -1;
+  SUBOOL locked = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->cache_path == NULL)
+    return;
+
+  SU_MAKE(set, suscan_object, SUSCAN_OBJECT_TYPE_SET);
+
+  pthread_mutex_lock(&self->list_mutex);
+  locked = SU_TRUE;
+
+  for (i = 0; i < self->thread_count; ++i) {
+    thread = self->thread_list[i];
+    if (!thread->iface->cacheable)
+      continue;
+
+    for (j = 0; j < self->device_count; ++j) {
+      prop = self->device_list[j];
+      if (prop->discovery != thread->discovery
+        || prop->epoch != thread->last_epoch)
+        continue;
+
+      SU_TRY(obj = suscan_device_properties_to_object(prop));
+      SU_TRY(
+        suscan_object_set_field_value(obj, "discovery", thread->iface->name));
+      SU_TRY(suscan_object_set_append(set, obj));
+      obj = NULL;
+    }
+  }
+
+  pthread_mutex_unlock(&self->list_mutex);
+  locked = SU_FALSE;
+
+  SU_TRY(suscan_object_to_cbor(set, &buffer));
+  SU_TRY(tmp_path = strbuild("%s.tmp", self->cache_path));
+  SU_TRY((fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) != -1);
+
+  size = grow_buf_get_size(&buffer);
+  SU_TRY(write(fd, grow_buf_get_buffer(&buffer), size) == size);
+
+  close(fd);
+  fd = -1;
+
+  SU_TRY(rename(tmp_path, self->cache_path) == 0);
+
+  ok = SU_TRUE;
+
+done:
+  if (locked)
+    pthread_mutex_unlock(&self->list_mutex);
+
+  if (!ok)
+    SU_WARNING("Cannot save device cache to %s\n", self->cache_path);
+
+  if (fd != -1) {
+    close(fd);
+    unlink(tmp_path);
+  }
+
+  if (tmp_path != NULL)
+    free(tmp_path);
+
+  if (obj != NULL)
+    SU_DISPOSE(suscan_object, obj);
+
+  if (set != NULL)
+    SU_DISPOSE(suscan_object, set);
+
+  grow_buf_finalize(&buffer);
+}
+
+SUPRIVATE SUBOOL
+suscan_device_facade_load_cache(suscan_device_facade_t *self)
+{
+  grow_buf_t buffer;
+  suscan_object_t *set = NULL;
+  const suscan_object_t *obj;
+  suscan_device_discovery_thread_t *thread;
+  struct suscan_device_properties *prop = NULL;
+  PTR_LIST_LOCAL(struct suscan_device_properties, cached);
+  const char *name;
+  struct stat sbuf;
+  void *data = NULL;
+  time_t now = time(NULL);
+  unsigned int i, j;
+  int fd = -1;
+  SUBOOL preloaded;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->cache_path == NULL)
+    return SU_TRUE;
+
+  /* No cache yet */
+  if (stat(self->cache_path, &sbuf) == -1 || sbuf.st_size == 0)
+    return SU_TRUE;
+
+  SU_ALLOCATE_MANY(data, sbuf.st_size, uint8_t);
+  SU_TRY((fd = open(self->cache_path, O_RDONLY)) != -1);
+  SU_TRY(read(fd, data, sbuf.st_size) == sbuf.st_size);
+
+  grow_buf_init_loan(&buffer, data, sbuf.st_size, sbuf.st_size);
+  SU_TRY(set = suscan_object_from_cbor(&buffer));
+  SU_TRY(suscan_object_get_type(set) == SUSCAN_OBJECT_TYPE_SET);
+
+  for (i = 0; i < self->thread_count; ++i) {
+    thread = self->thread_list[i];
+    if (!thread->iface->cacheable)
+      continue;
+
+    for (j = 0; j < suscan_object_set_get_count(set); ++j) {
+      if ((obj = suscan_object_set_get(set, j)) == NULL
+        || (name = suscan_object_get_field_value(obj, "discovery")) == NULL
+        || strcmp(name, thread->iface->name) != 0)
+        continue;
+
+      /* Entries from unknown source types are silently skipped */
+      if ((prop = suscan_device_properties_from_object(obj)) == NULL)
+        continue;
+
+      if (now - prop->probed > SUSCAN_DEVICE_CACHE_TTL) {
+        SU_DISPOSE(suscan_device_properties, prop);
+        prop = NULL;
+        continue;
+      }
+
+      SU_TRYC(PTR_LIST_APPEND_CHECK(cached, prop));
+      prop = NULL;
+    }
+
+    if (cached_count > 0) {
+      /* Ownership is transferred, even on failure */
+      preloaded = suscan_device_discovery_preload(
+          thread->discovery,
+          cached_list,
+          cached_count);
+      free(cached_list);
+      cached_list  = NULL;
+      cached_count = 0;
+
+      SU_TRY(preloaded);
+      SU_TRY(suscan_device_facade_update_from_discovery(self, thread));
+    }
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok)
+    SU_WARNING("Device cache %s ignored\n", self->cache_path);
+
+  if (prop != NULL)
+    SU_DISPOSE(suscan_device_properties, prop);
+
+  for (i = 0; i < cached_count; ++i)
+    SU_DISPOSE(suscan_device_properties, cached_list[i]);
+
+  if (cached_list != NULL)
+    free(cached_list);
+
+  if (set != NULL)
+    SU_DISPOSE(suscan_object, set);
+
+  if (fd != -1)
+    close(fd);
+
+  if (data != NULL)
+    free(data);
+
   return ok;
 }
 
+SUPRIVATE void
+suscan_device_facade_refresh(suscan_device_facade_t *self)
+{
+  suscan_device_discovery_thread_t *thread;
+  time_t now = time(NULL);
+  unsigned int i;
+
+  for (i = 0; i < self->thread_count; ++i) {
+    thread = self->thread_list[i];
+    if (now - thread->last_discovery >= self->refresh_interval) {
+      /* Do not trigger it again while this one is running */
+      thread->last_discovery = now;
+      suscan_device_discovery_thread_discovery(thread);
+    }
+  }
+}
+
 SUPRIVATE SUBOOL
 suscan_device_facade_list_worker_cb(
   struct suscan_mq *mq_out,
@@ -254,14 +533,20 @@ suscan_device_facade_list_worker_cb(
 
     if (thread != NULL) {
       /* New devices in discovery! */
-      suscan_device_facade_update_from_discovery(self, thread->discovery);
+      suscan_device_facade_update_from_discovery(self, thread);
+      if (thread->iface->cacheable)
+        suscan_device_facade_save_cache(self);
+
       pthread_mutex_lock(&self->disc_lock);
       self->disc_last = thread->iface->name;
-      pthread_cond_signal(&self->disc_cond);
+      pthread_cond_broadcast(&self->disc_cond);
       pthread_mutex_unlock(&self->disc_lock);
     }
   }
 
+  if (self->refresh_interval > 0 && !g_exiting)
+    suscan_device_facade_refresh(self);
+
   return SU_TRUE;
 }
 
@@ -289,18 +574,6 @@ SU_INSTANCER(suscan_device_facade)
   SU_CONSTRUCT_FAIL(suscan_mq, &new->output_mq);
   SU_CONSTRUCT_FAIL(suscan_mq, &new->list_worker_mq);
 
-  SU_TRY_FAIL(
-    new->list_worker = suscan_worker_new_ex(
-      "discovery-list",
-      &new->list_worker_mq,
-      new));
-
-  SU_TRY_FAIL(
-    suscan_worker_push(
-      new->list_worker,
-      suscan_device_facade_list_worker_cb,
-      NULL));
-  
   SU_TRY_FAIL(names = suscan_device_discovery_get_names());
 
   while (names[i] != NULL) {
@@ -318,6 +591,28 @@ SU_INSTANCER(suscan_device_facade)
   thread = NULL;
 
   free(names);
+  names = NULL;
+
+  /* Devices from the previous session, available before any discovery */
+  SU_TRY_FAIL(
+    new->cache_path = strbuild(
+      "%s/" SUSCAN_DEVICE_CACHE_FILE,
+      suscan_get_user_path()));
+
+  suscan_device_facade_load_cache(new);
+
+  /* Started last, so it owns the discovery threads from now on */
+  SU_TRY_FAIL(
+    new->list_worker = suscan_worker_new_ex(
+      "discovery-list",
+      &new->list_worker_mq,
+      new));
+
+  SU_TRY_FAIL(
+    suscan_worker_push(
+      new->list_worker,
+      suscan_device_facade_list_worker_cb,
+      NULL));
 
   return new;
 
@@ -368,6 +663,9 @@ SU_COLLECTOR(suscan_device_facade)
 
   if (self->have_disc_lock)
     pthread_mutex_destroy(&self->disc_lock);
+
+  if (self->cache_path != NULL)
+    free(self->cache_path);
   
   free(self);
 }
@@ -608,3 +906,68 @@ SU_GETTER(
 
   return copy;
 }
+
+/* Cursor pointing past the last event, to wait for new ones */
+SU_GETTER(suscan_device_facade, uint64_t, get_event_cursor)
+{
+  suscan_device_facade_t *mut = (suscan_device_facade_t *) self;
+  uint64_t cursor;
+
+  pthread_mutex_lock(&mut->disc_lock);
+  cursor = mut->event_seq;
+  pthread_mutex_unlock(&mut->disc_lock);
+
+  return cursor;
+}
+
+SU_GETTER(
+  suscan_device_facade,
+  SUBOOL,
+  wait_for_event,
+  struct suscan_device_event *event,
+  uint64_t *cursor,
+  unsigned int timeout_ms)
+{
+  suscan_device_facade_t *mut = (suscan_device_facade_t *) self;
+  int error;
+  SUBOOL got = SU_FALSE;
+  struct timeval tv, inc;
+  struct timespec ts;
+
+  pthread_mutex_lock(&mut->disc_lock);
+
+  inc.tv_sec = timeout_ms / 1000;
+  inc.tv_usec = (timeout_ms % 1000) * 1000;
+
+  gettimeofday(&tv, NULL);
+  timeradd(&tv, &inc, &tv);
+
+  ts.tv_sec  = tv.tv_sec;
+  ts.tv_nsec = tv.tv_usec * 1000;
+
+  while (*cursor >= mut->event_seq) {
+    if ((error = pthread_cond_timedwait(&mut->disc_cond, &mut->disc_lock, &ts)) != 0) {
+      if (error == ETIMEDOUT)
+        break;
+    }
+  }
+
+  if (*cursor < mut->event_seq) {
+    /* Fell behind: skip the overwritten events */
+    if (mut->event_seq - *cursor > SUSCAN_DEVICE_FACADE_MAX_EVENTS)
+      *cursor = mut->event_seq - SUSCAN_DEVICE_FACADE_MAX_EVENTS;
+
+    *event = mut->event_list[*cursor % SUSCAN_DEVICE_FACADE_MAX_EVENTS];
+    ++*cursor;
+    got = SU_TRUE;
+  }
+
+  pthread_mutex_unlock(&mut->disc_lock);
+
+  return got;
+}
+
+SU_METHOD(suscan_device_facade, void, set_refresh_interval, unsigned int secs)
+{
+  self->refresh_interval = secs;
+}
@@ -23,6 +23,7 @@
 #include <sigutils/types.h>
 #include <sigutils/defs.h>
 #include <rbtree.h>
+#include <time.h>
 #include "discovery.h"
 #include <analyzer/worker.h>
 
@@ -34,11 +35,22 @@ struct suscan_device_spec;
 struct suscan_device_facade;
 struct suscan_device_properties;
 
+#define SUSCAN_DEVICE_FACADE_MAX_EVENTS 256
+#define SUSCAN_DEVICE_CACHE_FILE        "devices.cache"
+#define SUSCAN_DEVICE_CACHE_TTL         (7 * 86400) /* Seconds */
+
 struct suscan_device_discovery_thread {
   const struct suscan_device_discovery_interface *iface;
   suscan_device_discovery_t                      *discovery;
   suscan_worker_t                                *worker;
   SUBOOL                                          in_progress;
+
+  /*
+   * Accessed by the list worker only. The device cache is loaded by the
+   * instancer before the list worker starts.
+   */
+  unsigned int                                    last_epoch;
+  time_t                                          last_discovery;
 };
 
 typedef struct suscan_device_discovery_thread suscan_device_discovery_thread_t;
@@ -49,6 +61,27 @@ SU_COLLECTOR(suscan_device_discovery_thread);
 SU_METHOD(suscan_device_discovery_thread, SUBOOL, discovery);
 SU_METHOD(suscan_device_discovery_thread, SUBOOL, cancel);
 
+enum suscan_device_event_type {
+  SUSCAN_DEVICE_EVENT_ADDED,
+  SUSCAN_DEVICE_EVENT_REMOVED,
+  SUSCAN_DEVICE_EVENT_UPDATED
+};
+
+/*
+ * Devices appearing, disappearing or being probed again. The
+ * discovery name is static and the properties can be retrieved by
+ * UUID. The facade keeps the last SUSCAN_DEVICE_FACADE_MAX_EVENTS
+ * events. Every consumer reads them through its own cursor (see
+ * suscan_device_facade_get_event_cursor), so consumers do not steal
+ * events from each other. Consumers falling behind skip the events
+ * that were overwritten.
+ */
+struct suscan_device_event {
+  enum suscan_device_event_type type;
+  uint64_t                      uuid;
+  const char                   *discovery;
+};
+
 struct suscan_device_facade {
   pthread_mutex_t  list_mutex;
   SUBOOL           have_mutex;
@@ -61,6 +94,11 @@ struct suscan_device_facade {
   SUBOOL           have_disc_cond;
   const char      *disc_last;
 
+  struct suscan_device_event event_list[SUSCAN_DEVICE_FACADE_MAX_EVENTS];
+  uint64_t         event_seq;  /* Events pushed so far */
+  unsigned int     refresh_interval;
+  char            *cache_path;
+
   struct suscan_mq output_mq;
   struct suscan_mq list_worker_mq;
   SUBOOL           halting;
@@ -82,11 +120,17 @@ SU_GETTER(suscan_device_facade, int,    get_all_devices, struct suscan_device_pr
 SU_GETTER(suscan_device_facade, int,    get_epoch_for_uuid, uint64_t);
 SU_GETTER(suscan_device_facade, struct suscan_device_properties *, get_device_by_uuid, uint64_t);
 SU_GETTER(suscan_device_facade, char *, wait_for_devices, unsigned int);
+SU_GETTER(suscan_device_facade, uint64_t, get_event_cursor);
+SU_GETTER(suscan_device_facade, SUBOOL, wait_for_event, struct suscan_device_event *, uint64_t *, unsigned int);
 
 SU_METHOD(suscan_device_facade, SUBOOL, discover_all);
 SU_METHOD(suscan_device_facade, SUBOOL, cancel_all);
 SU_METHOD(suscan_device_facade, SUBOOL, start_discovery, const char *);
 SU_METHOD(suscan_device_facade, SUBOOL, stop_discovery, const char *);
+
+/* Rediscover every backend periodically (0 disables it, the default) */
+SU_METHOD(suscan_device_facade, void,   set_refresh_interval, unsigned int);
+
 void suscan_device_facade_cleanup();
 
 #ifdef __cplusplus
@@ -164,12 +164,46 @@ done:
   return ok;
 }
 
+/* Traits are known without opening the device */
+SUPRIVATE SUBOOL
+soapysdr_discovery_set_traits(
+  suscan_device_properties_t *prop,
+  const SoapySDRKwargs *args)
+{
+  const char *key, *val;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  for (i = 0; i < args->size; ++i) {
+    key = args->keys[i];
+    val = args->vals[i];
+
+    if (strcmp(key, "driver") == 0) { /* Yes, we call the driver "device" */
+      SU_TRY(suscan_device_properties_set_trait(prop, "device", val));
+    } else if (strcmp(key, "serial") == 0) {
+      SU_TRY(suscan_device_properties_set_trait(prop, "serial", val));
+    } else if (strcmp(key, "device_id") == 0) {
+      SU_TRY(suscan_device_properties_set_trait(prop, "device_id", val));
+    } else if (strcmp(key, "label") == 0) {
+      SU_TRY(suscan_device_properties_set_label(prop, val));
+    }
+
+    /* Ignore the rest */
+  }
+
+  SU_TRY(suscan_device_properties_update_uuid(prop));
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 SUPRIVATE SUBOOL
 soapysdr_discovery_populate(suscan_device_properties_t *prop, const SoapySDRKwargs *args)
 {
   suscan_device_gain_desc_t *gain = NULL;
   const char *driver;
-  const char *key, *val;
 
   SoapySDRDevice *sdev = NULL;
   SoapySDRRange *freqRanges = NULL;
@@ -277,23 +311,7 @@ soapysdr_discovery_populate(suscan_device_properties_t *prop, const SoapySDRKwar
   for (i = 0; i < samp_rate_count; ++i)
     SU_TRY(suscan_device_properties_add_samp_rate(prop, samp_rate_list[i]));
 
-  /* Define traits. */
-  for (i = 0; i < args->size; ++i) {
-    key = args->keys[i];
-    val = args->vals[i];
-
-    if (strcmp(key, "driver") == 0) { /* Yes, we call the driver "device" */
-      SU_TRY(suscan_device_properties_set_trait(prop, "device", val));
-    } else if (strcmp(key, "serial") == 0) {
-      SU_TRY(suscan_device_properties_set_trait(prop, "serial", val));
-    } else if (strcmp(key, "device_id") == 0) {
-      SU_TRY(suscan_device_properties_set_trait(prop, "device_id", val));
-    } else if (strcmp(key, "label") == 0) {
-      SU_TRY(suscan_device_properties_set_label(prop, val));
-    }
-
-    /* Ignore the rest */
-  }
+  prop->probed = time(NULL);
 
   ok = SU_TRUE;
 
@@ -339,6 +357,7 @@ soapysdr_discovery_discovery(void *userdata, suscan_device_discovery_t *disc)
 {
   SoapySDRKwargs *soapy_dev_list = NULL;
   suscan_device_properties_t *prop = NULL;
+  suscan_device_properties_t *known = NULL;
 
   size_t soapy_dev_len;
   unsigned int i;
@@ -356,16 +375,39 @@ soapysdr_discovery_discovery(void *userdata, suscan_device_discovery_t *disc)
 
   SU_TRY(soapy_dev_list = SoapySDRDevice_enumerate(NULL, &soapy_dev_len));
 
-  /* First device is always null */
+  /*
+   * Opening a device is by far the slowest part of the discovery. Devices
+   * probed recently keep their last known properties. So do devices that
+   * cannot be opened right now (e.g. because they are in use).
+   */
   for (i = 0; i < soapy_dev_len && !self->cancelled; ++i) {
-    if (prop == NULL) {
-      SU_MAKE(prop, suscan_device_properties, NULL);
-      SU_TRY(suscan_device_properties_set_analyzer(prop, "local"));
-      SU_TRY(suscan_device_properties_set_source(prop, "soapysdr"));
+    SU_MAKE(prop, suscan_device_properties, NULL);
+    SU_TRY(suscan_device_properties_set_analyzer(prop, "local"));
+    SU_TRY(suscan_device_properties_set_source(prop, "soapysdr"));
+
+    if (soapysdr_discovery_set_traits(prop, soapy_dev_list + i)) {
+      known = suscan_device_discovery_lookup_device(disc, prop->uuid);
+
+      if ((known != NULL && time(NULL) - known->probed < SUSCAN_DEVICE_PROBE_TTL)
+        || !soapysdr_discovery_populate(prop, soapy_dev_list + i)) {
+        SU_DISPOSE(suscan_device_properties, prop);
+        prop  = known;
+        known = NULL;
+      }
+
+      if (prop != NULL) {
+        SU_TRY(suscan_device_discovery_push_device(disc, prop));
+        prop = NULL;
+      }
     }
 
-    if (soapysdr_discovery_populate(prop, soapy_dev_list + i)) {
-      SU_TRY(suscan_device_discovery_push_device(disc, prop));
+    if (known != NULL) {
+      SU_DISPOSE(suscan_device_properties, known);
+      known = NULL;
+    }
+
+    if (prop != NULL) {
+      SU_DISPOSE(suscan_device_properties, prop);
       prop = NULL;
     }
   }
@@ -378,6 +420,9 @@ done:
 
   if (prop != NULL)
     SU_DISPOSE(suscan_device_properties, prop);
+
+  if (known != NULL)
+    SU_DISPOSE(suscan_device_properties, known);
   
   return ok;
 }
@@ -408,7 +453,8 @@ SUPRIVATE struct suscan_device_discovery_interface g_soapysdr_discovery =
   .open      = soapysdr_discovery_open,
   .discovery = soapysdr_discovery_discovery,
   .cancel    = soapysdr_discovery_cancel,
-  .close     = soapysdr_discovery_close
+  .close     = soapysdr_discovery_close,
+  .cacheable = SU_TRUE
 };
 
 SUBOOL
@@ -98,6 +98,7 @@ SU_COPY_INSTANCER(suscan_device_properties)
   new->freq_min = self->freq_min;
   new->freq_max = self->freq_max;
   new->channels = self->channels;
+  new->probed   = self->probed;
   
   SU_ALLOCATE_MANY_FAIL(new->samp_rate_list, self->samp_rate_count, double);
   memcpy(
@@ -258,6 +259,181 @@ SU_GETTER(suscan_device_properties, const char *, get, const char *trait)
   return strmap_get(&self->traits, trait);
 }
 
+SU_GETTER(suscan_device_properties, suscan_object_t *, to_object)
+{
+  suscan_object_t *obj  = NULL;
+  suscan_object_t *set  = NULL;
+  suscan_object_t *item = NULL;
+  const suscan_device_gain_desc_t *gain;
+  struct timeval tv = {0, 0};
+  char *uri = NULL;
+  char value[32];
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_MAKE(obj, suscan_object, SUSCAN_OBJECT_TYPE_OBJECT);
+  SU_TRY(suscan_object_set_class(obj, "device_properties"));
+
+  SU_TRY(uri = suscan_device_properties_uri(self));
+  SU_TRY(suscan_object_set_field_value(obj, "uri", uri));
+  SU_TRY(suscan_object_set_field_value(obj, "label", self->label));
+  SU_TRY(suscan_object_set_field_double(obj, "freq_min", self->freq_min));
+  SU_TRY(suscan_object_set_field_double(obj, "freq_max", self->freq_max));
+  SU_TRY(suscan_object_set_field_uint(obj, "channels", self->channels));
+
+  tv.tv_sec = self->probed;
+  SU_TRY(suscan_object_set_field_tv(obj, "probed", tv));
+
+  /* Sample rates */
+  SU_MAKE(set, suscan_object, SUSCAN_OBJECT_TYPE_SET);
+  for (i = 0; i < self->samp_rate_count; ++i) {
+    snprintf(value, sizeof(value), "%.17g", self->samp_rate_list[i]);
+    SU_MAKE(item, suscan_object, SUSCAN_OBJECT_TYPE_FIELD);
+    SU_TRY(suscan_object_set_value(item, value));
+    SU_TRY(suscan_object_set_append(set, item));
+    item = NULL;
+  }
+  SU_TRY(suscan_object_set_field(obj, "samp_rates", set));
+  set = NULL;
+
+  /* Gains */
+  SU_MAKE(set, suscan_object, SUSCAN_OBJECT_TYPE_SET);
+  for (i = 0; i < self->gain_desc_count; ++i) {
+    gain = self->gain_desc_list[i];
+    SU_MAKE(item, suscan_object, SUSCAN_OBJECT_TYPE_OBJECT);
+    SU_TRY(suscan_object_set_class(item, "gain"));
+    SU_TRY(suscan_object_set_field_value(item, "name", gain->name));
+    SU_TRY(suscan_object_set_field_float(item, "min", gain->min));
+    SU_TRY(suscan_object_set_field_float(item, "max", gain->max));
+    SU_TRY(suscan_object_set_field_float(item, "step", gain->step));
+    SU_TRY(suscan_object_set_field_float(item, "default", gain->def));
+    SU_TRY(suscan_object_set_append(set, item));
+    item = NULL;
+  }
+  SU_TRY(suscan_object_set_field(obj, "gains", set));
+  set = NULL;
+
+  /* Antennas */
+  SU_MAKE(set, suscan_object, SUSCAN_OBJECT_TYPE_SET);
+  for (i = 0; i < self->antenna_count; ++i) {
+    SU_MAKE(item, suscan_object, SUSCAN_OBJECT_TYPE_FIELD);
+    SU_TRY(suscan_object_set_value(item, self->antenna_list[i]));
+    SU_TRY(suscan_object_set_append(set, item));
+    item = NULL;
+  }
+  SU_TRY(suscan_object_set_field(obj, "antennas", set));
+  set = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok && obj != NULL) {
+    SU_DISPOSE(suscan_object, obj);
+    obj = NULL;
+  }
+
+  if (set != NULL)
+    SU_DISPOSE(suscan_object, set);
+
+  if (item != NULL)
+    SU_DISPOSE(suscan_object, item);
+
+  if (uri != NULL)
+    free(uri);
+
+  return obj;
+}
+
+suscan_device_properties_t *
+suscan_device_properties_from_object(const suscan_object_t *obj)
+{
+  suscan_device_properties_t *new = NULL;
+  suscan_device_spec_t *spec = NULL;
+  suscan_device_gain_desc_t *gain;
+  const suscan_object_t *set, *item;
+  const char *uri, *label, *value, *name;
+  struct timeval tv = {0, 0};
+  double rate;
+  unsigned int i, count;
+
+  SU_TRY_FAIL(uri = suscan_object_get_field_value(obj, "uri"));
+  SU_TRY_FAIL(spec = suscan_device_spec_from_uri(uri));
+
+  label = suscan_object_get_field_value(obj, "label");
+  SU_MAKE_FAIL(new, suscan_device_properties, label);
+
+  SU_TRY_FAIL(suscan_device_properties_set_analyzer(new, spec->analyzer));
+  SU_TRY_FAIL(suscan_device_properties_set_source(new, spec->source));
+  SU_TRY_FAIL(strmap_copy(&new->traits, &spec->traits));
+
+  SU_TRY_FAIL(
+    suscan_device_properties_set_freq_range(
+      new,
+      suscan_object_get_field_double(obj, "freq_min", 0),
+      suscan_object_get_field_double(obj, "freq_max", 0)));
+
+  SU_TRY_FAIL(
+    suscan_device_properties_set_num_channels(
+      new,
+      suscan_object_get_field_uint(obj, "channels", 1)));
+
+  new->probed = suscan_object_get_field_tv(obj, "probed", &tv).tv_sec;
+
+  if ((set = suscan_object_get_field(obj, "samp_rates")) != NULL
+    && suscan_object_get_type(set) == SUSCAN_OBJECT_TYPE_SET) {
+    count = suscan_object_set_get_count(set);
+    for (i = 0; i < count; ++i)
+      if ((item = suscan_object_set_get(set, i)) != NULL
+        && (value = suscan_object_get_value(item)) != NULL
+        && sscanf(value, "%lf", &rate) == 1)
+        SU_TRY_FAIL(suscan_device_properties_add_samp_rate(new, rate));
+  }
+
+  if ((set = suscan_object_get_field(obj, "gains")) != NULL
+    && suscan_object_get_type(set) == SUSCAN_OBJECT_TYPE_SET) {
+    count = suscan_object_set_get_count(set);
+    for (i = 0; i < count; ++i) {
+      if ((item = suscan_object_set_get(set, i)) == NULL
+        || (name = suscan_object_get_field_value(item, "name")) == NULL)
+        continue;
+
+      SU_TRY_FAIL(
+        gain = suscan_device_properties_make_gain(
+          new,
+          name,
+          suscan_object_get_field_float(item, "min", 0),
+          suscan_object_get_field_float(item, "max", 0)));
+
+      gain->step = suscan_object_get_field_float(item, "step", 0);
+      gain->def  = suscan_object_get_field_float(item, "default", 0);
+    }
+  }
+
+  if ((set = suscan_object_get_field(obj, "antennas")) != NULL
+    && suscan_object_get_type(set) == SUSCAN_OBJECT_TYPE_SET) {
+    count = suscan_object_set_get_count(set);
+    for (i = 0; i < count; ++i)
+      if ((item = suscan_object_set_get(set, i)) != NULL
+        && (value = suscan_object_get_value(item)) != NULL)
+        SU_TRY_FAIL(suscan_device_properties_add_antenna(new, value));
+  }
+
+  suscan_device_properties_update_uuid(new);
+
+  SU_DISPOSE(suscan_device_spec, spec);
+
+  return new;
+
+fail:
+  if (spec != NULL)
+    SU_DISPOSE(suscan_device_spec, spec);
+
+  if (new != NULL)
+    SU_DISPOSE(suscan_device_properties, new);
+
+  return NULL;
+}
+
 SU_METHOD(suscan_device_properties, SUBOOL, set_analyzer, const char *analyzer)
 {
   const struct suscan_analyzer_interface *iface;
@@ -23,6 +23,8 @@
 #include <sigutils/types.h>
 #include <sigutils/defs.h>
 #include <strmap.h>
+#include <util/object.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -69,6 +71,7 @@ struct suscan_device_properties {
 
   /* INTERNAL */
   struct suscan_device_discovery *discovery;
+  time_t                          probed;   /* Last time the device was opened */
 };
 
 typedef struct suscan_device_properties suscan_device_properties_t;
@@ -91,6 +94,10 @@ SU_GETTER(suscan_device_properties, char *, uri);
 SU_GETTER(suscan_device_properties, suscan_device_gain_desc_t *, lookup_gain, const char *);
 SU_GETTER(suscan_device_properties, int, get_all_gains, suscan_device_gain_desc_t *const **);
 SU_GETTER(suscan_device_properties, const char *, get, const char *);
+SU_GETTER(suscan_device_properties, suscan_object_t *, to_object);
+
+suscan_device_properties_t *suscan_device_properties_from_object(
+  const suscan_object_t *object);
 
 SU_METHOD(suscan_device_properties, SUBOOL, set_analyzer, const char *);
 SU_METHOD(suscan_device_properties, SUBOOL, set_source, const char *);
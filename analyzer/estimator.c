@@ -89,6 +89,13 @@ suscan_estimator_feed(
   return (estimator->classptr->feed) (estimator->privdata, samples, size);
 }
 
+void
+suscan_estimator_reset(suscan_estimator_t *estimator)
+{
+  if (estimator->classptr->reset != NULL)
+    (estimator->classptr->reset) (estimator->privdata);
+}
+
 SUBOOL
 suscan_estimator_read(const suscan_estimator_t *estimator, SUFLOAT *out)
 {
@@ -27,6 +27,7 @@ extern "C" {
 #include <sigutils/sigutils.h>
 
 #define SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ 1024
+#define SUSCAN_ESTIMATOR_SNAPSHOT_SIZE  (4 * SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ)
 
 struct suscan_estimator_class {
   const char *name;
@@ -39,6 +40,9 @@ struct suscan_estimator_class {
 
   SUBOOL (*read) (const void *privdata, SUFLOAT *out);
 
+  /* Optional. Forgets all samples fed so far */
+  void (*reset) (void *privdata);
+
   void (*dtor) (void *privdata);
 };
 
@@ -77,6 +81,8 @@ SUBOOL suscan_estimator_feed(
     const SUCOMPLEX *samples,
     SUSCOUNT size);
 
+void suscan_estimator_reset(suscan_estimator_t *estimator);
+
 SUBOOL suscan_estimator_read(
     const suscan_estimator_t *estimator,
     SUFLOAT *out);
@@ -60,6 +60,12 @@ suscan_estimator_fac_read(const void *private, SUFLOAT *out)
   return SU_TRUE;
 }
 
+SUPRIVATE void
+suscan_estimator_fac_reset(void *private)
+{
+  su_channel_detector_rewind((su_channel_detector_t *) private);
+}
+
 SUPRIVATE void
 suscan_estimator_fac_dtor(void *private)
 {
@@ -76,6 +82,7 @@ suscan_estimator_fac_register(void)
       .ctor  = suscan_estimator_fac_ctor,
       .feed  = suscan_estimator_fac_feed,
       .read  = suscan_estimator_fac_read,
+      .reset = suscan_estimator_fac_reset,
       .dtor  = suscan_estimator_fac_dtor
   };
 
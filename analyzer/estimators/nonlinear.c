@@ -70,6 +70,12 @@ suscan_estimator_nonlinear_read(const void *private, SUFLOAT *out)
   return SU_TRUE;
 }
 
+SUPRIVATE void
+suscan_estimator_nonlinear_reset(void *private)
+{
+  su_channel_detector_rewind((su_channel_detector_t *) private);
+}
+
 SUPRIVATE void
 suscan_estimator_nonlinear_dtor(void *private)
 {
@@ -86,6 +92,7 @@ suscan_estimator_nonlinear_register(void)
       .ctor  = suscan_estimator_nonlinear_ctor,
       .feed  = suscan_estimator_nonlinear_feed,
       .read  = suscan_estimator_nonlinear_read,
+      .reset = suscan_estimator_nonlinear_reset,
       .dtor  = suscan_estimator_nonlinear_dtor
   };
 
@@ -0,0 +1,348 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "fftcache"
+
+#include <sigutils/log.h>
+#include <sigutils/taps.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "fftcache.h"
+
+/*
+ * sigutils plans its own transforms without taking our mutex, and FFTW
+ * measurements may overlap with them. Estimated plans still pick up the
+ * wisdom loaded at init.
+ */
+#define SUSCAN_FFT_CACHE_PLAN_FLAGS FFTW_ESTIMATE
+
+struct suscan_fft_cache_plan {
+  SUSCOUNT       size;
+  unsigned int   howmany;
+  int            direction;
+  SUBOOL         aligned;
+  SU_FFTW(_plan) plan;
+  unsigned int   refcnt;
+
+  struct suscan_fft_cache_plan *next;
+};
+
+struct suscan_fft_cache_window {
+  SUSCOUNT      size;
+  enum sigutils_channel_detector_window type;
+  SUFLOAT      *table;
+  unsigned int  refcnt;
+
+  struct suscan_fft_cache_window *next;
+};
+
+SUPRIVATE pthread_mutex_t g_fft_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE struct suscan_fft_cache_plan   *g_fft_cache_plans;
+SUPRIVATE struct suscan_fft_cache_window *g_fft_cache_windows;
+SUPRIVATE struct suscan_fft_cache_stats   g_fft_cache_stats;
+
+/* Called with the cache mutex held: FFTW planning is not thread-safe */
+SUPRIVATE struct suscan_fft_cache_plan *
+suscan_fft_cache_plan_new(
+  SUSCOUNT size,
+  unsigned int howmany,
+  int direction,
+  SUBOOL aligned)
+{
+  struct suscan_fft_cache_plan *new = NULL;
+  SU_FFTW(_complex) *scratch = NULL;
+  unsigned int flags = SUSCAN_FFT_CACHE_PLAN_FLAGS;
+  int n = size;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_fft_cache_plan);
+
+  new->size      = size;
+  new->howmany   = howmany;
+  new->direction = direction;
+  new->aligned   = aligned;
+
+  if (!aligned)
+    flags |= FFTW_UNALIGNED;
+
+  /* Plans are in place and run on the callers' buffers */
+  SU_TRY_FAIL(
+    scratch = SU_FFTW(_malloc)(howmany * size * sizeof(SU_FFTW(_complex))));
+
+  if (howmany == 1)
+    new->plan = SU_FFTW(_plan_dft_1d)(
+      size,
+      scratch,
+      scratch,
+      direction,
+      flags);
+  else
+    new->plan = SU_FFTW(_plan_many_dft)(
+      1,          /* rank */
+      &n,
+      howmany,
+      scratch,
+      NULL,
+      1,          /* stride */
+      size,       /* dist */
+      scratch,
+      NULL,
+      1,
+      size,
+      direction,
+      flags);
+
+  SU_TRY_FAIL(new->plan != NULL);
+
+  SU_FFTW(_free)(scratch);
+
+  return new;
+
+fail:
+  if (scratch != NULL)
+    SU_FFTW(_free)(scratch);
+
+  if (new != NULL)
+    free(new);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_fft_cache_plan_destroy(struct suscan_fft_cache_plan *self)
+{
+  if (self->plan != NULL)
+    SU_FFTW(_destroy_plan)(self->plan);
+
+  free(self);
+}
+
+SUPRIVATE struct suscan_fft_cache_window *
+suscan_fft_cache_window_new(
+  SUSCOUNT size,
+  enum sigutils_channel_detector_window type)
+{
+  struct suscan_fft_cache_window *new = NULL;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_fft_cache_window);
+
+  new->size = size;
+  new->type = type;
+
+  SU_ALLOCATE_MANY_FAIL(new->table, size, SUFLOAT);
+
+  for (i = 0; i < size; ++i)
+    new->table[i] = 1;
+
+  switch (type) {
+    case SU_CHANNEL_DETECTOR_WINDOW_HAMMING:
+      su_taps_apply_hamming(new->table, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_HANN:
+      su_taps_apply_hann(new->table, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_BLACKMANN_HARRIS:
+      su_taps_apply_blackmann_harris(new->table, size);
+      break;
+
+    case SU_CHANNEL_DETECTOR_WINDOW_FLAT_TOP:
+      su_taps_apply_flat_top(new->table, size);
+      break;
+
+    default:
+      /* Rectangular window */
+      break;
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    free(new);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_fft_cache_window_destroy(struct suscan_fft_cache_window *self)
+{
+  if (self->table != NULL)
+    free(self->table);
+
+  free(self);
+}
+
+SUPRIVATE SU_FFTW(_plan)
+suscan_fft_cache_acquire_plan_ex(
+  SUSCOUNT size,
+  unsigned int howmany,
+  int direction,
+  SUBOOL aligned)
+{
+  struct suscan_fft_cache_plan *entry;
+  SU_FFTW(_plan) plan = NULL;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (entry = g_fft_cache_plans; entry != NULL; entry = entry->next)
+    if (entry->size == size
+      && entry->howmany == howmany
+      && entry->direction == direction
+      && entry->aligned == aligned)
+      break;
+
+  if (entry != NULL) {
+    ++g_fft_cache_stats.plan_hits;
+  } else {
+    ++g_fft_cache_stats.plan_misses;
+    SU_TRY(
+      entry = suscan_fft_cache_plan_new(size, howmany, direction, aligned));
+
+    entry->next = g_fft_cache_plans;
+    g_fft_cache_plans = entry;
+    ++g_fft_cache_stats.plans;
+  }
+
+  ++entry->refcnt;
+  plan = entry->plan;
+
+done:
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+
+  return plan;
+}
+
+SU_FFTW(_plan)
+suscan_fft_cache_acquire_plan(SUSCOUNT size, int direction, SUBOOL aligned)
+{
+  return suscan_fft_cache_acquire_plan_ex(size, 1, direction, aligned);
+}
+
+SU_FFTW(_plan)
+suscan_fft_cache_acquire_batch_plan(
+  SUSCOUNT size,
+  unsigned int howmany,
+  int direction)
+{
+  return suscan_fft_cache_acquire_plan_ex(size, howmany, direction, SU_TRUE);
+}
+
+void
+suscan_fft_cache_release_plan(SU_FFTW(_plan) plan)
+{
+  struct suscan_fft_cache_plan *entry, *prev = NULL;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (entry = g_fft_cache_plans; entry != NULL; entry = entry->next) {
+    if (entry->plan == plan)
+      break;
+    prev = entry;
+  }
+
+  if (entry == NULL) {
+    SU_ERROR("Released plan does not belong to the FFT cache\n");
+  } else if (--entry->refcnt == 0) {
+    if (prev == NULL)
+      g_fft_cache_plans = entry->next;
+    else
+      prev->next = entry->next;
+
+    --g_fft_cache_stats.plans;
+    suscan_fft_cache_plan_destroy(entry);
+  }
+
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
+
+const SUFLOAT *
+suscan_fft_cache_acquire_window(
+  SUSCOUNT size,
+  enum sigutils_channel_detector_window type)
+{
+  struct suscan_fft_cache_window *entry;
+  const SUFLOAT *table = NULL;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (entry = g_fft_cache_windows; entry != NULL; entry = entry->next)
+    if (entry->size == size && entry->type == type)
+      break;
+
+  if (entry != NULL) {
+    ++g_fft_cache_stats.window_hits;
+  } else {
+    ++g_fft_cache_stats.window_misses;
+    SU_TRY(entry = suscan_fft_cache_window_new(size, type));
+
+    entry->next = g_fft_cache_windows;
+    g_fft_cache_windows = entry;
+    ++g_fft_cache_stats.windows;
+    g_fft_cache_stats.window_bytes += size * sizeof(SUFLOAT);
+  }
+
+  ++entry->refcnt;
+  table = entry->table;
+
+done:
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+
+  return table;
+}
+
+void
+suscan_fft_cache_release_window(const SUFLOAT *window)
+{
+  struct suscan_fft_cache_window *entry, *prev = NULL;
+
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+
+  for (entry = g_fft_cache_windows; entry != NULL; entry = entry->next) {
+    if (entry->table == window)
+      break;
+    prev = entry;
+  }
+
+  if (entry == NULL) {
+    SU_ERROR("Released window does not belong to the FFT cache\n");
+  } else if (--entry->refcnt == 0) {
+    if (prev == NULL)
+      g_fft_cache_windows = entry->next;
+    else
+      prev->next = entry->next;
+
+    --g_fft_cache_stats.windows;
+    g_fft_cache_stats.window_bytes -= entry->size * sizeof(SUFLOAT);
+    suscan_fft_cache_window_destroy(entry);
+  }
+
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
+
+void
+suscan_fft_cache_get_stats(struct suscan_fft_cache_stats *stats)
+{
+  (void) pthread_mutex_lock(&g_fft_cache_mutex);
+  *stats = g_fft_cache_stats;
+  (void) pthread_mutex_unlock(&g_fft_cache_mutex);
+}
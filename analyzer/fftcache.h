@@ -0,0 +1,79 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_FFTCACHE_H
+#define _ANALYZER_FFTCACHE_H
+
+#include <sigutils/types.h>
+#include <sigutils/detect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Process-wide cache of FFT plans and window tables. Plans are created once
+ * per (size, direction, alignment) and executed on the caller's buffers with
+ * SU_FFTW(_execute_dft), which is thread-safe. Plans are always in-place.
+ * Aligned plans may only be executed on buffers allocated with
+ * SU_FFTW(_malloc). Window tables are real and read-only.
+ *
+ * Batch plans transform howmany contiguous frames of size samples at once.
+ * They are always aligned.
+ *
+ * Entries are refcounted and released when the last user returns them.
+ */
+
+struct suscan_fft_cache_stats {
+  uint64_t plan_hits;
+  uint64_t plan_misses;
+  uint64_t window_hits;
+  uint64_t window_misses;
+
+  unsigned int plans;     /* Live entries */
+  unsigned int windows;
+  SUSCOUNT     window_bytes;
+};
+
+SU_FFTW(_plan) suscan_fft_cache_acquire_plan(
+  SUSCOUNT size,
+  int direction,
+  SUBOOL aligned);
+
+SU_FFTW(_plan) suscan_fft_cache_acquire_batch_plan(
+  SUSCOUNT size,
+  unsigned int howmany,
+  int direction);
+
+/* Both single and batch plans */
+void suscan_fft_cache_release_plan(SU_FFTW(_plan) plan);
+
+const SUFLOAT *suscan_fft_cache_acquire_window(
+  SUSCOUNT size,
+  enum sigutils_channel_detector_window type);
+
+void suscan_fft_cache_release_window(const SUFLOAT *window);
+
+void suscan_fft_cache_get_stats(struct suscan_fft_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_FFTCACHE_H */
@@ -270,6 +270,13 @@ suscan_analyzer_thread(void *data)
           SU_TRY(suscan_local_analyzer_slow_seek(self, &seek->position));
           break;
 
+        case SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW:
+          SU_TRY(suscan_local_analyzer_slow_get_overview(self, private));
+
+          /* Answered by the slow worker */
+          private = NULL;
+          break;
+
         case SUSCAN_ANALYZER_MESSAGE_TYPE_HISTORY_SIZE:
           history_size = (const struct suscan_analyzer_history_size_msg *) private;
           SU_TRY(
@@ -407,11 +414,50 @@ suscan_analyzer_params_debug(const struct suscan_analyzer_params *params)
   printf("Detector FC: %g\n", params->detector_params.fc);
   printf("Detector.softtune: %d\n", params->detector_params.tune);
   printf("Freq range: %lg, %lg\n", params->min_freq, params->max_freq);
+  printf("Channel spacing: %g\n", params->channel_spacing);
 }
 #endif /* DEBUG_ANALYZER_PARAMS */
 
 SUPRIVATE void suscan_local_analyzer_dtor(void *ptr);
 
+/*
+ * The raster channelizer serves inspectors opened on multiples of the
+ * channel spacing (relative to the tuner frequency). It requires the sample
+ * rate to be an even multiple of the spacing. If it is not, we just rely
+ * on the spectral tuner.
+ */
+SUPRIVATE void
+suscan_local_analyzer_init_pfb(suscan_local_analyzer_t *self)
+{
+  struct suscan_pfb_params params = suscan_pfb_params_INITIALIZER;
+  SUFLOAT spacing = self->parent->params.channel_spacing;
+  SUFLOAT branches;
+
+  /* Same rate the inspector factory uses, unaffected by throttling */
+  branches = suscan_local_analyzer_get_samp_rate(self) / spacing;
+  params.branches = SU_FLOOR(branches + .5);
+
+  if (params.branches < 4
+    || (params.branches & 1)
+    || SU_ABS(branches - params.branches) > 1e-3) {
+    SU_WARNING(
+      "Channel spacing (%g Hz) is not an even divisor of the sample rate, "
+      "raster channelizer disabled\n",
+      spacing);
+    return;
+  }
+
+  if ((self->pfb = suscan_pfb_new(&params)) == NULL) {
+    SU_WARNING("Failed to create raster channelizer\n");
+    return;
+  }
+
+  SU_INFO(
+    "Raster channelizer: %d channels, %g Hz apart\n",
+    params.branches,
+    spacing);
+}
+
 SUPRIVATE void
 suscan_local_analyzer_bbfilt_dtor(void *obj, void *userdata)
 {
@@ -430,6 +476,7 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   
   suscan_source_config_t *config;
   pthread_mutexattr_t attr;
+  unsigned int i;
   static SUBOOL insp_server_init = SU_FALSE;
 
   SU_ALLOCATE_FAIL(new, suscan_local_analyzer_t);
@@ -531,9 +578,27 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
 
   SU_TRYCATCH(new->stuner = su_specttuner_new(&st_params), goto fail);
 
+  /* Multi-channel sources: one spectral tuner per additional channel */
+  new->stream_count = suscan_source_get_channel_count(new->source);
+  for (i = 1; i < new->stream_count; ++i) {
+    SU_ALLOCATE_MANY_FAIL(
+      new->stream_buf[i],
+      st_params.window_size,
+      SUCOMPLEX);
+    SU_TRYCATCH(
+      new->stream_tuner[i] = su_specttuner_new(&st_params),
+      goto fail);
+  }
+
+  if (parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL
+    && parent->params.channel_spacing > 0)
+    suscan_local_analyzer_init_pfb(new);
+
   /* Initialize baseband filters */
   SU_MAKE_FAIL(new->bbfilt_tree, rbtree);
   rbtree_set_dtor(new->bbfilt_tree, suscan_local_analyzer_bbfilt_dtor, NULL);
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->bbfilt_mutex, NULL));
+  new->bbfilt_init = SU_TRUE;
 
   /* 
    * Spectral tuner mutex should be recursive in order to enable
@@ -619,6 +684,7 @@ SUPRIVATE void
 suscan_local_analyzer_dtor(void *ptr)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  unsigned int i;
 
   /* Prevent source from entering in timeout loops */
   if (self->source != NULL)
@@ -683,15 +749,29 @@ suscan_local_analyzer_dtor(void *ptr)
     suscan_inspector_factory_destroy(self->insp_factory);
 
   /* 
-   * Free spectral tuner. It must be done after destroying
-   * the factory, as the local factory implementation holds
-   * pointers to specttuner channels.
+   * Free spectral tuner and channelizer. It must be done after
+   * destroying the factory, as the local factory implementation holds
+   * pointers to their channels.
    */
   if (self->stuner_init)
     pthread_mutex_destroy(&self->stuner_mutex);
   
   if (self->stuner != NULL)
     su_specttuner_destroy(self->stuner);
+
+  if (self->pfb != NULL)
+    suscan_pfb_destroy(self->pfb);
+
+  if (self->bin_chan_list != NULL)
+    free(self->bin_chan_list);
+
+  for (i = 1; i < SUSCAN_SOURCE_MAX_CHANNELS; ++i) {
+    if (self->stream_tuner[i] != NULL)
+      su_specttuner_destroy(self->stream_tuner[i]);
+
+    if (self->stream_buf[i] != NULL)
+      free(self->stream_buf[i]);
+  }
   
   /* Free read buffer */
   if (self->read_buf != NULL)
@@ -708,6 +788,9 @@ suscan_local_analyzer_dtor(void *ptr)
   if (self->bbfilt_tree != NULL)
     rbtree_destroy(self->bbfilt_tree);
 
+  if (self->bbfilt_init)
+    pthread_mutex_destroy(&self->bbfilt_mutex);
+
   /* Finalize source info */
   suscan_source_info_finalize(&self->source_info);
 
@@ -1025,6 +1108,7 @@ suscan_local_analyzer_register_baseband_filter(
   struct suscan_analyzer_baseband_filter *new = NULL;
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
   SUBOOL automatic_priority = prio == SUSCAN_ANALYZER_BBFILT_PRIO_DEFAULT;
+  SUBOOL mutex_acquired = SU_FALSE;
   
   SU_TRYCATCH(
       self->parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL,
@@ -1037,6 +1121,9 @@ suscan_local_analyzer_register_baseband_filter(
   new->func = func;
   new->privdata = privdata;
 
+  SU_TRYZ_FAIL(pthread_mutex_lock(&self->bbfilt_mutex));
+  mutex_acquired = SU_TRUE;
+
   if (automatic_priority) {
     prio = 0;
     while (rbtree_search(self->bbfilt_tree, prio, RB_EXACT) != NULL)
@@ -1052,15 +1139,61 @@ suscan_local_analyzer_register_baseband_filter(
 
   SU_TRYC_FAIL(rbtree_insert(self->bbfilt_tree, prio, new));
 
+  (void) pthread_mutex_unlock(&self->bbfilt_mutex);
+
   return SU_TRUE;
 
 fail:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->bbfilt_mutex);
+
   if (new != NULL)
     suscan_analyzer_baseband_filter_destroy(new);
 
   return SU_FALSE;
 }
 
+/*
+ * Nodes cannot be removed from the tree, so the filter is released and its
+ * node is left empty. The channel loop already skips empty nodes.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_unregister_baseband_filter(
+    void *ptr,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  struct suscan_analyzer_baseband_filter *bbfilt;
+  struct rbtree_node *this;
+  SUBOOL found = SU_FALSE;
+
+  if (pthread_mutex_lock(&self->bbfilt_mutex) != 0)
+    return SU_FALSE;
+
+  this = rbtree_get_first(self->bbfilt_tree);
+
+  while (this != NULL) {
+    bbfilt = rbtree_node_data(this);
+    if (bbfilt != NULL
+      && bbfilt->func == func
+      && bbfilt->privdata == privdata) {
+      (void) rbtree_set(self->bbfilt_tree, this->key, NULL);
+      found = SU_TRUE;
+      break;
+    }
+
+    this = rbtree_node_next(this);
+  }
+
+  (void) pthread_mutex_unlock(&self->bbfilt_mutex);
+
+  if (!found)
+    SU_ERROR("Baseband filter not found\n");
+
+  return found;
+}
+
 /* Fast methods */
 SUPRIVATE SUBOOL
 suscan_local_analyzer_set_inspector_frequency(
@@ -1141,6 +1274,7 @@ suscan_local_analyzer_get_interface(void)
     SET_CALLBACK(set_history_size);
     SET_CALLBACK(replay);
     SET_CALLBACK(register_baseband_filter);
+    SET_CALLBACK(unregister_baseband_filter);
     SET_CALLBACK(get_measured_samp_rate);
     SET_CALLBACK(get_source_info_pointer);
     SET_CALLBACK(commit_source_info);
@@ -25,6 +25,7 @@
 #include <analyzer/inspector/factory.h>
 #include <analyzer/inspector/overridable.h>
 #include <analyzer/pool.h>
+#include <analyzer/pfb.h>
 
 #include <rbtree.h>
 
@@ -35,6 +36,9 @@
 extern "C" {
 #endif /* __cplusplus */
 
+struct suscan_analyzer_overview_msg;
+struct suscan_local_inspector_channel;
+
 #define SULIMPL(analyzer) ((suscan_local_analyzer_t *) ((analyzer)->impl))
 #define SUSCAN_LOCAL_ANALYZER_AS_ANALYZER(local) ((local)->parent)
 
@@ -123,6 +127,8 @@ struct suscan_local_analyzer {
   SUSCOUNT   read_size;
 
   rbtree_t *bbfilt_tree;
+  pthread_mutex_t bbfilt_mutex; /* Filters may be removed while running */
+  SUBOOL bbfilt_init;
 
   /* Spectral tuner */
   su_specttuner_t        *stuner;
@@ -132,6 +138,26 @@ struct suscan_local_analyzer {
   SUBOOL                  circularity;
   SUBOOL                  circ_state;
 
+  /* Raster channelizer (optional, protected by stuner_mutex) */
+  suscan_pfb_t           *pfb;
+
+  /*
+   * Frequency-domain inspectors that read their bins straight from the
+   * forward FFT of stuner (protected by stuner_mutex)
+   */
+  PTR_LIST(struct suscan_local_inspector_channel, bin_chan);
+  unsigned int            bin_chan_active;
+  volatile SUBOOL         bin_sync_pending;
+
+  /*
+   * Additional coherent channels of multi-channel sources, each one
+   * with its own spectral tuner (protected by stuner_mutex). Index 0
+   * is unused: the first channel is handled by stuner.
+   */
+  unsigned int            stream_count;
+  SUCOMPLEX              *stream_buf[SUSCAN_SOURCE_MAX_CHANNELS];
+  su_specttuner_t        *stream_tuner[SUSCAN_SOURCE_MAX_CHANNELS];
+
   /* Wide sweep parameters */
   SUBOOL sweep_params_requested;
   struct suscan_analyzer_sweep_params current_sweep_params;
@@ -159,6 +185,22 @@ typedef struct suscan_local_analyzer suscan_local_analyzer_t;
 /* Internal */
 SUBOOL suscan_local_analyzer_register_factory(void);
 
+/* Internal */
+su_specttuner_channel_t *suscan_local_analyzer_open_stream_channel(
+  suscan_local_analyzer_t *self,
+  unsigned int stream,
+  const struct sigutils_channel *chan_info,
+  SUBOOL precise,
+  su_specttuner_channel_data_func_t on_data,
+  su_specttuner_channel_new_freq_func_t on_new_freq,
+  void *privdata);
+
+/* Internal */
+SUBOOL suscan_local_analyzer_close_stream_channel(
+  suscan_local_analyzer_t *self,
+  unsigned int stream,
+  su_specttuner_channel_t *channel);
+
 /* Internal */
 SUBOOL suscan_local_analyzer_is_real_time_ex(const suscan_local_analyzer_t *self);
 
@@ -268,6 +310,11 @@ SUBOOL suscan_local_analyzer_slow_seek(
     suscan_local_analyzer_t *self,
     const struct timeval *tv);
 
+/* Internal */
+SUBOOL suscan_local_analyzer_slow_get_overview(
+    suscan_local_analyzer_t *self,
+    struct suscan_analyzer_overview_msg *msg);
+
 /* Internal */
 SUBOOL suscan_local_analyzer_slow_set_history_size(
     suscan_local_analyzer_t *self,
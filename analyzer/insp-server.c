@@ -227,6 +227,13 @@ DEF_MSGCB(OPEN)
 
   if (msg->handle != -1) {
     /* Subcarrier inspector */
+    if (msg->stream != 0) {
+      SU_ERROR("Subcarrier inspectors cannot select a source channel\n");
+      msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_ARGUMENT;
+      ok = SU_TRUE;
+      goto done;
+    }
+
     insp = suscan_local_analyzer_acquire_inspector(self, msg->handle);
     if (insp == NULL) {
       msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_HANDLE;
@@ -258,7 +265,8 @@ DEF_MSGCB(OPEN)
     factory,
     msg->class_name,
     &msg->channel,
-    msg->precise)) == NULL) {
+    msg->precise,
+    (unsigned int) msg->stream)) == NULL) {
     SU_ERROR("Failed to open inspector\n");
     msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CHANNEL;
     ok = SU_TRUE;
@@ -507,6 +515,45 @@ done:
   return SU_TRUE;
 }
 
+DEF_MSGCB(SET_PAUSED)
+{
+  suscan_inspector_t *insp = NULL;
+  
+  if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
+    goto done;
+  
+  suscan_inspector_factory_set_inspector_paused(
+    suscan_inspector_get_factory(insp),
+    insp,
+    msg->paused);
+
+done:
+  if (insp != NULL)
+    suscan_local_analyzer_return_inspector(self, insp);
+  
+  return SU_TRUE;
+}
+
+DEF_MSGCB(SET_SQUELCH)
+{
+  suscan_inspector_t *insp = NULL;
+  
+  if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
+    goto done;
+  
+  suscan_inspector_factory_set_inspector_squelch(
+    suscan_inspector_get_factory(insp),
+    insp,
+    msg->squelch_enabled,
+    msg->squelch_level);
+
+done:
+  if (insp != NULL)
+    suscan_local_analyzer_return_inspector(self, insp);
+  
+  return SU_TRUE;
+}
+
 DEF_MSGCB(SET_FREQ)
 {
   struct suscan_inspector_overridable_request *req = NULL;
@@ -717,6 +764,8 @@ suscan_insp_server_init(void)
   INIT_MSGCB(SET_TLE);
   INIT_MSGCB(RESET_EQUALIZER);
   INIT_MSGCB(SET_WATERMARK);
+  INIT_MSGCB(SET_PAUSED);
+  INIT_MSGCB(SET_SQUELCH);
   INIT_MSGCB(SET_FREQ);
   INIT_MSGCB(SET_BANDWIDTH);
   INIT_MSGCB(CLOSE);
@@ -206,6 +206,24 @@ suscan_inspector_factory_feed(
     goto done;
   }
 
+  /*
+   * Paused inspectors are dropped here until sync_suspensions releases
+   * their channel. Factories that cannot release it keep feeding them.
+   */
+  if (self->iface->set_suspended == NULL) {
+    if (suscan_inspector_is_paused(insp)) {
+      insp->suspended = SU_TRUE;
+    } else if (insp->suspended) {
+      suscan_inspector_reset_state(insp);
+      insp->suspended = SU_FALSE;
+    }
+  }
+
+  if (suscan_inspector_is_paused(insp)) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
   /* Step 1: update frequency corrections for this inspector */
   suscan_inspector_factory_update_frequency_corrections(self, insp);
 
@@ -217,7 +235,15 @@ suscan_inspector_factory_feed(
   info->samples.size = size;
   info->inspector    = insp;
 
-  SU_TRY(suscan_inspsched_queue_task(self->sched, info));
+  /*
+   * Frequency-domain inspectors only get the bins of their channel, which
+   * are processed faster than they are queued. Process them in batches.
+   */
+  if (suscan_inspector_is_freq_domain(insp)) {
+    SU_TRY(suscan_inspsched_defer_task(self->sched, info));
+  } else {
+    SU_TRY(suscan_inspsched_queue_task(self->sched, info));
+  }
   info = NULL;
 
   ok = SU_TRUE;
@@ -275,6 +301,74 @@ suscan_inspector_factory_force_sync(suscan_inspector_factory_t *self)
   return suscan_inspsched_sync(self->sched);
 }
 
+/*
+ * Closure route 2: suspended inspectors receive no data, so they are
+ * closed here.
+ */
+SUBOOL
+suscan_inspector_factory_sync_suspensions(suscan_inspector_factory_t *self)
+{
+  suscan_inspector_t *insp;
+  SUBOOL paused;
+  unsigned int i;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  if (!self->suspension_pending || self->iface->set_suspended == NULL)
+    return SU_TRUE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->inspector_list_mutex));
+  mutex_acquired = SU_TRUE;
+
+  self->suspension_pending = SU_FALSE;
+
+  for (i = 0; i < self->inspector_count; ++i) {
+    insp = self->inspector_list[i];
+    if (insp == NULL || !insp->suspended)
+      continue;
+
+    if (insp->state == SUSCAN_ASYNC_STATE_HALTING) {
+      (void) (self->iface->close) (self->userdata, insp->factory_userdata);
+      insp->factory_userdata = NULL;
+      insp->state = SUSCAN_ASYNC_STATE_HALTED;
+    }
+  }
+
+  for (i = 0; i < self->inspector_count; ++i) {
+    insp = self->inspector_list[i];
+    if (insp == NULL || insp->state != SUSCAN_ASYNC_STATE_RUNNING)
+      continue;
+
+    paused = suscan_inspector_is_paused(insp);
+    if (paused == insp->suspended)
+      continue;
+
+    if (!(self->iface->set_suspended) (
+      self->userdata,
+      insp->factory_userdata,
+      paused)) {
+      SU_WARNING(
+        "Failed to %s inspector 0x%x\n",
+        paused ? "suspend" : "resume",
+        insp->inspector_id);
+      continue;
+    }
+
+    if (!paused)
+      suscan_inspector_reset_state(insp);
+
+    insp->suspended = paused;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->inspector_list_mutex);
+
+  return ok;
+}
+
 /*
  * TODO: This is not enough to halt an inspector, as overridable
  * requests may keep references to it. Remember to call
@@ -291,9 +385,14 @@ suscan_inspector_factory_halt_inspector(
   SU_TRYZ(pthread_mutex_lock(&self->inspector_list_mutex));
   mutex_acquired = SU_TRUE;
 
-  if (insp->state == SUSCAN_ASYNC_STATE_RUNNING)
+  if (insp->state == SUSCAN_ASYNC_STATE_RUNNING) {
     insp->state = SUSCAN_ASYNC_STATE_HALTING;
 
+    /* Suspended inspectors are closed by sync_suspensions */
+    if (insp->suspended)
+      self->suspension_pending = SU_TRUE;
+  }
+
   (void) pthread_mutex_unlock(&self->inspector_list_mutex);
   mutex_acquired = SU_FALSE;
 
@@ -73,6 +73,9 @@ struct suscan_inspector_factory_class {
   /* Set frequency correction */
   SUBOOL (*set_freq_correction) (void *, void *, SUFLOAT);
   
+  /* Release or reacquire the inspector's channel (optional) */
+  SUBOOL (*set_suspended) (void *, void *, SUBOOL);
+
   /* Set underlying tuner frequency (optional) */
   SUBOOL (*set_tuner_freq) (void *, SUFREQ);
 
@@ -98,6 +101,7 @@ struct suscan_inspector_factory {
   PTR_LIST(suscan_inspector_t, inspector); /* This list owns inspectors */
   pthread_mutex_t     inspector_list_mutex; /* Inspector list lock */
   SUBOOL              inspector_list_init;
+  volatile SUBOOL     suspension_pending; /* Some inspector was (un)paused */
   
   suscan_inspsched_t *sched;   /* Inspector scheduler */
 };
@@ -202,6 +206,70 @@ suscan_inspector_factory_set_inspector_freq_correction(
     insp->factory_userdata, 
     correction);
 }
+SUINLINE void
+suscan_inspector_factory_subscribe_inspector(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_t *insp)
+{
+  if (suscan_inspector_subscribe(insp))
+    self->suspension_pending = SU_TRUE;
+}
+
+SUINLINE void
+suscan_inspector_factory_unsubscribe_inspector(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_t *insp)
+{
+  if (suscan_inspector_unsubscribe(insp))
+    self->suspension_pending = SU_TRUE;
+}
+
+/* Pausing drops the subscription of the client */
+SUINLINE void
+suscan_inspector_factory_set_inspector_paused(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_t *insp,
+  SUBOOL paused)
+{
+  if (insp->client_subscribed != paused)
+    return;
+
+  insp->client_subscribed = !paused;
+
+  if (paused)
+    suscan_inspector_factory_unsubscribe_inspector(self, insp);
+  else
+    suscan_inspector_factory_subscribe_inspector(self, insp);
+}
+
+SUINLINE void
+suscan_inspector_factory_set_inspector_squelch(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_t *insp,
+  SUBOOL enabled,
+  SUFLOAT level)
+{
+  insp->squelch_level   = level;
+  insp->squelch_enabled = enabled;
+
+  if (!enabled && insp->squelched) {
+    insp->squelched = SU_FALSE;
+    self->suspension_pending = SU_TRUE;
+  }
+}
+
+SUINLINE void
+suscan_inspector_factory_set_inspector_squelched(
+  suscan_inspector_factory_t *self,
+  suscan_inspector_t *insp,
+  SUBOOL squelched)
+{
+  if (insp->squelched != squelched) {
+    insp->squelched = squelched;
+    self->suspension_pending = SU_TRUE;
+  }
+}
+
 suscan_inspector_factory_t *suscan_inspector_factory_new(
   const char *name,
   ...);
@@ -236,6 +304,13 @@ SUBOOL suscan_inspector_factory_notify_freq(
 
 SUBOOL suscan_inspector_factory_force_sync(suscan_inspector_factory_t *self);
 
+/*
+ * Suspend paused inspectors and resume the rest. Must be called from the
+ * thread that feeds the factory, between feeds.
+ */
+SUBOOL suscan_inspector_factory_sync_suspensions(
+  suscan_inspector_factory_t *self);
+
 SUBOOL suscan_inspector_factory_halt_inspector(
   suscan_inspector_factory_t *self,
   suscan_inspector_t *insp);
@@ -32,6 +32,7 @@
 #include "inspector/params.h"
 
 #include "inspector/inspector.h"
+#include "inspector/kernels.h"
 
 /* Some default ASK demodulator parameters */
 #define SUSCAN_ASK_INSPECTOR_DEFAULT_ROLL_OFF  .35
@@ -329,6 +330,44 @@ suscan_ask_inspector_commit_config(void *private)
   }
 }
 
+/*
+ * Loops are rebuilt in a fresh instance configured like this one and
+ * swapped in, so the old ones are released along with it.
+ */
+void
+suscan_ask_inspector_reset(void *private)
+{
+  struct suscan_ask_inspector *insp = (struct suscan_ask_inspector *) private;
+  struct suscan_ask_inspector *fresh = NULL;
+  su_agc_t agc;
+  su_pll_t pll;
+  su_clock_detector_t cd;
+  su_sampler_t sampler;
+
+  SU_TRYCATCH(fresh = suscan_ask_inspector_new(&insp->samp_info), return);
+
+  fresh->req_params = insp->cur_params;
+  suscan_ask_inspector_commit_config(fresh);
+
+  agc = insp->agc;
+  insp->agc = fresh->agc;
+  fresh->agc = agc;
+
+  pll = insp->pll;
+  insp->pll = fresh->pll;
+  fresh->pll = pll;
+
+  cd = insp->cd;
+  insp->cd = fresh->cd;
+  fresh->cd = cd;
+
+  sampler = insp->sampler;
+  insp->sampler = fresh->sampler;
+  fresh->sampler = sampler;
+
+  suscan_ask_inspector_destroy(fresh);
+}
+
 SUSDIFF
 suscan_ask_inspector_feed(
     void *private,
@@ -336,76 +375,88 @@ suscan_ask_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX const_gain = 0;
-  SUCOMPLEX det_x;
-  SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  SUCOMPLEX last = 0;
+  SUCOMPLEX det_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX mf_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX output[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX *y;
+  SUSCOUNT block = suscan_inspector_kernel_block_size();
+  SUSCOUNT i, p = 0, len, n;
+  SUSDIFF result = -1;
 
   struct suscan_ask_inspector *ask_insp =
       (struct suscan_ask_inspector *) private;
 
-  last = ask_insp->last;
+  count = SU_MIN(count, suscan_inspector_sampler_buf_avail(insp));
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&ask_insp->lo)) * ask_insp->phase;
+  while (p < count) {
+    len = SU_MIN(count - p, block);
 
-    /* Perform gain control */
-    switch (ask_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        const_gain = 2 * ask_insp->cur_params.gc.gc_gain * det_x;
-        break;
+    /* Re-center carrier and perform gain control */
+    suscan_inspector_kernel_mix(
+      &ask_insp->lo,
+      ask_insp->phase,
+      x + p,
+      det_x,
+      len);
 
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        const_gain  = 2 * su_agc_feed(&ask_insp->agc, det_x);
-        break;
-    }
+    suscan_inspector_kernel_gain(
+      ask_insp->cur_params.gc.gc_ctrl,
+      &ask_insp->agc,
+      ask_insp->cur_params.gc.gc_gain,
+      det_x,
+      len);
 
     /* Apply PLL, if enabled */
     if (ask_insp->cur_params.ask.uses_pll)
-      const_gain = su_pll_track(&ask_insp->pll, const_gain);
+      for (i = 0; i < len; ++i)
+        det_x[i] = su_pll_track(&ask_insp->pll, det_x[i]);
 
     /* Select the component to be demodulated */
     switch (ask_insp->cur_params.ask.channel) {
       case SUSCAN_INSPECTOR_ASK_CHANNEL_I:
-        det_x = SU_C_REAL(const_gain);
+        for (i = 0; i < len; ++i)
+          det_x[i] = SU_C_REAL(det_x[i]);
         break;
 
       case SUSCAN_INSPECTOR_ASK_CHANNEL_Q:
-        det_x = I * SU_C_IMAG(const_gain);
+        for (i = 0; i < len; ++i)
+          det_x[i] = I * SU_C_IMAG(det_x[i]);
         break;
 
       default:
-        det_x = const_gain;
+        break;
     }
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, det_x);
+    SU_TRY(suscan_inspector_feed_sc_stuner(insp, det_x, len));
 
     /* Add matched filter, if enabled */
+    y = det_x;
     if (ask_insp->cur_params.mf.mf_conf
-        == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&ask_insp->mf, det_x);
-
-    /* Check if channel sampler is enabled */
-    if (ask_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&ask_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&ask_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&ask_insp->cd, &output, 1) == 1;
+        == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL) {
+      su_iir_filt_feed_bulk(&ask_insp->mf, det_x, mf_x, len);
+      y = mf_x;
     }
 
-    if (new_sample)
-      suscan_inspector_push_sample(insp, output * .75 * ask_insp->phase);
+    /* Sample, either manually or with automatic baudrate control */
+    n = suscan_inspector_kernel_sample(
+      ask_insp->cur_params.br.br_ctrl,
+      &ask_insp->sampler,
+      &ask_insp->cd,
+      y,
+      output,
+      len);
+
+    suscan_inspector_kernel_scale(.75 * ask_insp->phase, output, n);
+    suscan_inspector_push_sample_buffer(insp, output, n);
+
+    p += len;
   }
 
-  ask_insp->last = last;
+  result = p;
 
-  return i;
+done:
+  return result;
 }
 
 void
@@ -422,6 +473,7 @@ SUPRIVATE struct suscan_inspector_interface iface = {
     .get_config = suscan_ask_inspector_get_config,
     .parse_config = suscan_ask_inspector_parse_config,
     .commit_config = suscan_ask_inspector_commit_config,
+    .reset = suscan_ask_inspector_reset,
     .feed = suscan_ask_inspector_feed,
     .close = suscan_ask_inspector_close
 };
@@ -371,6 +371,25 @@ suscan_audio_inspector_commit_config(void *private)
   self->cur_params = self->req_params;
 }
 
+/* Called inside inspector mutex */
+void
+suscan_audio_inspector_reset(void *private)
+{
+  struct suscan_audio_inspector *self =
+      (struct suscan_audio_inspector *) private;
+  su_pll_t pll;
+
+  self->last = 0;
+
+  if (!suscan_audio_inspector_update_agc(self, self->cur_params.gc.gc_ts))
+    SU_ERROR("Failed to reset audio AGC\n");
+
+  if (su_pll_init(&pll, 0, .005f * self->samp_info.bw)) {
+    su_pll_finalize(&self->pll);
+    self->pll = pll;
+  }
+}
+
 SUSDIFF
 suscan_audio_inspector_feed(
     void *private,
@@ -528,6 +547,7 @@ SUPRIVATE struct suscan_inspector_interface iface = {
     .get_config = suscan_audio_inspector_get_config,
     .parse_config = suscan_audio_inspector_parse_config,
     .commit_config = suscan_audio_inspector_commit_config,
+    .reset = suscan_audio_inspector_reset,
     .new_bandwidth = suscan_audio_inspector_new_bandwidth,
     .feed = suscan_audio_inspector_feed,
     .close = suscan_audio_inspector_close
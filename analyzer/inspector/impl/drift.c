@@ -405,6 +405,11 @@ suscan_drift_inspector_close(void *private)
   suscan_drift_inspector_destroy((struct suscan_drift_inspector *) private);
 }
 
+/*
+ * No reset on resume: the PLL frequency is the drift measured so far, which
+ * is still the best guess after a pause. Losing lock only delays the next
+ * feedback, and users can still force a reset through pll_reset.
+ */
 SUPRIVATE struct suscan_inspector_interface iface = {
     .name          = "drift",
     .desc          = "Frequency drift",
@@ -32,6 +32,7 @@
 #include "inspector/params.h"
 
 #include "inspector/inspector.h"
+#include "inspector/kernels.h"
 
 /* Some default FSK demodulator parameters */
 #define SUSCAN_FSK_INSPECTOR_DEFAULT_ROLL_OFF  .35
@@ -305,6 +306,39 @@ suscan_fsk_inspector_commit_config(void *private)
   }
 }
 
+/*
+ * Loops are rebuilt in a fresh instance configured like this one and
+ * swapped in, so the old ones are released along with it.
+ */
+void
+suscan_fsk_inspector_reset(void *private)
+{
+  struct suscan_fsk_inspector *insp = (struct suscan_fsk_inspector *) private;
+  struct suscan_fsk_inspector *fresh = NULL;
+  su_agc_t agc;
+  su_clock_detector_t cd;
+  su_sampler_t sampler;
+
+  SU_TRYCATCH(fresh = suscan_fsk_inspector_new(&insp->samp_info), return);
+
+  fresh->req_params = insp->cur_params;
+  suscan_fsk_inspector_commit_config(fresh);
+
+  agc = insp->agc;
+  insp->agc = fresh->agc;
+  fresh->agc = agc;
+
+  cd = insp->cd;
+  insp->cd = fresh->cd;
+  fresh->cd = cd;
+
+  sampler = insp->sampler;
+  insp->sampler = fresh->sampler;
+  fresh->sampler = sampler;
+
+  suscan_fsk_inspector_destroy(fresh);
+}
+
 SUSDIFF
 suscan_fsk_inspector_feed(
     void *private,
@@ -312,69 +346,85 @@ suscan_fsk_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX const_gain = 0;
-  SUCOMPLEX det_x;
-  SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  SUCOMPLEX last = 0;
+  SUCOMPLEX const_gain[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX det_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX sc_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX output[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX *y;
+  SUCOMPLEX last;
+  SUSCOUNT block = suscan_inspector_kernel_block_size();
+  SUSCOUNT i, p = 0, len, n;
+  SUSDIFF result = -1;
 
   struct suscan_fsk_inspector *fsk_insp =
       (struct suscan_fsk_inspector *) private;
 
-  last = fsk_insp->last;
+  count = SU_MIN(count, suscan_inspector_sampler_buf_avail(insp));
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&fsk_insp->lo));
+  while (p < count) {
+    len = SU_MIN(count - p, block);
 
-    /* Perform gain control */
-    switch (fsk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        const_gain = 2 * fsk_insp->cur_params.gc.gc_gain * det_x;
-        break;
+    /* Re-center carrier and perform gain control */
+    suscan_inspector_kernel_mix(&fsk_insp->lo, 1, x + p, const_gain, len);
 
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        const_gain = 2 * su_agc_feed(&fsk_insp->agc, det_x);
-        break;
-    }
+    suscan_inspector_kernel_gain(
+      fsk_insp->cur_params.gc.gc_ctrl,
+      &fsk_insp->agc,
+      fsk_insp->cur_params.gc.gc_gain,
+      const_gain,
+      len);
 
     /*
      * We are actually encoding frequency information in the phase. This
      * is intentional, as the UI quantizes the argument of each sample.
      */
-    if (fsk_insp->cur_params.fsk.quad_demod)
-      det_x = const_gain * SU_C_CONJ(last);
-    else
-      det_x = (const_gain * SU_C_CONJ(last)) /
-      (.5 * (const_gain * SU_C_CONJ(const_gain) + last * SU_C_CONJ(last)) + 1e-8);
+    last = fsk_insp->last;
+    det_x[0] = const_gain[0] * SU_C_CONJ(last);
+    for (i = 1; i < len; ++i)
+      det_x[i] = const_gain[i] * SU_C_CONJ(const_gain[i - 1]);
+
+    if (!fsk_insp->cur_params.fsk.quad_demod) {
+      det_x[0] /= .5 * (const_gain[0] * SU_C_CONJ(const_gain[0])
+        + last * SU_C_CONJ(last)) + 1e-8;
+      for (i = 1; i < len; ++i)
+        det_x[i] /= .5 * (const_gain[i] * SU_C_CONJ(const_gain[i])
+          + const_gain[i - 1] * SU_C_CONJ(const_gain[i - 1])) + 1e-8;
+    }
 
-    last = const_gain;
+    fsk_insp->last = const_gain[len - 1];
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, SU_C_ARG(det_x));
+    for (i = 0; i < len; ++i)
+      sc_x[i] = SU_C_ARG(det_x[i]);
+    SU_TRY(suscan_inspector_feed_sc_stuner(insp, sc_x, len));
 
     /* Add matched filter, if enabled */
-    if (fsk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&fsk_insp->mf, det_x);
-
-    /* Check if channel sampler is enabled */
-    if (fsk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&fsk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&fsk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&fsk_insp->cd, &output, 1) == 1;
+    y = det_x;
+    if (fsk_insp->cur_params.mf.mf_conf
+        == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL) {
+      su_iir_filt_feed_bulk(&fsk_insp->mf, det_x, const_gain, len);
+      y = const_gain;
     }
 
-    if (new_sample)
-      suscan_inspector_push_sample(insp, output * .75 * fsk_insp->phase);
+    /* Sample, either manually or with automatic baudrate control */
+    n = suscan_inspector_kernel_sample(
+      fsk_insp->cur_params.br.br_ctrl,
+      &fsk_insp->sampler,
+      &fsk_insp->cd,
+      y,
+      output,
+      len);
+
+    suscan_inspector_kernel_scale(.75 * fsk_insp->phase, output, n);
+    suscan_inspector_push_sample_buffer(insp, output, n);
+
+    p += len;
   }
 
-  fsk_insp->last = last;
+  result = p;
 
-  return i;
+done:
+  return result;
 }
 
 void
@@ -391,6 +441,7 @@ SUPRIVATE struct suscan_inspector_interface iface = {
     .get_config = suscan_fsk_inspector_get_config,
     .parse_config = suscan_fsk_inspector_parse_config,
     .commit_config = suscan_fsk_inspector_commit_config,
+    .reset = suscan_fsk_inspector_reset,
     .feed = suscan_fsk_inspector_feed,
     .close = suscan_fsk_inspector_close
 };
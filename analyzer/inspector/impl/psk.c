@@ -33,6 +33,7 @@
 #include "inspector/params.h"
 
 #include "inspector/inspector.h"
+#include "inspector/kernels.h"
 
 /* Some default PSK demodulator parameters */
 #define SUSCAN_PSK_INSPECTOR_DEFAULT_ROLL_OFF  .35
@@ -393,6 +394,52 @@ suscan_psk_inspector_commit_config(void *private)
   }
 }
 
+/*
+ * Loops are rebuilt in a fresh instance configured like this one and
+ * swapped in, so the old ones are released along with it. A locked
+ * equalizer keeps its taps.
+ */
+void
+suscan_psk_inspector_reset(void *private)
+{
+  struct suscan_psk_inspector *insp = (struct suscan_psk_inspector *) private;
+  struct suscan_psk_inspector *fresh = NULL;
+  su_agc_t agc;
+  su_costas_t costas;
+  su_clock_detector_t cd;
+  su_sampler_t sampler;
+  su_equalizer_t eq;
+
+  SU_TRYCATCH(fresh = suscan_psk_inspector_new(&insp->samp_info), return);
+
+  fresh->req_params = insp->cur_params;
+  suscan_psk_inspector_commit_config(fresh);
+
+  agc = insp->agc;
+  insp->agc = fresh->agc;
+  fresh->agc = agc;
+
+  costas = insp->costas;
+  insp->costas = fresh->costas;
+  fresh->costas = costas;
+
+  cd = insp->cd;
+  insp->cd = fresh->cd;
+  fresh->cd = cd;
+
+  sampler = insp->sampler;
+  insp->sampler = fresh->sampler;
+  fresh->sampler = sampler;
+
+  if (!insp->cur_params.eq.eq_locked) {
+    eq = insp->eq;
+    insp->eq = fresh->eq;
+    fresh->eq = eq;
+  }
+
+  suscan_psk_inspector_destroy(fresh);
+}
+
 SUSDIFF
 suscan_psk_inspector_feed(
     void *private,
@@ -400,64 +447,81 @@ suscan_psk_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX det_x;
-  SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
+  SUCOMPLEX det_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX mf_x[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX output[SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE];
+  SUCOMPLEX *y;
+  SUSCOUNT block = suscan_inspector_kernel_block_size();
+  SUSCOUNT i, p = 0, len, n;
+  SUSDIFF result = -1;
   struct suscan_psk_inspector *psk_insp =
       (struct suscan_psk_inspector *) private;
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&psk_insp->lo)) * psk_insp->phase;
+  count = SU_MIN(count, suscan_inspector_sampler_buf_avail(insp));
 
-    /* Perform gain control */
-    switch (psk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        det_x *= 2 * psk_insp->cur_params.gc.gc_gain;
-        break;
+  while (p < count) {
+    len = SU_MIN(count - p, block);
 
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        det_x  = 2 * su_agc_feed(&psk_insp->agc, det_x);
-        break;
-    }
+    /* Re-center carrier and perform gain control */
+    suscan_inspector_kernel_mix(
+      &psk_insp->lo,
+      psk_insp->phase,
+      x + p,
+      det_x,
+      len);
+
+    suscan_inspector_kernel_gain(
+      psk_insp->cur_params.gc.gc_ctrl,
+      &psk_insp->agc,
+      psk_insp->cur_params.gc.gc_gain,
+      det_x,
+      len);
 
     /* Perform frequency correction */
     if (psk_insp->cur_params.fc.fc_ctrl
         != SUSCAN_INSPECTOR_CARRIER_CONTROL_MANUAL) {
-      su_costas_feed(&psk_insp->costas, det_x);
-      det_x = psk_insp->costas.y;
+      for (i = 0; i < len; ++i) {
+        su_costas_feed(&psk_insp->costas, det_x[i]);
+        det_x[i] = psk_insp->costas.y;
+      }
     }
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, det_x);
+    SU_TRY(suscan_inspector_feed_sc_stuner(insp, det_x, len));
 
     /* Add matched filter, if enabled */
-    if (psk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&psk_insp->mf, det_x);
-
-    /* Check if channel sampler is enabled */
-    if (psk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&psk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&psk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&psk_insp->cd, &output, 1) == 1;
+    y = det_x;
+    if (psk_insp->cur_params.mf.mf_conf
+        == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL) {
+      su_iir_filt_feed_bulk(&psk_insp->mf, det_x, mf_x, len);
+      y = mf_x;
     }
 
+    /* Sample, either manually or with automatic baudrate control */
+    n = suscan_inspector_kernel_sample(
+      psk_insp->cur_params.br.br_ctrl,
+      &psk_insp->sampler,
+      &psk_insp->cd,
+      y,
+      output,
+      len);
+
     /* Apply channel equalizer, if enabled */
-    if (new_sample) {
-      if (psk_insp->cur_params.eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA) {
-        output = su_equalizer_feed(&psk_insp->eq, output);
-      }
+    if (psk_insp->cur_params.eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA)
+      for (i = 0; i < n; ++i)
+        output[i] = su_equalizer_feed(&psk_insp->eq, output[i]);
 
-      /* Reduce amplitude so it fits in the constellation window */
-      suscan_inspector_push_sample(insp, output * .75);
-    }
+    /* Reduce amplitude so it fits in the constellation window */
+    suscan_inspector_kernel_scale(.75, output, n);
+    suscan_inspector_push_sample_buffer(insp, output, n);
+
+    p += len;
   }
 
-  return i;
+  result = p;
+
+done:
+  return result;
 }
 
 void
@@ -474,6 +538,7 @@ SUPRIVATE struct suscan_inspector_interface iface = {
     .get_config = suscan_psk_inspector_get_config,
     .parse_config = suscan_psk_inspector_parse_config,
     .commit_config = suscan_psk_inspector_commit_config,
+    .reset = suscan_psk_inspector_reset,
     .feed = suscan_psk_inspector_feed,
     .close = suscan_psk_inspector_close
 };
@@ -34,6 +34,38 @@
 
 #include "realtime.h"
 #include "msg.h"
+#include "bufpool.h"
+
+/* Process-wide inspector memory accounting */
+SUPRIVATE pthread_mutex_t g_insp_memory_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE struct suscan_inspector_memory_stats g_insp_memory;
+
+SUPRIVATE void
+suscan_inspector_account_memory(
+    SUSDIFF inspectors,
+    SUSDIFF object_bytes,
+    SUSDIFF sampler_bytes)
+{
+  (void) pthread_mutex_lock(&g_insp_memory_mutex);
+  g_insp_memory.inspectors    += inspectors;
+  g_insp_memory.object_bytes  += object_bytes;
+  g_insp_memory.sampler_bytes += sampler_bytes;
+  (void) pthread_mutex_unlock(&g_insp_memory_mutex);
+}
+
+void
+suscan_inspector_get_memory_stats(struct suscan_inspector_memory_stats *stats)
+{
+  struct suscan_buffer_stats pool_stats;
+
+  (void) pthread_mutex_lock(&g_insp_memory_mutex);
+  *stats = g_insp_memory;
+  (void) pthread_mutex_unlock(&g_insp_memory_mutex);
+
+  suscan_buffer_get_stats(&pool_stats);
+  stats->pool_bytes      = pool_stats.bytes_allocated;
+  stats->pool_free_bytes = pool_stats.bytes_free;
+}
 
 void
 suscan_inspector_lock(suscan_inspector_t *insp)
@@ -57,6 +89,59 @@ suscan_inspector_reset_equalizer(suscan_inspector_t *insp)
   suscan_inspector_unlock(insp);
 }
 
+/*
+ * Samples and snapshots collected before the pause are not contiguous with
+ * whatever comes next. Drop them, and let the class restart its loops.
+ */
+void
+suscan_inspector_reset_state(suscan_inspector_t *insp)
+{
+  suscan_inspector_lock(insp);
+
+  if (insp->iface->reset != NULL)
+    (insp->iface->reset) (insp->privdata);
+
+  insp->sampler_ptr       = 0;
+  insp->estimator_samples = 0;
+  insp->spectrum_samples  = 0;
+
+  (void) pthread_mutex_lock(&insp->estimator_mutex);
+  if (insp->estimator_state == SUSCAN_INSPECTOR_ESTIMATOR_STATE_COLLECTING)
+    insp->estimator_state = SUSCAN_INSPECTOR_ESTIMATOR_STATE_IDLE;
+  (void) pthread_mutex_unlock(&insp->estimator_mutex);
+
+  suscan_inspector_unlock(insp);
+}
+
+/*
+ * Both return SU_TRUE if the inspector went from having subscribers to
+ * having none, or the other way around.
+ */
+SUBOOL
+suscan_inspector_subscribe(suscan_inspector_t *insp)
+{
+  SUBOOL changed;
+
+  (void) pthread_mutex_lock(&insp->subscriber_mutex);
+  changed = insp->subscribers++ == 0;
+  (void) pthread_mutex_unlock(&insp->subscriber_mutex);
+
+  return changed;
+}
+
+SUBOOL
+suscan_inspector_unsubscribe(suscan_inspector_t *insp)
+{
+  SUBOOL changed = SU_FALSE;
+
+  (void) pthread_mutex_lock(&insp->subscriber_mutex);
+  if (insp->subscribers > 0)
+    changed = --insp->subscribers == 0;
+  (void) pthread_mutex_unlock(&insp->subscriber_mutex);
+
+  return changed;
+}
+
 /*********************** Channel opening and closing *************************/
 SUPRIVATE su_specttuner_channel_t *
 suscan_inspector_open_sc_channel_ex(
@@ -217,6 +302,9 @@ suscan_sc_inspector_factory_open(
       NULL),
     return NULL);
 
+  /* The parent must be fed for as long as this inspector is open */
+  suscan_inspector_factory_subscribe_inspector(self->factory, self);
+
   /* Prepare output fields */
   *inspclass = classname;
 
@@ -269,6 +357,8 @@ suscan_sc_inspector_factory_close(
 
   if (!suscan_inspector_open_sc_close_channel(self, chan))
     SU_WARNING("Failed to close channel!\n");
+
+  suscan_inspector_factory_unsubscribe_inspector(self->factory, self);
 }
 
 SUPRIVATE void
@@ -418,6 +508,57 @@ suscan_inspector_register_factory(void)
 }
 
 /********************* Inspector loop methods ***************************/
+/*
+ * Most inspectors produce far less than SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE
+ * samples between messages, and many of them produce none. The sampler buffer
+ * is therefore allocated on the first feed, and sized to hold the watermark
+ * or SUSCAN_INSPECTOR_SAMPLER_BUF_TIME seconds of output, whatever is bigger.
+ * Producing more than this before a message is sent just splits the output
+ * in several messages.
+ */
+SUPRIVATE SUBOOL
+suscan_inspector_ensure_sampler_buf(suscan_inspector_t *self)
+{
+  SUCOMPLEX *buf = NULL;
+  SUSCOUNT size;
+  SUSCOUNT old_bytes, new_bytes;
+
+  size = SU_MAX(
+    self->sample_msg_watermark,
+    self->samp_info.equiv_fs * SUSCAN_INSPECTOR_SAMPLER_BUF_TIME);
+
+  if (size < SUSCAN_INSPECTOR_SAMPLER_BUF_MIN)
+    size = SUSCAN_INSPECTOR_SAMPLER_BUF_MIN;
+  else if (size > SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE)
+    size = SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE;
+
+  if (self->sampler_buf != NULL && self->sampler_buf_size >= size)
+    return SU_TRUE;
+
+  SU_TRY(buf = suscan_buffer_alloc(size));
+
+  old_bytes = self->sampler_buf_size * sizeof(SUCOMPLEX);
+  new_bytes = suscan_buffer_get_capacity(buf) * sizeof(SUCOMPLEX);
+
+  if (self->sampler_buf != NULL) {
+    memcpy(buf, self->sampler_buf, self->sampler_ptr * sizeof(SUCOMPLEX));
+    suscan_buffer_return(self->sampler_buf);
+  }
+
+  self->sampler_buf      = buf;
+  self->sampler_buf_size = suscan_buffer_get_capacity(buf);
+
+  suscan_inspector_account_memory(
+    0,
+    0,
+    (SUSDIFF) new_bytes - (SUSDIFF) old_bytes);
+
+  return SU_TRUE;
+
+done:
+  return SU_FALSE;
+}
+
 SUBOOL
 suscan_inspector_sampler_loop(
     suscan_inspector_t *insp,
@@ -429,6 +570,8 @@ suscan_inspector_sampler_loop(
 
   SUSDIFF fed;
 
+  SU_TRYCATCH(suscan_inspector_ensure_sampler_buf(insp), goto fail);
+
   while (samp_count > 0) {
     /* Ensure the current inspector parameters are up-to-date */
     suscan_inspector_assert_params(insp);
@@ -527,6 +670,43 @@ done:
   return ok;
 }
 
+/*
+ * Refresh intervals are measured in samples of the equivalent sample rate,
+ * scaled by the throttle factor so that they still hold in wall-clock time
+ * when the source is throttled. This is much cheaper than reading the clock
+ * for every block of every inspector, and deterministic in replays.
+ */
+SUPRIVATE SUBOOL
+suscan_inspector_interval_elapsed(
+    const suscan_inspector_t *self,
+    SUFLOAT *acc,
+    SUFLOAT interval,
+    SUSCOUNT samp_count)
+{
+  SUFLOAT period = interval * self->samp_info.equiv_fs * self->throttle_factor;
+
+  /* Frequency domain inspectors get FFT windows, overlapped by half */
+  if (suscan_inspector_is_freq_domain(self))
+    samp_count /= 2;
+
+  *acc += samp_count;
+
+  if (*acc < period)
+    return SU_FALSE;
+
+  /*
+   * Keep the excess, so that updates do not drift by up to one block per
+   * period. After a stall longer than a period, fire once and drop the
+   * periods that were missed.
+   */
+  if (period > 0)
+    *acc -= period * SU_FLOOR(*acc / period);
+  else
+    *acc = 0;
+
+  return SU_TRUE;
+}
+
 SUBOOL
 suscan_inspector_spectrum_loop(
     suscan_inspector_t *insp,
@@ -540,11 +720,11 @@ suscan_inspector_spectrum_loop(
     src = insp->spectsrc_list[insp->spectsrc_index - 1];
 
     if (suscan_inspector_is_freq_domain(insp)) {
-      uint64_t interval = insp->interval_spectrum * 1e9;
-      uint64_t now = suscan_gettime();
-      if (now - insp->last_spectrum > interval) {
-        insp->last_spectrum = now;
-
+      if (suscan_inspector_interval_elapsed(
+        insp,
+        &insp->spectrum_samples,
+        insp->interval_spectrum,
+        samp_count)) {
         SU_TRY_FAIL(
           suscan_inspector_send_freq_domain_psd(
             insp,
@@ -604,64 +784,161 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_inspector_have_enabled_estimators(const suscan_inspector_t *self)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->estimator_count; ++i)
+    if (suscan_estimator_is_enabled(self->estimator_list[i]))
+      return SU_TRUE;
+
+  return SU_FALSE;
+}
+
 SUBOOL
 suscan_inspector_estimator_loop(
     suscan_inspector_t *insp,
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count)
+{
+  SUSCOUNT len;
+  SUBOOL ok = SU_FALSE;
+
+  if (insp->interval_estimator <= 0)
+    return SU_TRUE;
+
+  (void) pthread_mutex_lock(&insp->estimator_mutex);
+
+  switch (insp->estimator_state) {
+    case SUSCAN_INSPECTOR_ESTIMATOR_STATE_IDLE:
+      if (!suscan_inspector_interval_elapsed(
+        insp,
+        &insp->estimator_samples,
+        insp->interval_estimator,
+        samp_count))
+        break;
+
+      if (!suscan_inspector_have_enabled_estimators(insp))
+        break;
+
+      if (insp->estimator_snapshot == NULL)
+        SU_TRYCATCH(
+          insp->estimator_snapshot = suscan_buffer_alloc(
+            SUSCAN_ESTIMATOR_SNAPSHOT_SIZE),
+          goto done);
+
+      insp->estimator_snapshot_ptr = 0;
+      insp->estimator_state = SUSCAN_INSPECTOR_ESTIMATOR_STATE_COLLECTING;
+
+      /* Fall through */
+
+    case SUSCAN_INSPECTOR_ESTIMATOR_STATE_COLLECTING:
+      len = SU_MIN(
+        samp_count,
+        SUSCAN_ESTIMATOR_SNAPSHOT_SIZE - insp->estimator_snapshot_ptr);
+
+      memcpy(
+        insp->estimator_snapshot + insp->estimator_snapshot_ptr,
+        samp_buf,
+        len * sizeof(SUCOMPLEX));
+
+      insp->estimator_snapshot_ptr += len;
+
+      /* The scheduler queues it to its estimator worker */
+      if (insp->estimator_snapshot_ptr == SUSCAN_ESTIMATOR_SNAPSHOT_SIZE)
+        insp->estimator_state = SUSCAN_INSPECTOR_ESTIMATOR_STATE_READY;
+      break;
+
+    default:
+      /* Previous snapshot still being processed: skip */
+      break;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  (void) pthread_mutex_unlock(&insp->estimator_mutex);
+
+  return ok;
+}
+
+SUBOOL
+suscan_inspector_claim_estimator_snapshot(suscan_inspector_t *insp)
+{
+  SUBOOL claimed = SU_FALSE;
+
+  (void) pthread_mutex_lock(&insp->estimator_mutex);
+
+  if (insp->estimator_state == SUSCAN_INSPECTOR_ESTIMATOR_STATE_READY) {
+    insp->estimator_state = SUSCAN_INSPECTOR_ESTIMATOR_STATE_RUNNING;
+    claimed = SU_TRUE;
+  }
+
+  (void) pthread_mutex_unlock(&insp->estimator_mutex);
+
+  return claimed;
+}
+
+void
+suscan_inspector_drop_estimator_snapshot(suscan_inspector_t *insp)
+{
+  (void) pthread_mutex_lock(&insp->estimator_mutex);
+  insp->estimator_state = SUSCAN_INSPECTOR_ESTIMATOR_STATE_IDLE;
+  (void) pthread_mutex_unlock(&insp->estimator_mutex);
+}
+
+SUBOOL
+suscan_inspector_run_estimators(suscan_inspector_t *insp)
 {
   struct suscan_analyzer_inspector_msg *msg = NULL;
   unsigned int i;
-  uint64_t now;
   SUFLOAT value;
-  SUFLOAT seconds;
+  SUBOOL ok = SU_FALSE;
 
-  /* Check esimator state and update clients */
-  if (insp->interval_estimator > 0) {
-    now = suscan_gettime();
-    seconds = (now - insp->last_estimator) * 1e-9;
-    if (seconds >= insp->interval_estimator) {
-      insp->last_estimator = now;
-      for (i = 0; i < insp->estimator_count; ++i)
-        if (suscan_estimator_is_enabled(insp->estimator_list[i])) {
-          if (suscan_estimator_is_enabled(insp->estimator_list[i]))
-            SU_TRYCATCH(
-                suscan_estimator_feed(
-                    insp->estimator_list[i],
-                    samp_buf,
-                    samp_count),
-                goto fail);
-
-          if (suscan_estimator_read(insp->estimator_list[i], &value)) {
-            SU_TRYCATCH(
-                msg = suscan_analyzer_inspector_msg_new(
-                    SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
-                    rand()),
-                goto fail);
-
-            msg->enabled = SU_TRUE;
-            msg->estimator_id = i;
-            msg->value = value;
-            msg->inspector_id = insp->inspector_id;
-
-            SU_TRYCATCH(
-                suscan_mq_write(
-                    insp->mq_out,
-                    SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
-                    msg),
-                goto fail);
-          }
-        }
+  for (i = 0; i < insp->estimator_count; ++i)
+    if (suscan_estimator_is_enabled(insp->estimator_list[i])) {
+      /* Nothing from the previous snapshot must leak into this one */
+      suscan_estimator_reset(insp->estimator_list[i]);
+
+      SU_TRYCATCH(
+          suscan_estimator_feed(
+              insp->estimator_list[i],
+              insp->estimator_snapshot,
+              insp->estimator_snapshot_ptr),
+          goto done);
+
+      if (suscan_estimator_read(insp->estimator_list[i], &value)) {
+        SU_TRYCATCH(
+            msg = suscan_analyzer_inspector_msg_new(
+                SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
+                rand()),
+            goto done);
+
+        msg->enabled = SU_TRUE;
+        msg->estimator_id = i;
+        msg->value = value;
+        msg->inspector_id = insp->inspector_id;
+
+        SU_TRYCATCH(
+            suscan_mq_write(
+                insp->mq_out,
+                SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+                msg),
+            goto done);
+        msg = NULL;
+      }
     }
-  }
 
-  return SU_TRUE;
+  ok = SU_TRUE;
 
-fail:
+done:
   if (msg != NULL)
     suscan_analyzer_inspector_msg_destroy(msg);
 
-  return SU_FALSE;
+  suscan_inspector_drop_estimator_snapshot(insp);
+
+  return ok;
 }
 
 SUBOOL 
@@ -848,6 +1125,12 @@ suscan_inspector_destroy(suscan_inspector_t *self)
   if (self->corrector_init)
     pthread_mutex_destroy(&self->corrector_mutex);
 
+  if (self->estimator_mutex_init)
+    pthread_mutex_destroy(&self->estimator_mutex);
+
+  if (self->subscriber_mutex_init)
+    pthread_mutex_destroy(&self->subscriber_mutex);
+
   if (self->corrector != NULL)
     suscan_frequency_corrector_destroy(self->corrector);
 
@@ -866,6 +1149,19 @@ suscan_inspector_destroy(suscan_inspector_t *self)
   if (self->spectsrc_list != NULL)
     free(self->spectsrc_list);
 
+  if (self->estimator_snapshot != NULL)
+    suscan_buffer_return(self->estimator_snapshot);
+
+  if (self->sampler_buf != NULL) {
+    suscan_buffer_return(self->sampler_buf);
+    suscan_inspector_account_memory(
+      0,
+      0,
+      -(SUSDIFF) (self->sampler_buf_size * sizeof(SUCOMPLEX)));
+  }
+
+  suscan_inspector_account_memory(-1, -(SUSDIFF) sizeof(suscan_inspector_t), 0);
+
   free(self);
 }
 
@@ -889,7 +1185,9 @@ suscan_inspector_set_throttle_factor(
 
   if (factor <= 0.)
     factor = 1.;
-    
+
+  self->throttle_factor = factor;
+
   for (i = 0; i < self->spectsrc_count; ++i)
     suscan_spectsrc_set_throttle_factor(self->spectsrc_list[i], factor);
 }
@@ -1122,6 +1420,7 @@ suscan_inspector_new(
   }
 
   SU_ALLOCATE_FAIL(new, suscan_inspector_t);
+  suscan_inspector_account_memory(1, sizeof(suscan_inspector_t), 0);
   new->state            = SUSCAN_ASYNC_STATE_CREATED;
   new->samp_info        = *samp_info;
   new->frequency_domain = iface->frequency_domain;
@@ -1136,6 +1435,16 @@ suscan_inspector_new(
   SU_TRYZ_FAIL(pthread_mutex_init(&new->corrector_mutex, NULL));
   new->corrector_init = SU_TRUE;
 
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->estimator_mutex, NULL));
+  new->estimator_mutex_init = SU_TRUE;
+
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->subscriber_mutex, NULL));
+  new->subscriber_mutex_init = SU_TRUE;
+
+  /* The client that opens the inspector is its first subscriber */
+  new->subscribers       = 1;
+  new->client_subscribed = SU_TRUE;
+
   /* Factory specific fields */
   new->factory          = owner;
   new->factory_userdata = userdata;
@@ -1148,10 +1457,7 @@ suscan_inspector_new(
   new->interval_estimator    = .1;
   new->interval_spectrum     = .1;
   new->interval_orbit_report = .25;
-
-  /* Initialize clocks */
-  new->last_estimator = suscan_gettime();
-  new->last_spectrum  = suscan_gettime();
+  new->throttle_factor       = 1.;
 
   /* All set to call specific inspector */
   new->iface = iface;
@@ -36,7 +36,9 @@ extern "C" {
 #define SUSCAN_ANALYZER_CPU_USAGE_UPDATE_ALPHA .025
 
 #define SUSCAN_INSPECTOR_TUNER_BUF_SIZE    SU_BLOCK_STREAM_BUFFER_SIZE
-#define SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE  65536
+#define SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE  65536 /* Maximum */
+#define SUSCAN_INSPECTOR_SAMPLER_BUF_MIN   512
+#define SUSCAN_INSPECTOR_SAMPLER_BUF_TIME  .05   /* Seconds of output */
 #define SUSCAN_INSPECTOR_SPECTRUM_BUF_SIZE 8192
 
 struct suscan_inspector_factory;
@@ -48,6 +50,19 @@ enum suscan_aync_state {
   SUSCAN_ASYNC_STATE_HALTED
 };
 
+/*
+ * Estimators do not see the whole stream. Every estimator interval, the
+ * inspector collects a snapshot of SUSCAN_ESTIMATOR_SNAPSHOT_SIZE samples,
+ * which is then processed by a low-priority worker of the scheduler.
+ * Snapshots are not contiguous, so estimators are reset before each one.
+ */
+enum suscan_inspector_estimator_state {
+  SUSCAN_INSPECTOR_ESTIMATOR_STATE_IDLE,
+  SUSCAN_INSPECTOR_ESTIMATOR_STATE_COLLECTING,
+  SUSCAN_INSPECTOR_ESTIMATOR_STATE_READY,   /* Snapshot complete */
+  SUSCAN_INSPECTOR_ESTIMATOR_STATE_RUNNING  /* Queued to the worker */
+};
+
 /* TODO: protect baudrate access with mutexes */
 struct suscan_inspector {
   SUSCAN_REFCOUNT;              /* Reference counter */
@@ -81,12 +96,41 @@ struct suscan_inspector {
   SUFLOAT  interval_spectrum;
   SUFLOAT  interval_orbit_report;
 
-  uint64_t last_estimator;
-  uint64_t last_spectrum;
+  /* Estimator and spectrum updates are scheduled in samples */
+  SUFLOAT  throttle_factor;
+  SUFLOAT  estimator_samples;
+  SUFLOAT  spectrum_samples;
+
+  /* Estimators run on snapshots, in the scheduler's estimator worker */
+  SUCOMPLEX *estimator_snapshot;
+  SUSCOUNT   estimator_snapshot_ptr;
+
+  /* Changed by both the sample and the estimator workers */
+  pthread_mutex_t estimator_mutex;
+  SUBOOL          estimator_mutex_init;
+  enum suscan_inspector_estimator_state estimator_state;
+
   uint64_t last_orbit_report;
 
   uint32_t spectsrc_index;
 
+  /*
+   * Inspectors are fed while they have subscribers: the client that
+   * opened them (until it pauses them) and every subcarrier inspector
+   * opened on top. Inspectors without subscribers, or whose channel is
+   * held idle by the squelch, are paused. Suspension (releasing the
+   * channel) follows in the source thread.
+   */
+  pthread_mutex_t       subscriber_mutex;
+  SUBOOL                subscriber_mutex_init;
+  volatile unsigned int subscribers;
+  SUBOOL                client_subscribed;
+  SUBOOL          squelch_enabled;
+  SUFLOAT         squelch_level;  /* dB */
+  volatile SUBOOL squelched;
+  unsigned int    squelch_hang;   /* PSD updates left before closing */
+  SUBOOL          suspended;
+
   SUBOOL    params_requested;    /* New parameters requested */
   SUBOOL    bandwidth_notified;  /* New bandwidth set */
   SUFREQ    new_bandwidth;
@@ -97,10 +141,11 @@ struct suscan_inspector {
   pthread_mutex_t                  sc_stuner_mutex;
   SUBOOL                           sc_stuner_init;
 
-  /* Sampler output */
-  SUCOMPLEX sampler_buf[SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE];
-  SUSCOUNT  sampler_ptr;
-  SUSCOUNT  sample_msg_watermark; /* Watermark. When reached, message is sent */
+  /* Sampler output, allocated from the buffer pool on first use */
+  SUCOMPLEX *sampler_buf;
+  SUSCOUNT   sampler_buf_size;
+  SUSCOUNT   sampler_ptr;
+  SUSCOUNT   sample_msg_watermark; /* Watermark. When reached, message is sent */
   
   PTR_LIST(suscan_estimator_t, estimator); /* Parameter estimators */
   PTR_LIST(suscan_spectsrc_t, spectsrc); /* Spectrum source */
@@ -108,6 +153,22 @@ struct suscan_inspector {
 
 typedef struct suscan_inspector suscan_inspector_t;
 
+/* Spectrum source fed by the spectrum loop, if any */
+SUINLINE suscan_spectsrc_t *
+suscan_inspector_get_spectsrc(const suscan_inspector_t *self)
+{
+  if (self->spectsrc_index == 0 || self->frequency_domain)
+    return NULL;
+
+  return self->spectsrc_list[self->spectsrc_index - 1];
+}
+
+SUINLINE SUBOOL
+suscan_inspector_is_paused(const suscan_inspector_t *self)
+{
+  return self->subscribers == 0 || self->squelched;
+}
+
 SUINLINE SUBOOL
 suscan_inspector_is_freq_domain(const suscan_inspector_t *self)
 {
@@ -178,13 +239,13 @@ suscan_inspector_set_msg_watermark(suscan_inspector_t *self, SUSCOUNT wm)
 SUINLINE SUSCOUNT
 suscan_inspector_sampler_buf_avail(const suscan_inspector_t *self)
 {
-  return SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE - self->sampler_ptr;
+  return self->sampler_buf_size - self->sampler_ptr;
 }
 
 SUINLINE SUBOOL
 suscan_inspector_push_sample(suscan_inspector_t *self, SUCOMPLEX samp)
 {
-  if (self->sampler_ptr >= SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE)
+  if (self->sampler_ptr >= self->sampler_buf_size)
     return SU_FALSE;
 
   self->sampler_buf[self->sampler_ptr++] = samp;
@@ -273,6 +334,14 @@ void suscan_inspector_unlock(suscan_inspector_t *insp);
 
 void suscan_inspector_reset_equalizer(suscan_inspector_t *insp);
 
+/* Start over after a pause */
+void suscan_inspector_reset_state(suscan_inspector_t *insp);
+
+/* Return SU_TRUE if the inspector gained its first or lost its last one */
+SUBOOL suscan_inspector_subscribe(suscan_inspector_t *insp);
+
+SUBOOL suscan_inspector_unsubscribe(suscan_inspector_t *insp);
+
 SUBOOL suscan_inspector_set_corrector(
   suscan_inspector_t *self, 
   suscan_frequency_corrector_t *corrector);
@@ -347,11 +416,32 @@ SUBOOL suscan_inspector_estimator_loop(
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count);
 
+/* If the snapshot is complete, marks it as queued to the estimator worker */
+SUBOOL suscan_inspector_claim_estimator_snapshot(suscan_inspector_t *insp);
+
+/* Gives up a claimed snapshot, e.g. when it could not be queued */
+void suscan_inspector_drop_estimator_snapshot(suscan_inspector_t *insp);
+
+/* Feeds the last snapshot to the enabled estimators and sends their values */
+SUBOOL suscan_inspector_run_estimators(suscan_inspector_t *insp);
+
 SUSDIFF suscan_inspector_feed_bulk(
     suscan_inspector_t *insp,
     const SUCOMPLEX *x,
     int count);
 
+/* Memory held by all inspectors of this process */
+struct suscan_inspector_memory_stats {
+  SUSCOUNT inspectors;
+  SUSCOUNT object_bytes;
+  SUSCOUNT sampler_bytes;
+  SUSCOUNT pool_bytes;      /* Allocated by the buffer pool, cached included */
+  SUSCOUNT pool_free_bytes; /* Cached by the buffer pool, not in use */
+};
+
+void suscan_inspector_get_memory_stats(
+    struct suscan_inspector_memory_stats *stats);
+
 void suscan_inspector_notify_freq(
     suscan_inspector_t *insp,
     SUFLOAT prev_freq,
@@ -80,6 +80,13 @@ struct suscan_inspector_interface {
       const SUCOMPLEX *x,
       SUSCOUNT count);
 
+  /*
+   * Samples stopped and resumed (optional). Restart tracking loops from
+   * the current configuration, as they may have locked onto a signal
+   * that is no longer there.
+   */
+  void (*reset) (void *priv);
+
   /* Frequency was changed */
   void (*freq_changed) (
     void *priv,
@@ -0,0 +1,36 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "inspector-kernels"
+
+#include "kernels.h"
+
+SUPRIVATE SUBOOL g_reference = SU_FALSE;
+
+void
+suscan_inspector_kernels_set_reference(SUBOOL reference)
+{
+  g_reference = reference;
+}
+
+SUBOOL
+suscan_inspector_kernels_get_reference(void)
+{
+  return g_reference;
+}
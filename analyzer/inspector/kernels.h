@@ -0,0 +1,189 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _INSPECTOR_KERNELS_H
+#define _INSPECTOR_KERNELS_H
+
+#include <sigutils/sigutils.h>
+#include <sigutils/agc.h>
+#include <sigutils/iir.h>
+#include <sigutils/ncqo.h>
+#include <sigutils/clock.h>
+#include <sigutils/sampling.h>
+
+#include "params.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Block processing stages shared by the demodulating inspectors. Inspectors
+ * process their input in blocks of SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE
+ * samples, running each stage over the whole block before moving to the next
+ * one. Mode decisions are taken once per block, and the stages without a
+ * sample-to-sample dependency reduce to plain loops over arrays that the
+ * compiler can vectorize. Only the loops (AGC, Costas, clock recovery) remain
+ * serial.
+ *
+ * Every input sample produces at most one output symbol, so callers can bound
+ * the amount of input to the space left in the sampler buffer beforehand.
+ */
+
+#define SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE 512
+
+/*
+ * Reference mode: inspectors feed their stages one sample at a time and the
+ * local oscillator is read sample by sample, as the per-sample
+ * implementations did. Only meant to benchmark and check the block kernels.
+ */
+void suscan_inspector_kernels_set_reference(SUBOOL reference);
+SUBOOL suscan_inspector_kernels_get_reference(void);
+
+SUINLINE SUSCOUNT
+suscan_inspector_kernel_block_size(void)
+{
+  return suscan_inspector_kernels_get_reference()
+    ? 1
+    : SUSCAN_INSPECTOR_KERNEL_BLOCK_SIZE;
+}
+
+/* y = x * conj(lo) * phase, reading lo once per sample */
+SUINLINE void
+suscan_inspector_kernel_mix_reference(
+  su_ncqo_t *lo,
+  SUCOMPLEX phase,
+  const SUCOMPLEX *x,
+  SUCOMPLEX *y,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    y[i] = x[i] * SU_C_CONJ(su_ncqo_read(lo)) * phase;
+}
+
+/*
+ * y = x * conj(lo) * phase. The oscillator is evaluated once per block and
+ * rotated by a fixed step inside it, and its phase is advanced by the whole
+ * block afterwards. The rotation error is reset at every block.
+ */
+SUINLINE void
+suscan_inspector_kernel_mix(
+  su_ncqo_t *lo,
+  SUCOMPLEX phase,
+  const SUCOMPLEX *x,
+  SUCOMPLEX *y,
+  SUSCOUNT len)
+{
+  SUFLOAT phi, omega;
+  SUCOMPLEX z, step;
+  SUSCOUNT i;
+
+  if (suscan_inspector_kernels_get_reference()) {
+    suscan_inspector_kernel_mix_reference(lo, phase, x, y, len);
+    return;
+  }
+
+  phi   = su_ncqo_get_phase(lo);
+  omega = SU_NORM2ANG_FREQ(su_ncqo_get_freq(lo));
+  z     = SU_C_EXP(-I * phi) * phase;
+
+  if (omega == 0) {
+    for (i = 0; i < len; ++i)
+      y[i] = x[i] * z;
+  } else {
+    step = SU_C_EXP(-I * omega);
+
+    for (i = 0; i < len; ++i) {
+      y[i] = x[i] * z;
+      z   *= step;
+    }
+
+    phi += omega * len;
+    phi -= 2 * PI * SU_FLOOR(phi / (2 * PI));
+    su_ncqo_set_phase(lo, phi);
+  }
+}
+
+/* In place. Gains are doubled, as in the per-sample implementations */
+SUINLINE void
+suscan_inspector_kernel_gain(
+  enum suscan_inspector_gain_control ctrl,
+  su_agc_t *agc,
+  SUFLOAT gain,
+  SUCOMPLEX *x,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (ctrl == SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL) {
+    gain *= 2;
+    for (i = 0; i < len; ++i)
+      x[i] *= gain;
+  } else {
+    for (i = 0; i < len; ++i)
+      x[i] = 2 * su_agc_feed(agc, x[i]);
+  }
+}
+
+SUINLINE void
+suscan_inspector_kernel_scale(SUCOMPLEX k, SUCOMPLEX *x, SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    x[i] *= k;
+}
+
+/* Symbols are written to y. Returns the number of symbols. */
+SUINLINE SUSCOUNT
+suscan_inspector_kernel_sample(
+  enum suscan_inspector_baudrate_control ctrl,
+  su_sampler_t *sampler,
+  su_clock_detector_t *cd,
+  const SUCOMPLEX *x,
+  SUCOMPLEX *y,
+  SUSCOUNT len)
+{
+  SUSCOUNT i, n = 0;
+  SUCOMPLEX output;
+
+  if (ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+    for (i = 0; i < len; ++i) {
+      output = x[i];
+      if (su_sampler_feed(sampler, &output))
+        y[n++] = output;
+    }
+  } else {
+    for (i = 0; i < len; ++i) {
+      su_clock_detector_feed(cd, x[i]);
+      if (su_clock_detector_read(cd, y + n, 1) == 1)
+        ++n;
+    }
+  }
+
+  return n;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _INSPECTOR_KERNELS_H */
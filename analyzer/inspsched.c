@@ -17,15 +17,21 @@
 
 */
 
+#define _GNU_SOURCE
+
 #define SU_LOG_DOMAIN "inspsched"
 
 #include <sigutils/log.h>
 #include <sigutils/util/compat-unistd.h>
+#include <sched.h>
+#include <string.h>
 
 #include "inspsched.h"
 
 #include <compat.h>
 #include "msg.h"
+#include "spectsrc.h"
+#include "fftcache.h"
 
 /*************************** Task Info API ***************************/
 SUPRIVATE struct suscan_inspector_task_info *
@@ -128,15 +134,280 @@ done:
 
 
 /****************************** Inspsched API ****************************/
+SUPRIVATE SUBOOL suscan_inpsched_task_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private);
+
 SUPRIVATE SUBOOL
-suscan_inpsched_task_cb(
+suscan_inspsched_queue_estimation(
+  suscan_inspsched_t *self,
+  suscan_inspector_t *insp)
+{
+  struct suscan_inspector_task_info *info = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(info = suscan_inspsched_acquire_task_info(self, insp));
+
+  info->type      = SUSCAN_INSPECTOR_TASK_INFO_TYPE_ESTIMATE;
+  info->inspector = insp;
+
+  SU_TRY(
+    suscan_worker_push(
+      self->estimator_worker,
+      suscan_inpsched_task_cb,
+      info));
+  info = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (info != NULL)
+    suscan_inspsched_return_task_info(self, info);
+
+  /* Drop this snapshot, a new one will be taken */
+  if (!ok)
+    suscan_inspector_drop_estimator_snapshot(insp);
+
+  return ok;
+}
+
+/*
+ * Spectrum frames are transformed in the spectrum worker. Frames queued
+ * before it gets to run are transformed together, grouped by FFT size, in
+ * batches of up to SUSCAN_INSPSCHED_SPECTRUM_BATCH_MAX transforms.
+ */
+SUPRIVATE SU_FFTW(_plan)
+suscan_inspsched_get_batch_plan(
+  suscan_inspsched_t *self,
+  SUSCOUNT size,
+  unsigned int howmany)
+{
+  struct suscan_inspsched_batch_plan *entry = NULL;
+  unsigned int i;
+
+  for (i = 0; i < self->spectrum_plan_count; ++i)
+    if (self->spectrum_plan_list[i]->size == size
+      && self->spectrum_plan_list[i]->howmany == howmany)
+      return self->spectrum_plan_list[i]->plan;
+
+  SU_ALLOCATE_FAIL(entry, struct suscan_inspsched_batch_plan);
+
+  entry->size    = size;
+  entry->howmany = howmany;
+
+  SU_TRY_FAIL(
+    entry->plan = suscan_fft_cache_acquire_batch_plan(
+      size,
+      howmany,
+      FFTW_FORWARD));
+
+  SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(self->spectrum_plan, entry));
+
+  return entry->plan;
+
+fail:
+  if (entry != NULL) {
+    if (entry->plan != NULL)
+      suscan_fft_cache_release_plan(entry->plan);
+    free(entry);
+  }
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspsched_ensure_spectrum_buf(suscan_inspsched_t *self, SUSCOUNT size)
+{
+  SU_FFTW(_complex) *buf;
+
+  if (self->spectrum_buf_size >= size)
+    return SU_TRUE;
+
+  SU_TRY(buf = SU_FFTW(_malloc)(size * sizeof(SU_FFTW(_complex))));
+
+  if (self->spectrum_buf != NULL)
+    SU_FFTW(_free)(self->spectrum_buf);
+
+  self->spectrum_buf      = buf;
+  self->spectrum_buf_size = size;
+
+  return SU_TRUE;
+
+done:
+  return SU_FALSE;
+}
+
+/* All tasks share the FFT size, count is a power of two */
+SUPRIVATE void
+suscan_inspsched_run_spectrum_batch(
+  suscan_inspsched_t *self,
+  struct suscan_inspector_task_info **tasks,
+  unsigned int count)
+{
+  struct suscan_spectsrc *src;
+  SUSCOUNT size = suscan_spectsrc_get_fft_size(tasks[0]->spectrum.src);
+  SUCOMPLEX *buf;
+  SU_FFTW(_plan) plan;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscan_inspsched_ensure_spectrum_buf(self, count * size));
+  SU_TRY(plan = suscan_inspsched_get_batch_plan(self, size, count));
+
+  buf = (SUCOMPLEX *) self->spectrum_buf;
+
+  for (i = 0; i < count; ++i)
+    memcpy(
+      buf + i * size,
+      suscan_spectsrc_get_frame(tasks[i]->spectrum.src),
+      size * sizeof(SUCOMPLEX));
+
+  SU_FFTW(_execute_dft)(plan, self->spectrum_buf, self->spectrum_buf);
+
+  for (i = 0; i < count; ++i)
+    if (!suscan_spectsrc_deliver_psd(tasks[i]->spectrum.src, buf + i * size))
+      tasks[i]->inspector->state = SUSCAN_ASYNC_STATE_HALTING;
+
+  ok = SU_TRUE;
+
+done:
+  for (i = 0; i < count; ++i) {
+    /* Frames could not be transformed: drop them */
+    if (!ok) {
+      src = tasks[i]->spectrum.src;
+      src->frame_state = SUSCAN_SPECTSRC_FRAME_STATE_IDLE;
+    }
+
+    suscan_inspsched_return_task_info(self, tasks[i]);
+  }
+}
+
+SUPRIVATE int
+suscan_inspsched_spectrum_task_cmp(const void *a, const void *b)
+{
+  const struct suscan_inspector_task_info *ta =
+    *(const struct suscan_inspector_task_info **) a;
+  const struct suscan_inspector_task_info *tb =
+    *(const struct suscan_inspector_task_info **) b;
+  SUSCOUNT sa = suscan_spectsrc_get_fft_size(ta->spectrum.src);
+  SUSCOUNT sb = suscan_spectsrc_get_fft_size(tb->spectrum.src);
+
+  return (sa > sb) - (sa < sb);
+}
+
+SUPRIVATE SUBOOL
+suscan_inspsched_spectrum_cb(
     struct suscan_mq *mq_out,
     void *wk_private,
     void *cb_private)
 {
-  suscan_inspsched_t *sched = (suscan_inspsched_t *) wk_private;
-  struct suscan_inspector_task_info *task_info =
-      (struct suscan_inspector_task_info *) cb_private;
+  suscan_inspsched_t *self = (suscan_inspsched_t *) wk_private;
+  PTR_LIST_LOCAL(struct suscan_inspector_task_info, task);
+  unsigned int i, j, run, count;
+  SUSCOUNT size;
+
+  /* Take all pending frames */
+  if (pthread_mutex_lock(&self->spectrum_mutex) != 0)
+    return SU_FALSE;
+  task_list  = self->spectrum_task_list;
+  task_count = self->spectrum_task_count;
+  self->spectrum_task_list  = NULL;
+  self->spectrum_task_count = 0;
+  (void) pthread_mutex_unlock(&self->spectrum_mutex);
+
+  qsort(
+    task_list,
+    task_count,
+    sizeof(struct suscan_inspector_task_info *),
+    suscan_inspsched_spectrum_task_cmp);
+
+  i = 0;
+  while (i < task_count) {
+    size = suscan_spectsrc_get_fft_size(task_list[i]->spectrum.src);
+
+    for (j = i + 1; j < task_count; ++j)
+      if (suscan_spectsrc_get_fft_size(task_list[j]->spectrum.src) != size)
+        break;
+
+    run = j - i;
+
+    while (run > 0) {
+      count = SUSCAN_INSPSCHED_SPECTRUM_BATCH_MAX;
+      while (count > run)
+        count >>= 1;
+
+      suscan_inspsched_run_spectrum_batch(self, task_list + i, count);
+
+      i   += count;
+      run -= count;
+    }
+  }
+
+  if (task_list != NULL)
+    free(task_list);
+
+  return SU_FALSE;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspsched_queue_spectrum(
+  suscan_inspsched_t *self,
+  suscan_inspector_t *insp,
+  suscan_spectsrc_t *src)
+{
+  struct suscan_inspector_task_info *info = NULL;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL first = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  src->frame_state = SUSCAN_SPECTSRC_FRAME_STATE_QUEUED;
+
+  SU_TRY(info = suscan_inspsched_acquire_task_info(self, insp));
+
+  info->type         = SUSCAN_INSPECTOR_TASK_INFO_TYPE_SPECTRUM;
+  info->inspector    = insp;
+  info->spectrum.src = src;
+
+  SU_TRY(pthread_mutex_lock(&self->spectrum_mutex) == 0);
+  mutex_acquired = SU_TRUE;
+
+  SU_TRYC(PTR_LIST_APPEND_CHECK(self->spectrum_task, info));
+  info = NULL;
+
+  /* Frames queued before the worker runs join this batch */
+  first = self->spectrum_task_count == 1;
+
+  (void) pthread_mutex_unlock(&self->spectrum_mutex);
+  mutex_acquired = SU_FALSE;
+
+  if (first)
+    SU_TRY(
+      suscan_worker_push(
+        self->spectrum_worker,
+        suscan_inspsched_spectrum_cb,
+        NULL));
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->spectrum_mutex);
+
+  if (info != NULL) {
+    suscan_inspsched_return_task_info(self, info);
+    src->frame_state = SUSCAN_SPECTSRC_FRAME_STATE_IDLE;
+  }
+
+  return ok;
+}
+
+SUPRIVATE void
+suscan_inspsched_run_task(
+    suscan_inspsched_t *sched,
+    struct suscan_inspector_task_info *task_info)
+{
+  suscan_spectsrc_t *src;
   SUBOOL ok = SU_FALSE;
 
   switch (task_info->type) {
@@ -149,7 +420,15 @@ suscan_inpsched_task_cb(
               task_info->samples.size),
           goto fail);
 
-      /* Feed spectrum */
+      if (suscan_inspector_claim_estimator_snapshot(task_info->inspector))
+        SU_TRYCATCH(
+            suscan_inspsched_queue_estimation(sched, task_info->inspector),
+            goto fail);
+
+      /* Feed spectrum. Frames are transformed by the spectrum worker. */
+      if ((src = suscan_inspector_get_spectsrc(task_info->inspector)) != NULL)
+        suscan_spectsrc_set_deferred(src, SU_TRUE);
+
       SU_TRYCATCH(
           suscan_inspector_spectrum_loop(
               task_info->inspector,
@@ -157,6 +436,11 @@ suscan_inpsched_task_cb(
               task_info->samples.size),
           goto fail);
 
+      if (src != NULL && suscan_spectsrc_frame_ready(src))
+        SU_TRYCATCH(
+            suscan_inspsched_queue_spectrum(sched, task_info->inspector, src),
+            goto fail);
+
       /*
       * We just process the incoming data. If we broke something,
       * mark the inspector as halted.
@@ -175,6 +459,16 @@ suscan_inpsched_task_cb(
         task_info->new_freq.old_f0,
         task_info->new_freq.new_f0);
       break;
+
+    case SUSCAN_INSPECTOR_TASK_INFO_TYPE_ESTIMATE:
+      SU_TRYCATCH(
+          suscan_inspector_run_estimators(task_info->inspector),
+          goto fail);
+      break;
+
+    case SUSCAN_INSPECTOR_TASK_INFO_TYPE_SPECTRUM:
+      /* Never queued here, see suscan_inspsched_queue_spectrum */
+      break;
   }
 
   ok = SU_TRUE;
@@ -184,6 +478,35 @@ fail:
     task_info->inspector->state = SUSCAN_ASYNC_STATE_HALTING;
 
   suscan_inspsched_return_task_info(sched, task_info);
+}
+
+SUPRIVATE SUBOOL
+suscan_inpsched_task_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_inspsched_t *sched = (suscan_inspsched_t *) wk_private;
+  struct suscan_inspector_task_info *task_info =
+      (struct suscan_inspector_task_info *) cb_private;
+
+  suscan_inspsched_run_task(sched, task_info);
+
+  return SU_FALSE;
+}
+
+SUPRIVATE SUBOOL
+suscan_inpsched_batch_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  struct suscan_inspsched_task_batch *batch =
+      (struct suscan_inspsched_task_batch *) cb_private;
+  unsigned int i;
+
+  for (i = 0; i < batch->task_count; ++i)
+    suscan_inspsched_run_task(batch->sched, batch->task_list[i]);
 
   return SU_FALSE;
 }
@@ -232,10 +555,77 @@ suscan_inspsched_queue_task(
   return SU_TRUE;
 }
 
+SUBOOL
+suscan_inspsched_defer_task(
+    suscan_inspsched_t *sched,
+    struct suscan_inspector_task_info *task_info)
+{
+  struct suscan_inspector_task_info **tmp;
+  unsigned int alloc;
+
+  if (sched->deferred_count == sched->deferred_alloc) {
+    alloc = sched->deferred_alloc == 0 ? 64 : 2 * sched->deferred_alloc;
+
+    SU_TRYCATCH(
+        tmp = realloc(
+          sched->deferred_list,
+          alloc * sizeof(struct suscan_inspector_task_info *)),
+        return SU_FALSE);
+
+    sched->deferred_list  = tmp;
+    sched->deferred_alloc = alloc;
+  }
+
+  sched->deferred_list[sched->deferred_count++] = task_info;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspsched_flush_deferred(suscan_inspsched_t *sched)
+{
+  unsigned int i, per_worker, offset = 0;
+  struct suscan_inspsched_task_batch *batch;
+
+  if (sched->deferred_count == 0)
+    return SU_TRUE;
+
+  per_worker =
+    (sched->deferred_count + sched->worker_count - 1) / sched->worker_count;
+
+  for (i = 0; i < sched->worker_count && offset < sched->deferred_count; ++i) {
+    batch = sched->batch_list + i;
+
+    batch->task_list  = sched->deferred_list + offset;
+    batch->task_count = SU_MIN(per_worker, sched->deferred_count - offset);
+    offset += batch->task_count;
+
+    SU_TRYCATCH(
+        suscan_worker_push(
+            sched->worker_list[i],
+            suscan_inpsched_batch_cb,
+            batch),
+        goto fail);
+  }
+
+  return SU_TRUE;
+
+fail:
+  /* Tasks from this batch on will never run, give them back to the pool */
+  for (offset -= batch->task_count; offset < sched->deferred_count; ++offset)
+    suscan_inspsched_return_task_info(sched, sched->deferred_list[offset]);
+
+  return SU_FALSE;
+}
+
 SUBOOL
 suscan_inspsched_sync(suscan_inspsched_t *sched)
 {
   unsigned int i;
+  SUBOOL ok;
+
+  /* Deferred tasks go before the barriers */
+  ok = suscan_inspsched_flush_deferred(sched);
 
   /* Queue barriers */
   for (i = 0; i < sched->worker_count; ++i)
@@ -249,10 +639,32 @@ suscan_inspsched_sync(suscan_inspsched_t *sched)
   /* Wait for all threads */
   pthread_barrier_wait(&sched->barrier);
 
+  /* Batches already processed, task infos are back in the free list */
+  sched->deferred_count = 0;
+
   /* Reset date */
   sched->have_time = SU_FALSE;
 
-  return SU_TRUE;
+  return ok;
+}
+
+/*
+ * Estimations are not time-critical: let them use the CPU time left by
+ * the rest of the analyzer.
+ */
+SUPRIVATE void
+suscan_inspsched_lower_priority(suscan_worker_t *worker)
+{
+#ifdef SCHED_IDLE
+  struct sched_param param;
+
+  memset(&param, 0, sizeof(struct sched_param));
+
+  if (pthread_setschedparam(worker->thread, SCHED_IDLE, &param) != 0)
+    SU_WARNING("Cannot lower priority of the estimator worker\n");
+#else
+  (void) worker;
+#endif /* SCHED_IDLE */
 }
 
 SUBOOL
@@ -271,9 +683,47 @@ suscan_inspsched_destroy(suscan_inspsched_t *self)
       return SU_FALSE;
     }
 
+  /* Estimations left in its queue are in the alloc list */
+  if (self->estimator_worker != NULL)
+    if (!suscan_analyzer_halt_worker(self->estimator_worker)) {
+      SU_ERROR("Fatal error while halting estimator worker\n");
+      return SU_FALSE;
+    }
+
+  /* Same for spectrum frames */
+  if (self->spectrum_worker != NULL)
+    if (!suscan_analyzer_halt_worker(self->spectrum_worker)) {
+      SU_ERROR("Fatal error while halting spectrum worker\n");
+      return SU_FALSE;
+    }
+
+  if (self->spectrum_task_list != NULL)
+    free(self->spectrum_task_list);
+
+  for (i = 0; i < self->spectrum_plan_count; ++i) {
+    suscan_fft_cache_release_plan(self->spectrum_plan_list[i]->plan);
+    free(self->spectrum_plan_list[i]);
+  }
+
+  if (self->spectrum_plan_list != NULL)
+    free(self->spectrum_plan_list);
+
+  if (self->spectrum_buf != NULL)
+    SU_FFTW(_free)(self->spectrum_buf);
+
+  if (self->spectrum_mutex_init)
+    pthread_mutex_destroy(&self->spectrum_mutex);
+
   if (self->worker_list != NULL)
     free(self->worker_list);
 
+  /* Deferred task infos are in the alloc list too */
+  if (self->deferred_list != NULL)
+    free(self->deferred_list);
+
+  if (self->batch_list != NULL)
+    free(self->batch_list);
+
   /*
    * All workers halted, source worker must be finished by now
    * it is safe to go on with the object destruction. We basically
@@ -329,6 +779,26 @@ suscan_inspsched_new(struct suscan_mq *ctl_mq)
     worker = NULL;
   }
 
+  SU_TRYCATCH(
+    new->estimator_worker = suscan_worker_new_ex(
+      "inspsched-estimator",
+      &new->mq_out,
+      new),
+    goto fail);
+  suscan_inspsched_lower_priority(new->estimator_worker);
+
+  SU_TRYCATCH(
+    pthread_mutex_init(&new->spectrum_mutex, NULL) == 0,
+    goto fail);
+  new->spectrum_mutex_init = SU_TRUE;
+
+  SU_TRYCATCH(
+    new->spectrum_worker = suscan_worker_new_ex(
+      "inspsched-spectrum",
+      &new->mq_out,
+      new),
+    goto fail);
+
   SU_TRYCATCH(
     pthread_mutex_init(&new->task_mutex, NULL) == 0,
     goto fail);
@@ -339,6 +809,15 @@ suscan_inspsched_new(struct suscan_mq *ctl_mq)
     goto fail);
   new->barrier_init = SU_TRUE;
 
+  SU_TRYCATCH(
+    new->batch_list = calloc(
+      new->worker_count,
+      sizeof(struct suscan_inspsched_task_batch)),
+    goto fail);
+
+  for (i = 0; i < new->worker_count; ++i)
+    new->batch_list[i].sched = new;
+
   return new;
 
 fail:
@@ -29,13 +29,18 @@
 #include "worker.h"
 #include "list.h"
 
+#define SUSCAN_INSPSCHED_SPECTRUM_BATCH_MAX 16 /* Power of two */
+
 struct suscan_inspector;
 struct suscan_inspsched;
+struct suscan_spectsrc;
 struct suscan_inspector_factory;
 
 enum suscan_inspector_task_info_type {
   SUSCAN_INSPECTOR_TASK_INFO_TYPE_SAMPLES,
-  SUSCAN_INSPECTOR_TASK_INFO_TYPE_NEW_FREQ
+  SUSCAN_INSPECTOR_TASK_INFO_TYPE_NEW_FREQ,
+  SUSCAN_INSPECTOR_TASK_INFO_TYPE_ESTIMATE,
+  SUSCAN_INSPECTOR_TASK_INFO_TYPE_SPECTRUM
 };
 
 struct suscan_inspector_task_info {
@@ -54,10 +59,26 @@ struct suscan_inspector_task_info {
     SUFREQ old_f0;
     SUFREQ new_f0;
   } new_freq;
+
+  struct {
+    struct suscan_spectsrc *src;
+  } spectrum;
 };
 
 struct suscan_local_analyzer;
 
+struct suscan_inspsched_task_batch {
+  struct suscan_inspsched            *sched;
+  struct suscan_inspector_task_info **task_list;
+  unsigned int                        task_count;
+};
+
+struct suscan_inspsched_batch_plan {
+  SUSCOUNT       size;
+  unsigned int   howmany;
+  SU_FFTW(_plan) plan;
+};
+
 struct suscan_inspsched {
   struct suscan_mq *ctl_mq;
 
@@ -76,6 +97,24 @@ struct suscan_inspsched {
   unsigned int last_worker; /* Used as rotatory index */
   pthread_barrier_t  barrier; /* Inspector barrier */
   SUBOOL barrier_init;
+
+  /* Deferred tasks, split among workers on the next sync */
+  struct suscan_inspector_task_info **deferred_list;
+  unsigned int                        deferred_count;
+  unsigned int                        deferred_alloc;
+  struct suscan_inspsched_task_batch *batch_list; /* One per worker */
+
+  /* Low-priority worker for estimator snapshots */
+  suscan_worker_t *estimator_worker;
+
+  /* Spectrum worker: transforms spectrum source frames in batches */
+  suscan_worker_t   *spectrum_worker;
+  pthread_mutex_t    spectrum_mutex;
+  SUBOOL             spectrum_mutex_init;
+  PTR_LIST(struct suscan_inspector_task_info, spectrum_task);
+  PTR_LIST(struct suscan_inspsched_batch_plan, spectrum_plan);
+  SU_FFTW(_complex) *spectrum_buf;
+  SUSCOUNT           spectrum_buf_size;
 };
 
 typedef struct suscan_inspsched suscan_inspsched_t;
@@ -98,6 +137,17 @@ SUBOOL suscan_inspsched_queue_task(
     suscan_inspsched_t *sched,
     struct suscan_inspector_task_info *task_info);
 
+/*
+ * Deferred tasks are not queued one by one. Instead, they are split among
+ * the workers in a few batches when the scheduler is synchronized. Meant
+ * for tasks too small to be worth a queue message each (e.g. a handful of
+ * bins of a frequency-domain inspector). Must be called from the same
+ * thread that calls suscan_inspsched_sync.
+ */
+SUBOOL suscan_inspsched_defer_task(
+    suscan_inspsched_t *sched,
+    struct suscan_inspector_task_info *task_info);
+
 SUBOOL suscan_inspsched_sync(suscan_inspsched_t *sched);
 
 /*
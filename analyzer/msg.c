@@ -651,6 +651,56 @@ suscan_analyzer_inspector_msg_deserialize_set_watermark(
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_serialize_set_paused(
+    grow_buf_t *buffer,
+    const struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(bool, self->paused);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_deserialize_set_paused(
+    grow_buf_t *buffer,
+    struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(bool, self->paused);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_serialize_set_squelch(
+    grow_buf_t *buffer,
+    const struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(bool,  self->squelch_enabled);
+  SUSCAN_PACK(float, self->squelch_level);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_deserialize_set_squelch(
+    grow_buf_t *buffer,
+    struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(bool,  self->squelch_enabled);
+  SUSCAN_UNPACK(float, self->squelch_level);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
 SUPRIVATE SUBOOL
 suscan_analyzer_inspector_msg_serialize_set_tle(
     grow_buf_t *buffer,
@@ -843,6 +893,18 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
           suscan_analyzer_inspector_msg_serialize_set_tle(buffer, self),
           goto fail);
       break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_PAUSED:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_serialize_set_paused(buffer, self),
+          goto fail);
+      break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_SQUELCH:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_serialize_set_squelch(buffer, self),
+          goto fail);
+      break;
     
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT:
       SU_TRYCATCH(
@@ -942,6 +1004,18 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
           suscan_analyzer_inspector_msg_deserialize_set_tle(buffer, self),
           goto fail);
       break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_PAUSED:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_deserialize_set_paused(buffer, self),
+          goto fail);
+      break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_SQUELCH:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_deserialize_set_squelch(buffer, self),
+          goto fail);
+      break;
     
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT:
       SU_TRYCATCH(
@@ -1215,6 +1289,96 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_replay_msg)
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+/************************** Overview tile message *****************************/
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_overview_msg)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(uint,  self->req_id);
+  SUSCAN_PACK(int,   self->status);
+  SUSCAN_PACK(uint,  self->level);
+  SUSCAN_PACK(uint,  self->levels);
+  SUSCAN_PACK(uint,  self->first_row);
+  SUSCAN_PACK(uint,  self->row_count);
+  SUSCAN_PACK(uint,  self->rows);
+  SUSCAN_PACK(uint,  self->row_samples);
+  SUSCAN_PACK(uint,  self->bins);
+  SUSCAN_PACK(float, self->samp_rate);
+  SUSCAN_PACK(uint,  self->start.tv_sec);
+  SUSCAN_PACK(uint,  self->start.tv_usec);
+
+  SU_TRYCATCH(
+      suscan_pack_compact_float_array(
+          buffer,
+          self->data,
+          self->data_size),
+      goto fail);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_overview_msg)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+  uint64_t tv_sec = 0;
+  uint32_t tv_usec = 0;
+
+  SUSCAN_UNPACK(uint32, self->req_id);
+  SUSCAN_UNPACK(int32,  self->status);
+  SUSCAN_UNPACK(uint32, self->level);
+  SUSCAN_UNPACK(uint32, self->levels);
+  SUSCAN_UNPACK(uint64, self->first_row);
+  SUSCAN_UNPACK(uint64, self->row_count);
+  SUSCAN_UNPACK(uint64, self->rows);
+  SUSCAN_UNPACK(uint64, self->row_samples);
+  SUSCAN_UNPACK(uint32, self->bins);
+  SUSCAN_UNPACK(float,  self->samp_rate);
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+
+  self->start.tv_sec  = tv_sec;
+  self->start.tv_usec = tv_usec;
+
+  SU_TRYCATCH(
+      suscan_unpack_compact_float_array(
+          buffer,
+          &self->data,
+          &self->data_size),
+      goto fail);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+struct suscan_analyzer_overview_msg *
+suscan_analyzer_overview_msg_new(
+    unsigned int level,
+    SUSCOUNT first_row,
+    SUSCOUNT row_count,
+    uint32_t req_id)
+{
+  struct suscan_analyzer_overview_msg *new = NULL;
+
+  SU_TRYCATCH(
+      new = calloc(1, sizeof(struct suscan_analyzer_overview_msg)),
+      return NULL);
+
+  new->level     = level;
+  new->first_row = first_row;
+  new->row_count = row_count;
+  new->req_id    = req_id;
+
+  return new;
+}
+
+void
+suscan_analyzer_overview_msg_destroy(struct suscan_analyzer_overview_msg *msg)
+{
+  if (msg->data != NULL)
+    free(msg->data);
+
+  free(msg);
+}
+
 /*********************** Generic message serialization ************************/
 SUBOOL
 suscan_analyzer_msg_serialize(
@@ -1275,6 +1439,10 @@ suscan_analyzer_msg_serialize(
     case SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY:
       SU_TRY_FAIL(suscan_analyzer_replay_msg_serialize(ptr, buffer));
       break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW:
+      SU_TRY_FAIL(suscan_analyzer_overview_msg_serialize(ptr, buffer));
+      break;
     
   }
 
@@ -1360,6 +1528,11 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
       SU_TRY_FAIL(suscan_analyzer_replay_msg_deserialize(msgptr, buffer));
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW:
+      SU_TRY_FAIL(msgptr = suscan_analyzer_overview_msg_new(0, 0, 0, 0));
+      SU_TRY_FAIL(suscan_analyzer_overview_msg_deserialize(msgptr, buffer));
+      break;
+
     default:
       SU_WARNING("Unknown message type `%d'\n", *type);
       goto fail;
@@ -1408,6 +1581,10 @@ suscan_analyzer_dispose_message(uint32_t type, void *ptr)
       suscan_analyzer_sample_batch_msg_destroy(ptr);
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW:
+      suscan_analyzer_overview_msg_destroy(ptr);
+      break;
+
     case SUSCAN_ANALYZER_MESSAGE_TYPE_PARAMS:
     case SUSCAN_ANALYZER_MESSAGE_TYPE_THROTTLE:
       free(ptr);
@@ -48,6 +48,7 @@ extern "C" {
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_SEEK          0xd
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_HISTORY_SIZE  0xe
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY        0xf
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW      0x10 /* Overview tile */
 
 /* Invalid message. No one should even send this. */
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_INVALID       0x8000000
@@ -101,6 +102,29 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_replay_msg) {
   SUBOOL replay;
 };
 
+#define SUSCAN_ANALYZER_OVERVIEW_MAX_ROWS 1024
+
+/*
+ * Overview tile. Requests only fill level, first_row and row_count, and
+ * are answered with a message of the same type holding up to row_count rows
+ * of bins elements each, or with status != 0 if no overview is available.
+ */
+SUSCAN_SERIALIZABLE(suscan_analyzer_overview_msg) {
+  uint32_t req_id;
+  int32_t  status;
+  uint32_t level;
+  uint32_t levels;
+  uint64_t first_row;
+  uint64_t row_count;
+  uint64_t rows;         /* Total rows in this level */
+  uint64_t row_samples;  /* Samples per row in this level */
+  uint32_t bins;
+  SUFLOAT  samp_rate;
+  struct timeval start;  /* Timestamp of the first sample of the capture */
+  SUFLOAT *data;         /* row_count x bins */
+  SUSCOUNT data_size;
+};
+
 
 /* Channel spectrum message */
 SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
@@ -153,6 +177,8 @@ enum suscan_analyzer_inspector_msgkind {
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CORRECTION,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL,
+  SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_PAUSED,
+  SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_SQUELCH,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_COUNT
 };
 
@@ -185,6 +211,8 @@ suscan_analyzer_inspector_msgkind_to_string(
     SUSCAN_COMP_MSGKIND(ORBIT_REPORT);
     SUSCAN_COMP_MSGKIND(INVALID_CORRECTION);
     SUSCAN_COMP_MSGKIND(SIGNAL);
+    SUSCAN_COMP_MSGKIND(SET_PAUSED);
+    SUSCAN_COMP_MSGKIND(SET_SQUELCH);
 
     default:
       return "UNKNOWN";
@@ -210,6 +238,7 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_inspector_msg) {
       struct sigutils_channel channel;
       suscan_config_t *config;
       SUBOOL precise;
+      uint32_t stream; /* Source channel. Local analyzers only */
       uint32_t fs;  /* Baseband rate */
       SUFLOAT equiv_fs; /* Channel rate */
       SUFLOAT bandwidth;
@@ -243,9 +272,15 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_inspector_msg) {
       SUDOUBLE signal_value;
     };
     
+    struct {
+      SUBOOL  squelch_enabled;
+      SUFLOAT squelch_level; /* dB */
+    };
+
     struct suscan_orbit_report orbit_report;
 
     SUSCOUNT watermark;
+    SUBOOL   paused;
   };
 };
 
@@ -334,6 +369,16 @@ struct suscan_analyzer_sample_batch_msg *suscan_analyzer_sample_batch_msg_new(
 void suscan_analyzer_sample_batch_msg_destroy(
     struct suscan_analyzer_sample_batch_msg *msg);
 
+/* Overview tile message */
+struct suscan_analyzer_overview_msg *suscan_analyzer_overview_msg_new(
+    unsigned int level,
+    SUSCOUNT first_row,
+    SUSCOUNT row_count,
+    uint32_t req_id);
+
+void suscan_analyzer_overview_msg_destroy(
+    struct suscan_analyzer_overview_msg *msg);
+
 /* Generic serializer / deserializer */
 SUBOOL
 suscan_analyzer_msg_serialize(
@@ -0,0 +1,369 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "pfb"
+
+#include <sigutils/log.h>
+#include <sigutils/taps.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pfb.h"
+#include "fftcache.h"
+
+/*
+ * Windowed sinc with its -6 dB point at one raster spacing. With 2x
+ * oversampled outputs, the passband (half a spacing) is flat and whatever
+ * could alias onto it (one and a half spacings away) falls in the stopband.
+ * The transition band, which overlaps the neighbouring channels, is left to
+ * the channel filters.
+ */
+SUPRIVATE void
+suscan_pfb_init_prototype(SUFLOAT *h, SUSCOUNT taps, unsigned int branches)
+{
+  SUSCOUNT i;
+  SUFLOAT t, fc = 1. / branches;
+  SUFLOAT sum = 0;
+
+  for (i = 0; i < taps; ++i) {
+    t = i - .5 * (taps - 1);
+    h[i] = t == 0 ? 2 * fc : SU_SIN(2 * PI * fc * t) / (PI * t);
+  }
+
+  su_taps_apply_blackmann_harris(h, taps);
+
+  for (i = 0; i < taps; ++i)
+    sum += h[i];
+
+  /* Unity gain at bin centers */
+  for (i = 0; i < taps; ++i)
+    h[i] /= sum;
+}
+
+SU_INSTANCER(suscan_pfb, const struct suscan_pfb_params *params)
+{
+  suscan_pfb_t *new = NULL;
+
+  if (params->branches < 2 || (params->branches & 1)) {
+    SU_ERROR("Invalid number of branches (%d)\n", params->branches);
+    goto fail;
+  }
+
+  if (params->taps_per_branch < 1) {
+    SU_ERROR("Invalid number of taps per branch\n");
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, suscan_pfb_t);
+
+  new->params     = *params;
+  new->decimation = params->branches >> 1;
+  new->taps       = params->branches * params->taps_per_branch;
+
+  SU_ALLOCATE_MANY_FAIL(new->h, new->taps, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->history, 2 * new->taps, SUCOMPLEX);
+
+  suscan_pfb_init_prototype(new->h, new->taps, params->branches);
+
+  SU_TRY_FAIL(
+    new->fft = SU_FFTW(_malloc)(
+      params->branches * sizeof(SU_FFTW(_complex))));
+
+  SU_TRY_FAIL(
+    new->plan = suscan_fft_cache_acquire_plan(
+      params->branches,
+      FFTW_FORWARD,
+      SU_TRUE));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_pfb_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_pfb_channel_destroy(suscan_pfb_channel_t *self)
+{
+  if (self->buffer != NULL)
+    free(self->buffer);
+
+  if (self->lpf_init)
+    su_iir_filt_finalize(&self->lpf);
+
+  free(self);
+}
+
+SU_COLLECTOR(suscan_pfb)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->channel_count; ++i)
+    if (self->channel_list[i] != NULL)
+      suscan_pfb_channel_destroy(self->channel_list[i]);
+
+  if (self->channel_list != NULL)
+    free(self->channel_list);
+
+  if (self->plan != NULL)
+    suscan_fft_cache_release_plan(self->plan);
+
+  if (self->fft != NULL)
+    SU_FFTW(_free)(self->fft);
+
+  if (self->history != NULL)
+    free(self->history);
+
+  if (self->h != NULL)
+    free(self->h);
+
+  free(self);
+}
+
+SU_METHOD(
+  suscan_pfb,
+  suscan_pfb_channel_t *,
+  open_channel,
+  unsigned int bin,
+  suscan_pfb_channel_data_func_t on_data,
+  void *privdata)
+{
+  suscan_pfb_channel_t *new = NULL;
+  unsigned int i;
+
+  if (bin >= self->params.branches) {
+    SU_ERROR("Raster bin %d out of range\n", bin);
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, suscan_pfb_channel_t);
+
+  new->parent   = self;
+  new->bin      = bin;
+  new->on_data  = on_data;
+  new->privdata = privdata;
+
+  su_ncqo_init(&new->lo, 0);
+
+  /* Reuse free slots */
+  for (i = 0; i < self->channel_count; ++i)
+    if (self->channel_list[i] == NULL)
+      break;
+
+  if (i < self->channel_count) {
+    self->channel_list[i] = new;
+    new->index = i;
+  } else {
+    SU_TRYC_FAIL(new->index = PTR_LIST_APPEND_CHECK(self->channel, new));
+  }
+
+  ++self->open_count;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_pfb_channel_destroy(new);
+
+  return NULL;
+}
+
+SU_METHOD(suscan_pfb, SUBOOL, close_channel, suscan_pfb_channel_t *channel)
+{
+  if (channel->parent != self
+    || channel->index < 0
+    || channel->index >= self->channel_count
+    || self->channel_list[channel->index] != channel) {
+    SU_ERROR("Channel does not belong to this channelizer\n");
+    return SU_FALSE;
+  }
+
+  self->channel_list[channel->index] = NULL;
+  --self->open_count;
+  suscan_pfb_channel_destroy(channel);
+
+  return SU_TRUE;
+}
+
+SU_METHOD(
+  suscan_pfb,
+  void,
+  set_channel_freq,
+  suscan_pfb_channel_t *channel,
+  unsigned int bin,
+  SUFLOAT offset)
+{
+  if (bin < self->params.branches)
+    channel->bin = bin;
+
+  channel->offset = offset;
+  su_ncqo_set_angfreq(&channel->lo, offset);
+}
+
+SU_METHOD(
+  suscan_pfb,
+  SUBOOL,
+  set_channel_bandwidth,
+  suscan_pfb_channel_t *channel,
+  SUFLOAT bw)
+{
+  su_iir_filt_t lpf = su_iir_filt_INITIALIZER;
+
+  if (bw > 0 && bw < 2) {
+    SU_TRY_FAIL(
+      su_iir_brickwall_lp_init(
+        &lpf,
+        SUSCAN_PFB_CHANNEL_FILTER_LEN,
+        .5 * bw));
+  }
+
+  if (channel->lpf_init)
+    su_iir_filt_finalize(&channel->lpf);
+
+  channel->lpf      = lpf;
+  channel->lpf_init = bw > 0 && bw < 2;
+
+  return SU_TRUE;
+
+fail:
+  return SU_FALSE;
+}
+
+/* Make room for the outputs of size input samples */
+SUPRIVATE SUBOOL
+suscan_pfb_reserve(suscan_pfb_t *self, SUSCOUNT size)
+{
+  suscan_pfb_channel_t *chan;
+  SUSCOUNT needed = size / self->decimation + 1;
+  SUCOMPLEX *tmp;
+  unsigned int i;
+
+  for (i = 0; i < self->channel_count; ++i) {
+    chan = self->channel_list[i];
+    if (chan == NULL || chan->buffer_alloc >= needed)
+      continue;
+
+    SU_TRYCATCH(
+      tmp = realloc(chan->buffer, needed * sizeof(SUCOMPLEX)),
+      return SU_FALSE);
+
+    chan->buffer       = tmp;
+    chan->buffer_alloc = needed;
+  }
+
+  return SU_TRUE;
+}
+
+/*
+ * Folds the last taps samples into the FFT buffer and transforms them. The
+ * result is referred to the start of the window, which has moved by
+ * branches / 2 samples since the previous output: bin k must be corrected by
+ * exp(-j pi k n), i.e. odd bins flip sign every other output.
+ */
+SUINLINE void
+suscan_pfb_run_block(suscan_pfb_t *self)
+{
+  const SUCOMPLEX *x = self->history + self->history_ptr;
+  const SUFLOAT *h = self->h;
+  SUCOMPLEX *fft = (SUCOMPLEX *) self->fft;
+  unsigned int M = self->params.branches;
+  unsigned int P = self->params.taps_per_branch;
+  unsigned int m, q;
+  suscan_pfb_channel_t *chan;
+  SUCOMPLEX y;
+  SUBOOL flip;
+
+  for (m = 0; m < M; ++m)
+    fft[m] = h[m] * x[m];
+
+  for (q = 1; q < P; ++q)
+    for (m = 0; m < M; ++m)
+      fft[m] += h[m + q * M] * x[m + q * M];
+
+  SU_FFTW(_execute_dft)(self->plan, self->fft, self->fft);
+
+  ++self->block;
+  flip = self->block & 1;
+
+  for (m = 0; m < self->channel_count; ++m) {
+    chan = self->channel_list[m];
+    if (chan == NULL)
+      continue;
+
+    y = fft[chan->bin];
+    if (flip && (chan->bin & 1))
+      y = -y;
+
+    if (chan->offset != 0)
+      y *= SU_C_CONJ(su_ncqo_read(&chan->lo));
+
+    if (chan->lpf_init)
+      y = su_iir_filt_feed(&chan->lpf, y);
+
+    chan->buffer[chan->buffer_ptr++] = y;
+  }
+}
+
+SU_METHOD(suscan_pfb, SUBOOL, feed, const SUCOMPLEX *data, SUSCOUNT size)
+{
+  suscan_pfb_channel_t *chan;
+  SUSCOUNT i, L = self->taps;
+  SUSCOUNT p = self->history_ptr;
+  unsigned int j;
+
+  SU_TRYCATCH(suscan_pfb_reserve(self, size), return SU_FALSE);
+
+  /*
+   * Every sample is written twice, L samples apart, so the last L samples
+   * can always be read contiguously starting at history + history_ptr.
+   */
+  for (i = 0; i < size; ++i) {
+    self->history[p] = self->history[p + L] = data[i];
+    if (++p == L)
+      p = 0;
+
+    if (++self->phase == self->decimation) {
+      self->phase       = 0;
+      self->history_ptr = p;
+      suscan_pfb_run_block(self);
+    }
+  }
+
+  self->history_ptr = p;
+
+  /* Channels may be closed from their callbacks */
+  for (j = 0; j < self->channel_count; ++j) {
+    chan = self->channel_list[j];
+    if (chan == NULL || chan->buffer_ptr == 0)
+      continue;
+
+    size = chan->buffer_ptr;
+    chan->buffer_ptr = 0;
+    self->new_data = SU_TRUE;
+
+    if (chan->on_data != NULL)
+      SU_TRYCATCH(
+        (chan->on_data) (chan, chan->privdata, chan->buffer, size),
+        return SU_FALSE);
+  }
+
+  return SU_TRUE;
+}
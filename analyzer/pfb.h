@@ -0,0 +1,187 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_PFB_H
+#define _ANALYZER_PFB_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <sigutils/ncqo.h>
+#include <sigutils/iir.h>
+#include <sigutils/util/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Polyphase filterbank channelizer. Splits its input in a raster of
+ * `branches' channels spaced fs / branches apart, centered at bins
+ * 0, 1, ..., branches - 1 (bins above branches / 2 are negative
+ * frequencies). All channels are computed at once with a single FFT of
+ * `branches' points every `branches / 2' input samples, so the cost does not
+ * depend on the number of open channels. Outputs are 2x oversampled
+ * (fs * 2 / branches) so that a channel as wide as the raster spacing can be
+ * extracted without aliasing from its neighbours. Outputs still carry part
+ * of the neighbouring channels (up to one spacing away from the bin center):
+ * each channel removes it with its own low-pass filter, whose width is set
+ * by set_channel_bandwidth.
+ *
+ * Each open channel may apply a small frequency offset on top of its bin
+ * center. Output samples are accumulated during a call to feed and
+ * delivered through on_data before it returns. Delivered buffers are
+ * owned by the channel and remain valid until the next call to feed.
+ */
+
+#define SUSCAN_PFB_DEFAULT_TAPS_PER_BRANCH 8
+#define SUSCAN_PFB_CHANNEL_FILTER_LEN      63
+
+struct suscan_pfb;
+
+struct suscan_pfb_channel;
+
+typedef SUBOOL (*suscan_pfb_channel_data_func_t) (
+  const struct suscan_pfb_channel *channel,
+  void *privdata,
+  const SUCOMPLEX *data,
+  SUSCOUNT size);
+
+struct suscan_pfb_channel {
+  struct suscan_pfb *parent;
+  int       index;      /* Position in the parent's channel list */
+  unsigned  bin;        /* Raster bin */
+  SUFLOAT   offset;     /* Angular frequency offset, at the channel rate */
+  su_ncqo_t lo;
+
+  su_iir_filt_t lpf;    /* Channel filter, at the channel rate */
+  SUBOOL        lpf_init;
+
+  SUCOMPLEX *buffer;
+  SUSCOUNT   buffer_alloc;
+  SUSCOUNT   buffer_ptr;
+
+  suscan_pfb_channel_data_func_t on_data;
+  void *privdata;
+};
+
+typedef struct suscan_pfb_channel suscan_pfb_channel_t;
+
+struct suscan_pfb_params {
+  unsigned int branches;        /* Must be even */
+  unsigned int taps_per_branch;
+};
+
+#define suscan_pfb_params_INITIALIZER                       \
+{                                                           \
+  0,                                  /* branches */        \
+  SUSCAN_PFB_DEFAULT_TAPS_PER_BRANCH, /* taps_per_branch */ \
+}
+
+struct suscan_pfb {
+  struct suscan_pfb_params params;
+  unsigned int decimation;
+  SUSCOUNT     taps;        /* branches * taps_per_branch */
+
+  SUFLOAT     *h;           /* Prototype filter */
+  SUCOMPLEX   *history;     /* Twice the filter length, see feed */
+  SUSCOUNT     history_ptr;
+  unsigned int phase;       /* Input samples since the last output */
+  uint64_t     block;       /* Number of outputs so far */
+
+  SU_FFTW(_complex) *fft;
+  SU_FFTW(_plan)     plan;
+
+  SUBOOL       new_data;
+
+  PTR_LIST(suscan_pfb_channel_t, channel);
+  unsigned int open_count;
+};
+
+typedef struct suscan_pfb suscan_pfb_t;
+
+SUINLINE
+SU_GETTER(suscan_pfb, unsigned int, get_branches)
+{
+  return self->params.branches;
+}
+
+SUINLINE
+SU_GETTER(suscan_pfb, unsigned int, get_decimation)
+{
+  return self->decimation;
+}
+
+SUINLINE
+SU_GETTER(suscan_pfb, unsigned int, get_channel_count)
+{
+  return self->open_count;
+}
+
+SUINLINE
+SU_GETTER(suscan_pfb, SUBOOL, new_data)
+{
+  return self->new_data;
+}
+
+SUINLINE
+SU_METHOD(suscan_pfb, void, ack_data)
+{
+  self->new_data = SU_FALSE;
+}
+
+SU_INSTANCER(suscan_pfb, const struct suscan_pfb_params *params);
+SU_COLLECTOR(suscan_pfb);
+
+SU_METHOD(
+  suscan_pfb,
+  suscan_pfb_channel_t *,
+  open_channel,
+  unsigned int bin,
+  suscan_pfb_channel_data_func_t on_data,
+  void *privdata);
+
+SU_METHOD(suscan_pfb, SUBOOL, close_channel, suscan_pfb_channel_t *channel);
+
+/* Offset is the angular frequency at the channel rate */
+SU_METHOD(
+  suscan_pfb,
+  void,
+  set_channel_freq,
+  suscan_pfb_channel_t *channel,
+  unsigned int bin,
+  SUFLOAT offset);
+
+/*
+ * Bandwidth is the normalized frequency at the channel rate. Channels
+ * as wide as the channel rate (or 0) are not filtered.
+ */
+SU_METHOD(
+  suscan_pfb,
+  SUBOOL,
+  set_channel_bandwidth,
+  suscan_pfb_channel_t *channel,
+  SUFLOAT bw);
+
+SU_METHOD(suscan_pfb, SUBOOL, feed, const SUCOMPLEX *data, SUSCOUNT size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_PFB_H */
@@ -0,0 +1,1073 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define _GNU_SOURCE
+
+#define SU_LOG_DOMAIN "recorder"
+
+#include <sigutils/log.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "recorder.h"
+#include "analyzer.h"
+#include "realtime.h"
+#include "version.h"
+#include <analyzer/source/config.h>
+#include <analyzer/source/impl/file.h>
+#include <analyzer/source/impl/bfp.h>
+
+#define SUSCAN_RECORDER_MQ_TYPE_BLOCK 0
+
+/****************************** Block helpers *********************************/
+SUPRIVATE void *
+suscan_recorder_alloc_aligned(size_t size)
+{
+  void *mem = NULL;
+
+#ifdef _WIN32
+  mem = malloc(size);
+#else
+  if (posix_memalign(&mem, SUSCAN_RECORDER_DIRECT_IO_ALIGN, size) != 0)
+    mem = NULL;
+#endif /* _WIN32 */
+
+  return mem;
+}
+
+SUPRIVATE void
+suscan_recorder_encode(
+  suscan_recorder_t *self,
+  struct suscan_recorder_block *block,
+  const SUCOMPLEX *samples,
+  SUSCOUNT count)
+{
+  float *out = (float *) (block->data + block->size);
+
+#ifdef _SU_SINGLE_PRECISION
+  memcpy(out, samples, count * sizeof(SUCOMPLEX));
+#else
+  SUSCOUNT i;
+
+  for (i = 0; i < count; ++i) {
+    out[2 * i]     = SU_C_REAL(samples[i]);
+    out[2 * i + 1] = SU_C_IMAG(samples[i]);
+  }
+#endif /* _SU_SINGLE_PRECISION */
+
+  block->samples += count;
+  block->size    += count * self->sample_size;
+}
+
+/* Bytes that a block takes on disk, at most */
+SUPRIVATE SUSCOUNT
+suscan_recorder_disk_size(
+  const suscan_recorder_t *self,
+  const struct suscan_recorder_block *block)
+{
+  SUSCOUNT frames;
+
+  if (self->frame_samples == 0)
+    return block->size;
+
+  frames =
+    (self->carry_samples + block->samples + self->frame_samples - 1)
+    / self->frame_samples;
+
+  return frames * SUSCAN_BFP_FRAME_SIZE;
+}
+
+/*
+ * Called from the I/O worker only. Every BFP frame but the last one of a
+ * file must be full, so the samples that do not fill a frame are carried
+ * over to the next block. Returns the size of the encoded frames.
+ */
+SUPRIVATE SUSCOUNT
+suscan_recorder_encode_bfp(
+  suscan_recorder_t *self,
+  const struct suscan_recorder_block *block)
+{
+  const float *iq = (const float *) block->data;
+  uint8_t *frame  = self->io_buf;
+  SUSCOUNT left   = block->samples;
+  SUSCOUNT chunk;
+
+  /* Complete the frame left by the previous block */
+  if (self->carry_samples > 0) {
+    chunk = SU_MIN(left, self->frame_samples - self->carry_samples);
+
+    memcpy(
+      self->carry_buf + 2 * self->carry_samples,
+      iq,
+      2 * chunk * sizeof(float));
+
+    self->carry_samples += chunk;
+    iq                  += 2 * chunk;
+    left                -= chunk;
+
+    if (self->carry_samples < self->frame_samples)
+      return 0;
+
+    suscan_bfp_encode_frame(
+      self->params.format,
+      frame,
+      self->carry_buf,
+      self->frame_samples);
+
+    self->carry_samples = 0;
+    frame += SUSCAN_BFP_FRAME_SIZE;
+  }
+
+  while (left >= self->frame_samples) {
+    suscan_bfp_encode_frame(
+      self->params.format,
+      frame,
+      iq,
+      self->frame_samples);
+
+    iq    += 2 * self->frame_samples;
+    left  -= self->frame_samples;
+    frame += SUSCAN_BFP_FRAME_SIZE;
+  }
+
+  if (left > 0) {
+    memcpy(self->carry_buf, iq, 2 * left * sizeof(float));
+    self->carry_samples = left;
+  }
+
+  return frame - self->io_buf;
+}
+
+SUPRIVATE void
+suscan_recorder_sample_time(
+  const suscan_recorder_t *self,
+  SUSCOUNT sample,
+  struct timeval *tv)
+{
+  struct timeval elapsed;
+  SUSCOUNT delta = sample - self->first_sample;
+  SUSCOUNT fs    = self->params.samp_rate;
+
+  if (fs == 0) {
+    *tv = self->start_time;
+    return;
+  }
+
+  elapsed.tv_sec  = delta / fs;
+  elapsed.tv_usec = (1000000ull * (delta % fs)) / fs;
+
+  timeradd(&self->start_time, &elapsed, tv);
+}
+
+/****************************** File handling *********************************/
+SUPRIVATE SUBOOL
+suscan_recorder_write_fd(int fd, const uint8_t *data, size_t size)
+{
+  ssize_t ret;
+
+  while (size > 0) {
+    ret = write(fd, data, size);
+
+    if (ret == -1) {
+      if (errno == EINTR)
+        continue;
+
+      SU_ERROR("Recorder write failed: %s\n", strerror(errno));
+      return SU_FALSE;
+    }
+
+    data += ret;
+    size -= ret;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_recorder_format_datetime(
+  const struct timeval *tv,
+  char *buf,
+  size_t size)
+{
+  struct tm tm;
+  time_t secs = tv->tv_sec;
+  char date[32];
+
+  gmtime_r(&secs, &tm);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &tm);
+
+  snprintf(buf, size, "%s.%06ldZ", date, (long) tv->tv_usec);
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_write_meta(suscan_recorder_t *self)
+{
+  FILE *fp = NULL;
+  char datetime[64];
+  uint64_t dropped;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->stats_mutex));
+  dropped = self->stats.samples_dropped;
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+
+  if ((fp = fopen(self->meta_path, "w")) == NULL) {
+    SU_ERROR("Cannot open `%s' for writing: %s\n", self->meta_path, strerror(errno));
+    goto done;
+  }
+
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"global\": {\n");
+  fprintf(
+    fp,
+    "    \"core:datatype\": \"%s\",\n",
+    suscan_sigmf_datatype_from_format(self->params.format));
+  fprintf(fp, "    \"core:sample_rate\": %llu,\n", (unsigned long long) self->params.samp_rate);
+  fprintf(fp, "    \"core:version\": \"1.0.0\",\n");
+  fprintf(fp, "    \"core:recorder\": \"suscan %s\",\n", SUSCAN_VERSION_STRING);
+  if (self->frame_samples > 0)
+    fprintf(fp, "    \"suscan:bfp_frame_size\": %u,\n", SUSCAN_BFP_FRAME_SIZE);
+  fprintf(fp, "    \"suscan:dropped_samples\": %llu\n", (unsigned long long) dropped);
+  fprintf(fp, "  },\n");
+  fprintf(fp, "  \"captures\": [\n");
+
+  for (i = 0; i < self->capture_count; ++i) {
+    suscan_recorder_format_datetime(
+      &self->capture_list[i].start_time,
+      datetime,
+      sizeof(datetime));
+
+    fprintf(fp, "    {\n");
+    fprintf(
+      fp,
+      "      \"core:sample_start\": %llu,\n",
+      (unsigned long long) self->capture_list[i].sample_start);
+    fprintf(fp, "      \"core:frequency\": %.3lf,\n", self->params.frequency);
+    fprintf(fp, "      \"core:datetime\": \"%s\"\n", datetime);
+    fprintf(fp, "    }%s\n", i + 1 < self->capture_count ? "," : "");
+  }
+
+  fprintf(fp, "  ],\n");
+  fprintf(fp, "  \"annotations\": []\n");
+  fprintf(fp, "}\n");
+
+  if (ferror(fp)) {
+    SU_ERROR("Failed to write SigMF metadata to `%s'\n", self->meta_path);
+    goto done;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (fp != NULL)
+    fclose(fp);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_add_capture(suscan_recorder_t *self, SUSCOUNT first_sample)
+{
+  struct suscan_recorder_capture *tmp;
+  struct suscan_recorder_capture *capture;
+  unsigned int new_alloc;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->capture_count == self->capture_alloc) {
+    new_alloc = self->capture_alloc == 0 ? 4 : 2 * self->capture_alloc;
+    SU_TRY(
+      tmp = realloc(
+        self->capture_list,
+        new_alloc * sizeof(struct suscan_recorder_capture)));
+
+    self->capture_list  = tmp;
+    self->capture_alloc = new_alloc;
+  }
+
+  capture = self->capture_list + self->capture_count++;
+  capture->sample_start = self->file_samples;
+  suscan_recorder_sample_time(self, first_sample, &capture->start_time);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void
+suscan_recorder_preallocate(suscan_recorder_t *self)
+{
+  uint64_t size = self->params.prealloc_size;
+
+  if (size == 0)
+    size = self->params.max_file_size;
+
+  if (!self->params.preallocate || size == 0)
+    return;
+
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+  if (fallocate(self->fd, FALLOC_FL_KEEP_SIZE, 0, size) == -1)
+    SU_WARNING(
+      "Cannot preallocate %llu bytes for `%s': %s\n",
+      (unsigned long long) size,
+      self->data_path,
+      strerror(errno));
+#else
+  SU_WARNING("File preallocation not supported in this platform\n");
+#endif /* defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE) */
+}
+
+SUPRIVATE void
+suscan_recorder_disable_direct_io(suscan_recorder_t *self)
+{
+#ifdef O_DIRECT
+  int flags;
+
+  if (self->fd_direct) {
+    if ((flags = fcntl(self->fd, F_GETFL)) != -1)
+      (void) fcntl(self->fd, F_SETFL, flags & ~O_DIRECT);
+    self->fd_direct = SU_FALSE;
+  }
+#endif /* O_DIRECT */
+}
+
+/* Writes the carried samples as the last, incomplete BFP frame of the file */
+SUPRIVATE SUBOOL
+suscan_recorder_flush_carry(suscan_recorder_t *self)
+{
+  SUBOOL ok = SU_FALSE;
+
+  if (self->carry_samples == 0)
+    return SU_TRUE;
+
+  /* The frame header tells how many samples it really holds */
+  suscan_bfp_encode_frame(
+    self->params.format,
+    self->io_buf,
+    self->carry_buf,
+    self->carry_samples);
+
+  self->carry_samples = 0;
+
+  SU_TRY(
+    suscan_recorder_write_fd(self->fd, self->io_buf, SUSCAN_BFP_FRAME_SIZE));
+
+  self->file_bytes += SUSCAN_BFP_FRAME_SIZE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->stats_mutex));
+  self->stats.bytes_written += SUSCAN_BFP_FRAME_SIZE;
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/*
+ * Indices are a convenience: if we fail to create or update one, we give up
+ * on it and keep recording. The file source will rebuild it when needed.
+ */
+SUPRIVATE void
+suscan_recorder_open_index(suscan_recorder_t *self)
+{
+  struct suscan_capture_index_params params =
+    suscan_capture_index_params_INITIALIZER;
+  char *index_path = NULL;
+
+  if (self->params.samp_rate == 0)
+    return;
+
+  params.samp_rate  = self->params.samp_rate;
+  params.start_time = self->capture_list[0].start_time;
+
+  /* Let the capture be opened (and seeked) while we are recording it */
+  params.live       = SU_TRUE;
+
+  if (self->frame_samples > 0) {
+    params.frame_bytes   = SUSCAN_BFP_FRAME_SIZE;
+    params.frame_samples = self->frame_samples;
+  } else {
+    params.frame_bytes   = self->sample_size;
+    params.frame_samples = 1;
+  }
+
+  if ((index_path = suscan_capture_index_path_for(self->data_path)) == NULL)
+    return;
+
+  if ((self->index = suscan_capture_index_writer_new(index_path, &params))
+    == NULL)
+    SU_WARNING("Cannot create capture index, recording without it\n");
+
+  free(index_path);
+}
+
+SUPRIVATE void
+suscan_recorder_close_index(suscan_recorder_t *self)
+{
+  if (self->index == NULL)
+    return;
+
+  if (!suscan_capture_index_writer_finish(self->index, self->file_bytes))
+    SU_WARNING("Failed to complete the capture index of `%s'\n", self->data_path);
+
+  suscan_capture_index_writer_destroy(self->index);
+  self->index = NULL;
+}
+
+/* Called from the I/O worker, before updating the file counters */
+SUPRIVATE void
+suscan_recorder_feed_index(
+  suscan_recorder_t *self,
+  const struct suscan_recorder_block *block)
+{
+  const SUCOMPLEX *data;
+  struct timeval tv, *tvp = NULL;
+#ifndef _SU_SINGLE_PRECISION
+  const float *iq = (const float *) block->data;
+  SUSCOUNT i;
+#endif /* _SU_SINGLE_PRECISION */
+
+  if (self->index == NULL)
+    return;
+
+  /* Blocks after dropped samples do not start where the previous one ended */
+  if (self->file_samples == 0
+    || self->index->next_sample != self->file_samples
+    || self->capture_list[self->capture_count - 1].sample_start
+      == self->file_samples) {
+    suscan_recorder_sample_time(self, block->first_sample, &tv);
+    tvp = &tv;
+  }
+
+#ifdef _SU_SINGLE_PRECISION
+  data = (const SUCOMPLEX *) block->data;
+#else
+  for (i = 0; i < block->samples; ++i)
+    self->index_buf[i] = iq[2 * i] + I * iq[2 * i + 1];
+
+  data = self->index_buf;
+#endif /* _SU_SINGLE_PRECISION */
+
+  if (!suscan_capture_index_writer_feed(
+    self->index,
+    data,
+    block->samples,
+    self->file_samples,
+    tvp)) {
+    SU_WARNING("Failed to update the capture index, giving up on it\n");
+    suscan_capture_index_writer_destroy(self->index);
+    self->index = NULL;
+  }
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_close_file(suscan_recorder_t *self)
+{
+  SUBOOL ok = SU_TRUE;
+
+  if (self->fd == -1)
+    return SU_TRUE;
+
+  if (!suscan_recorder_flush_carry(self))
+    ok = SU_FALSE;
+
+  suscan_recorder_close_index(self);
+
+  /* Release preallocated space beyond the last sample */
+  if (ftruncate(self->fd, self->file_bytes) == -1) {
+    SU_WARNING("Cannot truncate `%s': %s\n", self->data_path, strerror(errno));
+  }
+
+  if (close(self->fd) == -1) {
+    SU_ERROR("Failed to close `%s': %s\n", self->data_path, strerror(errno));
+    ok = SU_FALSE;
+  }
+
+  self->fd = -1;
+
+  if (!suscan_recorder_write_meta(self))
+    ok = SU_FALSE;
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_open_file(suscan_recorder_t *self)
+{
+  SUBOOL rotate =
+    self->params.max_file_size > 0 || self->params.max_file_duration > 0;
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->data_path != NULL) {
+    free(self->data_path);
+    self->data_path = NULL;
+  }
+
+  if (self->meta_path != NULL) {
+    free(self->meta_path);
+    self->meta_path = NULL;
+  }
+
+  if (rotate) {
+    SU_TRY(
+      self->data_path = strbuild(
+        "%s-%04u.sigmf-data",
+        self->path,
+        self->file_index));
+    SU_TRY(
+      self->meta_path = strbuild(
+        "%s-%04u.sigmf-meta",
+        self->path,
+        self->file_index));
+  } else {
+    SU_TRY(self->data_path = strbuild("%s.sigmf-data", self->path));
+    SU_TRY(self->meta_path = strbuild("%s.sigmf-meta", self->path));
+  }
+
+  self->fd_direct = SU_FALSE;
+
+#ifdef O_DIRECT
+  if (self->params.direct_io) {
+    self->fd = open(self->data_path, flags | O_DIRECT, 0644);
+    if (self->fd == -1)
+      SU_WARNING(
+        "Cannot open `%s' with O_DIRECT (%s), falling back to buffered I/O\n",
+        self->data_path,
+        strerror(errno));
+    else
+      self->fd_direct = SU_TRUE;
+  }
+#endif /* O_DIRECT */
+
+  if (self->fd == -1)
+    self->fd = open(self->data_path, flags, 0644);
+
+  if (self->fd == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", self->data_path, strerror(errno));
+    goto done;
+  }
+
+  suscan_recorder_preallocate(self);
+
+  self->file_bytes         = 0;
+  self->file_samples       = 0;
+  self->carry_samples      = 0;
+  self->capture_count      = 0;
+
+  SU_TRYZ(pthread_mutex_lock(&self->stats_mutex));
+  ++self->stats.files_written;
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+
+  ++self->file_index;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_must_rotate(
+  const suscan_recorder_t *self,
+  const struct suscan_recorder_block *block)
+{
+  SUFLOAT duration;
+
+  if (self->file_bytes == 0)
+    return SU_FALSE;
+
+  if (self->params.max_file_size > 0
+    && self->file_bytes + suscan_recorder_disk_size(self, block)
+      > self->params.max_file_size)
+    return SU_TRUE;
+
+  if (self->params.max_file_duration > 0 && self->params.samp_rate > 0) {
+    duration =
+      SU_ASFLOAT(self->file_samples + block->samples) / self->params.samp_rate;
+    if (duration > self->params.max_file_duration)
+      return SU_TRUE;
+  }
+
+  return SU_FALSE;
+}
+
+/* Called from the I/O worker only */
+SUPRIVATE SUBOOL
+suscan_recorder_store_block(
+  suscan_recorder_t *self,
+  struct suscan_recorder_block *block)
+{
+  const uint8_t *data = block->data;
+  SUSCOUNT size = block->size;
+  uint64_t t0, t1;
+  SUFLOAT seconds;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->fd != -1 && suscan_recorder_must_rotate(self, block))
+    SU_TRY(suscan_recorder_close_file(self));
+
+  if (self->fd == -1) {
+    SU_TRY(suscan_recorder_open_file(self));
+    SU_TRY(suscan_recorder_add_capture(self, block->first_sample));
+    SU_TRY(suscan_recorder_write_meta(self));
+    suscan_recorder_open_index(self);
+  } else if (block->first_sample != self->next_sample) {
+    /* Samples were dropped: start a new capture segment */
+    SU_TRY(suscan_recorder_add_capture(self, block->first_sample));
+  }
+
+  /* Samples carried over to the next frame already count as file samples */
+  if (self->frame_samples > 0) {
+    size = suscan_recorder_encode_bfp(self, block);
+    data = self->io_buf;
+  }
+
+  /* Unaligned tails cannot be written with O_DIRECT */
+  if (size % SUSCAN_RECORDER_DIRECT_IO_ALIGN != 0)
+    suscan_recorder_disable_direct_io(self);
+
+  t0 = suscan_gettime_raw();
+  SU_TRY(suscan_recorder_write_fd(self->fd, data, size));
+  t1 = suscan_gettime_raw();
+
+  suscan_recorder_feed_index(self, block);
+
+  self->file_bytes   += size;
+  self->file_samples += block->samples;
+  self->next_sample   = block->first_sample + block->samples;
+
+  /* Update statistics */
+  self->measure_bytes += size;
+  seconds = (t1 - self->last_measure) * 1e-9;
+
+  SU_TRYZ(pthread_mutex_lock(&self->stats_mutex));
+  self->stats.bytes_written   += size;
+  self->stats.samples_written += block->samples;
+  ++self->stats.blocks_written;
+
+  if ((t1 - t0) * 1e-9 > self->stats.max_write_time)
+    self->stats.max_write_time = (t1 - t0) * 1e-9;
+
+  if (seconds >= SUSCAN_RECORDER_RATE_MEASURE_INTERVAL) {
+    self->stats.write_rate = self->measure_bytes / seconds;
+    self->measure_bytes    = 0;
+    self->last_measure     = t1;
+  }
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_drain(suscan_recorder_t *self)
+{
+  struct suscan_recorder_block *block;
+  uint32_t type;
+  SUBOOL failed;
+  SUBOOL ok = SU_TRUE;
+
+  (void) pthread_mutex_lock(&self->stats_mutex);
+  failed = self->stats.failed;
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+
+  while (suscan_mq_poll(&self->full_mq, &type, (void **) &block)) {
+    if (ok && !failed) {
+      if (!suscan_recorder_store_block(self, block)) {
+        (void) pthread_mutex_lock(&self->stats_mutex);
+        self->stats.failed = SU_TRUE;
+        (void) pthread_mutex_unlock(&self->stats_mutex);
+        ok = SU_FALSE;
+      }
+    }
+
+    /* Blocks are always returned, even if we failed to write them */
+    block->size    = 0;
+    block->samples = 0;
+    suscan_mq_write(&self->free_mq, SUSCAN_RECORDER_MQ_TYPE_BLOCK, block);
+  }
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_recorder_io_cb(
+  struct suscan_mq *mq_out,
+  void *wk_private,
+  void *cb_private)
+{
+  suscan_recorder_t *self = (suscan_recorder_t *) wk_private;
+
+  (void) suscan_recorder_drain(self);
+
+  return SU_FALSE;
+}
+
+/****************************** Producer side *********************************/
+SUPRIVATE SUBOOL
+suscan_recorder_submit(suscan_recorder_t *self)
+{
+  struct suscan_recorder_block *block = self->curr;
+  SUBOOL ok = SU_FALSE;
+
+  self->curr = NULL;
+
+  if (block->samples == 0) {
+    suscan_mq_write(&self->free_mq, SUSCAN_RECORDER_MQ_TYPE_BLOCK, block);
+    return SU_TRUE;
+  }
+
+  SU_TRY(suscan_mq_write(&self->full_mq, SUSCAN_RECORDER_MQ_TYPE_BLOCK, block));
+  SU_TRY(suscan_worker_push(self->worker, suscan_recorder_io_cb, NULL));
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SU_METHOD(
+  suscan_recorder,
+  SUBOOL,
+  write,
+  const SUCOMPLEX *samples,
+  SUSCOUNT len,
+  SUSCOUNT first_sample)
+{
+  struct suscan_recorder_block *block;
+  SUSCOUNT chunk;
+  uint32_t type;
+  SUBOOL ok = SU_FALSE;
+
+  if (!self->have_start) {
+    if (self->start_time.tv_sec == 0 && self->start_time.tv_usec == 0)
+      gettimeofday(&self->start_time, NULL);
+
+    self->first_sample = first_sample;
+    self->have_start   = SU_TRUE;
+  }
+
+  while (len > 0) {
+    /* Discontinuity: the block must not span it */
+    if (self->curr != NULL
+      && self->curr->first_sample + self->curr->samples != first_sample)
+      SU_TRY(suscan_recorder_submit(self));
+
+    if (self->curr == NULL) {
+      if (!suscan_mq_poll(&self->free_mq, &type, (void **) &block)) {
+        /* The I/O worker is lagging behind. Drop what is left. */
+        SU_TRYZ(pthread_mutex_lock(&self->stats_mutex));
+        ++self->stats.blocks_dropped;
+        self->stats.samples_dropped += len;
+        (void) pthread_mutex_unlock(&self->stats_mutex);
+        break;
+      }
+
+      block->size         = 0;
+      block->samples      = 0;
+      block->first_sample = first_sample;
+      self->curr          = block;
+    }
+
+    block = self->curr;
+    chunk = SU_MIN(len, self->block_samples - block->samples);
+
+    suscan_recorder_encode(self, block, samples, chunk);
+
+    samples      += chunk;
+    len          -= chunk;
+    first_sample += chunk;
+
+    if (block->samples == self->block_samples)
+      SU_TRY(suscan_recorder_submit(self));
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SU_METHOD(suscan_recorder, SUBOOL, flush)
+{
+  if (self->curr == NULL)
+    return SU_TRUE;
+
+  return suscan_recorder_submit(self);
+}
+
+SU_METHOD(suscan_recorder, void, get_stats, struct suscan_recorder_stats *stats)
+{
+  (void) pthread_mutex_lock(&self->stats_mutex);
+  *stats = self->stats;
+  (void) pthread_mutex_unlock(&self->stats_mutex);
+}
+
+/**************************** Analyzer integration ****************************/
+SUPRIVATE SUBOOL
+suscan_recorder_baseband_filter_func(
+  void *privdata,
+  struct suscan_analyzer *analyzer,
+  SUCOMPLEX *samples,
+  SUSCOUNT length,
+  SUSCOUNT consumed)
+{
+  suscan_recorder_t *self = (suscan_recorder_t *) privdata;
+  const struct suscan_source_info *info;
+
+  if (!self->have_start) {
+    if (self->params.samp_rate == 0)
+      self->params.samp_rate = suscan_analyzer_get_samp_rate(analyzer);
+
+    if (self->params.frequency == 0) {
+      info = suscan_analyzer_get_source_info(analyzer);
+      self->params.frequency = info->frequency;
+    }
+
+    suscan_analyzer_get_source_time(analyzer, &self->start_time);
+  }
+
+  /* Recording failures must not bring the analyzer down */
+  if (!suscan_recorder_write(self, samples, length, consumed))
+    SU_WARNING("Failed to queue samples for recording\n");
+
+  return SU_TRUE;
+}
+
+SU_METHOD(suscan_recorder, SUBOOL, attach, struct suscan_analyzer *analyzer)
+{
+  if (self->analyzer != NULL) {
+    SU_ERROR("Recorder already attached to an analyzer\n");
+    return SU_FALSE;
+  }
+
+  if (!suscan_analyzer_register_baseband_filter(
+    analyzer,
+    suscan_recorder_baseband_filter_func,
+    self))
+    return SU_FALSE;
+
+  self->analyzer = analyzer;
+
+  return SU_TRUE;
+}
+
+SU_METHOD(suscan_recorder, SUBOOL, detach)
+{
+  SUBOOL ok;
+
+  if (self->analyzer == NULL)
+    return SU_TRUE;
+
+  ok = suscan_analyzer_unregister_baseband_filter(
+    self->analyzer,
+    suscan_recorder_baseband_filter_func,
+    self);
+
+  self->analyzer = NULL;
+
+  return ok;
+}
+
+/************************ Construction and destruction ************************/
+SU_INSTANCER(suscan_recorder, const struct suscan_recorder_params *params)
+{
+  suscan_recorder_t *new = NULL;
+  SUSCOUNT block_size, mem_size;
+  unsigned int i;
+
+  if (params->path == NULL) {
+    SU_ERROR("Recorder path not set\n");
+    goto fail;
+  }
+
+  if (params->num_blocks < 2) {
+    SU_ERROR("Recorder needs at least two blocks\n");
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, suscan_recorder_t);
+
+  new->fd     = -1;
+  new->params = *params;
+
+  SU_TRY_FAIL(new->path = strdup(params->path));
+  new->params.path = new->path;
+
+  new->sample_size = 2 * sizeof(float);
+
+  if (new->params.format == SUSCAN_SOURCE_FORMAT_AUTO)
+    new->params.format = SUSCAN_SOURCE_FORMAT_RAW_FLOAT32;
+
+  if (new->params.format != SUSCAN_SOURCE_FORMAT_RAW_FLOAT32) {
+    new->frame_samples = suscan_bfp_frame_samples(new->params.format);
+    if (new->frame_samples == 0) {
+      SU_ERROR("Unsupported recording format\n");
+      goto fail;
+    }
+  }
+
+  /* Blocks must be multiples of both the sample size and the I/O alignment */
+  block_size = params->block_size;
+  if (block_size < SUSCAN_RECORDER_DIRECT_IO_ALIGN)
+    block_size = SUSCAN_RECORDER_DIRECT_IO_ALIGN;
+  block_size =
+    SUSCAN_RECORDER_DIRECT_IO_ALIGN
+    * ((block_size + SUSCAN_RECORDER_DIRECT_IO_ALIGN - 1)
+      / SUSCAN_RECORDER_DIRECT_IO_ALIGN);
+
+  new->params.block_size = block_size;
+
+  if (new->frame_samples > 0) {
+    new->block_samples =
+      (block_size / SUSCAN_BFP_FRAME_SIZE) * new->frame_samples;
+    SU_TRY_FAIL(new->io_buf = suscan_recorder_alloc_aligned(block_size));
+    SU_ALLOCATE_MANY_FAIL(new->carry_buf, 2 * new->frame_samples, float);
+  } else {
+    new->block_samples = block_size / new->sample_size;
+  }
+
+  mem_size = new->block_samples * new->sample_size;
+
+#ifndef _SU_SINGLE_PRECISION
+  SU_ALLOCATE_MANY_FAIL(new->index_buf, new->block_samples, SUCOMPLEX);
+#endif /* _SU_SINGLE_PRECISION */
+
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->stats_mutex, NULL));
+  new->stats_mutex_init = SU_TRUE;
+
+  SU_CONSTRUCT_FAIL(suscan_mq, &new->free_mq);
+  new->free_mq_init = SU_TRUE;
+
+  SU_CONSTRUCT_FAIL(suscan_mq, &new->full_mq);
+  new->full_mq_init = SU_TRUE;
+
+  SU_CONSTRUCT_FAIL(suscan_mq, &new->mq_out);
+  new->mq_out_init = SU_TRUE;
+
+  SU_ALLOCATE_MANY_FAIL(
+    new->block_list,
+    params->num_blocks,
+    struct suscan_recorder_block);
+  new->block_count = params->num_blocks;
+
+  for (i = 0; i < new->block_count; ++i) {
+    SU_TRY_FAIL(
+      new->block_list[i].data = suscan_recorder_alloc_aligned(mem_size));
+    SU_TRY_FAIL(
+      suscan_mq_write(
+        &new->free_mq,
+        SUSCAN_RECORDER_MQ_TYPE_BLOCK,
+        new->block_list + i));
+  }
+
+  new->last_measure = suscan_gettime_raw();
+
+  SU_TRY_FAIL(
+    new->worker = suscan_worker_new_ex("recorder-worker", &new->mq_out, new));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_recorder_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_recorder)
+{
+  struct suscan_recorder_block *block;
+  uint32_t type;
+  unsigned int i;
+
+  /* Stop receiving samples before touching the producer state */
+  if (!suscan_recorder_detach(self))
+    SU_WARNING("Failed to remove the recorder baseband filter\n");
+
+  /* Queue whatever was left in the current block */
+  if (self->curr != NULL && self->full_mq_init)
+    (void) suscan_recorder_flush(self);
+
+  /* Stop the I/O worker and write pending blocks from here */
+  if (self->worker != NULL)
+    if (!suscan_worker_halt(self->worker)) {
+      SU_ERROR("Recorder worker destruction failed, memory leak ahead\n");
+      return;
+    }
+
+  if (self->full_mq_init) {
+    (void) suscan_recorder_drain(self);
+    suscan_mq_finalize(&self->full_mq);
+  }
+
+  if (!suscan_recorder_close_file(self))
+    SU_ERROR("Recording may be incomplete\n");
+
+  if (self->free_mq_init) {
+    while (suscan_mq_poll(&self->free_mq, &type, (void **) &block));
+    suscan_mq_finalize(&self->free_mq);
+  }
+
+  if (self->mq_out_init)
+    suscan_mq_finalize(&self->mq_out);
+
+  if (self->block_list != NULL) {
+    for (i = 0; i < self->block_count; ++i)
+      if (self->block_list[i].data != NULL)
+        free(self->block_list[i].data);
+
+    free(self->block_list);
+  }
+
+  if (self->capture_list != NULL)
+    free(self->capture_list);
+
+  if (self->io_buf != NULL)
+    free(self->io_buf);
+
+  if (self->carry_buf != NULL)
+    free(self->carry_buf);
+
+  if (self->index_buf != NULL)
+    free(self->index_buf);
+
+  if (self->stats_mutex_init)
+    pthread_mutex_destroy(&self->stats_mutex);
+
+  if (self->data_path != NULL)
+    free(self->data_path);
+
+  if (self->meta_path != NULL)
+    free(self->meta_path);
+
+  if (self->path != NULL)
+    free(self->path);
+
+  free(self);
+}
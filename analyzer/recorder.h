@@ -0,0 +1,198 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SUSCAN_RECORDER_H
+#define _SUSCAN_RECORDER_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <sigutils/util/compat-time.h>
+#include <pthread.h>
+
+#include "mq.h"
+#include "worker.h"
+#include <analyzer/source/index.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_RECORDER_DIRECT_IO_ALIGN       4096
+#define SUSCAN_RECORDER_DEFAULT_BLOCK_SIZE    (1 << 20) /* Bytes */
+#define SUSCAN_RECORDER_DEFAULT_NUM_BLOCKS    32
+#define SUSCAN_RECORDER_RATE_MEASURE_INTERVAL 1.0
+
+struct suscan_analyzer;
+
+/*
+ * The recorder is a sample sink that stores baseband samples as SigMF
+ * recordings. Samples are copied into one of a fixed set of preallocated
+ * blocks by the producer (usually the source worker, through a baseband
+ * filter) and written to disk by a dedicated I/O worker. The producer never
+ * blocks: if the I/O worker falls behind and no free blocks are left,
+ * incoming samples are dropped and accounted in the recorder statistics.
+ *
+ * Samples are kept as complex float32 in memory. If a block floating point
+ * format is requested, quantization happens in the I/O worker right before
+ * writing, so the cost of encoding is not paid by the producer.
+ */
+
+struct suscan_recorder_params {
+  const char *path;   /* Path prefix, without the .sigmf-* extension */
+  SUFREQ      frequency;
+  SUSCOUNT    samp_rate;
+  int         format;        /* RAW_FLOAT32 (or AUTO) or one of the BFP formats */
+
+  SUSCOUNT    block_size;    /* On disk, rounded to SUSCAN_RECORDER_DIRECT_IO_ALIGN */
+  unsigned    num_blocks;
+  SUBOOL      direct_io;     /* Bypass the page cache (O_DIRECT) */
+  SUBOOL      preallocate;   /* Reserve disk space in advance (fallocate) */
+  uint64_t    prealloc_size; /* In bytes, 0 defaults to max_file_size */
+
+  /* File rotation. Zero disables the corresponding criterion. */
+  uint64_t    max_file_size;     /* Bytes */
+  SUFLOAT     max_file_duration; /* Seconds */
+};
+
+#define suscan_recorder_params_INITIALIZER              \
+{                                                       \
+  NULL, /* path */                                      \
+  0,    /* frequency */                                 \
+  0,    /* samp_rate */                                 \
+  0,    /* format */                                    \
+  SUSCAN_RECORDER_DEFAULT_BLOCK_SIZE, /* block_size */  \
+  SUSCAN_RECORDER_DEFAULT_NUM_BLOCKS, /* num_blocks */  \
+  SU_FALSE, /* direct_io */                             \
+  SU_TRUE,  /* preallocate */                           \
+  0,    /* prealloc_size */                             \
+  0,    /* max_file_size */                             \
+  0,    /* max_file_duration */                         \
+}
+
+struct suscan_recorder_stats {
+  uint64_t bytes_written;
+  uint64_t blocks_written;
+  uint64_t blocks_dropped;
+  uint64_t samples_written;
+  uint64_t samples_dropped;
+  unsigned files_written;
+  SUFLOAT  write_rate;     /* Bytes per second, last measurement interval */
+  SUFLOAT  max_write_time; /* Longest single block write, in seconds */
+  SUBOOL   failed;
+};
+
+struct suscan_recorder_block {
+  uint8_t  *data;
+  SUSCOUNT  size;         /* Bytes used */
+  SUSCOUNT  samples;
+  SUSCOUNT  first_sample; /* Absolute index of the first sample */
+};
+
+/* Start of a contiguous run of samples inside the current file */
+struct suscan_recorder_capture {
+  SUSCOUNT       sample_start;
+  struct timeval start_time;
+};
+
+struct suscan_recorder {
+  struct suscan_recorder_params params;
+  char    *path;
+  SUSCOUNT block_samples;
+  unsigned sample_size;   /* In memory */
+  SUSCOUNT frame_samples; /* BFP only, 0 for float32 */
+  uint8_t *io_buf;        /* BFP only, encoded block */
+  float   *carry_buf;     /* BFP only, samples of an incomplete frame */
+
+  struct suscan_recorder_block *block_list;
+  unsigned                      block_count;
+
+  struct suscan_mq free_mq;
+  SUBOOL           free_mq_init;
+  struct suscan_mq full_mq;
+  SUBOOL           full_mq_init;
+  struct suscan_mq mq_out;
+  SUBOOL           mq_out_init;
+  suscan_worker_t *worker;
+
+  /* Producer state */
+  struct suscan_analyzer       *analyzer; /* Attached analyzer, if any */
+  struct suscan_recorder_block *curr;
+  SUBOOL         have_start;
+  SUSCOUNT       first_sample;
+  struct timeval start_time;
+
+  /* I/O worker state */
+  int      fd;
+  SUBOOL   fd_direct;
+  unsigned file_index;
+  char    *data_path;
+  char    *meta_path;
+  uint64_t file_bytes;
+  SUSCOUNT file_samples;  /* Including carried samples */
+  SUSCOUNT carry_samples;
+  SUSCOUNT next_sample;
+  uint64_t last_measure;
+  uint64_t measure_bytes;
+
+  struct suscan_recorder_capture *capture_list;
+  unsigned                        capture_count;
+  unsigned                        capture_alloc;
+
+  /* Capture index of the current file (see source/index.h) */
+  suscan_capture_index_writer_t *index;
+  SUCOMPLEX                     *index_buf; /* Double precision only */
+
+  /* Statistics, shared by both sides */
+  pthread_mutex_t              stats_mutex;
+  SUBOOL                       stats_mutex_init;
+  struct suscan_recorder_stats stats;
+};
+
+typedef struct suscan_recorder suscan_recorder_t;
+
+SU_INSTANCER(suscan_recorder, const struct suscan_recorder_params *);
+SU_COLLECTOR(suscan_recorder);
+
+/* Producer side: never blocks, drops samples when out of blocks */
+SU_METHOD(
+  suscan_recorder,
+  SUBOOL,
+  write,
+  const SUCOMPLEX *samples,
+  SUSCOUNT len,
+  SUSCOUNT first_sample);
+
+/* Hand the partially filled block (if any) to the I/O worker */
+SU_METHOD(suscan_recorder, SUBOOL, flush);
+
+SU_METHOD(suscan_recorder, void, get_stats, struct suscan_recorder_stats *);
+
+/*
+ * Installs the recorder as a baseband filter of a (local) analyzer. The
+ * filter is removed by detach, or when the recorder is destroyed, so the
+ * analyzer must outlive the recorder attached to it.
+ */
+SU_METHOD(suscan_recorder, SUBOOL, attach, struct suscan_analyzer *analyzer);
+SU_METHOD(suscan_recorder, SUBOOL, detach);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _SUSCAN_RECORDER_H */
@@ -21,6 +21,8 @@
 
 #include <analyzer/impl/local.h>
 #include <analyzer/msg.h>
+#include <analyzer/source/index.h>
+#include <analyzer/source/overview.h>
 #include <string.h>
 #include <inttypes.h>
 
@@ -239,6 +241,70 @@ suscan_local_analyzer_set_replay_cb(
   return SU_FALSE;
 }
 
+SUPRIVATE SUBOOL
+suscan_local_analyzer_get_overview_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
+  struct suscan_analyzer_overview_msg *msg =
+    (struct suscan_analyzer_overview_msg *) cb_private;
+  const suscan_overview_t *overview;
+  SUSDIFF got;
+
+  msg->status = -1;
+
+  overview = suscan_source_get_overview(self->source);
+  if (overview == NULL || msg->level >= suscan_overview_get_levels(overview))
+    goto done;
+
+  if (msg->row_count > SUSCAN_ANALYZER_OVERVIEW_MAX_ROWS)
+    msg->row_count = SUSCAN_ANALYZER_OVERVIEW_MAX_ROWS;
+
+  msg->levels      = suscan_overview_get_levels(overview);
+  msg->bins        = suscan_overview_get_bins(overview);
+  msg->rows        = suscan_overview_get_rows(overview, msg->level);
+  msg->row_samples = suscan_overview_get_row_samples(overview, msg->level);
+  msg->samp_rate   = suscan_overview_get_samp_rate(overview);
+  suscan_overview_get_start_time(overview, &msg->start);
+
+  SU_TRYCATCH(
+    msg->data = malloc(msg->row_count * msg->bins * sizeof(SUFLOAT)),
+    goto done);
+
+  got = suscan_overview_read_tile(
+    overview,
+    msg->level,
+    msg->first_row,
+    msg->row_count,
+    msg->data);
+
+  if (got < 0)
+    goto done;
+
+  msg->row_count = got;
+  msg->data_size = got * msg->bins;
+  msg->status    = 0;
+
+done:
+  if (msg->status != 0) {
+    if (msg->data != NULL)
+      free(msg->data);
+    msg->data      = NULL;
+    msg->data_size = 0;
+    msg->row_count = 0;
+  }
+
+  if (!suscan_mq_write(
+    self->parent->mq_out,
+    SUSCAN_ANALYZER_MESSAGE_TYPE_OVERVIEW,
+    msg))
+    suscan_analyzer_overview_msg_destroy(msg);
+
+  return SU_FALSE;
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_set_agc_cb(
     struct suscan_mq *mq_out,
@@ -681,6 +747,9 @@ suscan_local_analyzer_slow_seek(
     suscan_local_analyzer_t *self,
     const struct timeval *tv)
 {
+  const suscan_capture_index_t *index;
+  struct timeval abs;
+  SUSCOUNT sample;
   uint64_t samp_rate;
 
   SU_TRYCATCH(
@@ -689,7 +758,19 @@ suscan_local_analyzer_slow_seek(
 
   /* We need to conver the timeval to position first */
   samp_rate = suscan_source_get_samp_rate(self->source);
-  
+  index     = suscan_source_get_capture_index(self->source);
+
+  /* Captures with an index may have gaps. Let the index do the math. */
+  if (index != NULL && !self->source->history_replay) {
+    timeradd(&suscan_source_get_info(self->source)->source_start, tv, &abs);
+    if (suscan_capture_index_lookup_sample(index, &abs, &sample)) {
+      self->seek_req_value =
+        sample / suscan_source_get_decimation(self->source);
+      self->seek_req = SU_TRUE;
+      return SU_TRUE;
+    }
+  }
+
   self->seek_req_value = 
     tv->tv_sec * samp_rate + (tv->tv_usec * samp_rate) / 1000000;
   self->seek_req = SU_TRUE;
@@ -713,6 +794,18 @@ suscan_local_analyzer_slow_set_replay(
         (void *) (uintptr_t) replay);
 }
 
+SUBOOL
+suscan_local_analyzer_slow_get_overview(
+    suscan_local_analyzer_t *self,
+    struct suscan_analyzer_overview_msg *msg)
+{
+  /* Tiles are read from disk. Keep this away from the analyzer thread. */
+  return suscan_worker_push(
+      self->slow_wk,
+      suscan_local_analyzer_get_overview_cb,
+      msg);
+}
+
 SUBOOL
 suscan_local_analyzer_slow_set_history_size(
     suscan_local_analyzer_t *self,
@@ -31,6 +31,7 @@
 #include "../src/suscan.h"
 
 #include "source.h"
+#include "source/convert.h"
 #include "compat.h"
 
 #include <sigutils/taps.h>
@@ -56,6 +57,8 @@
 void
 suscan_source_destroy(suscan_source_t *self)
 {
+  unsigned int i;
+
   if (self->src_priv != NULL)
     (self->iface->close) (self->src_priv);
   
@@ -71,12 +74,25 @@ suscan_source_destroy(suscan_source_t *self)
   if (self->read_buf != NULL)
     free(self->read_buf);
 
+  if (self->native_buf != NULL)
+    free(self->native_buf);
+
+  for (i = 1; i < SUSCAN_SOURCE_MAX_CHANNELS; ++i)
+    if (self->chan_scratch[i] != NULL)
+      free(self->chan_scratch[i]);
+
   if (self->throttle_mutex_init)
     pthread_mutex_destroy(&self->throttle_mutex);
 
   if (self->history_mutex_init)
     pthread_mutex_destroy(&self->history_mutex);
 
+  if (self->flow_cond_init)
+    pthread_cond_destroy(&self->flow_cond);
+
+  if (self->flow_mutex_init)
+    pthread_mutex_destroy(&self->flow_mutex);
+
   free(self);
 }
 
@@ -236,15 +252,187 @@ suscan_source_get_dc_samples(const suscan_source_t *self)
   return (SUSCOUNT) (int_time * samp_rate);
 }
 
+SUPRIVATE SUBOOL
+suscan_source_assert_channel_scratch(suscan_source_t *self, SUSCOUNT size)
+{
+  SUCOMPLEX *tmp;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  if (size > self->chan_scratch_alloc) {
+    for (i = 1; i < self->channel_count; ++i) {
+      SU_TRY(
+        tmp = realloc(self->chan_scratch[i], size * sizeof(SUCOMPLEX)));
+      self->chan_scratch[i] = tmp;
+    }
+
+    self->chan_scratch_alloc = size;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/*
+ * All channels are read in the same call, so they remain aligned. The
+ * first count channels go to the caller's buffers.
+ */
+SUPRIVATE SUSDIFF
+suscan_source_read_channels(
+  suscan_source_t *self,
+  SUCOMPLEX *const *buffers,
+  unsigned int count,
+  SUSCOUNT max)
+{
+  SUCOMPLEX *planes[SUSCAN_SOURCE_MAX_CHANNELS];
+  SUSDIFF got;
+  unsigned int i;
+
+  if (count < self->channel_count)
+    if (!suscan_source_assert_channel_scratch(self, max))
+      return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
+
+  for (i = 0; i < self->channel_count; ++i)
+    planes[i] = i < count ? buffers[i] : self->chan_scratch[i];
+
+  got = (self->iface->read_multi) (
+    self->src_priv,
+    planes,
+    self->channel_count,
+    max);
+
+  if (got < 1)
+    return got;
+
+  if (self->dc_correction_enabled) {
+    su_dc_corrector_correct(&self->dc_corrector, planes[0], got);
+
+    for (i = 1; i < count; ++i)
+      su_dc_corrector_correct(&self->chan_dc_corrector[i], planes[i], got);
+  }
+
+  return got;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_assert_native_buf(suscan_source_t *self, SUSCOUNT size)
+{
+  uint8_t *tmp;
+  SUBOOL ok = SU_FALSE;
+
+  if (size > self->native_alloc) {
+    SU_TRY(
+      tmp = realloc(
+        self->native_buf,
+        size * suscan_convert_sample_size(self->native_format)));
+    self->native_buf   = tmp;
+    self->native_alloc = size;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void suscan_source_history_write(
+  suscan_source_t *self,
+  const void *buffer,
+  SUSCOUNT len);
+
+/*
+ * Convert native samples and remove their DC in blocks small enough to
+ * stay in L1, so DC removal does not take a second pass over memory.
+ */
+SUPRIVATE void
+suscan_source_convert_native(
+  suscan_source_t *self,
+  SUCOMPLEX *buffer,
+  const void *data,
+  SUSCOUNT len)
+{
+  const uint8_t *in = (const uint8_t *) data;
+  size_t size = suscan_convert_sample_size(self->native_format);
+  SUSCOUNT chunk;
+
+  while (len > 0) {
+    chunk = SU_MIN(len, SUSCAN_SOURCE_CONVERT_BLOCK);
+
+    suscan_convert_samples(
+      buffer,
+      in,
+      self->native_format,
+      self->native_scale,
+      chunk);
+
+    if (self->dc_correction_enabled)
+      su_dc_corrector_correct(&self->dc_corrector, buffer, chunk);
+
+    buffer += chunk;
+    in     += chunk * size;
+    len    -= chunk;
+  }
+}
+
+/*
+ * Read from the source into the first DSP stage, DC removal included.
+ * With the native front-end, integer samples are kept in the history as
+ * they come and only converted to SUCOMPLEX here.
+ */
+SUPRIVATE SUSDIFF
+suscan_source_read_raw(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
+{
+  const void *data;
+  SUSDIFF got;
+
+  if (self->native_format == SUSCAN_SOURCE_FORMAT_AUTO) {
+    got = (self->iface->read) (self->src_priv, buffer, max);
+    if (got > 0 && self->dc_correction_enabled)
+      su_dc_corrector_correct(&self->dc_corrector, buffer, got);
+
+    return got;
+  }
+
+  if (!suscan_source_assert_native_buf(self, max))
+    return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
+
+  data = self->native_buf;
+  got  = (self->iface->read_native) (
+    self->src_priv,
+    &data,
+    self->native_buf,
+    max);
+
+  if (got > 0) {
+    if (self->history_native && self->history_enabled)
+      suscan_source_history_write(self, data, got);
+
+    suscan_source_convert_native(self, buffer, data, got);
+  }
+
+  return got;
+}
+
 SUINLINE SUSDIFF
-suscan_source_read_samples(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
+suscan_source_read_samples(
+  suscan_source_t *self,
+  SUCOMPLEX *const *buffers,
+  unsigned int count,
+  SUSCOUNT max)
 {
+  SUCOMPLEX *buffer = buffers[0];
   SUSDIFF got = 0;
   SUSCOUNT result = -1;
   SUSCOUNT spill_avail, chunk;
   SUCOMPLEX *bufdec = buffer;
   SUSCOUNT maxdec = max;
 
+  /* Multi-channel sources are never decimated */
+  if (self->channel_count > 1)
+    return suscan_source_read_channels(self, buffers, count, max);
+
   if (self->decim > 1) {
     result = 0;
     spill_avail = self->decim_spillover_size - self->decim_spillover_ptr;
@@ -272,22 +460,18 @@ suscan_source_read_samples(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT ma
       self->curr_size = maxdec;
 
       do {
-        if ((got = (self->iface->read) (
-          self->src_priv,
+        if ((got = suscan_source_read_raw(
+          self,
           self->read_buf,
           SUSCAN_SOURCE_DEFAULT_BUFSIZ)) < 1)
           return got;
 
-        if (self->dc_correction_enabled)
-          su_dc_corrector_correct(&self->dc_corrector, self->read_buf, got);
         suscan_source_feed_decimator(self, self->read_buf, got);
       } while(self->curr_ptr == 0);
       result += self->curr_ptr;
     }
   } else {
-    result = (self->iface->read) (self->src_priv, buffer, max);
-    if (result > 0 && self->dc_correction_enabled)
-      su_dc_corrector_correct(&self->dc_corrector, buffer, result);
+    result = suscan_source_read_raw(self, buffer, max);
   }
 
   return result;
@@ -309,18 +493,21 @@ suscan_source_history_get_rel_history_rp(const suscan_source_t *self)
   return ptr;
 }
 
-SUINLINE void
+SUPRIVATE void
 suscan_source_history_write(
   suscan_source_t *self,
-  const SUCOMPLEX *buffer,
+  const void *data,
   SUSCOUNT len)
 {
+  const uint8_t *buffer = (const uint8_t *) data;
+  size_t samp_size = self->history_samp_size;
+
   (void) pthread_mutex_lock(&self->history_mutex);
 
   SUSCOUNT ptr = self->history_ptr;
 
   if (len > self->history_alloc) {
-    buffer += len - self->history_alloc;
+    buffer += (len - self->history_alloc) * samp_size;
     len = self->history_alloc;
   }
 
@@ -328,17 +515,17 @@ suscan_source_history_write(
   SUSCOUNT avail = self->history_alloc - ptr;
   SUSCOUNT chunklen = MIN(len, avail);
 
-  memcpy(self->history + ptr, buffer, chunklen * sizeof(SUCOMPLEX));
+  memcpy(self->history + ptr * samp_size, buffer, chunklen * samp_size);
 
   rem    -= chunklen;
-  buffer += chunklen;
+  buffer += chunklen * samp_size;
   ptr    += chunklen;
 
   if (ptr == self->history_alloc) {
     ptr = 0;
   
     if (rem > 0) {
-      memcpy(self->history, buffer, rem * sizeof(SUCOMPLEX));
+      memcpy(self->history, buffer, rem * samp_size);
       ptr += rem;
     }
   }
@@ -358,7 +545,7 @@ suscan_source_history_write(
 SUINLINE SUSDIFF
 suscan_source_history_read(
   suscan_source_t *self,
-  SUCOMPLEX *buffer,
+  void *buffer,
   SUSCOUNT len)
 {
   SUSCOUNT avail;
@@ -379,7 +566,10 @@ suscan_source_history_read(
   if (len > avail)
     len = avail;
 
-  memcpy(buffer, self->history + self->rp, len * sizeof(SUCOMPLEX));
+  memcpy(
+    buffer,
+    self->history + self->rp * self->history_samp_size,
+    len * self->history_samp_size);
 
   self->rp += len;
   
@@ -398,17 +588,83 @@ done:
   return len;
 }
 
-SUSDIFF
-suscan_source_read(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
+/* Native histories go through the same conversion as live samples */
+SUPRIVATE SUSDIFF
+suscan_source_history_replay(
+  suscan_source_t *self,
+  SUCOMPLEX *buffer,
+  SUSCOUNT max)
+{
+  SUSDIFF got;
+
+  if (!self->history_native)
+    return suscan_source_history_read(self, buffer, max);
+
+  if (!suscan_source_assert_native_buf(self, max))
+    return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
+
+  got = suscan_source_history_read(self, self->native_buf, max);
+
+  if (got > 0)
+    suscan_source_convert_native(self, buffer, self->native_buf, got);
+
+  return got;
+}
+
+/*
+ * Waits while the source is held. Forced EOS is polled, as it is set
+ * without taking any lock. Returns whether reads must be throttled.
+ */
+SUPRIVATE SUBOOL
+suscan_source_wait_flow(suscan_source_t *self)
 {
+  struct timespec ts;
+  SUBOOL unthrottled;
+
+  (void) pthread_mutex_lock(&self->flow_mutex);
+
+  while (self->held && !self->force_eos) {
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += SUSCAN_SOURCE_HOLD_POLL_MS * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_nsec -= 1000000000;
+      ++ts.tv_sec;
+    }
+
+    (void) pthread_cond_timedwait(&self->flow_cond, &self->flow_mutex, &ts);
+  }
+
+  unthrottled = self->unthrottled;
+
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+
+  return !unthrottled;
+}
+
+/*
+ * Multi-channel sources have no history (see
+ * suscan_source_set_history_length), so replays are single-channel.
+ */
+SUPRIVATE SUSDIFF
+suscan_source_read_internal(
+  suscan_source_t *self,
+  SUCOMPLEX *const *buffers,
+  unsigned int count,
+  SUSCOUNT max)
+{
+  SUCOMPLEX *buffer = buffers[0];
   SUSDIFF result = -1;
   SUBOOL replay = self->history_replay;
+  SUBOOL throttled;
 
   if (!self->capturing)
     return 0;
 
+  throttled = suscan_source_wait_flow(self)
+    && (!suscan_source_is_real_time(self) || replay);
+
   /* With non-real time sources, use throttle to control CPU usage */
-  if (!suscan_source_is_real_time(self) || replay) {
+  if (throttled) {
     SU_TRYZ(pthread_mutex_lock(&self->throttle_mutex));
     max = suscan_throttle_get_portion(&self->throttle, max);
     SU_TRYZ(pthread_mutex_unlock(&self->throttle_mutex));
@@ -416,22 +672,22 @@ suscan_source_read(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
   
   if (self->history_enabled) {
     if (self->history_replay) {
-      result = suscan_source_history_read(self, buffer, max);
+      result = suscan_source_history_replay(self, buffer, max);
     } else {
-      result = suscan_source_read_samples(self, buffer, max);
+      result = suscan_source_read_samples(self, buffers, count, max);
 
-      if (result > 0)
+      if (result > 0 && !self->history_native)
         suscan_source_history_write(self, buffer, result);
     }
   } else {
     /* No history, just regular read */
-    result = suscan_source_read_samples(self, buffer, max);
+    result = suscan_source_read_samples(self, buffers, count, max);
   }
 
   if (result > 0)
     self->total_samples += result;
 
-  if (!suscan_source_is_real_time(self) || replay) {
+  if (throttled) {
     SU_TRYZ(pthread_mutex_lock(&self->throttle_mutex));
     suscan_throttle_advance(&self->throttle, result);
     SU_TRYZ(pthread_mutex_unlock(&self->throttle_mutex));
@@ -441,6 +697,25 @@ done:
   return result;
 }
 
+SUSDIFF
+suscan_source_read(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
+{
+  return suscan_source_read_internal(self, &buffer, 1, max);
+}
+
+SUSDIFF
+suscan_source_read_multi(
+  suscan_source_t *self,
+  SUCOMPLEX *const *buffers,
+  SUSCOUNT max)
+{
+  return suscan_source_read_internal(
+    self,
+    buffers,
+    suscan_source_get_channel_count(self),
+    max);
+}
+
 SUBOOL
 suscan_source_fill_buffer(
   suscan_source_t *self,
@@ -448,6 +723,19 @@ suscan_source_fill_buffer(
   SUSCOUNT size,
   SUSDIFF *got)
 {
+  return suscan_source_fill_buffer_multi(self, buffer, NULL, size, got);
+}
+
+SUBOOL
+suscan_source_fill_buffer_multi(
+  suscan_source_t *self,
+  suscan_sample_buffer_t *buffer,
+  SUCOMPLEX *const *aux,
+  SUSCOUNT size,
+  SUSDIFF *got)
+{
+  SUCOMPLEX *planes[SUSCAN_SOURCE_MAX_CHANNELS];
+  unsigned int i, count = 1;
   SUSCOUNT amount;
   SUSDIFF p = -1, read;
   SUCOMPLEX *data;
@@ -455,11 +743,19 @@ suscan_source_fill_buffer(
 
   data = suscan_sample_buffer_data(buffer);
 
+  if (aux != NULL)
+    count = suscan_source_get_channel_count(self);
+
   p = 0;
 
   while (p < size) {
     amount = size - p;
-    read = suscan_source_read(self, data + p, amount);
+
+    planes[0] = data + p;
+    for (i = 1; i < count; ++i)
+      planes[i] = aux[i - 1] + p;
+
+    read = suscan_source_read_internal(self, planes, count, amount);
 
     /* Check for errors */
     if (read == 0)
@@ -602,6 +898,24 @@ done:
 }
 
 
+void
+suscan_source_set_unthrottled(suscan_source_t *self, SUBOOL unthrottled)
+{
+  (void) pthread_mutex_lock(&self->flow_mutex);
+  self->unthrottled = unthrottled;
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+}
+
+void
+suscan_source_set_held(suscan_source_t *self, SUBOOL held)
+{
+  (void) pthread_mutex_lock(&self->flow_mutex);
+  self->held = held;
+  if (!held)
+    (void) pthread_cond_broadcast(&self->flow_cond);
+  (void) pthread_mutex_unlock(&self->flow_mutex);
+}
+
 SUSDIFF
 suscan_source_get_max_size(const suscan_source_t *self)
 {
@@ -611,6 +925,24 @@ suscan_source_get_max_size(const suscan_source_t *self)
   return (self->iface->max_size) (self->src_priv);
 }
 
+const struct suscan_capture_index *
+suscan_source_get_capture_index(const suscan_source_t *self)
+{
+  if (self->iface->get_index == NULL || self->src_priv == NULL)
+    return NULL;
+
+  return (self->iface->get_index) (self->src_priv);
+}
+
+const struct suscan_overview *
+suscan_source_get_overview(const suscan_source_t *self)
+{
+  if (self->iface->get_overview == NULL || self->src_priv == NULL)
+    return NULL;
+
+  return (self->iface->get_overview) (self->src_priv);
+}
+
 SUSCOUNT
 suscan_source_get_base_samp_rate(const suscan_source_t *self)
 {
@@ -674,12 +1006,17 @@ suscan_source_set_agc(suscan_source_t *self, SUBOOL set)
 SUBOOL
 suscan_source_set_dc_remove(suscan_source_t *self, SUBOOL remove)
 {
+  unsigned int i;
+
   if (!self->capturing)
     return SU_FALSE;
 
   if (self->soft_dc) {
-    if (remove)
+    if (remove) {
       su_dc_corrector_reset(&self->dc_corrector);
+      for (i = 1; i < self->channel_count; ++i)
+        su_dc_corrector_reset(&self->chan_dc_corrector[i]);
+    }
     self->dc_correction_enabled = remove;
     return SU_TRUE;
   } else {
@@ -923,6 +1260,8 @@ suscan_source_config_check(const suscan_source_config_t *config)
 SUPRIVATE void
 suscan_source_adjust_permissions(suscan_source_t *self)
 {
+  su_dc_corrector_t *corrector;
+  unsigned int i;
   SUSCOUNT dc_samples;
   SUFREQ fdiff;
   SUFREQ f0;
@@ -949,12 +1288,15 @@ suscan_source_adjust_permissions(suscan_source_t *self)
     self->dc_correction_enabled = self->config->dc_remove;
 
     dc_samples = suscan_source_get_dc_samples(self);
-    if (dc_samples > 0)
-      su_dc_corrector_init_with_training_period(&self->dc_corrector, dc_samples);
-    else
-      su_dc_corrector_init_with_alpha(
-        &self->dc_corrector,
-        SU_SPLPF_ALPHA(SUSCAN_SOURCE_DC_AVERAGING_PERIOD));
+    for (i = 0; i < self->channel_count; ++i) {
+      corrector = i == 0 ? &self->dc_corrector : &self->chan_dc_corrector[i];
+      if (dc_samples > 0)
+        su_dc_corrector_init_with_training_period(corrector, dc_samples);
+      else
+        su_dc_corrector_init_with_alpha(
+          corrector,
+          SU_SPLPF_ALPHA(SUSCAN_SOURCE_DC_AVERAGING_PERIOD));
+    }
     
     if (self->soft_dc) {
       SU_INFO("Source does not support native DC correction, falling back to software correction\n");
@@ -1083,7 +1425,7 @@ done:
 SUBOOL
 suscan_source_set_history_alloc(suscan_source_t *self, size_t bytes)
 {
-  SUSCOUNT samples = __UNITS(bytes, sizeof(SUCOMPLEX));
+  SUSCOUNT samples = __UNITS(bytes, self->history_samp_size);
   return suscan_source_set_history_length(self, samples);
 }
 
@@ -1092,8 +1434,9 @@ suscan_source_set_history_length(suscan_source_t *self, SUSCOUNT length)
 {
   size_t new_alloc = length;
   size_t old_alloc = self->history_alloc;
+  size_t samp_size = self->history_samp_size;
   SUBOOL mutex_acquired = SU_TRUE;
-  SUCOMPLEX *new_bytes;
+  uint8_t *new_bytes;
   SUBOOL ok = SU_FALSE;
 
   SU_TRYZ(pthread_mutex_lock(&self->history_mutex));
@@ -1113,16 +1456,25 @@ suscan_source_set_history_length(suscan_source_t *self, SUSCOUNT length)
     goto done;
   }
 
+  /*
+   * The history holds a single channel. Replaying it would feed zeroes to
+   * the rest of the channels, so multi-channel sources get no history.
+   */
+  if (self->channel_count > 1) {
+    SU_ERROR("History is not supported in multi-channel sources\n");
+    goto done;
+  }
+
   new_bytes = mmap(
     NULL,
-    new_alloc * sizeof(SUCOMPLEX),
+    new_alloc * samp_size,
     PROT_READ | PROT_WRITE,
     MAP_PRIVATE | MAP_ANONYMOUS,
     0, 0);
 
-  if (new_bytes == (SUCOMPLEX *) -1) {
+  if (new_bytes == (uint8_t *) -1) {
     SU_ERROR(
-      "Cannot mmap %lld bytes of memory for history: %s\n", new_alloc * sizeof(SUCOMPLEX), strerror(errno));
+      "Cannot mmap %lld bytes of memory for history: %s\n", new_alloc * samp_size, strerror(errno));
     goto done;
   }
 
@@ -1149,10 +1501,16 @@ suscan_source_set_history_length(suscan_source_t *self, SUSCOUNT length)
     if (p + copy_size > old_alloc) {
       SUSCOUNT size1 = old_alloc - p;
       SUSCOUNT size2 = copy_size - size1;
-      memcpy(new_bytes, self->history + p,     size1 * sizeof(SUCOMPLEX));
-      memcpy(new_bytes + size1, self->history, size2 * sizeof(SUCOMPLEX));
+      memcpy(
+        new_bytes,
+        self->history + p * samp_size,
+        size1 * samp_size);
+      memcpy(new_bytes + size1 * samp_size, self->history, size2 * samp_size);
     } else {
-      memcpy(new_bytes, self->history + p, copy_size * sizeof(SUCOMPLEX));
+      memcpy(
+        new_bytes,
+        self->history + p * samp_size,
+        copy_size * samp_size);
     }
 
     self->history_size = copy_size;
@@ -1245,12 +1603,45 @@ void
 suscan_source_clear_history(suscan_source_t *self)
 {
   if (self->history_alloc > 0) {
-    munmap(self->history, self->history_alloc * sizeof(SUCOMPLEX));
+    munmap(self->history, self->history_alloc * self->history_samp_size);
     self->history_alloc = 0;
     self->history = NULL;
   }
 }
 
+/*
+ * Native samples make it to the history only if no decimation takes
+ * place, as the history holds what the source delivers to the analyzer.
+ */
+SUPRIVATE void
+suscan_source_init_native(suscan_source_t *self)
+{
+  enum suscan_source_format format;
+  SUFLOAT scale;
+
+  if (self->iface->read_native == NULL
+      || self->iface->get_native_format == NULL
+      || self->channel_count > 1
+      || !(self->iface->get_native_format) (self->src_priv, &format, &scale)) {
+    SU_INFO(
+      "Source `%s' cannot deliver native samples, converting at the source\n",
+      self->iface->name);
+    return;
+  }
+
+  self->native_format = format;
+  self->native_scale  = scale;
+
+  if (self->decim == 1) {
+    self->history_native    = SU_TRUE;
+    self->history_samp_size = suscan_convert_sample_size(format);
+  }
+
+  SU_INFO(
+    "Native front-end enabled (%d bytes per sample)\n",
+    (int) suscan_convert_sample_size(format));
+}
+
 suscan_source_t *
 suscan_source_new(suscan_source_config_t *config)
 {
@@ -1262,9 +1653,17 @@ suscan_source_new(suscan_source_config_t *config)
   SU_TRYZ_FAIL(pthread_mutex_init(&new->history_mutex, NULL));
   new->history_mutex_init = SU_TRUE;
 
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->flow_mutex, NULL));
+  new->flow_mutex_init = SU_TRUE;
+
+  SU_TRYZ_FAIL(pthread_cond_init(&new->flow_cond, NULL));
+  new->flow_cond_init = SU_TRUE;
+
   SU_TRY_FAIL(new->config = suscan_source_config_clone(config));
 
   new->decim = 1;
+  new->native_format     = SUSCAN_SOURCE_FORMAT_AUTO;
+  new->history_samp_size = sizeof(SUCOMPLEX);
 
   if (config->average > 1)
     SU_TRY_FAIL(suscan_source_configure_decimation(new, config->average));
@@ -1282,11 +1681,30 @@ suscan_source_new(suscan_source_config_t *config)
     goto fail;
   }
 
+  new->channel_count = config->channel_count;
+
+  if (new->channel_count > 1) {
+    if (new->iface->read_multi == NULL) {
+      SU_ERROR(
+        "Source type `%s' does not support multiple channels\n",
+        config->type);
+      goto fail;
+    }
+
+    if (new->decim > 1) {
+      SU_ERROR("Multi-channel sources cannot be decimated\n");
+      goto fail;
+    }
+  }
+
   /* Call the source constructor */
   new->src_priv = (new->iface->open) (new, new->config, &new->info);
   if (new->src_priv == NULL)
     goto fail;
   
+  if (config->native_frontend)
+    suscan_source_init_native(new);
+
   /* Done, adjust permissions */
   suscan_source_adjust_permissions(new);
   suscan_source_populate_source_info(new);
@@ -1306,6 +1724,12 @@ fail:
 
 SUBOOL
 suscan_init_sources(void)
+{
+  return suscan_init_sources_ex(0);
+}
+
+SUBOOL
+suscan_init_sources_ex(unsigned int flags)
 {
   suscan_device_facade_t *facade = NULL;
   SUBOOL ok = SU_FALSE;
@@ -1330,8 +1754,11 @@ suscan_init_sources(void)
 #endif /* _WIN32 */
 
   SU_TRY(suscan_source_init_source_types());
-  SU_TRY(facade = suscan_device_facade_instance());
-  SU_TRY(suscan_device_facade_discover_all(facade));
+
+  if (!(flags & SUSCAN_INIT_SOURCES_LAZY_DISCOVERY)) {
+    SU_TRY(facade = suscan_device_facade_instance());
+    SU_TRY(suscan_device_facade_discover_all(facade));
+  }
 
   /* TODO: Register analyzer interfaces? */
   SU_TRY(suscan_confdb_use("sources"));
@@ -49,8 +49,10 @@ extern "C" {
 #define SUSCAN_SOAPY_SETTING_PFXLEN     (sizeof("soapy:") - 1)
 
 #define SUSCAN_SOURCE_DEFAULT_READ_TIMEOUT 100000 /* 100 ms */
+#define SUSCAN_SOURCE_HOLD_POLL_MS         100
 #define SUSCAN_SOURCE_ANTIALIAS_REL_SIZE    5
 #define SUSCAN_SOURCE_DECIMATOR_BUFFER_SIZE 512
+#define SUSCAN_SOURCE_CONVERT_BLOCK         512
 
 #define SUSCAN_SOURCE_DC_AVERAGING_PERIOD   10
 #define SUSCAN_SOURCE_DECIM_INNER_GUARD     5e-2
@@ -58,6 +60,8 @@ extern "C" {
 
 struct sigutils_specttuner;
 struct sigutils_specttuner_channel;
+struct suscan_capture_index;
+struct suscan_overview;
 
 /************** Source interface: to be implemented by all sources ************/
 struct suscan_source;
@@ -84,10 +88,37 @@ struct suscan_source_interface {
   SUBOOL   (*cancel) (void *);
 
   SUSDIFF  (*read) (void *, SUCOMPLEX *buffer, SUSCOUNT max);
+
+  /* Optional: planar read of several coherent channels, one buffer each */
+  SUSDIFF  (*read_multi) (
+    void *,
+    SUCOMPLEX *const *buffers,
+    unsigned int count,
+    SUSCOUNT max);
+
+  /*
+   * Optional: read interleaved integer samples as delivered by the
+   * hardware. get_native_format tells the format (RAW_SIGNED16 or
+   * RAW_SIGNED8) and the scale that turns them into what read returns.
+   * Samples are either copied to buffer, or left where they are (e.g. in
+   * a driver buffer) if that memory stays valid until the next read. In
+   * both cases, *data points to them on return.
+   */
+  SUBOOL   (*get_native_format) (
+    void *,
+    enum suscan_source_format *format,
+    SUFLOAT *scale);
+  SUSDIFF  (*read_native) (
+    void *,
+    const void **data,
+    void *buffer,
+    SUSCOUNT max);
   SUSDIFF  (*max_size) (void *);
   
   void     (*get_time) (void *, struct timeval *tv);
   SUBOOL   (*seek) (void *,  SUSCOUNT samples);
+  const struct suscan_capture_index *(*get_index) (void *);
+  const struct suscan_overview *(*get_overview) (void *);
 
   SUBOOL   (*set_frequency) (void *, SUFREQ freq);
   SUBOOL   (*set_gain) (void *, const char *name, SUFLOAT value);
@@ -125,6 +156,16 @@ struct suscan_source {
   /* To prevent source from looping forever */
   SUBOOL force_eos;
 
+  /*
+   * Multi-channel sources. Channel 0 goes through the regular path,
+   * the rest (index 0 unused) are read into the caller's planes or
+   * into the scratch buffers if the caller did not ask for them.
+   */
+  unsigned int      channel_count;
+  SUCOMPLEX        *chan_scratch[SUSCAN_SOURCE_MAX_CHANNELS];
+  SUSCOUNT          chan_scratch_alloc;
+  su_dc_corrector_t chan_dc_corrector[SUSCAN_SOURCE_MAX_CHANNELS];
+
   /* Downsampling members */
   struct sigutils_specttuner         *decimator;
   struct sigutils_specttuner_channel *main_channel;
@@ -140,17 +181,36 @@ struct suscan_source {
 
   int decim;
 
-  /* History */
+  /*
+   * Native front-end. Samples are read in the source's integer format
+   * and converted right before DC removal and decimation.
+   */
+  enum suscan_source_format native_format; /* AUTO if disabled */
+  SUFLOAT    native_scale;
+  uint8_t   *native_buf;
+  SUSCOUNT   native_alloc;
+
+  /* History. Kept in native format if there is no decimation */
   SUBOOL     history_enabled;
   SUBOOL     history_replay;
+  SUBOOL     history_native;
+  size_t     history_samp_size;
   SUSCOUNT   history_alloc;
   SUSCOUNT   history_size;
   SUSCOUNT   history_ptr;
   SUSCOUNT   rp; /* Replay pointer */
-  SUCOMPLEX *history;
+  uint8_t   *history;
 
   pthread_mutex_t history_mutex;
   SUBOOL          history_mutex_init;
+
+  /* Flow control, for consumers that process captures offline */
+  pthread_mutex_t flow_mutex;
+  SUBOOL          flow_mutex_init;
+  pthread_cond_t  flow_cond;
+  SUBOOL          flow_cond_init;
+  SUBOOL          unthrottled;
+  SUBOOL          held;
 };
 
 typedef struct suscan_source suscan_source_t;
@@ -168,12 +228,30 @@ SUSDIFF suscan_source_read(
     SUCOMPLEX *buffer,
     SUSCOUNT max);
 
+/*
+ * Read all channels of a multi-channel source at once. buffers holds
+ * one plane per channel (see suscan_source_get_channel_count), all of
+ * them receiving the same number of samples.
+ */
+SUSDIFF suscan_source_read_multi(
+    suscan_source_t *source,
+    SUCOMPLEX *const *buffers,
+    SUSCOUNT max);
+
 SUBOOL suscan_source_fill_buffer(
   suscan_source_t *source,
   suscan_sample_buffer_t *buffer,
   SUSCOUNT size,
   SUSDIFF *got);
 
+/* Same as above, with the channels other than the first one in aux */
+SUBOOL suscan_source_fill_buffer_multi(
+  suscan_source_t *source,
+  suscan_sample_buffer_t *buffer,
+  SUCOMPLEX *const *aux,
+  SUSCOUNT size,
+  SUSDIFF *got);
+
 suscan_sample_buffer_t *suscan_source_read_buffer(
   suscan_source_t *source,
   suscan_sample_buffer_pool_t *pool,
@@ -181,10 +259,27 @@ suscan_sample_buffer_t *suscan_source_read_buffer(
 
 SUSDIFF  suscan_source_get_max_size(const suscan_source_t *self);
 
+/* Capture index of file sources, NULL if not (yet) available */
+const struct suscan_capture_index *suscan_source_get_capture_index(
+  const suscan_source_t *self);
+
+/* Precomputed overview of file sources, NULL if not available */
+const struct suscan_overview *suscan_source_get_overview(
+  const suscan_source_t *self);
+
 void   suscan_source_get_time(suscan_source_t *self, struct timeval *tv);
 SUBOOL suscan_source_seek(suscan_source_t *self, SUSCOUNT);
 
 SUBOOL suscan_source_override_throttle(suscan_source_t *self, SUSCOUNT val);
+
+/*
+ * Read non-real time sources as fast as possible. Unlike overriding the
+ * throttle, this leaves the effective sample rate untouched.
+ */
+void suscan_source_set_unthrottled(suscan_source_t *self, SUBOOL unthrottled);
+
+/* Block reads until released, or until EOS is forced */
+void suscan_source_set_held(suscan_source_t *self, SUBOOL held);
 SUFREQ suscan_source_get_freq(const suscan_source_t *source);
 SUBOOL suscan_source_set_freq(suscan_source_t *source, SUFREQ freq);
 SUBOOL suscan_source_set_lnb_freq(suscan_source_t *source, SUFREQ freq);
@@ -281,12 +376,26 @@ suscan_source_get_samp_rate(const suscan_source_t *src)
     return (SUFLOAT) src->config->samp_rate / src->config->average;
 }
 
+/* Coherent channels delivered by the source */
+SUINLINE unsigned int
+suscan_source_get_channel_count(const suscan_source_t *self)
+{
+  return self->channel_count;
+}
+
 SUINLINE int
 suscan_source_get_decimation(const suscan_source_t *self)
 {
   return self->decim;
 }
 
+/* AUTO unless the samples are converted by the native front-end */
+SUINLINE enum suscan_source_format
+suscan_source_get_native_format(const suscan_source_t *self)
+{
+  return self->native_format;
+}
+
 SUINLINE void
 suscan_source_force_eos(suscan_source_t *src)
 {
@@ -332,8 +441,16 @@ SUBOOL suscan_source_register_soapysdr(void);
 SUBOOL suscan_source_register_tonegen(void);
 SUBOOL suscan_source_register_stdin(void);
 
+/*
+ * With SUSCAN_INIT_SOURCES_LAZY_DISCOVERY, device discovery (and
+ * therefore SoapySDR module loading) is not started here. It is up to
+ * the caller to start it before devices are needed.
+ */
+#define SUSCAN_INIT_SOURCES_LAZY_DISCOVERY 1
+
 SUBOOL suscan_source_init_source_types(void);
 SUBOOL suscan_init_sources(void);
+SUBOOL suscan_init_sources_ex(unsigned int flags);
 
 #ifdef __cplusplus
 }
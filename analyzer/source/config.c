@@ -412,6 +412,20 @@ suscan_source_config_set_average(
   return SU_TRUE;
 }
 
+SUBOOL
+suscan_source_config_get_native_frontend(const suscan_source_config_t *config)
+{
+  return config->native_frontend;
+}
+
+void
+suscan_source_config_set_native_frontend(
+    suscan_source_config_t *config,
+    SUBOOL native)
+{
+  config->native_frontend = native;
+}
+
 unsigned int
 suscan_source_config_get_channel(const suscan_source_config_t *config)
 {
@@ -432,6 +446,30 @@ suscan_source_config_set_channel(
   config->channel = channel;
 }
 
+unsigned int
+suscan_source_config_get_channel_count(const suscan_source_config_t *config)
+{
+  return config->channel_count;
+}
+
+SUBOOL
+suscan_source_config_set_channel_count(
+    suscan_source_config_t *config,
+    unsigned int count)
+{
+  if (count < 1 || count > SUSCAN_SOURCE_MAX_CHANNELS) {
+    SU_ERROR(
+      "Invalid channel count %d (must be between 1 and %d)\n",
+      count,
+      SUSCAN_SOURCE_MAX_CHANNELS);
+    return SU_FALSE;
+  }
+
+  config->channel_count = count;
+
+  return SU_TRUE;
+}
+
 struct suscan_source_gain_value *
 suscan_source_config_lookup_gain(
     const suscan_source_config_t *config,
@@ -855,6 +893,7 @@ suscan_source_config_new(
 
   new->format    = format;
   new->average   = 1;
+  new->channel_count = 1;
   new->dc_remove = SU_TRUE;
   new->loop      = SU_TRUE;
   
@@ -950,8 +989,10 @@ suscan_source_config_clone(const suscan_source_config_t *config)
   new->dc_remove  = config->dc_remove;
   new->samp_rate  = config->samp_rate;
   new->average    = config->average;
+  new->native_frontend  = config->native_frontend;
   new->ppm        = config->ppm;
   new->channel    = config->channel;
+  new->channel_count    = config->channel_count;
   new->loop       = config->loop;
   new->start_time = config->start_time;
 
@@ -988,6 +1029,12 @@ suscan_source_config_helper_format_to_str(enum suscan_source_format type)
 
     case SUSCAN_SOURCE_FORMAT_SIGMF:
       return "SIGMF";
+
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED16:
+      return "BFP_SIGNED16";
+
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED8:
+      return "BFP_SIGNED8";
   }
 
   return NULL;
@@ -1013,6 +1060,10 @@ suscan_source_type_config_helper_str_to_format(const char *format)
       return SUSCAN_SOURCE_FORMAT_WAV;
     else if (strcasecmp(format, "SIGMF") == 0)
       return SUSCAN_SOURCE_FORMAT_SIGMF;
+    else if (strcasecmp(format, "BFP_SIGNED16") == 0)
+      return SUSCAN_SOURCE_FORMAT_BFP_SIGNED16;
+    else if (strcasecmp(format, "BFP_SIGNED8") == 0)
+      return SUSCAN_SOURCE_FORMAT_BFP_SIGNED8;
   }
 
   return SUSCAN_SOURCE_FORMAT_AUTO;
@@ -1063,7 +1114,9 @@ suscan_source_config_to_object(const suscan_source_config_t *cfg)
   SU_CFGSAVE(bool,   loop);
   SU_CFGSAVE(uint,   samp_rate);
   SU_CFGSAVE(uint,   average);
+  SU_CFGSAVE(bool,   native_frontend);
   SU_CFGSAVE(uint,   channel);
+  SU_CFGSAVE(uint,   channel_count);
 
   /* Save device params */
   SU_TRY_FAIL(obj = suscan_device_spec_to_object(cfg->device_spec));
@@ -1162,6 +1215,9 @@ suscan_source_config_from_object(const suscan_object_t *object)
   SU_CFGLOAD(bool,   loop, SU_FALSE);
   SU_CFGLOAD(uint,   samp_rate, 1.8e6);
   SU_CFGLOAD(uint,   channel, 0);
+  SU_CFGLOAD(bool,   native_frontend, SU_FALSE);
+
+  SU_TRY_FAIL(SU_CFGLOAD(uint, channel_count, 1));
 
   SU_TRY_FAIL(SU_CFGLOAD(uint, average, 1));
 
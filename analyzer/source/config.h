@@ -33,6 +33,7 @@ extern "C" {
 #define SUSCAN_SOURCE_DEFAULT_FREQ      433920000 /* 433 ISM */
 #define SUSCAN_SOURCE_DEFAULT_SAMP_RATE 1000000
 #define SUSCAN_SOURCE_DEFAULT_BANDWIDTH SUSCAN_SOURCE_DEFAULT_SAMP_RATE
+#define SUSCAN_SOURCE_MAX_CHANNELS      8
 
 #define SUSCAN_SOURCE_LOCAL_INTERFACE   "local"
 #define SUSCAN_SOURCE_REMOTE_INTERFACE  "remote"
@@ -44,7 +45,9 @@ enum suscan_source_format {
   SUSCAN_SOURCE_FORMAT_RAW_UNSIGNED8,
   SUSCAN_SOURCE_FORMAT_RAW_SIGNED16,
   SUSCAN_SOURCE_FORMAT_RAW_SIGNED8,
-  SUSCAN_SOURCE_FORMAT_SIGMF
+  SUSCAN_SOURCE_FORMAT_SIGMF,
+  SUSCAN_SOURCE_FORMAT_BFP_SIGNED16, /* Block floating point, see bfp.h */
+  SUSCAN_SOURCE_FORMAT_BFP_SIGNED8
 };
 
 #define SUSCAN_SOURCE_CONFIG_GUESS_FREQ       (1 << 0)
@@ -87,6 +90,7 @@ SUSCAN_SERIALIZABLE(suscan_source_config) {
   struct timeval start_time;
   unsigned int samp_rate;
   unsigned int average;
+  SUBOOL  native_frontend; /* Keep integer samples up to the first DSP stage */
 
   /* For file sources */
   char *path;
@@ -96,6 +100,7 @@ SUSCAN_SERIALIZABLE(suscan_source_config) {
   suscan_device_spec_t *device_spec;
   char *antenna;
   unsigned int channel;
+  unsigned int channel_count;    /* Coherent channels, starting at channel */
   PTR_LIST(struct suscan_source_gain_value, gain);
   PTR_LIST(struct suscan_source_gain_value, hidden_gain);
 };
@@ -200,6 +205,12 @@ SUBOOL suscan_source_config_set_average(
     suscan_source_config_t *config,
     unsigned int average);
 
+SUBOOL suscan_source_config_get_native_frontend(
+    const suscan_source_config_t *config);
+void suscan_source_config_set_native_frontend(
+    suscan_source_config_t *config,
+    SUBOOL native);
+
 unsigned int suscan_source_config_get_channel(
     const suscan_source_config_t *config);
 
@@ -210,6 +221,13 @@ void suscan_source_config_set_channel(
     suscan_source_config_t *config,
     unsigned int channel);
 
+unsigned int suscan_source_config_get_channel_count(
+    const suscan_source_config_t *config);
+
+SUBOOL suscan_source_config_set_channel_count(
+    suscan_source_config_t *config,
+    unsigned int count);
+
 struct suscan_source_gain_value *suscan_source_config_lookup_gain(
     const suscan_source_config_t *config,
     const char *name);
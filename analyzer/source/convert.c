@@ -0,0 +1,93 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "convert"
+
+#include "convert.h"
+#include <string.h>
+
+#ifdef SU_USE_VOLK
+#  include <volk/volk.h>
+#endif /* SU_USE_VOLK */
+
+/*
+ * A SUCOMPLEX is laid out as two SUFLOATs, so both conversions are a
+ * scaled int-to-float cast of 2 * samples components. VOLK provides
+ * SIMD kernels for it in single precision. Otherwise, the loops are
+ * simple enough to be vectorized by the compiler.
+ */
+void
+suscan_convert_cs16(
+  SUCOMPLEX *out,
+  const int16_t *in,
+  SUFLOAT scale,
+  SUSCOUNT samples)
+{
+#if defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION)
+  volk_16i_s32f_convert_32f((float *) out, in, 1.f / scale, 2 * samples);
+#else
+  SUFLOAT *restrict as_real = (SUFLOAT *) out;
+  const int16_t *restrict q = in;
+  SUSCOUNT i, n = 2 * samples;
+
+  for (i = 0; i < n; ++i)
+    as_real[i] = scale * q[i];
+#endif /* defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION) */
+}
+
+void
+suscan_convert_cs8(
+  SUCOMPLEX *out,
+  const int8_t *in,
+  SUFLOAT scale,
+  SUSCOUNT samples)
+{
+#if defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION)
+  volk_8i_s32f_convert_32f((float *) out, in, 1.f / scale, 2 * samples);
+#else
+  SUFLOAT *restrict as_real = (SUFLOAT *) out;
+  const int8_t *restrict q = in;
+  SUSCOUNT i, n = 2 * samples;
+
+  for (i = 0; i < n; ++i)
+    as_real[i] = scale * q[i];
+#endif /* defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION) */
+}
+
+void
+suscan_convert_samples(
+  SUCOMPLEX *out,
+  const void *in,
+  enum suscan_source_format format,
+  SUFLOAT scale,
+  SUSCOUNT samples)
+{
+  switch (format) {
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED16:
+      suscan_convert_cs16(out, (const int16_t *) in, scale, samples);
+      break;
+
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED8:
+      suscan_convert_cs8(out, (const int8_t *) in, scale, samples);
+      break;
+
+    default:
+      memcpy(out, in, samples * sizeof(SUCOMPLEX));
+  }
+}
@@ -0,0 +1,82 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_SOURCE_CONVERT_H
+#define _ANALYZER_SOURCE_CONVERT_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <stdint.h>
+#include <analyzer/source/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Conversion of interleaved integer I/Q pairs (as delivered by most ADCs)
+ * to SUCOMPLEX, with out[i] = scale * in[i]. Buffers must not overlap.
+ *
+ * The VOLK kernels are used only in single precision builds (with
+ * _SU_SINGLE_PRECISION), as they produce 32-bit floats. Double precision
+ * builds always take the scalar loops.
+ */
+void suscan_convert_cs16(
+  SUCOMPLEX *out,
+  const int16_t *in,
+  SUFLOAT scale,
+  SUSCOUNT samples);
+
+void suscan_convert_cs8(
+  SUCOMPLEX *out,
+  const int8_t *in,
+  SUFLOAT scale,
+  SUSCOUNT samples);
+
+/*
+ * Native sample formats of the integer front-end: RAW_SIGNED16 and
+ * RAW_SIGNED8 are interleaved CS16 and CS8. Anything else is SUCOMPLEX.
+ */
+SUINLINE size_t
+suscan_convert_sample_size(enum suscan_source_format format)
+{
+  switch (format) {
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED16:
+      return 2 * sizeof(int16_t);
+
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED8:
+      return 2 * sizeof(int8_t);
+
+    default:
+      return sizeof(SUCOMPLEX);
+  }
+}
+
+void suscan_convert_samples(
+  SUCOMPLEX *out,
+  const void *in,
+  enum suscan_source_format format,
+  SUFLOAT scale,
+  SUSCOUNT samples);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_SOURCE_CONVERT_H */
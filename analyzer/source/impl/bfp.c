@@ -0,0 +1,383 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "bfp"
+
+#include "bfp.h"
+#include <sigutils/log.h>
+#include <sigutils/util/compat-unistd.h>
+#include <sigutils/util/compat-fcntl.h>
+#include <sigutils/util/compat-stat.h>
+#include <analyzer/source/config.h>
+#include <analyzer/source/convert.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+
+/******************************** Frame helpers *******************************/
+unsigned int
+suscan_bfp_component_size(int format)
+{
+  switch (format) {
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED16:
+      return sizeof(int16_t);
+
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED8:
+      return sizeof(int8_t);
+  }
+
+  return 0;
+}
+
+SUSCOUNT
+suscan_bfp_frame_samples(int format)
+{
+  unsigned int size = suscan_bfp_component_size(format);
+
+  if (size == 0)
+    return 0;
+
+  return (SUSCAN_BFP_FRAME_SIZE - SUSCAN_BFP_HEADER_SIZE) / (2 * size);
+}
+
+void
+suscan_bfp_encode_frame(
+  int format,
+  uint8_t *frame,
+  const float *iq,
+  SUSCOUNT samples)
+{
+  struct suscan_bfp_frame_header *header =
+    (struct suscan_bfp_frame_header *) frame;
+  uint8_t *payload = frame + SUSCAN_BFP_HEADER_SIZE;
+  unsigned int size = suscan_bfp_component_size(format);
+  SUSCOUNT i, n = 2 * samples;
+  float peak = 0, full, k;
+
+  for (i = 0; i < n; ++i)
+    if (fabsf(iq[i]) > peak)
+      peak = fabsf(iq[i]);
+
+  full = format == SUSCAN_SOURCE_FORMAT_BFP_SIGNED16 ? 32767.f : 127.f;
+
+  header->magic    = SUSCAN_BFP_MAGIC;
+  header->samples  = samples;
+  header->scale    = peak > 0 ? peak / full : 1.f;
+  header->reserved = 0;
+
+  k = 1.f / header->scale;
+
+  if (format == SUSCAN_SOURCE_FORMAT_BFP_SIGNED16) {
+    int16_t *q = (int16_t *) payload;
+    for (i = 0; i < n; ++i)
+      q[i] = (int16_t) lrintf(k * iq[i]);
+  } else {
+    int8_t *q = (int8_t *) payload;
+    for (i = 0; i < n; ++i)
+      q[i] = (int8_t) lrintf(k * iq[i]);
+  }
+
+  memset(
+    payload + n * size,
+    0,
+    SUSCAN_BFP_FRAME_SIZE - SUSCAN_BFP_HEADER_SIZE - n * size);
+}
+
+void
+suscan_bfp_set_frame_samples(uint8_t *frame, SUSCOUNT samples)
+{
+  struct suscan_bfp_frame_header *header =
+    (struct suscan_bfp_frame_header *) frame;
+
+  header->samples = samples;
+}
+
+/* Conversion back to floating point is a plain scaled int-to-float cast */
+SUPRIVATE void
+suscan_bfp_decode(
+  int format,
+  const uint8_t *payload,
+  float scale,
+  SUCOMPLEX *out,
+  SUSCOUNT samples)
+{
+  if (!(scale > 0)) {
+    memset(out, 0, samples * sizeof(SUCOMPLEX));
+    return;
+  }
+
+  if (format == SUSCAN_SOURCE_FORMAT_BFP_SIGNED16)
+    suscan_convert_cs16(out, (const int16_t *) payload, scale, samples);
+  else
+    suscan_convert_cs8(out, (const int8_t *) payload, scale, samples);
+}
+
+/*********************************** Reader ***********************************/
+/* Samples that can actually be read from a frame of `bytes' bytes */
+SUPRIVATE SUSCOUNT
+suscan_bfp_reader_frame_avail(
+  const suscan_bfp_reader_t *self,
+  const struct suscan_bfp_frame_header *header,
+  size_t bytes)
+{
+  SUSCOUNT avail;
+
+  if (bytes < SUSCAN_BFP_HEADER_SIZE)
+    return 0;
+
+  avail = (bytes - SUSCAN_BFP_HEADER_SIZE)
+    / (2 * suscan_bfp_component_size(self->format));
+
+  avail = SU_MIN(avail, self->frame_samples);
+
+  return SU_MIN(avail, header->samples);
+}
+
+SUPRIVATE SUBOOL
+suscan_bfp_reader_fill(suscan_bfp_reader_t *self)
+{
+  size_t want = SUSCAN_BFP_READ_FRAMES * SUSCAN_BFP_FRAME_SIZE;
+  size_t total = 0;
+  ssize_t got;
+
+  while (total < want) {
+    got = read(self->fd, self->buffer + total, want - total);
+
+    if (got == -1) {
+      if (errno == EINTR)
+        continue;
+
+      SU_ERROR("Failed to read BFP file: %s\n", strerror(errno));
+      return SU_FALSE;
+    }
+
+    if (got == 0)
+      break;
+
+    total += got;
+  }
+
+  self->buf_size   = total;
+  self->buf_frames =
+    (total + SUSCAN_BFP_FRAME_SIZE - 1) / SUSCAN_BFP_FRAME_SIZE;
+  self->buf_ptr    = 0;
+  self->frame_ptr  = self->skip;
+  self->skip       = 0;
+
+  return SU_TRUE;
+}
+
+SU_METHOD(suscan_bfp_reader, SUSDIFF, read, SUCOMPLEX *buf, SUSCOUNT max)
+{
+  const struct suscan_bfp_frame_header *header;
+  const uint8_t *frame;
+  unsigned int size = suscan_bfp_component_size(self->format);
+  SUSCOUNT avail, chunk;
+  SUSCOUNT got = 0;
+
+  while (got < max) {
+    if (self->buf_ptr >= self->buf_frames) {
+      if (!suscan_bfp_reader_fill(self))
+        return -1;
+
+      if (self->buf_frames == 0)
+        break;
+    }
+
+    frame  = self->buffer + self->buf_ptr * SUSCAN_BFP_FRAME_SIZE;
+    header = (const struct suscan_bfp_frame_header *) frame;
+
+    if (self->buf_size - self->buf_ptr * SUSCAN_BFP_FRAME_SIZE
+      >= SUSCAN_BFP_HEADER_SIZE
+      && header->magic != SUSCAN_BFP_MAGIC) {
+      SU_ERROR("Corrupted BFP frame (bad magic)\n");
+      return -1;
+    }
+
+    avail = suscan_bfp_reader_frame_avail(
+      self,
+      header,
+      self->buf_size - self->buf_ptr * SUSCAN_BFP_FRAME_SIZE);
+
+    if (self->frame_ptr < avail) {
+      chunk = SU_MIN(max - got, avail - self->frame_ptr);
+
+      suscan_bfp_decode(
+        self->format,
+        frame + SUSCAN_BFP_HEADER_SIZE + 2 * size * self->frame_ptr,
+        header->scale,
+        buf + got,
+        chunk);
+
+      got             += chunk;
+      self->frame_ptr += chunk;
+    }
+
+    if (self->frame_ptr >= avail) {
+      ++self->buf_ptr;
+      self->frame_ptr = 0;
+    }
+  }
+
+  return got;
+}
+
+SU_METHOD(
+  suscan_bfp_reader,
+  SUBOOL,
+  seek_offset,
+  uint64_t byte_offset,
+  SUSCOUNT skip)
+{
+  if (byte_offset % SUSCAN_BFP_FRAME_SIZE != 0
+    || skip >= self->frame_samples) {
+    SU_ERROR("Invalid BFP frame position\n");
+    return SU_FALSE;
+  }
+
+  if ((byte_offset / SUSCAN_BFP_FRAME_SIZE) * self->frame_samples + skip
+    > self->total_samples) {
+    SU_ERROR("Seek beyond the end of the BFP file\n");
+    return SU_FALSE;
+  }
+
+  if (lseek(self->fd, (off_t) byte_offset, SEEK_SET) == -1) {
+    SU_ERROR("Cannot seek BFP file: %s\n", strerror(errno));
+    return SU_FALSE;
+  }
+
+  self->buf_frames = 0;
+  self->buf_ptr    = 0;
+  self->buf_size   = 0;
+  self->frame_ptr  = 0;
+  self->skip       = skip;
+
+  return SU_TRUE;
+}
+
+SU_METHOD(suscan_bfp_reader, SUBOOL, seek, SUSCOUNT pos)
+{
+  if (pos > self->total_samples) {
+    SU_ERROR("Seek beyond the end of the BFP file\n");
+    return SU_FALSE;
+  }
+
+  return suscan_bfp_reader_seek_offset(
+    self,
+    (uint64_t) (pos / self->frame_samples) * SUSCAN_BFP_FRAME_SIZE,
+    pos % self->frame_samples);
+}
+
+SU_GETTER(suscan_bfp_reader, SUSCOUNT, get_samples)
+{
+  return self->total_samples;
+}
+
+/* All frames but the last one are full. The last one tells how many are left */
+SUPRIVATE SUBOOL
+suscan_bfp_reader_count_samples(suscan_bfp_reader_t *self)
+{
+  struct suscan_bfp_frame_header header;
+  struct stat sbuf;
+  uint64_t frames;
+  off_t last;
+  ssize_t got;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYC(fstat(self->fd, &sbuf));
+
+  frames = (sbuf.st_size + SUSCAN_BFP_FRAME_SIZE - 1) / SUSCAN_BFP_FRAME_SIZE;
+  if (frames == 0) {
+    self->total_samples = 0;
+    return SU_TRUE;
+  }
+
+  last = (off_t) (frames - 1) * SUSCAN_BFP_FRAME_SIZE;
+
+  if (sbuf.st_size - last < (off_t) SUSCAN_BFP_HEADER_SIZE) {
+    /* Truncated header. Ignore that frame. */
+    self->total_samples = (frames - 1) * self->frame_samples;
+    return SU_TRUE;
+  }
+
+  SU_TRYC(lseek(self->fd, last, SEEK_SET));
+  got = read(self->fd, &header, sizeof(struct suscan_bfp_frame_header));
+  SU_TRY(got == sizeof(struct suscan_bfp_frame_header));
+  SU_TRYC(lseek(self->fd, 0, SEEK_SET));
+
+  if (header.magic != SUSCAN_BFP_MAGIC) {
+    SU_ERROR("Not a BFP file (bad magic)\n");
+    goto done;
+  }
+
+  self->total_samples =
+    (frames - 1) * self->frame_samples
+    + suscan_bfp_reader_frame_avail(self, &header, sbuf.st_size - last);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SU_INSTANCER(suscan_bfp_reader, const char *path, int format)
+{
+  suscan_bfp_reader_t *new = NULL;
+
+  if (suscan_bfp_component_size(format) == 0) {
+    SU_ERROR("Invalid BFP format\n");
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, suscan_bfp_reader_t);
+
+  new->format        = format;
+  new->frame_samples = suscan_bfp_frame_samples(format);
+
+  if ((new->fd = open(path, O_RDONLY)) == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", path, strerror(errno));
+    goto fail;
+  }
+
+  SU_ALLOCATE_MANY_FAIL(
+    new->buffer,
+    SUSCAN_BFP_READ_FRAMES * SUSCAN_BFP_FRAME_SIZE,
+    uint8_t);
+
+  SU_TRY_FAIL(suscan_bfp_reader_count_samples(new));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_bfp_reader_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_bfp_reader)
+{
+  if (self->fd != -1)
+    close(self->fd);
+
+  if (self->buffer != NULL)
+    free(self->buffer);
+
+  free(self);
+}
@@ -0,0 +1,110 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SOURCES_IMPL_BFP_H
+#define _SOURCES_IMPL_BFP_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Block floating point (BFP) IQ files. Samples are quantized to signed 16 or
+ * 8 bit integers, sharing one scale factor per frame. Every frame is exactly
+ * SUSCAN_BFP_FRAME_SIZE bytes long (a header followed by interleaved I/Q
+ * pairs, zero-padded if short), so that frames can be written with O_DIRECT
+ * and a sample can be located without scanning the file. Only the last frame
+ * of a file may hold less than suscan_bfp_frame_samples() samples.
+ *
+ * Headers and samples are stored in host byte order, which is little endian
+ * in every platform we support.
+ */
+
+#define SUSCAN_BFP_FRAME_SIZE  4096
+#define SUSCAN_BFP_MAGIC       0x50464253 /* "SBFP" */
+#define SUSCAN_BFP_READ_FRAMES 16
+
+struct suscan_bfp_frame_header {
+  uint32_t magic;
+  uint32_t samples;  /* Valid samples in this frame */
+  float    scale;    /* x = q * scale */
+  uint32_t reserved;
+};
+
+#define SUSCAN_BFP_HEADER_SIZE sizeof(struct suscan_bfp_frame_header)
+
+/* Bytes per real component, 0 if the format is not a BFP format */
+unsigned int suscan_bfp_component_size(int format);
+
+/* Complex samples in a full frame */
+SUSCOUNT suscan_bfp_frame_samples(int format);
+
+/*
+ * Quantizes up to suscan_bfp_frame_samples() samples (given as interleaved
+ * float I/Q pairs) into a full frame.
+ */
+void suscan_bfp_encode_frame(
+  int format,
+  uint8_t *frame,
+  const float *iq,
+  SUSCOUNT samples);
+
+/* Rewrites the sample count of an already encoded frame */
+void suscan_bfp_set_frame_samples(uint8_t *frame, SUSCOUNT samples);
+
+struct suscan_bfp_reader {
+  int       fd;
+  int       format;
+  SUSCOUNT  frame_samples;
+  SUSCOUNT  total_samples;
+
+  uint8_t  *buffer;      /* SUSCAN_BFP_READ_FRAMES frames */
+  size_t    buf_size;    /* Bytes currently in buffer */
+  unsigned  buf_frames;  /* Frames currently in buffer */
+  unsigned  buf_ptr;     /* Frame being consumed */
+  SUSCOUNT  frame_ptr;   /* Next sample of the frame being consumed */
+  SUSCOUNT  skip;        /* Samples to discard from the next frame (seek) */
+};
+
+typedef struct suscan_bfp_reader suscan_bfp_reader_t;
+
+SU_INSTANCER(suscan_bfp_reader, const char *path, int format);
+SU_COLLECTOR(suscan_bfp_reader);
+
+SU_METHOD(suscan_bfp_reader, SUSDIFF, read, SUCOMPLEX *buf, SUSCOUNT max);
+SU_METHOD(suscan_bfp_reader, SUBOOL, seek, SUSCOUNT pos);
+
+/* Seek to the frame at byte_offset, and skip the first samples in it */
+SU_METHOD(
+  suscan_bfp_reader,
+  SUBOOL,
+  seek_offset,
+  uint64_t byte_offset,
+  SUSCOUNT skip);
+SU_GETTER(suscan_bfp_reader, SUSCOUNT, get_samples);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _SOURCES_IMPL_BFP_H */
@@ -21,6 +21,7 @@
 #include <analyzer/source.h>
 #include <sigutils/util/compat-time.h>
 #include <sigutils/util/compat-stdlib.h>
+#include <sigutils/util/compat-stat.h>
 #include <libgen.h>
 
 #ifdef _SU_SINGLE_PRECISION
@@ -50,6 +51,48 @@ suscan_source_format_to_sf_format(enum suscan_source_format format)
   }
 }
 
+/*
+ * SigMF datatype names understood by suscan. The file source uses this table
+ * to open SigMF captures, and the recorder to describe the ones it writes.
+ */
+SUPRIVATE const struct {
+  int         format;
+  const char *datatype;
+} g_sigmf_datatypes[] = {
+  {SUSCAN_SOURCE_FORMAT_RAW_SIGNED8,   "ci8"},
+  {SUSCAN_SOURCE_FORMAT_RAW_UNSIGNED8, "cu8"},
+  {SUSCAN_SOURCE_FORMAT_RAW_SIGNED16,  "ci16_le"},
+  {SUSCAN_SOURCE_FORMAT_RAW_FLOAT32,   "cf32_le"},
+
+  /* Not SigMF core types: other tools will not be able to read these */
+  {SUSCAN_SOURCE_FORMAT_BFP_SIGNED16,  "bfp_ci16_le"},
+  {SUSCAN_SOURCE_FORMAT_BFP_SIGNED8,   "bfp_ci8"}
+};
+
+const char *
+suscan_sigmf_datatype_from_format(int format)
+{
+  unsigned int i;
+
+  for (i = 0; i < sizeof(g_sigmf_datatypes) / sizeof(g_sigmf_datatypes[0]); ++i)
+    if (g_sigmf_datatypes[i].format == format)
+      return g_sigmf_datatypes[i].datatype;
+
+  return NULL;
+}
+
+int
+suscan_sigmf_datatype_to_format(const char *datatype)
+{
+  unsigned int i;
+
+  for (i = 0; i < sizeof(g_sigmf_datatypes) / sizeof(g_sigmf_datatypes[0]); ++i)
+    if (strcmp(g_sigmf_datatypes[i].datatype, datatype) == 0)
+      return g_sigmf_datatypes[i].format;
+
+  return -1;
+}
+
 SUPRIVATE SNDFILE *
 suscan_source_config_open_file_raw(
   const suscan_source_config_t *self,
@@ -124,6 +167,112 @@ suscan_source_config_open_file_sigmf(
 #endif
 }
 
+/*
+ * Resolves the format, data file and sample rate of a capture, looking into
+ * the extension and SigMF metadata if needed. The format is left as AUTO or
+ * SIGMF if it cannot be told in advance. *path must be freed by the caller.
+ */
+SUPRIVATE SUBOOL
+suscan_source_config_file_resolve(
+  const suscan_source_config_t *self,
+  int *format,
+  char **path,
+  unsigned int *samp_rate)
+{
+  const char *p;
+#ifdef HAVE_JSONC
+  struct suscan_sigmf_metadata metadata;
+#endif /* HAVE_JSONC */
+
+  *format    = self->format;
+  *samp_rate = self->samp_rate;
+
+  if (*format == SUSCAN_SOURCE_FORMAT_AUTO
+    && (p = strrchr(self->path, '.')) != NULL) {
+    ++p;
+    if (strcmp(p, "sigmf-data") == 0 || strcmp(p, "sigmf-meta") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_SIGMF;
+    else if (strcasecmp(p, "wav") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_WAV;
+    else if (strcasecmp(p, "cu8") == 0 || strcasecmp(p, "u8") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_RAW_UNSIGNED8;
+    else if (strcasecmp(p, "cs16") == 0 || strcasecmp(p, "s16") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED16;
+    else if (strcasecmp(p, "cf32") == 0 || strcasecmp(p, "raw") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_RAW_FLOAT32;
+    else if (strcasecmp(p, "bfp16") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_BFP_SIGNED16;
+    else if (strcasecmp(p, "bfp8") == 0)
+      *format = SUSCAN_SOURCE_FORMAT_BFP_SIGNED8;
+  }
+
+#ifdef HAVE_JSONC
+  /* Let the SigMF opener complain about broken metadata */
+  if (*format == SUSCAN_SOURCE_FORMAT_SIGMF
+    && suscan_sigmf_extract_metadata(&metadata, self->path)) {
+    *format    = metadata.format;
+    *samp_rate = metadata.sample_rate;
+    *path      = strdup(metadata.path_data);
+
+    suscan_sigmf_metadata_finalize(&metadata);
+
+    return *path != NULL;
+  }
+#endif /* HAVE_JSONC */
+
+  *path = strdup(self->path);
+
+  return *path != NULL;
+}
+
+/*
+ * Block floating point captures cannot be read by libsndfile. Returns
+ * SU_FALSE on error, and leaves *reader set to NULL if the file does
+ * not look like a BFP capture.
+ */
+SUPRIVATE SUBOOL
+suscan_source_config_open_file_bfp(
+  const suscan_source_config_t *self,
+  suscan_bfp_reader_t **reader,
+  SF_INFO *sf_info)
+{
+  char *path = NULL;
+  unsigned int samp_rate;
+  int format;
+  SUBOOL ok = SU_FALSE;
+
+  *reader = NULL;
+
+  if (self->path == NULL)
+    return SU_TRUE;
+
+  SU_TRY(suscan_source_config_file_resolve(self, &format, &path, &samp_rate));
+
+  if (suscan_bfp_component_size(format) == 0) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_MAKE(*reader, suscan_bfp_reader, path, format);
+
+  memset(sf_info, 0, sizeof(SF_INFO));
+  sf_info->frames     = suscan_bfp_reader_get_samples(*reader);
+  sf_info->channels   = 2;
+  sf_info->samplerate = samp_rate;
+
+  SU_INFO(
+    "BFP file source opened (%s)\n",
+    format == SUSCAN_SOURCE_FORMAT_BFP_SIGNED16 ? "16 bit" : "8 bit");
+
+  ok = SU_TRUE;
+
+done:
+  if (path != NULL)
+    free(path);
+
+  return ok;
+}
+
 SUPRIVATE const char *
 suscan_source_config_helper_sf_format_to_str(int format)
 {
@@ -243,20 +392,50 @@ suscan_source_config_sf_open(
         suscan_source_format_to_sf_format(self->format),
         sf_info);
       break;
+
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED16:
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED8:
+      SU_ERROR("Block floating point captures cannot be opened as audio files\n");
+      break;
   }
 
   return sf;
 }
 
+/* Opens the file either as a BFP capture or through libsndfile */
+SUPRIVATE SUBOOL
+suscan_source_config_file_open_any(
+  const suscan_source_config_t *self,
+  SNDFILE **sf,
+  suscan_bfp_reader_t **bfp,
+  SF_INFO *sf_info)
+{
+  *sf = NULL;
+
+  if (!suscan_source_config_open_file_bfp(self, bfp, sf_info))
+    return SU_FALSE;
+
+  if (*bfp != NULL)
+    return SU_TRUE;
+
+  return (*sf = suscan_source_config_sf_open(self, sf_info)) != NULL;
+}
+
 SUBOOL
 suscan_source_config_file_is_valid(const suscan_source_config_t *self)
 {
   SUBOOL ok = SU_FALSE;
   SNDFILE *sf = NULL;
+  suscan_bfp_reader_t *bfp = NULL;
   SF_INFO sf_info;
 
-  if ((sf = suscan_source_config_sf_open(self, &sf_info)) != NULL) {
-    sf_close(sf);
+  if (suscan_source_config_file_open_any(self, &sf, &bfp, &sf_info)) {
+    if (sf != NULL)
+      sf_close(sf);
+
+    if (bfp != NULL)
+      suscan_bfp_reader_destroy(bfp);
+
     ok = SU_TRUE;
   }
 
@@ -264,13 +443,482 @@ suscan_source_config_file_is_valid(const suscan_source_config_t *self)
 }
 
 /****************************** Implementation ********************************/
+SUPRIVATE SUSDIFF
+suscan_source_file_read_handle(
+  SNDFILE *sf,
+  suscan_bfp_reader_t *bfp,
+  const SF_INFO *sf_info,
+  SUCOMPLEX *buf,
+  SUSCOUNT max)
+{
+  SUFLOAT *as_real = (SUFLOAT *) buf;
+  int got, i;
+
+  /* BFP readers deliver complex samples directly */
+  if (bfp != NULL)
+    return suscan_bfp_reader_read(bfp, buf, max);
+
+  got = sf_read(sf, as_real, max * (sf_info->channels == 2 ? 2 : 1));
+
+  if (got > 0) {
+    /* Real data mode: iteratively cast to complex */
+    if (sf_info->channels == 1) {
+      for (i = got - 1; i >= 0; --i)
+        buf[i] = as_real[i];
+    } else {
+      got >>= 1;
+    }
+  }
+
+  return got;
+}
+
+/* Byte layout of each format, so that index entries point inside the file */
+SUPRIVATE void
+suscan_source_file_index_layout(
+  int format,
+  struct suscan_capture_index_params *params)
+{
+  params->frame_samples = 1;
+
+  switch (format) {
+    case SUSCAN_SOURCE_FORMAT_RAW_FLOAT32:
+      params->frame_bytes = 2 * sizeof(float);
+      break;
+
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED16:
+      params->frame_bytes = 2 * sizeof(int16_t);
+      break;
+
+    case SUSCAN_SOURCE_FORMAT_RAW_UNSIGNED8:
+    case SUSCAN_SOURCE_FORMAT_RAW_SIGNED8:
+      params->frame_bytes = 2 * sizeof(uint8_t);
+      break;
+
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED16:
+    case SUSCAN_SOURCE_FORMAT_BFP_SIGNED8:
+      params->frame_bytes   = SUSCAN_BFP_FRAME_SIZE;
+      params->frame_samples = suscan_bfp_frame_samples(format);
+      break;
+
+    default:
+      /* Containers (WAV) and unknown formats */
+      params->frame_bytes = 0;
+  }
+}
+
+/*
+ * Seeks through the capture index when it knows where the target sample is
+ * in the data file, and by sample position otherwise. libsndfile only seeks
+ * by frames, so for files it opens the offset is turned into a frame number.
+ */
+SUPRIVATE SUBOOL
+suscan_source_file_seek_handle(
+  SNDFILE *sf,
+  suscan_bfp_reader_t *bfp,
+  const suscan_capture_index_t *index,
+  const struct suscan_capture_index_params *layout,
+  SUSCOUNT pos)
+{
+  SUSCOUNT first, skip;
+  uint64_t offset;
+
+  if (index != NULL
+    && layout->frame_bytes > 0
+    && suscan_capture_index_lookup_offset(index, pos, &first, &offset)) {
+    /* The offset is that of the frame holding the first sample of the entry */
+    first  -= first % layout->frame_samples;
+    offset += ((pos - first) / layout->frame_samples) * layout->frame_bytes;
+    skip    = (pos - first) % layout->frame_samples;
+
+    if (bfp != NULL)
+      return suscan_bfp_reader_seek_offset(bfp, offset, skip);
+
+    return sf_seek(
+      sf,
+      ((offset - layout->data_offset) / layout->frame_bytes)
+        * layout->frame_samples + skip,
+      SEEK_SET) != -1;
+  }
+
+  if (bfp != NULL)
+    return suscan_bfp_reader_seek(bfp, pos);
+
+  return sf_seek(sf, pos, SEEK_SET) != -1;
+}
+
+/******************************* Standalone reader ****************************/
+SU_INSTANCER(suscan_source_file_reader, const suscan_source_config_t *config)
+{
+  suscan_source_file_reader_t *new = NULL;
+
+  char *data_path = NULL;
+  unsigned int samp_rate;
+  int format;
+
+  SU_ALLOCATE_FAIL(new, suscan_source_file_reader_t);
+
+  SU_TRY_FAIL(
+    suscan_source_config_file_open_any(
+      config,
+      &new->sf,
+      &new->bfp,
+      &new->sf_info));
+
+  SU_TRY_FAIL(
+    suscan_source_config_file_resolve(
+      config,
+      &format,
+      &data_path,
+      &samp_rate));
+
+  suscan_source_file_index_layout(format, &new->layout);
+  SU_TRY_FAIL(new->index_path = suscan_capture_index_path_for(data_path));
+
+  free(data_path);
+
+  return new;
+
+fail:
+  if (data_path != NULL)
+    free(data_path);
+
+  if (new != NULL)
+    suscan_source_file_reader_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_source_file_reader)
+{
+  if (self->index != NULL)
+    suscan_capture_index_destroy(self->index);
+
+  if (self->index_path != NULL)
+    free(self->index_path);
+
+  if (self->sf != NULL)
+    sf_close(self->sf);
+
+  if (self->bfp != NULL)
+    suscan_bfp_reader_destroy(self->bfp);
+
+  free(self);
+}
+
+SU_METHOD(
+  suscan_source_file_reader,
+  SUSDIFF,
+  read,
+  SUCOMPLEX *buf,
+  SUSCOUNT max)
+{
+  return suscan_source_file_read_handle(
+    self->sf,
+    self->bfp,
+    &self->sf_info,
+    buf,
+    max);
+}
+
+SU_METHOD(suscan_source_file_reader, SUBOOL, seek, SUSCOUNT pos)
+{
+  /* Readers that never seek do not need the index */
+  if (!self->index_loaded) {
+    self->index = suscan_capture_index_new(self->index_path);
+    self->index_loaded = SU_TRUE;
+  }
+
+  return suscan_source_file_seek_handle(
+    self->sf,
+    self->bfp,
+    self->index,
+    &self->layout,
+    pos);
+}
+
+SU_GETTER(suscan_source_file_reader, SUSCOUNT, get_samples)
+{
+  return self->sf_info.frames;
+}
+
+SU_GETTER(suscan_source_file_reader, unsigned int, get_samp_rate)
+{
+  return self->sf_info.samplerate;
+}
+
+char *
+suscan_source_config_file_get_data_path(const suscan_source_config_t *self)
+{
+  char *path = NULL;
+  unsigned int samp_rate;
+  int format;
+
+  if (!suscan_source_config_file_resolve(self, &format, &path, &samp_rate))
+    return NULL;
+
+  return path;
+}
+
+/************************** Capture index handling ****************************/
+SUPRIVATE void
+suscan_source_file_set_index(
+  struct suscan_source_file *self,
+  suscan_capture_index_t *index)
+{
+  (void) pthread_mutex_lock(&self->index_mutex);
+  self->index = index;
+  (void) pthread_mutex_unlock(&self->index_mutex);
+}
+
+SUPRIVATE SUBOOL
+suscan_source_file_index_cancelled(struct suscan_source_file *self)
+{
+  SUBOOL cancel;
+
+  (void) pthread_mutex_lock(&self->index_mutex);
+  cancel = self->index_cancel;
+  (void) pthread_mutex_unlock(&self->index_mutex);
+
+  return cancel;
+}
+
+SUPRIVATE suscan_capture_index_t *
+suscan_source_file_get_index_locked(struct suscan_source_file *self)
+{
+  suscan_capture_index_t *index;
+
+  (void) pthread_mutex_lock(&self->index_mutex);
+  index = self->index;
+  (void) pthread_mutex_unlock(&self->index_mutex);
+
+  return index;
+}
+
+/*
+ * Reads the whole capture through a separate handle, and installs the
+ * resulting index once finished. Runs in its own thread, as this may take
+ * as long as replaying the file at full speed.
+ */
+SUPRIVATE void *
+suscan_source_file_index_thread(void *userdata)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+  suscan_capture_index_writer_t *writer = self->index_writer;
+  suscan_capture_index_t *index = NULL;
+  suscan_source_file_reader_t *reader = NULL;
+  SUCOMPLEX *buffer = NULL;
+  SUSCOUNT pos = 0;
+  SUSDIFF got;
+  SUBOOL ok = SU_FALSE;
+
+  SU_MAKE(reader, suscan_source_file_reader, self->config);
+  SU_ALLOCATE_MANY(buffer, SUSCAN_SOURCE_FILE_INDEX_READ_SIZE, SUCOMPLEX);
+
+  while (!suscan_source_file_index_cancelled(self)) {
+    got = suscan_source_file_reader_read(
+      reader,
+      buffer,
+      SUSCAN_SOURCE_FILE_INDEX_READ_SIZE);
+
+    SU_TRY(got >= 0);
+    if (got == 0)
+      break;
+
+    SU_TRY(
+      suscan_capture_index_writer_feed(
+        writer,
+        buffer,
+        got,
+        pos,
+        pos == 0 ? &self->index_params.start_time : NULL));
+
+    pos += got;
+  }
+
+  if (suscan_source_file_index_cancelled(self))
+    goto done;
+
+  SU_TRY(suscan_capture_index_writer_finish(writer, self->data_size));
+  SU_MAKE(index, suscan_capture_index, self->index_path);
+
+  suscan_source_file_set_index(self, index);
+  index = NULL;
+
+  SU_INFO("Capture index `%s' ready\n", self->index_path);
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok && !suscan_source_file_index_cancelled(self))
+    SU_WARNING("Failed to build capture index, seeking by time will be approximate\n");
+
+  if (index != NULL)
+    suscan_capture_index_destroy(index);
+
+  /* Releases the index lock */
+  if (writer != NULL)
+    suscan_capture_index_writer_destroy(writer);
+  self->index_writer = NULL;
+
+  if (buffer != NULL)
+    free(buffer);
+
+  if (reader != NULL)
+    suscan_source_file_reader_destroy(reader);
+
+  return NULL;
+}
+
+/* Overviews are built by suscli, we only load them if up to date */
+SUPRIVATE void
+suscan_source_file_load_overview(
+  struct suscan_source_file *self,
+  const char *data_path)
+{
+  char *path = NULL;
+
+  if ((path = suscan_overview_path_for(data_path)) == NULL)
+    return;
+
+  if ((self->overview = suscan_overview_new(path)) != NULL
+    && !suscan_overview_is_fresh(self->overview, self->data_size)) {
+    SU_WARNING("Overview `%s' is outdated, ignoring\n", path);
+    suscan_overview_destroy(self->overview);
+    self->overview = NULL;
+  }
+
+  free(path);
+}
+
+/*
+ * Loads the index of the capture if there is an up to date one, or starts
+ * building it otherwise, unless someone else is already building it or
+ * the source was told not to. Failures here are never fatal: without an
+ * index, we just fall back to assuming a constant sample rate.
+ */
+SUPRIVATE void
+suscan_source_file_init_index(struct suscan_source_file *self)
+{
+  struct suscan_capture_index_params params =
+    suscan_capture_index_params_INITIALIZER;
+  suscan_capture_index_t *index = NULL;
+  char *data_path = NULL;
+  const char *build;
+  struct stat sbuf;
+  unsigned int samp_rate;
+  int format;
+
+  if (pthread_mutex_init(&self->index_mutex, NULL) != 0)
+    return;
+  self->index_mutex_init = SU_TRUE;
+
+  if (!suscan_source_config_file_resolve(
+    self->config,
+    &format,
+    &data_path,
+    &samp_rate))
+    goto done;
+
+  if (stat(data_path, &sbuf) == -1)
+    goto done;
+
+  self->data_size = sbuf.st_size;
+  suscan_source_file_load_overview(self, data_path);
+
+  SU_TRY(self->index_path = suscan_capture_index_path_for(data_path));
+
+  /* Needed by seeks too, even if the index is not built here */
+  params.samp_rate  = self->samp_rate;
+  params.start_time = self->config->start_time;
+  suscan_source_file_index_layout(format, &params);
+
+  self->index_params = params;
+
+  if ((index = suscan_capture_index_new(self->index_path)) != NULL) {
+    if (suscan_capture_index_is_fresh(index, self->data_size)) {
+      self->index = index;
+      index = NULL;
+      goto done;
+    }
+
+    SU_INFO("Capture index `%s' is outdated, rebuilding\n", self->index_path);
+  }
+
+  build = suscan_source_config_get_param(
+    self->config,
+    SUSCAN_SOURCE_FILE_INDEX_PARAM);
+  if (build != NULL && strcmp(build, "false") == 0)
+    goto done;
+
+  /* Taking the index lock here lets concurrent openers skip the build */
+  if ((self->index_writer = suscan_capture_index_writer_new(
+    self->index_path,
+    &self->index_params)) == NULL) {
+    /*
+     * Someone else holds the lock. If it is the recorder of this very
+     * capture, its live index already covers what we can read.
+     */
+    if (index != NULL && suscan_capture_index_get_entry_count(index) > 0) {
+      SU_INFO("Using partial capture index `%s'\n", self->index_path);
+      self->index = index;
+      index = NULL;
+    }
+
+    goto done;
+  }
+
+  if (pthread_create(
+    &self->index_thread,
+    NULL,
+    suscan_source_file_index_thread,
+    self) != 0) {
+    SU_WARNING("Cannot start capture index thread\n");
+    suscan_capture_index_writer_destroy(self->index_writer);
+    self->index_writer = NULL;
+    goto done;
+  }
+
+  self->index_thread_running = SU_TRUE;
+
+done:
+  if (index != NULL)
+    suscan_capture_index_destroy(index);
+
+  if (data_path != NULL)
+    free(data_path);
+}
+
+/********************************* Source API *********************************/
 SUPRIVATE void
 suscan_source_file_close(void *ptr)
 {
   struct suscan_source_file *self = (struct suscan_source_file *) ptr;
 
+  if (self->index_thread_running) {
+    (void) pthread_mutex_lock(&self->index_mutex);
+    self->index_cancel = SU_TRUE;
+    (void) pthread_mutex_unlock(&self->index_mutex);
+    pthread_join(self->index_thread, NULL);
+  }
+
+  if (self->index != NULL)
+    suscan_capture_index_destroy(self->index);
+
+  if (self->index_mutex_init)
+    pthread_mutex_destroy(&self->index_mutex);
+
+  if (self->index_path != NULL)
+    free(self->index_path);
+
+  if (self->overview != NULL)
+    suscan_overview_destroy(self->overview);
+
   if (self->sf != NULL)
     sf_close(self->sf);
+
+  if (self->bfp != NULL)
+    suscan_bfp_reader_destroy(self->bfp);
   
   free(self);
 }
@@ -304,9 +952,12 @@ suscan_source_file_open(
 
   new->source = source;
   new->config = config;
-  new->sf     = suscan_source_config_sf_open(config, &new->sf_info);
-  
-  if (new->sf == NULL)
+
+  if (!suscan_source_config_file_open_any(
+    config,
+    &new->sf,
+    &new->bfp,
+    &new->sf_info))
     goto fail;
 
   new->iq_file   = new->sf_info.channels == 2;
@@ -332,6 +983,8 @@ suscan_source_file_open(
 
   new->samp_rate = (SUFLOAT) info->source_samp_rate;
 
+  suscan_source_file_init_index(new);
+
   return new;
 
 fail:
@@ -347,16 +1000,88 @@ suscan_source_file_start(void *self)
   return SU_TRUE;
 }
 
-SUPRIVATE SUSDIFF
-suscan_source_file_read(
-  void *userdata,
-  SUCOMPLEX *buf,
-  SUSCOUNT max)
+SUPRIVATE SUBOOL
+suscan_source_file_seek(void *userdata, SUSCOUNT pos)
 {
   struct suscan_source_file *self = (struct suscan_source_file *) userdata;
-  SUFLOAT *as_real;
-  int got, i;
-  unsigned int real_count;
+
+  if (!suscan_source_file_seek_handle(
+    self->sf,
+    self->bfp,
+    suscan_source_file_get_index_locked(self),
+    &self->index_params,
+    pos))
+    return SU_FALSE;
+
+  self->total_samples = pos;
+
+  return SU_TRUE;
+}
+
+/*
+ * 16 and 8 bit I/Q files can be read as they are by the native front-end.
+ * 8 bit samples are read raw, as single bytes, so they are not widened to
+ * 16 bits on the way.
+ */
+SUPRIVATE SUBOOL
+suscan_source_file_is_native(const struct suscan_source_file *self)
+{
+  int subformat = self->sf_info.format & SF_FORMAT_SUBMASK;
+
+  return self->bfp == NULL
+    && self->sf_info.channels == 2
+    && (subformat == SF_FORMAT_PCM_16 || subformat == SF_FORMAT_PCM_S8);
+}
+
+SUINLINE SUBOOL
+suscan_source_file_is_native_8bit(const struct suscan_source_file *self)
+{
+  return (self->sf_info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_PCM_S8;
+}
+
+SUPRIVATE SUSDIFF
+suscan_source_file_read_chunk(
+  struct suscan_source_file *self,
+  void *buf,
+  SUSCOUNT max,
+  SUBOOL native)
+{
+  sf_count_t got;
+
+  if (native) {
+    if (!suscan_source_file_is_native_8bit(self))
+      return sf_readf_short(self->sf, (short *) buf, max);
+
+    /*
+     * Raw reads count bytes. A truncated file may end in half a pair:
+     * drop it and realign the file pointer to the last whole sample.
+     */
+    got = sf_read_raw(self->sf, buf, 2 * max);
+    if (got < 0)
+      return got;
+
+    if (got & 1)
+      sf_seek(self->sf, sf_seek(self->sf, 0, SEEK_CUR), SEEK_SET);
+
+    return got >> 1;
+  }
+
+  return suscan_source_file_read_handle(
+    self->sf,
+    self->bfp,
+    &self->sf_info,
+    (SUCOMPLEX *) buf,
+    max);
+}
+
+SUPRIVATE SUSDIFF
+suscan_source_file_read_any(
+  struct suscan_source_file *self,
+  void *buf,
+  SUSCOUNT max,
+  SUBOOL native)
+{
+  SUSDIFF got;
 
   if (self->force_eos)
     return 0;
@@ -364,46 +1089,85 @@ suscan_source_file_read(
   if (max > SUSCAN_SOURCE_DEFAULT_BUFSIZ)
     max = SUSCAN_SOURCE_DEFAULT_BUFSIZ;
 
-  real_count = max * (self->iq_file ? 2 : 1);
-
-  as_real = (SUFLOAT *) buf;
-
-  got = sf_read(self->sf, as_real, real_count);
+  got = suscan_source_file_read_chunk(self, buf, max, native);
 
   if (got == 0 && self->config->loop) {
-    if (sf_seek(self->sf, 0, SEEK_SET) == -1) {
+    if (!suscan_source_file_seek(self, 0)) {
       SU_ERROR("Failed to seek to the beginning of the stream\n");
       return 0;
     }
     
     suscan_source_mark_looped(self->source);
-    self->total_samples = 0;
-    got = sf_read(self->sf, as_real, real_count);
+    got = suscan_source_file_read_chunk(self, buf, max, native);
   }
 
-  if (got > 0) {
-    /* Real data mode: iteratively cast to complex */
-    if (self->sf_info.channels == 1) {
-      for (i = got - 1; i >= 0; --i)
-        buf[i] = as_real[i];
-    } else {
-      got >>= 1;
-    }
-
+  if (got > 0)
     self->total_samples += got;
-  }
 
   return got;
 }
 
+SUPRIVATE SUSDIFF
+suscan_source_file_read(
+  void *userdata,
+  SUCOMPLEX *buf,
+  SUSCOUNT max)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+
+  return suscan_source_file_read_any(self, buf, max, SU_FALSE);
+}
+
+SUPRIVATE SUSDIFF
+suscan_source_file_read_native(
+  void *userdata,
+  const void **data,
+  void *buf,
+  SUSCOUNT max)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+
+  *data = buf;
+
+  return suscan_source_file_read_any(self, buf, max, SU_TRUE);
+}
+
+SUPRIVATE SUBOOL
+suscan_source_file_get_native_format(
+  void *userdata,
+  enum suscan_source_format *format,
+  SUFLOAT *scale)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+
+  if (!suscan_source_file_is_native(self))
+    return SU_FALSE;
+
+  if (suscan_source_file_is_native_8bit(self)) {
+    *format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED8;
+    *scale  = 1. / 128;
+  } else {
+    *format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED16;
+    *scale  = 1. / 32768;
+  }
+
+  return SU_TRUE;
+}
+
 SUPRIVATE void
 suscan_source_file_get_time(void *userdata, struct timeval *tv)
 {
   struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+  const suscan_capture_index_t *index;
   struct timeval elapsed;
   SUSCOUNT samp_count = self->total_samples;
   SUFLOAT samp_rate = self->samp_rate;
 
+  /* The index knows about gaps and per-segment timestamps */
+  index = suscan_source_file_get_index_locked(self);
+  if (index != NULL && suscan_capture_index_lookup_time(index, samp_count, tv))
+    return;
+
   elapsed.tv_sec  = samp_count / samp_rate;
   elapsed.tv_usec = 
     (1000000 
@@ -413,17 +1177,20 @@ suscan_source_file_get_time(void *userdata, struct timeval *tv)
   timeradd(&self->config->start_time, &elapsed, tv);
 }
 
-SUPRIVATE SUBOOL
-suscan_source_file_seek(void *userdata, SUSCOUNT pos)
+SUPRIVATE const struct suscan_capture_index *
+suscan_source_file_get_index(void *userdata)
 {
   struct suscan_source_file *self = (struct suscan_source_file *) userdata;
 
-  if (sf_seek(self->sf, pos, SEEK_SET) == -1)
-    return SU_FALSE;
+  return suscan_source_file_get_index_locked(self);
+}
 
-  self->total_samples = pos;
+SUPRIVATE const struct suscan_overview *
+suscan_source_file_get_overview(void *userdata)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
 
-  return SU_TRUE;
+  return self->overview;
 }
 
 SUPRIVATE SUSDIFF
@@ -658,11 +1425,11 @@ SUPRIVATE SUSDIFF
 suscan_source_file_estimate_size(const suscan_source_config_t *config)
 {
   SNDFILE *sf = NULL;
+  suscan_bfp_reader_t *bfp = NULL;
   SF_INFO sf_info;
   SUSDIFF max_size = -1;
 
-  sf = suscan_source_config_sf_open(config, &sf_info);
-  if (sf == NULL)
+  if (!suscan_source_config_file_open_any(config, &sf, &bfp, &sf_info))
     goto done;
     
   max_size = sf_info.frames - 1;
@@ -670,6 +1437,9 @@ suscan_source_file_estimate_size(const suscan_source_config_t *config)
 done:
   if (sf != NULL)
     sf_close(sf);
+
+  if (bfp != NULL)
+    suscan_bfp_reader_destroy(bfp);
   
   return max_size;
 }
@@ -687,7 +1457,11 @@ SUPRIVATE struct suscan_source_interface g_file_source =
   .start           = suscan_source_file_start,
   .cancel          = suscan_source_file_cancel,
   .read            = suscan_source_file_read,
+  .get_native_format = suscan_source_file_get_native_format,
+  .read_native     = suscan_source_file_read_native,
   .seek            = suscan_source_file_seek,
+  .get_index       = suscan_source_file_get_index,
+  .get_overview    = suscan_source_file_get_overview,
   .max_size        = suscan_source_file_max_size,
   .get_time        = suscan_source_file_get_time,
   .guess_metadata  = suscan_source_file_guess_metadata,
@@ -23,8 +23,20 @@
 #include <sndfile.h>
 #include <sigutils/types.h>
 #include <sigutils/util/compat-time.h>
+#include <analyzer/source/index.h>
+#include <analyzer/source/overview.h>
+#include <pthread.h>
+#include "bfp.h"
 
-/* File sources are accessed through a soundfile handle */
+#define SUSCAN_SOURCE_FILE_INDEX_READ_SIZE 65536
+
+/* Source parameter. Set to "false" to never build capture indices */
+#define SUSCAN_SOURCE_FILE_INDEX_PARAM     "_suscan_capture_index"
+
+/*
+ * File sources are accessed through a soundfile handle, except for block
+ * floating point captures, which have their own reader.
+ */
 
 struct suscan_source_config;
 struct suscan_source;
@@ -45,6 +57,7 @@ struct suscan_sigmf_metadata {
 
 struct suscan_source_file {
   SNDFILE *sf;
+  suscan_bfp_reader_t *bfp;
   SF_INFO sf_info;
   struct suscan_source_config *config;
   struct suscan_source *source;
@@ -54,8 +67,64 @@ struct suscan_source_file {
   SUFLOAT  samp_rate;
   SUSCOUNT total_samples;
   SUSCOUNT seek_request;
+
+  /* Capture index, built in the background if missing or outdated */
+  suscan_capture_index_t *index;
+  char           *index_path;
+  uint64_t        data_size;
+  struct suscan_capture_index_params index_params;
+  suscan_capture_index_writer_t *index_writer;
+  pthread_mutex_t index_mutex;
+  SUBOOL          index_mutex_init;
+  pthread_t       index_thread;
+  SUBOOL          index_thread_running;
+  SUBOOL          index_cancel; /* Protected by index_mutex */
+
+  /* Precomputed overview, if any */
+  suscan_overview_t *overview;
+};
+
+/*
+ * Standalone reader of the samples of a file source, for tools and
+ * background tasks that need their own handle to the capture.
+ */
+struct suscan_source_file_reader {
+  SNDFILE             *sf;
+  suscan_bfp_reader_t *bfp;
+  SF_INFO              sf_info;
+
+  /* Capture index and data layout, loaded on the first seek */
+  struct suscan_capture_index_params layout;
+  char                   *index_path;
+  suscan_capture_index_t *index;
+  SUBOOL                  index_loaded;
 };
 
+typedef struct suscan_source_file_reader suscan_source_file_reader_t;
+
+SU_INSTANCER(
+  suscan_source_file_reader,
+  const struct suscan_source_config *config);
+SU_COLLECTOR(suscan_source_file_reader);
+
+SU_METHOD(
+  suscan_source_file_reader,
+  SUSDIFF,
+  read,
+  SUCOMPLEX *buf,
+  SUSCOUNT max);
+SU_METHOD(suscan_source_file_reader, SUBOOL, seek, SUSCOUNT pos);
+SU_GETTER(suscan_source_file_reader, SUSCOUNT, get_samples);
+SU_GETTER(suscan_source_file_reader, unsigned int, get_samp_rate);
+
+/* File actually holding the samples (e.g. the sigmf-data file) */
+char *suscan_source_config_file_get_data_path(
+  const struct suscan_source_config *config);
+
+/* SigMF datatype names, shared by the file source and the recorder */
+const char *suscan_sigmf_datatype_from_format(int format);
+int suscan_sigmf_datatype_to_format(const char *datatype);
+
 SUBOOL suscan_sigmf_extract_metadata(
   struct suscan_sigmf_metadata *self,
   const char *path);
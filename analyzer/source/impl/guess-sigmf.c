@@ -98,15 +98,7 @@ SU_METHOD(
   }
 
   as_str = json_object_get_string(datatype);
-  if (strcmp(as_str, "ci8") == 0) {
-    metadata->format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED8;
-  } else if (strcmp(as_str, "cu8") == 0) {
-    metadata->format = SUSCAN_SOURCE_FORMAT_RAW_UNSIGNED8;
-  } else if (strcmp(as_str, "ci16_le") == 0) {
-    metadata->format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED16;
-  } else if (strcmp(as_str, "cf32_le") == 0) {
-    metadata->format = SUSCAN_SOURCE_FORMAT_RAW_FLOAT32;
-  } else {
+  if ((metadata->format = suscan_sigmf_datatype_to_format(as_str)) == -1) {
     SU_ERROR("Unrecognized sample format `%s'\n", as_str);
     goto done;
   }
@@ -19,6 +19,7 @@
 
 #include "soapysdr.h"
 #include <analyzer/source.h>
+#include <analyzer/source/convert.h>
 #include <analyzer/device/spec.h>
 #include <analyzer/device/properties.h>
 #include <analyzer/device/facade.h>
@@ -122,45 +123,30 @@ done:
 }
 
 SUPRIVATE SUBOOL
-suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
+suscan_source_soapysdr_init_channel(
+  struct suscan_source_soapysdr *self,
+  size_t channel)
 {
   suscan_source_config_t *config = self->config;
   unsigned int i;
-  char *antenna = NULL;
-  const char *key, *desc, *val;
-  strmap_t *all_params = NULL;
-  SoapySDRArgInfo *arg;
+  SUBOOL have_dc;
   SUBOOL ok = SU_FALSE;
 
-  SU_TRY(all_params = suscan_device_spec_get_all(config->device_spec));
-  SU_TRY(self->sdr_args = strmap_to_SoapySDRKwargs(all_params));
-
-  if ((self->sdr = SoapySDRDevice_make(self->sdr_args)) == NULL) {
-    SU_ERROR("Failed to open SDR device: %s\n", SoapySDRDevice_lastError());
-    goto done;
-  }
-
   if (self->config->antenna != NULL)
     if (SoapySDRDevice_setAntenna(
         self->sdr,
         SOAPY_SDR_RX,
-        config->channel,
+        channel,
         config->antenna) != 0) {
       SU_ERROR("Failed to set SDR antenna: %s\n", SoapySDRDevice_lastError());
       goto done;
     }
 
-  /* Disable AGC to prevent eccentric receivers from ignoring gain settings */
-  if (SoapySDRDevice_setGainMode(self->sdr, SOAPY_SDR_RX, 0, false) != 0) {
-    SU_ERROR("Failed to disable AGC. This is most likely a driver issue.\n");
-    goto done;
-  }
-
   for (i = 0; i < config->gain_count; ++i)
     if (SoapySDRDevice_setGainElement(
         self->sdr,
         SOAPY_SDR_RX,
-        config->channel,
+        channel,
         config->gain_list[i]->name,
         config->gain_list[i]->val) != 0)
       SU_WARNING(
@@ -172,7 +158,7 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   if (SoapySDRDevice_setFrequency(
       self->sdr,
       SOAPY_SDR_RX,
-      config->channel,
+      channel,
       config->freq - config->lnb_freq,
       NULL) != 0) {
     SU_ERROR("Failed to set SDR frequency: %s\n", SoapySDRDevice_lastError());
@@ -182,7 +168,7 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   if (SoapySDRDevice_setSampleRate(
       self->sdr,
       SOAPY_SDR_RX,
-      config->channel,
+      channel,
       config->samp_rate) != 0) {
     SU_ERROR("Failed to set sample rate: %s\n", SoapySDRDevice_lastError());
     goto done;
@@ -191,20 +177,17 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   if (SoapySDRDevice_setBandwidth(
       self->sdr,
       SOAPY_SDR_RX,
-      config->channel,
+      channel,
       config->bandwidth) != 0) {
     SU_ERROR("Failed to set SDR IF bandwidth: %s\n", SoapySDRDevice_lastError());
     goto done;
   }
 
-  if (SoapySDRDevice_setClockSource(self->sdr, "external") != 0)
-    SU_WARNING("Failed to switch to external clock\n");
-  
 #if SOAPY_SDR_API_VERSION >= 0x00060000
   if (SoapySDRDevice_setFrequencyCorrection(
       self->sdr,
       SOAPY_SDR_RX,
-      config->channel,
+      channel,
       config->ppm) != 0) {
     SU_ERROR(
         "Failed to set SDR frequency correction: %s\n",
@@ -219,16 +202,16 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
 #endif /* SOAPY_SDR_API_VERSION >= 0x00060000 */
 
   /* TODO: Implement IQ balance*/
-  self->have_dc = SoapySDRDevice_hasDCOffsetMode(
+  have_dc = SoapySDRDevice_hasDCOffsetMode(
       self->sdr,
       SOAPY_SDR_RX,
-      config->channel);
+      channel);
 
-  if (self->have_dc) {
+  if (have_dc) {
     if (SoapySDRDevice_setDCOffsetMode(
         self->sdr,
         SOAPY_SDR_RX,
-        config->channel,
+        channel,
         config->dc_remove) != 0) {
       SU_ERROR(
           "Failed to set DC offset correction: %s\n",
@@ -237,9 +220,100 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
     }
   }
 
-  /* All set: open SoapySDR stream */
-  self->chan_array[0] = config->channel;
+  /* Hardware DC correction only if all channels support it */
+  if (channel == config->channel)
+    self->have_dc = have_dc;
+  else
+    self->have_dc = self->have_dc && have_dc;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_setup_stream(
+  struct suscan_source_soapysdr *self,
+  const char *format,
+  const SoapySDRKwargs *args)
+{
+#if SOAPY_SDR_API_VERSION < 0x00080000
+  if (SoapySDRDevice_setupStream(
+      self->sdr,
+      &self->rx_stream,
+      SOAPY_SDR_RX,
+      format,
+      self->chan_array,
+      self->chan_count,
+      args) != 0) {
+#else
+  if ((self->rx_stream = SoapySDRDevice_setupStream(
+      self->sdr,
+      SOAPY_SDR_RX,
+      format,
+      self->chan_array,
+      self->chan_count,
+      args)) == NULL) {
+#endif
+    SU_ERROR(
+        "Failed to open RX stream on SDR device: %s\n",
+        SoapySDRDevice_lastError());
+    self->rx_stream = NULL;
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
+{
+  suscan_source_config_t *config = self->config;
+  unsigned int i;
+  char *antenna = NULL;
+  const char *key, *desc, *val;
+  strmap_t *all_params = NULL;
+  SoapySDRArgInfo *arg;
+  char *format = NULL;
+  double full_scale = 0;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(all_params = suscan_device_spec_get_all(config->device_spec));
+  SU_TRY(self->sdr_args = strmap_to_SoapySDRKwargs(all_params));
 
+  if ((self->sdr = SoapySDRDevice_make(self->sdr_args)) == NULL) {
+    SU_ERROR("Failed to open SDR device: %s\n", SoapySDRDevice_lastError());
+    goto done;
+  }
+
+  /* Coherent channels are consecutive, starting at the configured one */
+  self->chan_count = config->channel_count;
+  for (i = 0; i < self->chan_count; ++i)
+    self->chan_array[i] = config->channel + i;
+
+  if (self->chan_count > 1 && config->channel + self->chan_count
+    > SoapySDRDevice_getNumChannels(self->sdr, SOAPY_SDR_RX)) {
+    SU_ERROR(
+      "Device has no RX channels %u to %u\n",
+      config->channel,
+      (unsigned) (config->channel + self->chan_count - 1));
+    goto done;
+  }
+
+  /* Disable AGC to prevent eccentric receivers from ignoring gain settings */
+  if (SoapySDRDevice_setGainMode(self->sdr, SOAPY_SDR_RX, 0, false) != 0) {
+    SU_ERROR("Failed to disable AGC. This is most likely a driver issue.\n");
+    goto done;
+  }
+
+  if (SoapySDRDevice_setClockSource(self->sdr, "external") != 0)
+    SU_WARNING("Failed to switch to external clock\n");
+
+  for (i = 0; i < self->chan_count; ++i)
+    SU_TRY(suscan_source_soapysdr_init_channel(self, self->chan_array[i]));
+
+  /* All set: open SoapySDR stream */
   /* Set up stream arguments */
   self->stream_args = SoapySDRDevice_getStreamArgsInfo(
     self->sdr,
@@ -280,28 +354,58 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
     }
   }
 
-#if SOAPY_SDR_API_VERSION < 0x00080000
-  if (SoapySDRDevice_setupStream(
+  /* Try to read directly from the driver buffers, in its native format */
+  val = SoapySDRKwargs_get(self->sdr_args, SUSCAN_SOAPY_SETTING_PREFIX "direct");
+  if (val == NULL || strcmp(val, "false") != 0) {
+    format = SoapySDRDevice_getNativeStreamFormat(
       self->sdr,
-      &self->rx_stream,
       SOAPY_SDR_RX,
-      SUSCAN_SOAPY_SAMPFMT,
-      self->chan_array,
-      1,
-      &stream_args_to_set) != 0) {
-#else
-  if ((self->rx_stream = SoapySDRDevice_setupStream(
+      config->channel,
+      &full_scale);
+
+    if (format != NULL && full_scale > 0) {
+      if (strcmp(format, SOAPY_SDR_CS16) == 0) {
+        self->format        = SOAPY_SDR_CS16;
+        self->sample_format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16;
+      } else if (strcmp(format, SOAPY_SDR_CS8) == 0) {
+        self->format        = SOAPY_SDR_CS8;
+        self->sample_format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8;
+      }
+
+      self->scale = 1. / full_scale;
+    }
+
+    if (self->format == NULL)
+      self->format = SUSCAN_SOAPY_SAMPFMT;
+
+    if (!suscan_source_soapysdr_setup_stream(
+      self,
+      self->format,
+      &stream_args_to_set))
+      goto done;
+
+    if (SoapySDRDevice_getNumDirectAccessBuffers(
       self->sdr,
-      SOAPY_SDR_RX,
-      SUSCAN_SOAPY_SAMPFMT,
-      self->chan_array,
-      1,
-      &stream_args_to_set)) == NULL) {
-#endif
-    SU_ERROR(
-        "Failed to open RX stream on SDR device: %s\n",
-        SoapySDRDevice_lastError());
-    goto done;
+      self->rx_stream) > 0) {
+      self->direct = SU_TRUE;
+      SU_INFO(
+        "SoapySDR: reading %s samples through direct buffer access\n",
+        self->format);
+    } else {
+      SoapySDRDevice_closeStream(self->sdr, self->rx_stream);
+      self->rx_stream     = NULL;
+      self->sample_format = SUSCAN_SOURCE_SOAPYSDR_FORMAT_COMPLEX;
+    }
+  }
+
+  /* No direct access, let SoapySDR convert samples for us */
+  if (!self->direct) {
+    self->format = SUSCAN_SOAPY_SAMPFMT;
+    if (!suscan_source_soapysdr_setup_stream(
+      self,
+      self->format,
+      &stream_args_to_set))
+      goto done;
   }
 
   SoapySDRKwargs_clear(&stream_args_to_set);
@@ -369,6 +473,8 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
             SoapySDRDevice_lastError());
           goto done;
         }
+      } else if (strcmp(key, "direct") == 0) {
+        /* Handled when the stream was set up */
       } else {
         SU_ERROR("Unknown SoapySDR-specific tweak `%s'\n", key);
         goto done;
@@ -390,6 +496,9 @@ suscan_source_soapysdr_init_sdr(struct suscan_source_soapysdr *self)
   ok = SU_TRUE;
 
 done:
+  if (format != NULL)
+    free(format);
+
   if (all_params != NULL)
     SU_DISPOSE(strmap, all_params);
   
@@ -402,8 +511,14 @@ suscan_source_soapysdr_close(void *ptr)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) ptr;
 
-  if (self->rx_stream != NULL)
+  if (self->rx_stream != NULL) {
+    if (self->dma_acquired)
+      SoapySDRDevice_releaseReadBuffer(
+        self->sdr,
+        self->rx_stream,
+        self->dma_handle);
     SoapySDRDevice_closeStream(self->sdr, self->rx_stream);
+  }
 
   if (self->settings != NULL)
     SoapySDRArgInfoList_clear(self->settings, self->settings_count);
@@ -600,10 +715,172 @@ suscan_source_soapysdr_start(void *userdata)
   return SU_TRUE;
 }
 
+/*
+ * Direct access reads take samples straight from the driver buffers.
+ * The driver buffer is held until it is consumed, and released on the
+ * next read: native reads hand out pointers into it.
+ */
 SUPRIVATE SUSDIFF
-suscan_source_soapysdr_read(
+suscan_source_soapysdr_acquire(struct suscan_source_soapysdr *self)
+{
+  int result;
+  int flags = 0;
+  long long timeNs = 0;
+
+  if (self->dma_acquired && self->dma_ptr == self->dma_avail) {
+    SoapySDRDevice_releaseReadBuffer(
+      self->sdr,
+      self->rx_stream,
+      self->dma_handle);
+    self->dma_acquired = SU_FALSE;
+  }
+
+  while (!self->dma_acquired) {
+    if (self->force_eos)
+      return 0;
+
+    result = SoapySDRDevice_acquireReadBuffer(
+          self->sdr,
+          self->rx_stream,
+          &self->dma_handle,
+          self->dma_buffs,
+          &flags,
+          &timeNs,
+          SUSCAN_SOURCE_DEFAULT_READ_TIMEOUT);
+
+    /* Empty buffers are still acquired, and must be given back */
+    if (result == 0) {
+      SoapySDRDevice_releaseReadBuffer(
+        self->sdr,
+        self->rx_stream,
+        self->dma_handle);
+      continue;
+    }
+
+    if (result == SOAPY_SDR_TIMEOUT
+        || result == SOAPY_SDR_OVERFLOW
+        || result == SOAPY_SDR_UNDERFLOW)
+      continue;
+
+    if (result < 0) {
+      SU_ERROR(
+          "Failed to acquire stream buffer: %s (result %d)\n",
+          SoapySDR_errToStr(result),
+          result);
+      return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
+    }
+
+    self->dma_avail    = result;
+    self->dma_ptr      = 0;
+    self->dma_acquired = SU_TRUE;
+  }
+
+  return self->dma_avail - self->dma_ptr;
+}
+
+SUPRIVATE SUSDIFF
+suscan_source_soapysdr_read_direct(
+  struct suscan_source_soapysdr *self,
+  SUCOMPLEX *const *buffers,
+  unsigned int count,
+  SUSCOUNT max)
+{
+  SUSDIFF avail;
+  unsigned int i;
+  SUSCOUNT chunk;
+  const uint8_t *src;
+
+  if ((avail = suscan_source_soapysdr_acquire(self)) < 1)
+    return avail;
+
+  chunk = MIN(max, (SUSCOUNT) avail);
+
+  for (i = 0; i < count; ++i) {
+    src = (const uint8_t *) self->dma_buffs[i];
+
+    if (self->sample_format == SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16)
+      suscan_convert_cs16(
+        buffers[i],
+        (const int16_t *) src + 2 * self->dma_ptr,
+        self->scale,
+        chunk);
+    else if (self->sample_format == SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8)
+      suscan_convert_cs8(
+        buffers[i],
+        (const int8_t *) src + 2 * self->dma_ptr,
+        self->scale,
+        chunk);
+    else
+      memcpy(
+        buffers[i],
+        (const SUCOMPLEX *) src + self->dma_ptr,
+        chunk * sizeof(SUCOMPLEX));
+  }
+
+  self->dma_ptr += chunk;
+
+  return chunk;
+}
+
+/* Integer samples, left as they are in the driver buffer */
+SUPRIVATE SUSDIFF
+suscan_source_soapysdr_read_native(
   void *userdata,
-  SUCOMPLEX *buf,
+  const void **data,
+  void *buffer,
+  SUSCOUNT max)
+{
+  struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  SUSDIFF avail;
+  SUSCOUNT chunk;
+  size_t size;
+
+  if ((avail = suscan_source_soapysdr_acquire(self)) < 1)
+    return avail;
+
+  size  = self->sample_format == SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16 ? 4 : 2;
+  chunk = MIN(max, (SUSCOUNT) avail);
+
+  *data = (const uint8_t *) self->dma_buffs[0] + self->dma_ptr * size;
+  self->dma_ptr += chunk;
+
+  return chunk;
+}
+
+SUPRIVATE SUBOOL
+suscan_source_soapysdr_get_native_format(
+  void *userdata,
+  enum suscan_source_format *format,
+  SUFLOAT *scale)
+{
+  struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+
+  if (!self->direct)
+    return SU_FALSE;
+
+  switch (self->sample_format) {
+    case SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16:
+      *format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED16;
+      break;
+
+    case SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8:
+      *format = SUSCAN_SOURCE_FORMAT_RAW_SIGNED8;
+      break;
+
+    default:
+      return SU_FALSE;
+  }
+
+  *scale = self->scale;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUSDIFF
+suscan_source_soapysdr_read_multi(
+  void *userdata,
+  SUCOMPLEX *const *buffers,
+  unsigned int count,
   SUSCOUNT max)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
@@ -612,6 +889,9 @@ suscan_source_soapysdr_read(
   long long timeNs = 0;
   SUBOOL retry;
 
+  if (self->direct)
+    return suscan_source_soapysdr_read_direct(self, buffers, count, max);
+
   do {
     retry = SU_FALSE;
     if (self->force_eos)
@@ -620,7 +900,7 @@ suscan_source_soapysdr_read(
       result = SoapySDRDevice_readStream(
           self->sdr,
           self->rx_stream,
-          (void * const*) &buf,
+          (void * const*) buffers,
           max,
           &flags,
           &timeNs,
@@ -645,6 +925,23 @@ suscan_source_soapysdr_read(
   return result;
 }
 
+SUPRIVATE SUSDIFF
+suscan_source_soapysdr_read(
+  void *userdata,
+  SUCOMPLEX *buf,
+  SUSCOUNT max)
+{
+  struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+
+  /* The stream expects one buffer per channel, see read_multi */
+  if (self->chan_count > 1) {
+    SU_ERROR("Single-buffer read from a multi-channel SoapySDR stream\n");
+    return SU_BLOCK_PORT_READ_ERROR_ACQUIRE;
+  }
+
+  return suscan_source_soapysdr_read_multi(userdata, &buf, 1, max);
+}
+
 SUPRIVATE void
 suscan_source_soapysdr_get_time(void *userdata, struct timeval *tv)
 {
@@ -675,17 +972,19 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_frequency(void *userdata, SUFREQ freq)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
   /* Set device frequency */
-  if (SoapySDRDevice_setFrequency(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      freq,
-      NULL) != 0) {
-    SU_ERROR("Failed to set SDR frequency: %s\n", SoapySDRDevice_lastError());
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setFrequency(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        freq,
+        NULL) != 0) {
+      SU_ERROR("Failed to set SDR frequency: %s\n", SoapySDRDevice_lastError());
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -694,20 +993,22 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_gain(void *userdata, const char *name, SUFLOAT gain)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
   /* Set gain element */
-  if (SoapySDRDevice_setGainElement(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      name,
-      gain) != 0) {
-    SU_ERROR(
-        "Failed to set SDR gain `%s': %s\n",
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setGainElement(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
         name,
-        SoapySDRDevice_lastError());
-    return SU_FALSE;
-  }
+        gain) != 0) {
+      SU_ERROR(
+          "Failed to set SDR gain `%s': %s\n",
+          name,
+          SoapySDRDevice_lastError());
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -716,19 +1017,21 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_antenna(void *userdata, const char *name)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
   /* Set antenna */
-  if (SoapySDRDevice_setAntenna(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      name) != 0) {
-    SU_ERROR(
-        "Failed to set SDR antenna `%s': %s\n",
-        name,
-        SoapySDRDevice_lastError());
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setAntenna(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        name) != 0) {
+      SU_ERROR(
+          "Failed to set SDR antenna `%s': %s\n",
+          name,
+          SoapySDRDevice_lastError());
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -737,18 +1040,20 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_bandwidth(void *userdata, SUFLOAT bw)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
   /* Set device bandwidth */
-  if (SoapySDRDevice_setBandwidth(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      bw) != 0) {
-    SU_ERROR(
-        "Failed to set SDR bandwidth: %s\n",
-        SoapySDRDevice_lastError());
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setBandwidth(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        bw) != 0) {
+      SU_ERROR(
+          "Failed to set SDR bandwidth: %s\n",
+          SoapySDRDevice_lastError());
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -757,19 +1062,21 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_ppm(void *userdata, SUFLOAT ppm)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
   /* Set ppm correction */
 #if SOAPY_SDR_API_VERSION >= 0x00060000
-  if (SoapySDRDevice_setFrequencyCorrection(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      ppm) != 0) {
-    SU_ERROR(
-        "Failed to set SDR frequency correction: %s\n",
-        SoapySDRDevice_lastError());
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setFrequencyCorrection(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        ppm) != 0) {
+      SU_ERROR(
+          "Failed to set SDR frequency correction: %s\n",
+          SoapySDRDevice_lastError());
+      return SU_FALSE;
+    }
 #else
   SU_WARNING(
       "SoapySDR "
@@ -784,16 +1091,18 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_dc_remove(void *userdata, SUBOOL remove)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
-  if (SoapySDRDevice_setDCOffsetMode(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      remove ? true : false)
-      != 0) {
-    SU_ERROR("Failed to set DC mode\n");
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setDCOffsetMode(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        remove ? true : false)
+        != 0) {
+      SU_ERROR("Failed to set DC mode\n");
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -802,16 +1111,18 @@ SUPRIVATE SUBOOL
 suscan_source_soapysdr_set_agc(void *userdata, SUBOOL set)
 {
   struct suscan_source_soapysdr *self = (struct suscan_source_soapysdr *) userdata;
+  unsigned int i;
 
-  if (SoapySDRDevice_setGainMode(
-      self->sdr,
-      SOAPY_SDR_RX,
-      self->config->channel,
-      set ? true : false)
-      != 0) {
-    SU_ERROR("Failed to set AGC\n");
-    return SU_FALSE;
-  }
+  for (i = 0; i < self->chan_count; ++i)
+    if (SoapySDRDevice_setGainMode(
+        self->sdr,
+        SOAPY_SDR_RX,
+        self->chan_array[i],
+        set ? true : false)
+        != 0) {
+      SU_ERROR("Failed to set AGC\n");
+      return SU_FALSE;
+    }
 
   return SU_TRUE;
 }
@@ -848,6 +1159,9 @@ SUPRIVATE struct suscan_source_interface g_soapysdr_source =
   .start           = suscan_source_soapysdr_start,
   .cancel          = suscan_source_soapysdr_cancel,
   .read            = suscan_source_soapysdr_read,
+  .read_multi      = suscan_source_soapysdr_read_multi,
+  .get_native_format = suscan_source_soapysdr_get_native_format,
+  .read_native     = suscan_source_soapysdr_read_native,
   .set_frequency   = suscan_source_soapysdr_set_frequency,
   .set_gain        = suscan_source_soapysdr_set_gain,
   .set_antenna     = suscan_source_soapysdr_set_antenna,
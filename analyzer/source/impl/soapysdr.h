@@ -25,12 +25,19 @@
 #include <SoapySDR/Device.h>
 #include <SoapySDR/Formats.h>
 #include <SoapySDR/Version.h>
+#include <analyzer/source/config.h>
 
 /* SDR sources are accessed through SoapySDR */
 
 struct suscan_source_config;
 struct suscan_source;
 
+enum suscan_source_soapysdr_format {
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_COMPLEX,
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS16,
+  SUSCAN_SOURCE_SOAPYSDR_FORMAT_CS8
+};
+
 struct suscan_source_soapysdr {
   struct suscan_source_config *config;
   struct suscan_source        *source;
@@ -45,10 +52,22 @@ struct suscan_source_soapysdr {
   char           **clock_sources;
   size_t           clock_sources_count;
   
-  size_t chan_array[1];
+  size_t chan_array[SUSCAN_SOURCE_MAX_CHANNELS];
+  size_t chan_count;
   SUFLOAT samp_rate; /* Actual sample rate */
   size_t mtu;
 
+  /* Direct buffer access: samples are converted from the driver buffers */
+  SUBOOL       direct;
+  const char  *format;
+  enum suscan_source_soapysdr_format sample_format;
+  SUFLOAT      scale;
+  size_t       dma_handle;
+  const void  *dma_buffs[SUSCAN_SOURCE_MAX_CHANNELS];
+  SUSCOUNT     dma_avail;
+  SUSCOUNT     dma_ptr;
+  SUBOOL       dma_acquired;
+
   /* To prevent source from looping forever */
   SUBOOL force_eos;
   SUBOOL have_dc;
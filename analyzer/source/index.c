@@ -0,0 +1,677 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define _FILE_OFFSET_BITS 64
+
+#define SU_LOG_DOMAIN "capture-index"
+
+#include "index.h"
+#include <sigutils/log.h>
+#include <sigutils/util/util.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef _WIN32
+#  include <sys/file.h>
+#endif /* _WIN32 */
+
+char *
+suscan_capture_index_path_for(const char *data_path)
+{
+  return strbuild("%s%s", data_path, SUSCAN_CAPTURE_INDEX_EXTENSION);
+}
+
+/* Timestamp of a sample, counted from a given time reference */
+SUPRIVATE void
+suscan_capture_index_advance(
+  const struct timeval *start,
+  SUSCOUNT samples,
+  SUFLOAT samp_rate,
+  struct timeval *tv)
+{
+  struct timeval elapsed;
+  uint64_t usec;
+
+  if (samp_rate <= 0) {
+    *tv = *start;
+    return;
+  }
+
+  usec = (uint64_t) (1e6 * (samples / (double) samp_rate));
+
+  elapsed.tv_sec  = usec / 1000000;
+  elapsed.tv_usec = usec % 1000000;
+
+  timeradd(start, &elapsed, tv);
+}
+
+SUINLINE void
+suscan_capture_index_entry_get_time(
+  const struct suscan_capture_index_entry *entry,
+  struct timeval *tv)
+{
+  tv->tv_sec  = entry->tv_sec;
+  tv->tv_usec = entry->tv_usec;
+}
+
+/******************************* Index writer *********************************/
+SUPRIVATE SUBOOL
+suscan_capture_index_writer_on_psd(
+  void *userdata,
+  const SUFLOAT *psd,
+  unsigned int size)
+{
+  suscan_capture_index_writer_t *self =
+    (suscan_capture_index_writer_t *) userdata;
+
+  if (size == self->params.psd_bins) {
+    memcpy(self->last_psd, psd, size * sizeof(SUFLOAT));
+    self->have_psd = SU_TRUE;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_capture_index_writer_emit(suscan_capture_index_writer_t *self)
+{
+  struct suscan_capture_index_entry *entry = self->entry;
+  float *psd = (float *) (entry + 1);
+  struct timeval start;
+  unsigned int i;
+
+  if (entry->samples == 0)
+    return SU_TRUE;
+
+  entry->power = self->power_acc / entry->samples;
+  entry->peak  = self->peak;
+
+  for (i = 0; i < self->params.psd_bins; ++i)
+    psd[i] = self->have_psd ? self->last_psd[i] : 0;
+
+  if (fwrite(entry, self->entry_size, 1, self->fp) != 1
+    || (self->params.live && fflush(self->fp) != 0)) {
+    SU_ERROR("Failed to write capture index entry: %s\n", strerror(errno));
+    return SU_FALSE;
+  }
+
+  ++self->header.entry_count;
+
+  /* Unless told otherwise, the next entry follows this one */
+  suscan_capture_index_entry_get_time(entry, &start);
+  suscan_capture_index_advance(
+    &start,
+    entry->samples,
+    self->params.samp_rate,
+    &self->next_time);
+
+  entry->samples  = 0;
+  self->power_acc = 0;
+  self->peak      = 0;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_capture_index_writer_start_entry(suscan_capture_index_writer_t *self)
+{
+  struct suscan_capture_index_entry *entry = self->entry;
+
+  entry->sample      = self->next_sample;
+  entry->byte_offset = 0;
+  entry->tv_sec      = self->next_time.tv_sec;
+  entry->tv_usec     = self->next_time.tv_usec;
+  entry->samples     = 0;
+
+  if (self->params.frame_bytes > 0)
+    entry->byte_offset = self->params.data_offset
+      + (self->next_sample / self->params.frame_samples)
+      * self->params.frame_bytes;
+}
+
+SU_METHOD(
+  suscan_capture_index_writer,
+  SUBOOL,
+  feed,
+  const SUCOMPLEX *data,
+  SUSCOUNT len,
+  SUSCOUNT first_sample,
+  const struct timeval *first_time)
+{
+  struct suscan_capture_index_entry *entry = self->entry;
+  SUSCOUNT i, chunk;
+  SUFLOAT power;
+  SUBOOL ok = SU_FALSE;
+
+  if (first_time != NULL || first_sample != self->next_sample) {
+    SU_TRY(suscan_capture_index_writer_emit(self));
+
+    if (first_time != NULL)
+      self->next_time = *first_time;
+
+    self->next_sample = first_sample;
+
+    /* Do not describe the new segment with the PSD of the previous one */
+    self->have_psd = SU_FALSE;
+  }
+
+  while (len > 0) {
+    if (entry->samples == 0)
+      suscan_capture_index_writer_start_entry(self);
+
+    chunk = SU_MIN(len, self->params.block_samples - entry->samples);
+
+    for (i = 0; i < chunk; ++i) {
+      power = SU_C_REAL(data[i] * SU_C_CONJ(data[i]));
+      self->power_acc += power;
+      if (power > self->peak)
+        self->peak = power;
+    }
+
+    SU_TRY(su_smoothpsd_feed(self->smooth_psd, data, chunk));
+
+    entry->samples    += chunk;
+    self->next_sample += chunk;
+    data              += chunk;
+    len               -= chunk;
+
+    if (entry->samples == self->params.block_samples)
+      SU_TRY(suscan_capture_index_writer_emit(self));
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SU_METHOD(suscan_capture_index_writer, SUBOOL, finish, uint64_t data_size)
+{
+  SUBOOL ok = SU_FALSE;
+
+  if (self->fp == NULL)
+    return SU_TRUE;
+
+  SU_TRY(suscan_capture_index_writer_emit(self));
+
+  self->header.data_size = data_size;
+
+  SU_TRYC(fseeko(self->fp, 0, SEEK_SET));
+  SU_TRY(
+    fwrite(
+      &self->header,
+      sizeof(struct suscan_capture_index_header),
+      1,
+      self->fp) == 1);
+
+  ok = SU_TRUE;
+
+done:
+  if (fclose(self->fp) != 0)
+    ok = SU_FALSE;
+
+  self->fp = NULL;
+
+  /* Live indices are already in place */
+  if (self->tmp_path == NULL)
+    return ok;
+
+  if (ok && rename(self->tmp_path, self->path) == -1) {
+    SU_ERROR(
+      "Cannot move capture index to `%s': %s\n",
+      self->path,
+      strerror(errno));
+    ok = SU_FALSE;
+  }
+
+  if (!ok)
+    unlink(self->tmp_path);
+
+  return ok;
+}
+
+/* Returns -1 if someone else holds the lock */
+SUPRIVATE int
+suscan_capture_index_writer_lock(const char *path)
+{
+  char *lock_path = NULL;
+  int fd = -1;
+
+  SU_TRY(lock_path = strbuild("%s%s", path, SUSCAN_CAPTURE_INDEX_LOCK_EXTENSION));
+
+  if ((fd = open(lock_path, O_RDWR | O_CREAT, 0644)) == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", lock_path, strerror(errno));
+    goto done;
+  }
+
+#ifndef _WIN32
+  if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+    if (errno == EWOULDBLOCK)
+      SU_INFO("Capture index `%s' is being built elsewhere\n", path);
+    else
+      SU_ERROR("Cannot lock `%s': %s\n", lock_path, strerror(errno));
+
+    close(fd);
+    fd = -1;
+  }
+#endif /* _WIN32 */
+
+done:
+  if (lock_path != NULL)
+    free(lock_path);
+
+  return fd;
+}
+
+SU_INSTANCER(
+  suscan_capture_index_writer,
+  const char *path,
+  const struct suscan_capture_index_params *params)
+{
+  suscan_capture_index_writer_t *new = NULL;
+  struct sigutils_smoothpsd_params sp_params =
+      sigutils_smoothpsd_params_INITIALIZER;
+  int fd = -1;
+
+  if (params->block_samples == 0 || params->block_samples > UINT32_MAX) {
+    SU_ERROR("Invalid capture index block size\n");
+    goto fail;
+  }
+
+  if (params->psd_bins == 0 || params->samp_rate <= 0) {
+    SU_ERROR("Invalid capture index parameters\n");
+    goto fail;
+  }
+
+  SU_ALLOCATE_FAIL(new, suscan_capture_index_writer_t);
+
+  new->lock_fd = -1;
+  if ((new->lock_fd = suscan_capture_index_writer_lock(path)) == -1)
+    goto fail;
+
+  SU_TRY_FAIL(new->path = strdup(path));
+  if (!params->live)
+    SU_TRY_FAIL(new->tmp_path = strbuild("%s.XXXXXX", path));
+
+  new->params = *params;
+  if (new->params.frame_samples == 0)
+    new->params.frame_bytes = 0;
+
+  new->entry_size =
+    sizeof(struct suscan_capture_index_entry)
+    + params->psd_bins * sizeof(float);
+
+  SU_ALLOCATE_MANY_FAIL(new->last_psd, params->psd_bins, SUFLOAT);
+  SU_TRY_FAIL(new->entry = calloc(1, new->entry_size));
+
+  sp_params.fft_size     = params->psd_bins;
+  sp_params.samp_rate    = params->samp_rate;
+  sp_params.refresh_rate = params->samp_rate / params->block_samples;
+
+  SU_MAKE_FAIL(
+    new->smooth_psd,
+    su_smoothpsd,
+    &sp_params,
+    suscan_capture_index_writer_on_psd,
+    new);
+
+  new->header.magic         = SUSCAN_CAPTURE_INDEX_MAGIC;
+  new->header.version       = SUSCAN_CAPTURE_INDEX_VERSION;
+  new->header.entry_size    = new->entry_size;
+  new->header.psd_bins      = params->psd_bins;
+  new->header.block_samples = params->block_samples;
+  new->header.samp_rate     = params->samp_rate;
+  new->header.start_sec     = params->start_time.tv_sec;
+  new->header.start_usec    = params->start_time.tv_usec;
+
+  new->next_time = params->start_time;
+
+  if (params->live) {
+    if ((new->fp = fopen(path, "wb")) == NULL) {
+      SU_ERROR(
+        "Cannot create capture index `%s': %s\n",
+        path,
+        strerror(errno));
+      goto fail;
+    }
+  } else {
+    if ((fd = mkstemp(new->tmp_path)) == -1
+      || (new->fp = fdopen(fd, "wb")) == NULL) {
+      SU_ERROR(
+        "Cannot create capture index `%s': %s\n",
+        path,
+        strerror(errno));
+      if (fd != -1) {
+        close(fd);
+        unlink(new->tmp_path);
+      }
+      goto fail;
+    }
+
+    /* mkstemp creates files only readable by their owner */
+    (void) fchmod(fd, 0644);
+  }
+
+  /* Placeholder, completed by finish() */
+  SU_TRY_FAIL(
+    fwrite(
+      &new->header,
+      sizeof(struct suscan_capture_index_header),
+      1,
+      new->fp) == 1);
+
+  if (params->live)
+    SU_TRYC_FAIL(fflush(new->fp));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_capture_index_writer_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_capture_index_writer)
+{
+  /*
+   * Unfinished indices are discarded, and rebuilt when opened. Live ones
+   * are left as they are: readers use their complete entries until then.
+   */
+  if (self->fp != NULL) {
+    fclose(self->fp);
+    if (self->tmp_path != NULL)
+      unlink(self->tmp_path);
+  }
+
+  if (self->tmp_path != NULL)
+    free(self->tmp_path);
+
+  if (self->path != NULL)
+    free(self->path);
+
+  /* Closing the descriptor releases the lock */
+  if (self->lock_fd != -1)
+    close(self->lock_fd);
+
+  if (self->smooth_psd != NULL)
+    su_smoothpsd_destroy(self->smooth_psd);
+
+  if (self->last_psd != NULL)
+    free(self->last_psd);
+
+  if (self->entry != NULL)
+    free(self->entry);
+
+  free(self);
+}
+
+/******************************** Index reader ********************************/
+SU_GETTER(suscan_capture_index, SUSCOUNT, get_entry_count)
+{
+  return self->entry_count;
+}
+
+SU_GETTER(suscan_capture_index, unsigned int, get_psd_bins)
+{
+  return self->header.psd_bins;
+}
+
+SU_GETTER(
+  suscan_capture_index,
+  const struct suscan_capture_index_entry *,
+  get_entry,
+  SUSCOUNT index)
+{
+  if (index >= self->entry_count)
+    return NULL;
+
+  return (const struct suscan_capture_index_entry *)
+    (self->entries + index * self->header.entry_size);
+}
+
+SU_GETTER(suscan_capture_index, const float *, get_psd, SUSCOUNT index)
+{
+  const struct suscan_capture_index_entry *entry;
+
+  if ((entry = suscan_capture_index_get_entry(self, index)) == NULL)
+    return NULL;
+
+  return (const float *) (entry + 1);
+}
+
+SU_GETTER(suscan_capture_index, SUBOOL, is_fresh, uint64_t data_size)
+{
+  return self->header.entry_count > 0 && self->header.data_size == data_size;
+}
+
+/* Last entry that starts at or before the given sample */
+SUPRIVATE SUSDIFF
+suscan_capture_index_find_sample(
+  const suscan_capture_index_t *self,
+  SUSCOUNT sample)
+{
+  SUSDIFF lo = 0, hi = (SUSDIFF) self->entry_count - 1, mid, found = -1;
+
+  while (lo <= hi) {
+    mid = lo + (hi - lo) / 2;
+    if (suscan_capture_index_get_entry(self, mid)->sample <= sample) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  return found;
+}
+
+/* Last entry that starts at or before the given time */
+SUPRIVATE SUSDIFF
+suscan_capture_index_find_time(
+  const suscan_capture_index_t *self,
+  const struct timeval *tv)
+{
+  SUSDIFF lo = 0, hi = (SUSDIFF) self->entry_count - 1, mid, found = -1;
+  struct timeval start;
+
+  while (lo <= hi) {
+    mid = lo + (hi - lo) / 2;
+    suscan_capture_index_entry_get_time(
+      suscan_capture_index_get_entry(self, mid),
+      &start);
+
+    if (!timercmp(&start, tv, >)) {
+      found = mid;
+      lo = mid + 1;
+    } else {
+      hi = mid - 1;
+    }
+  }
+
+  return found;
+}
+
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_time,
+  SUSCOUNT sample,
+  struct timeval *tv)
+{
+  const struct suscan_capture_index_entry *entry;
+  struct timeval start;
+  SUSDIFF index;
+
+  if ((index = suscan_capture_index_find_sample(self, sample)) == -1)
+    return SU_FALSE;
+
+  entry = suscan_capture_index_get_entry(self, index);
+  suscan_capture_index_entry_get_time(entry, &start);
+  suscan_capture_index_advance(
+    &start,
+    sample - entry->sample,
+    self->header.samp_rate,
+    tv);
+
+  return SU_TRUE;
+}
+
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_sample,
+  const struct timeval *tv,
+  SUSCOUNT *sample)
+{
+  const struct suscan_capture_index_entry *entry;
+  struct timeval start, diff;
+  SUSCOUNT offset;
+  SUSDIFF index;
+
+  if (self->entry_count == 0)
+    return SU_FALSE;
+
+  /* Before the first entry: go to the beginning */
+  if ((index = suscan_capture_index_find_time(self, tv)) == -1)
+    index = 0;
+
+  entry = suscan_capture_index_get_entry(self, index);
+  suscan_capture_index_entry_get_time(entry, &start);
+
+  offset = 0;
+  if (timercmp(tv, &start, >)) {
+    timersub(tv, &start, &diff);
+    offset = (diff.tv_sec + 1e-6 * diff.tv_usec) * self->header.samp_rate;
+  }
+
+  /* Times inside a gap map to the start of the next entry */
+  *sample = entry->sample + SU_MIN(offset, entry->samples);
+
+  return SU_TRUE;
+}
+
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_offset,
+  SUSCOUNT sample,
+  SUSCOUNT *entry_sample,
+  uint64_t *byte_offset)
+{
+  const struct suscan_capture_index_entry *entry;
+  SUSDIFF index;
+
+  if ((index = suscan_capture_index_find_sample(self, sample)) == -1)
+    return SU_FALSE;
+
+  entry = suscan_capture_index_get_entry(self, index);
+
+  /* Only the first entry may legitimately start at byte 0 */
+  if (entry->byte_offset == 0 && entry->sample != 0)
+    return SU_FALSE;
+
+  *entry_sample = entry->sample;
+  *byte_offset  = entry->byte_offset;
+
+  return SU_TRUE;
+}
+
+SU_INSTANCER(suscan_capture_index, const char *path)
+{
+  suscan_capture_index_t *new = NULL;
+  FILE *fp = NULL;
+  off_t size;
+  size_t expected;
+
+  if ((fp = fopen(path, "rb")) == NULL)
+    goto fail;
+
+  SU_ALLOCATE_FAIL(new, suscan_capture_index_t);
+
+  SU_TRY_FAIL(
+    fread(
+      &new->header,
+      sizeof(struct suscan_capture_index_header),
+      1,
+      fp) == 1);
+
+  expected =
+    sizeof(struct suscan_capture_index_entry)
+    + new->header.psd_bins * sizeof(float);
+
+  if (new->header.magic != SUSCAN_CAPTURE_INDEX_MAGIC
+    || new->header.version != SUSCAN_CAPTURE_INDEX_VERSION
+    || new->header.entry_size != expected
+    || new->header.samp_rate <= 0) {
+    SU_WARNING("`%s' is not a valid capture index\n", path);
+    goto fail;
+  }
+
+  /* Unfinished index: use every complete entry */
+  new->entry_count = new->header.entry_count;
+  if (new->entry_count == 0) {
+    SU_TRYC_FAIL(fseeko(fp, 0, SEEK_END));
+    SU_TRYC_FAIL(size = ftello(fp));
+    SU_TRYC_FAIL(
+      fseeko(fp, sizeof(struct suscan_capture_index_header), SEEK_SET));
+
+    new->entry_count =
+      (size - sizeof(struct suscan_capture_index_header))
+      / new->header.entry_size;
+  }
+
+  if (new->entry_count > 0) {
+    SU_ALLOCATE_MANY_FAIL(
+      new->entries,
+      new->entry_count * new->header.entry_size,
+      uint8_t);
+
+    SU_TRY_FAIL(
+      fread(
+        new->entries,
+        new->header.entry_size,
+        new->entry_count,
+        fp) == new->entry_count);
+  }
+
+  fclose(fp);
+
+  return new;
+
+fail:
+  if (fp != NULL)
+    fclose(fp);
+
+  if (new != NULL)
+    suscan_capture_index_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_capture_index)
+{
+  if (self->entries != NULL)
+    free(self->entries);
+
+  free(self);
+}
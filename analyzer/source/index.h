@@ -0,0 +1,218 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_SOURCE_INDEX_H
+#define _ANALYZER_SOURCE_INDEX_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <sigutils/smoothpsd.h>
+#include <sigutils/util/compat-time.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Capture indices are sidecar files that summarize a capture file in
+ * fixed-size entries, each one describing a block of consecutive samples:
+ * where it starts (sample, byte offset in the data file and timestamp) and
+ * a coarse summary of its contents (mean and peak power, and a low
+ * resolution PSD). They let us translate between sample positions and
+ * timestamps of captures with gaps, and draw an overview of huge files
+ * without reading them.
+ *
+ * Indices are written incrementally by the recorder, or built in the
+ * background by the file source the first time a capture is opened.
+ * Writers hold an exclusive lock on a .lock sidecar while they run, and
+ * write to a temporary file that replaces the index once finished, so
+ * readers never see a partially written index.
+ *
+ * The recorder is the exception: its writer is live, and appends entries
+ * to the index itself as the capture grows, so captures can be opened
+ * while they are being recorded. Live indices have entry_count == 0 until
+ * finished, and readers use their complete entries only.
+ */
+
+#define SUSCAN_CAPTURE_INDEX_MAGIC           0x58444953 /* "SIDX" */
+#define SUSCAN_CAPTURE_INDEX_VERSION         1
+#define SUSCAN_CAPTURE_INDEX_EXTENSION       ".sidx"
+#define SUSCAN_CAPTURE_INDEX_LOCK_EXTENSION  ".lock"
+#define SUSCAN_CAPTURE_INDEX_DEFAULT_BLOCK   (1 << 20) /* Samples */
+#define SUSCAN_CAPTURE_INDEX_DEFAULT_PSD_BINS 32
+
+struct suscan_capture_index_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_size;
+  uint32_t psd_bins;
+  uint64_t block_samples;
+  uint64_t entry_count;  /* 0 if the writer did not finish */
+  uint64_t data_size;    /* Size of the data file when indexed */
+  double   samp_rate;
+  int64_t  start_sec;
+  uint32_t start_usec;
+  uint32_t reserved;
+};
+
+struct suscan_capture_index_entry {
+  uint64_t sample;       /* First sample of the entry */
+  uint64_t byte_offset;  /* Start of the frame holding it, 0 if unknown */
+  int64_t  tv_sec;       /* Timestamp of the first sample */
+  uint32_t tv_usec;
+  uint32_t samples;      /* Usually block_samples, less on discontinuities */
+  float    power;        /* Mean power */
+  float    peak;         /* Peak power */
+  /* Followed by psd_bins floats, as delivered by su_smoothpsd */
+};
+
+struct suscan_capture_index_params {
+  SUFLOAT        samp_rate;
+  struct timeval start_time;
+  SUSCOUNT       block_samples;
+  unsigned int   psd_bins;
+
+  /* Layout of the data file, to compute byte offsets */
+  uint64_t       data_offset;
+  uint64_t       frame_bytes;    /* 0 if the layout is not known */
+  SUSCOUNT       frame_samples;
+
+  /* Write in place, flushing every entry. For captures being recorded. */
+  SUBOOL         live;
+};
+
+#define suscan_capture_index_params_INITIALIZER                 \
+{                                                               \
+  0,                                     /* samp_rate */        \
+  {0, 0},                                /* start_time */       \
+  SUSCAN_CAPTURE_INDEX_DEFAULT_BLOCK,    /* block_samples */    \
+  SUSCAN_CAPTURE_INDEX_DEFAULT_PSD_BINS, /* psd_bins */         \
+  0,                                     /* data_offset */      \
+  0,                                     /* frame_bytes */      \
+  1,                                     /* frame_samples */    \
+  SU_FALSE,                              /* live */             \
+}
+
+/* Index file path for a given data file. Must be freed by the caller. */
+char *suscan_capture_index_path_for(const char *data_path);
+
+/******************************* Index writer *********************************/
+struct suscan_capture_index_writer {
+  struct suscan_capture_index_params params;
+  struct suscan_capture_index_header header;
+  FILE          *fp;
+  char          *path;
+  char          *tmp_path;
+  int            lock_fd;
+
+  su_smoothpsd_t *smooth_psd;
+  SUFLOAT        *last_psd;
+  SUBOOL          have_psd;
+
+  struct suscan_capture_index_entry *entry; /* Entry being accumulated */
+  size_t         entry_size;
+  SUSCOUNT       next_sample;
+  struct timeval next_time;
+  SUFLOAT        power_acc;
+  SUFLOAT        peak;
+};
+
+typedef struct suscan_capture_index_writer suscan_capture_index_writer_t;
+
+/* Fails if another writer (in any process) is building the same index */
+SU_INSTANCER(
+  suscan_capture_index_writer,
+  const char *path,
+  const struct suscan_capture_index_params *params);
+SU_COLLECTOR(suscan_capture_index_writer);
+
+/*
+ * Adds samples to the index. first_time must be given for the first samples
+ * and after every time discontinuity, and can be NULL otherwise.
+ */
+SU_METHOD(
+  suscan_capture_index_writer,
+  SUBOOL,
+  feed,
+  const SUCOMPLEX *data,
+  SUSCOUNT len,
+  SUSCOUNT first_sample,
+  const struct timeval *first_time);
+
+/* Writes the last entry, completes the header and moves the index in place */
+SU_METHOD(suscan_capture_index_writer, SUBOOL, finish, uint64_t data_size);
+
+/******************************** Index reader ********************************/
+struct suscan_capture_index {
+  struct suscan_capture_index_header header;
+  uint8_t *entries;
+  SUSCOUNT entry_count;
+};
+
+typedef struct suscan_capture_index suscan_capture_index_t;
+
+SU_INSTANCER(suscan_capture_index, const char *path);
+SU_COLLECTOR(suscan_capture_index);
+
+SU_GETTER(suscan_capture_index, SUSCOUNT, get_entry_count);
+SU_GETTER(suscan_capture_index, unsigned int, get_psd_bins);
+SU_GETTER(
+  suscan_capture_index,
+  const struct suscan_capture_index_entry *,
+  get_entry,
+  SUSCOUNT index);
+SU_GETTER(suscan_capture_index, const float *, get_psd, SUSCOUNT index);
+
+/* True if the index was finished for a data file of this size */
+SU_GETTER(suscan_capture_index, SUBOOL, is_fresh, uint64_t data_size);
+
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_time,
+  SUSCOUNT sample,
+  struct timeval *tv);
+
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_sample,
+  const struct timeval *tv,
+  SUSCOUNT *sample);
+
+/*
+ * Entry holding a given sample: its first sample, and the byte offset of
+ * the data frame holding that sample. Fails if the index does not know
+ * the byte layout of the data file.
+ */
+SU_GETTER(
+  suscan_capture_index,
+  SUBOOL,
+  lookup_offset,
+  SUSCOUNT sample,
+  SUSCOUNT *entry_sample,
+  uint64_t *byte_offset);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_SOURCE_INDEX_H */
@@ -0,0 +1,584 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define _FILE_OFFSET_BITS 64
+#define SU_LOG_DOMAIN "overview"
+
+#include <sigutils/log.h>
+#include <sigutils/smoothpsd.h>
+#include <sigutils/util/compat-stat.h>
+#include <sigutils/util/compat-fcntl.h>
+#include <sigutils/util/compat-unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#  include <sys/file.h>
+#endif /* _WIN32 */
+
+#include "overview.h"
+#include <analyzer/source/config.h>
+#include <analyzer/source/impl/file.h>
+
+char *
+suscan_overview_path_for(const char *data_path)
+{
+  return strbuild("%s%s", data_path, SUSCAN_OVERVIEW_EXTENSION);
+}
+
+SUPRIVATE unsigned int
+suscan_overview_count_levels(SUSCOUNT rows)
+{
+  unsigned int levels = 1;
+
+  while (rows > 1 && levels < SUSCAN_OVERVIEW_MAX_LEVELS) {
+    rows = (rows + 1) / 2;
+    ++levels;
+  }
+
+  return levels;
+}
+
+/********************************* Builder ************************************/
+/* A contiguous range of rows of level 0, computed by its own thread */
+struct suscan_overview_task {
+  const suscan_source_config_t *config;
+  const struct suscan_overview_params *params;
+  SUFLOAT   samp_rate;
+  SUSCOUNT  row_samples;
+  SUSCOUNT  first_row;
+  SUSCOUNT  rows;
+  float    *out;       /* rows x bins */
+  SUSCOUNT  produced;
+
+  pthread_t thread;
+  SUBOOL    running;
+  SUBOOL    ok;
+};
+
+SUPRIVATE SUBOOL
+suscan_overview_task_on_psd(
+  void *userdata,
+  const SUFLOAT *psd,
+  unsigned int size)
+{
+  struct suscan_overview_task *self = (struct suscan_overview_task *) userdata;
+  float *row;
+  unsigned int i;
+
+  if (self->produced < self->rows && size == self->params->bins) {
+    row = self->out + self->produced * size;
+    for (i = 0; i < size; ++i)
+      row[i] = psd[i];
+    ++self->produced;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void *
+suscan_overview_task_thread(void *userdata)
+{
+  struct suscan_overview_task *self = (struct suscan_overview_task *) userdata;
+  struct sigutils_smoothpsd_params sp_params =
+      sigutils_smoothpsd_params_INITIALIZER;
+  suscan_source_file_reader_t *reader = NULL;
+  su_smoothpsd_t *smooth_psd = NULL;
+  SUCOMPLEX *buffer = NULL;
+  SUSCOUNT left = self->rows * self->row_samples;
+  SUSCOUNT i;
+  unsigned int bins = self->params->bins;
+  SUSDIFF got;
+
+  SU_MAKE(reader, suscan_source_file_reader, self->config);
+  SU_TRY(
+    suscan_source_file_reader_seek(
+      reader,
+      self->first_row * self->row_samples));
+
+  SU_ALLOCATE_MANY(buffer, SUSCAN_OVERVIEW_READ_SIZE, SUCOMPLEX);
+
+  sp_params.fft_size     = bins;
+  sp_params.samp_rate    = self->samp_rate;
+  sp_params.refresh_rate = self->samp_rate / self->row_samples;
+  sp_params.window       = self->params->window;
+
+  SU_MAKE(
+    smooth_psd,
+    su_smoothpsd,
+    &sp_params,
+    suscan_overview_task_on_psd,
+    self);
+
+  while (left > 0) {
+    got = suscan_source_file_reader_read(
+      reader,
+      buffer,
+      SU_MIN(left, SUSCAN_OVERVIEW_READ_SIZE));
+
+    SU_TRY(got >= 0);
+    if (got == 0)
+      break;
+
+    SU_TRY(su_smoothpsd_feed(smooth_psd, buffer, got));
+    left -= got;
+  }
+
+  /* Rows lost to rounding at the end of the segment repeat the last one */
+  if (self->produced > 0)
+    for (i = self->produced; i < self->rows; ++i)
+      memcpy(
+        self->out + i * bins,
+        self->out + (self->produced - 1) * bins,
+        bins * sizeof(float));
+
+  self->ok = SU_TRUE;
+
+done:
+  if (smooth_psd != NULL)
+    su_smoothpsd_destroy(smooth_psd);
+
+  if (buffer != NULL)
+    free(buffer);
+
+  if (reader != NULL)
+    suscan_source_file_reader_destroy(reader);
+
+  return NULL;
+}
+
+/* Every row of the next level is the average of two rows of this one */
+SUPRIVATE void
+suscan_overview_reduce(
+  const float *in,
+  SUSCOUNT rows,
+  unsigned int bins,
+  float *out)
+{
+  const float *a, *b;
+  SUSCOUNT r;
+  unsigned int i;
+
+  for (r = 0; r < (rows + 1) / 2; ++r) {
+    a = in + 2 * r * bins;
+
+    if (2 * r + 1 < rows) {
+      b = a + bins;
+      for (i = 0; i < bins; ++i)
+        out[i] = .5f * (a[i] + b[i]);
+    } else {
+      memcpy(out, a, bins * sizeof(float));
+    }
+
+    out += bins;
+  }
+}
+
+SUPRIVATE unsigned int
+suscan_overview_get_thread_count(const struct suscan_overview_params *params)
+{
+  long count = params->threads;
+
+  if (count == 0 && (count = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+    count = 1;
+
+  return count;
+}
+
+/* Returns -1 if someone else holds the lock */
+SUPRIVATE int
+suscan_overview_lock(const char *path)
+{
+  char *lock_path = NULL;
+  int fd = -1;
+
+  SU_TRY(lock_path = strbuild("%s%s", path, SUSCAN_OVERVIEW_LOCK_EXTENSION));
+
+  if ((fd = open(lock_path, O_RDWR | O_CREAT, 0644)) == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", lock_path, strerror(errno));
+    goto done;
+  }
+
+#ifndef _WIN32
+  if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+    if (errno == EWOULDBLOCK)
+      SU_INFO("Overview `%s' is being built elsewhere\n", path);
+    else
+      SU_ERROR("Cannot lock `%s': %s\n", lock_path, strerror(errno));
+
+    close(fd);
+    fd = -1;
+  }
+#endif /* _WIN32 */
+
+done:
+  if (lock_path != NULL)
+    free(lock_path);
+
+  return fd;
+}
+
+SUBOOL
+suscan_overview_build(
+  const suscan_source_config_t *config,
+  const char *path,
+  const struct suscan_overview_params *params)
+{
+  struct suscan_overview_header header;
+  struct suscan_overview_task *tasks = NULL;
+  suscan_source_file_reader_t *reader = NULL;
+  char *data_path = NULL;
+  char *tmp_path = NULL;
+  float *level = NULL, *next = NULL, *tmp;
+  FILE *fp = NULL;
+  int fd = -1, lock_fd = -1;
+  SUBOOL tmp_created = SU_FALSE;
+  struct stat sbuf;
+  SUSCOUNT total, rows, per_task, first;
+  SUFLOAT samp_rate;
+  unsigned int i, count = 0, bins = params->bins;
+  SUBOOL ok = SU_FALSE;
+
+  if (bins < 2 || params->max_rows == 0) {
+    SU_ERROR("Invalid overview parameters\n");
+    goto done;
+  }
+
+  if ((lock_fd = suscan_overview_lock(path)) == -1)
+    goto done;
+
+  SU_TRY(data_path = suscan_source_config_file_get_data_path(config));
+  if (stat(data_path, &sbuf) == -1) {
+    SU_ERROR("Cannot stat `%s': %s\n", data_path, strerror(errno));
+    goto done;
+  }
+
+  /* Only needed to learn the size and rate of the capture */
+  SU_MAKE(reader, suscan_source_file_reader, config);
+  total     = suscan_source_file_reader_get_samples(reader);
+  samp_rate = suscan_source_file_reader_get_samp_rate(reader);
+  suscan_source_file_reader_destroy(reader);
+  reader = NULL;
+
+  if (total < bins || samp_rate <= 0) {
+    SU_ERROR("Capture is too short for an overview of %u bins\n", bins);
+    goto done;
+  }
+
+  memset(&header, 0, sizeof(struct suscan_overview_header));
+  header.magic       = SUSCAN_OVERVIEW_MAGIC;
+  header.version     = SUSCAN_OVERVIEW_VERSION;
+  header.bins        = bins;
+  header.row_samples = (total + params->max_rows - 1) / params->max_rows;
+  if (header.row_samples < bins)
+    header.row_samples = bins;
+  header.rows        = total / header.row_samples;
+  header.levels      = suscan_overview_count_levels(header.rows);
+  header.samp_rate   = samp_rate;
+  header.start_sec   = config->start_time.tv_sec;
+  header.start_usec  = config->start_time.tv_usec;
+  header.data_size   = sbuf.st_size;
+
+  rows = header.rows;
+
+  SU_ALLOCATE_MANY(level, rows * bins, float);
+  SU_ALLOCATE_MANY(next, ((rows + 1) / 2) * bins, float);
+
+  /* Split level 0 in equally sized segments, one per thread */
+  count = suscan_overview_get_thread_count(params);
+  if (count > rows)
+    count = rows;
+
+  SU_ALLOCATE_MANY(tasks, count, struct suscan_overview_task);
+
+  per_task = rows / count;
+  first    = 0;
+
+  for (i = 0; i < count; ++i) {
+    tasks[i].config      = config;
+    tasks[i].params      = params;
+    tasks[i].samp_rate   = samp_rate;
+    tasks[i].row_samples = header.row_samples;
+    tasks[i].first_row   = first;
+    tasks[i].rows        = i == count - 1 ? rows - first : per_task;
+    tasks[i].out         = level + first * bins;
+
+    first += tasks[i].rows;
+  }
+
+  for (i = 0; i < count; ++i) {
+    SU_TRYZ(
+      pthread_create(
+        &tasks[i].thread,
+        NULL,
+        suscan_overview_task_thread,
+        tasks + i));
+    tasks[i].running = SU_TRUE;
+  }
+
+  for (i = 0; i < count; ++i) {
+    pthread_join(tasks[i].thread, NULL);
+    tasks[i].running = SU_FALSE;
+  }
+
+  for (i = 0; i < count; ++i)
+    if (!tasks[i].ok) {
+      SU_ERROR("Failed to compute overview rows %llu-%llu\n",
+        (unsigned long long) tasks[i].first_row,
+        (unsigned long long) (tasks[i].first_row + tasks[i].rows - 1));
+      goto done;
+    }
+
+  /* Readers only see the overview once it is complete */
+  SU_TRY(tmp_path = strbuild("%s.XXXXXX", path));
+  if ((fd = mkstemp(tmp_path)) == -1) {
+    SU_ERROR("Cannot create overview `%s': %s\n", path, strerror(errno));
+    goto done;
+  }
+
+  tmp_created = SU_TRUE;
+
+  if ((fp = fdopen(fd, "wb")) == NULL) {
+    SU_ERROR("Cannot create overview `%s': %s\n", path, strerror(errno));
+    close(fd);
+    goto done;
+  }
+
+  /* mkstemp creates files only readable by their owner */
+  (void) fchmod(fd, 0644);
+
+  SU_TRY(fwrite(&header, sizeof(struct suscan_overview_header), 1, fp) == 1);
+
+  for (i = 0; i < header.levels; ++i) {
+    SU_TRY(fwrite(level, bins * sizeof(float), rows, fp) == rows);
+
+    if (rows > 1) {
+      suscan_overview_reduce(level, rows, bins, next);
+
+      tmp   = level;
+      level = next;
+      next  = tmp;
+      rows  = (rows + 1) / 2;
+    }
+  }
+
+  if (fclose(fp) != 0) {
+    fp = NULL;
+    SU_ERROR("Cannot write overview `%s': %s\n", path, strerror(errno));
+    goto done;
+  }
+
+  fp = NULL;
+
+  if (rename(tmp_path, path) == -1) {
+    SU_ERROR("Cannot move overview to `%s': %s\n", path, strerror(errno));
+    goto done;
+  }
+
+  tmp_created = SU_FALSE;
+
+  SU_INFO(
+    "Overview `%s': %u levels, %llu rows of %llu samples\n",
+    path,
+    header.levels,
+    (unsigned long long) header.rows,
+    (unsigned long long) header.row_samples);
+
+  ok = SU_TRUE;
+
+done:
+  if (tasks != NULL) {
+    for (i = 0; i < count; ++i)
+      if (tasks[i].running)
+        pthread_join(tasks[i].thread, NULL);
+    free(tasks);
+  }
+
+  if (fp != NULL)
+    fclose(fp);
+
+  if (tmp_created)
+    unlink(tmp_path);
+
+  if (tmp_path != NULL)
+    free(tmp_path);
+
+  if (lock_fd != -1)
+    close(lock_fd);
+
+  if (level != NULL)
+    free(level);
+
+  if (next != NULL)
+    free(next);
+
+  if (reader != NULL)
+    suscan_source_file_reader_destroy(reader);
+
+  if (data_path != NULL)
+    free(data_path);
+
+  return ok;
+}
+
+/********************************** Reader ************************************/
+SU_GETTER(suscan_overview, unsigned int, get_levels)
+{
+  return self->header.levels;
+}
+
+SU_GETTER(suscan_overview, unsigned int, get_bins)
+{
+  return self->header.bins;
+}
+
+SU_GETTER(suscan_overview, SUSCOUNT, get_rows, unsigned int level)
+{
+  if (level >= self->header.levels)
+    return 0;
+
+  return self->level_rows[level];
+}
+
+SU_GETTER(suscan_overview, SUSCOUNT, get_row_samples, unsigned int level)
+{
+  if (level >= self->header.levels)
+    return 0;
+
+  return self->header.row_samples << level;
+}
+
+SU_GETTER(suscan_overview, SUFLOAT, get_samp_rate)
+{
+  return self->header.samp_rate;
+}
+
+SU_GETTER(suscan_overview, void, get_start_time, struct timeval *tv)
+{
+  tv->tv_sec  = self->header.start_sec;
+  tv->tv_usec = self->header.start_usec;
+}
+
+SU_GETTER(suscan_overview, SUBOOL, is_fresh, uint64_t data_size)
+{
+  return self->header.data_size == data_size;
+}
+
+SU_GETTER(
+  suscan_overview,
+  SUSDIFF,
+  read_tile,
+  unsigned int level,
+  SUSCOUNT first_row,
+  SUSCOUNT count,
+  SUFLOAT *out)
+{
+  size_t row_size = self->header.bins * sizeof(float);
+  ssize_t got;
+#ifndef _SU_SINGLE_PRECISION
+  const float *as_float = (const float *) out;
+  SUSCOUNT i;
+#endif /* _SU_SINGLE_PRECISION */
+
+  if (level >= self->header.levels)
+    return -1;
+
+  if (first_row >= self->level_rows[level])
+    return 0;
+
+  if (count > self->level_rows[level] - first_row)
+    count = self->level_rows[level] - first_row;
+
+  got = pread(
+    self->fd,
+    out,
+    count * row_size,
+    self->level_offset[level] + first_row * row_size);
+
+  if (got != (ssize_t) (count * row_size)) {
+    SU_ERROR("Failed to read overview tile\n");
+    return -1;
+  }
+
+#ifndef _SU_SINGLE_PRECISION
+  /* Expand in place, from the end */
+  for (i = count * self->header.bins; i-- > 0;)
+    out[i] = as_float[i];
+#endif /* _SU_SINGLE_PRECISION */
+
+  return count;
+}
+
+SU_INSTANCER(suscan_overview, const char *path)
+{
+  suscan_overview_t *new = NULL;
+  SUSCOUNT rows;
+  uint64_t offset;
+  unsigned int i;
+
+  SU_ALLOCATE_FAIL(new, suscan_overview_t);
+
+  new->fd = -1;
+
+  if ((new->fd = open(path, O_RDONLY)) == -1)
+    goto fail;
+
+  SU_TRY_FAIL(
+    read(new->fd, &new->header, sizeof(struct suscan_overview_header))
+      == sizeof(struct suscan_overview_header));
+
+  if (new->header.magic != SUSCAN_OVERVIEW_MAGIC
+    || new->header.version != SUSCAN_OVERVIEW_VERSION
+    || new->header.bins == 0
+    || new->header.rows == 0
+    || new->header.levels == 0
+    || new->header.levels > SUSCAN_OVERVIEW_MAX_LEVELS
+    || new->header.samp_rate <= 0) {
+    SU_WARNING("`%s' is not a valid overview\n", path);
+    goto fail;
+  }
+
+  rows   = new->header.rows;
+  offset = sizeof(struct suscan_overview_header);
+
+  for (i = 0; i < new->header.levels; ++i) {
+    new->level_rows[i]   = rows;
+    new->level_offset[i] = offset;
+
+    offset += rows * new->header.bins * sizeof(float);
+    rows    = (rows + 1) / 2;
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_overview_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_overview)
+{
+  if (self->fd != -1)
+    close(self->fd);
+
+  free(self);
+}
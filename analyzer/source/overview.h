@@ -0,0 +1,138 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_SOURCE_OVERVIEW_H
+#define _ANALYZER_SOURCE_OVERVIEW_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+#include <sigutils/detect.h>
+#include <sigutils/util/compat-time.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Overviews are multi-resolution waterfalls of a whole capture, stored in a
+ * sidecar file next to it. Level 0 holds one averaged PSD (row) per
+ * row_samples samples. Every other level halves the number of rows of the
+ * previous one by averaging pairs of rows, until a single row is left.
+ * Levels are stored one after another, starting from level 0:
+ *
+ *   [header] [level 0: rows x bins] [level 1: ceil(rows / 2) x bins] ...
+ *
+ * PSDs are stored as linear power, float32, in host byte order.
+ */
+
+#define SUSCAN_OVERVIEW_MAGIC            0x57564f53 /* "SOVW" */
+#define SUSCAN_OVERVIEW_VERSION          1
+#define SUSCAN_OVERVIEW_EXTENSION        ".sovw"
+#define SUSCAN_OVERVIEW_LOCK_EXTENSION   ".lock"
+#define SUSCAN_OVERVIEW_MAX_LEVELS       64
+#define SUSCAN_OVERVIEW_DEFAULT_BINS     512
+#define SUSCAN_OVERVIEW_DEFAULT_MAX_ROWS 16384
+#define SUSCAN_OVERVIEW_READ_SIZE        65536
+
+struct suscan_overview_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t bins;
+  uint32_t levels;
+  uint64_t row_samples; /* Samples per row of level 0 */
+  uint64_t rows;        /* Rows of level 0 */
+  uint64_t data_size;   /* Size of the data file when built */
+  double   samp_rate;
+  int64_t  start_sec;
+  uint32_t start_usec;
+  uint32_t reserved;
+};
+
+struct suscan_overview_params {
+  unsigned int bins;
+  SUSCOUNT     max_rows;  /* Rows of level 0 will not exceed this */
+  unsigned int threads;   /* 0: one per core */
+  enum sigutils_channel_detector_window window;
+};
+
+#define suscan_overview_params_INITIALIZER                         \
+{                                                                  \
+  SUSCAN_OVERVIEW_DEFAULT_BINS,            /* bins */              \
+  SUSCAN_OVERVIEW_DEFAULT_MAX_ROWS,        /* max_rows */          \
+  0,                                       /* threads */           \
+  SU_CHANNEL_DETECTOR_WINDOW_BLACKMANN_HARRIS, /* window */        \
+}
+
+struct suscan_source_config;
+
+/* Overview file path for a given data file. Must be freed by the caller. */
+char *suscan_overview_path_for(const char *data_path);
+
+/*
+ * Reads the whole capture once, splitting it in as many segments as
+ * threads, and saves the resulting pyramid to path. The pyramid is written
+ * to a temporary file and renamed when complete, and path.lock is held
+ * meanwhile so that only one process builds it.
+ */
+SUBOOL suscan_overview_build(
+  const struct suscan_source_config *config,
+  const char *path,
+  const struct suscan_overview_params *params);
+
+struct suscan_overview {
+  struct suscan_overview_header header;
+  int      fd;
+  SUSCOUNT level_rows[SUSCAN_OVERVIEW_MAX_LEVELS];
+  uint64_t level_offset[SUSCAN_OVERVIEW_MAX_LEVELS];
+};
+
+typedef struct suscan_overview suscan_overview_t;
+
+SU_INSTANCER(suscan_overview, const char *path);
+SU_COLLECTOR(suscan_overview);
+
+SU_GETTER(suscan_overview, unsigned int, get_levels);
+SU_GETTER(suscan_overview, unsigned int, get_bins);
+SU_GETTER(suscan_overview, SUSCOUNT, get_rows, unsigned int level);
+SU_GETTER(suscan_overview, SUSCOUNT, get_row_samples, unsigned int level);
+SU_GETTER(suscan_overview, SUFLOAT, get_samp_rate);
+SU_GETTER(suscan_overview, void, get_start_time, struct timeval *tv);
+
+/* True if the overview was built for a data file of this size */
+SU_GETTER(suscan_overview, SUBOOL, is_fresh, uint64_t data_size);
+
+/*
+ * Reads up to count rows of a level, starting from first_row, into out
+ * (count x bins elements). Returns the number of rows read, or -1 on error.
+ */
+SU_GETTER(
+  suscan_overview,
+  SUSDIFF,
+  read_tile,
+  unsigned int level,
+  SUSCOUNT first_row,
+  SUSCOUNT count,
+  SUFLOAT *out);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_SOURCE_OVERVIEW_H */
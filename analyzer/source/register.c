@@ -73,17 +73,24 @@ done:
   return iface;
 }
 
+SUPRIVATE SUBOOL g_source_types_registered = SU_FALSE;
+
+/* Idempotent: callers may register source types ahead of the sources */
 SUBOOL
 suscan_source_init_source_types(void)
 {
   SUBOOL ok = SU_FALSE;
 
 #ifndef SUSCAN_THIN_CLIENT
+  if (g_source_types_registered)
+    return SU_TRUE;
+
   SU_TRY(suscan_source_register_file());
   SU_TRY(suscan_source_register_soapysdr());
   SU_TRY(suscan_source_register_stdin());
   SU_TRY(suscan_source_register_tonegen());
 
+  g_source_types_registered = SU_TRUE;
   ok = SU_TRUE;
 
 done:
@@ -22,7 +22,8 @@
 #define SU_LOG_DOMAIN "spectsrc"
 
 #include "spectsrc.h"
-#include <sigutils/taps.h>
+#include "fftcache.h"
+#include "spectsrcs/kernels.h"
 
 PTR_LIST_CONST(struct suscan_spectsrc_class, spectsrc_class);
 
@@ -59,23 +60,15 @@ suscan_spectsrc_class_register(const struct suscan_spectsrc_class *class)
   return SU_TRUE;
 }
 
-SUPRIVATE SUBOOL
-suscan_spectsrc_on_psd_data(
-    void *userdata,
-    const SUFLOAT *data,
-    unsigned int size)
+SUPRIVATE void
+suscan_spectsrc_update_psd_period(suscan_spectsrc_t *self)
 {
-  suscan_spectsrc_t *self = (suscan_spectsrc_t *) userdata;
-  SUBOOL ok = SU_FALSE;
-
-  SU_TRYCATCH(
-      (self->on_spectrum) (self->userdata, data, size),
-      goto done);
-
-  ok = SU_TRUE;
+  SUFLOAT period =
+    self->samp_rate * self->throttle_factor / self->refresh_rate;
 
-done:
-  return ok;
+  self->psd_period = period < 1 ? 1 : (SUSCOUNT) SU_FLOOR(period);
+  self->psd_ptr    = 0;
+  self->frame_ptr  = 0;
 }
 
 void
@@ -85,9 +78,7 @@ suscan_spectsrc_set_throttle_factor(
 {
   if (!sufeq(throttle_factor, self->throttle_factor, 1e-6)) {
     self->throttle_factor = throttle_factor;
-    self->smooth_psd_params.samp_rate = 
-      su_smoothpsd_get_nominal_samp_rate(self->smooth_psd) * self->throttle_factor;
-    (void) su_smoothpsd_set_params(self->smooth_psd, &self->smooth_psd_params);
+    suscan_spectsrc_update_psd_period(self);
   }
 }
 
@@ -102,35 +93,41 @@ suscan_spectsrc_new(
     void *userdata)
 {
   suscan_spectsrc_t *new = NULL;
-  struct sigutils_smoothpsd_params params =
-      sigutils_smoothpsd_params_INITIALIZER;
 
+  SU_TRYCATCH(size > 0 && spectrum_rate > 0, goto fail);
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_spectsrc_t)), goto fail);
 
   new->classptr = classdef;
   new->on_spectrum = on_spectrum;
   new->userdata = userdata;
 
-  if (classdef->preproc != NULL) {
-    SU_TRYCATCH(new->buffer = malloc(size * sizeof(SUCOMPLEX)), goto fail);
-    new->buffer_size = size;
-  }
-
+  new->samp_rate = samp_rate;
   new->refresh_rate = spectrum_rate;
   new->throttle_factor = 1.;
+  new->fft_size = size;
+  new->frame_hop = size > 1 ? size / 2 : 1;
+
+  suscan_spectsrc_update_psd_period(new);
+
+  SU_TRYCATCH(
+      new->frame = SU_FFTW(_malloc)(size * sizeof(SU_FFTW(_complex))),
+      goto fail);
+  SU_TRYCATCH(
+      new->history = calloc(size, sizeof(SUCOMPLEX)),
+      goto fail);
+  SU_TRYCATCH(
+      new->psd = calloc(size, sizeof(SUFLOAT)),
+      goto fail);
 
-  params.fft_size = size;
-  params.samp_rate = samp_rate;
-  params.refresh_rate = new->refresh_rate / new->throttle_factor;
-  params.window = window_type;
+  SU_TRYCATCH(
+      new->fft_plan = suscan_fft_cache_acquire_plan(
+          size,
+          FFTW_FORWARD,
+          SU_TRUE),
+      goto fail);
 
-  new->smooth_psd_params = params;
-  
   SU_TRYCATCH(
-      new->smooth_psd = su_smoothpsd_new(
-          &params,
-          suscan_spectsrc_on_psd_data,
-          new),
+      new->window = suscan_fft_cache_acquire_window(size, window_type),
       goto fail);
 
   SU_TRYCATCH(
@@ -146,6 +143,147 @@ fail:
   return NULL;
 }
 
+/* Window of the last fft_size samples, oldest first */
+SUPRIVATE void
+suscan_spectsrc_make_frame(suscan_spectsrc_t *self)
+{
+  SUCOMPLEX *frame = (SUCOMPLEX *) self->frame;
+  SUSCOUNT n = self->fft_size;
+  SUSCOUNT head = n - self->history_ptr;
+  SUSCOUNT i;
+
+  for (i = 0; i < head; ++i)
+    frame[i] = self->history[self->history_ptr + i] * self->window[i];
+
+  for (i = head; i < n; ++i)
+    frame[i] = self->history[i - head] * self->window[i];
+}
+
+/*
+ * Same normalization as su_smoothpsd: periodograms scaled by 1/N and
+ * averaged over all frames since the last delivery.
+ */
+SUBOOL
+suscan_spectsrc_deliver_psd(suscan_spectsrc_t *self, const SUCOMPLEX *fft)
+{
+  SUSCOUNT n = self->fft_size;
+  SUFLOAT k = 1. / n;
+  SUBOOL last = self->frame_last;
+  SUSCOUNT i;
+
+  (suscan_spectsrc_kernels_get()->psd) (
+    self->psd,
+    fft,
+    k,
+    self->psd_iters > 0,
+    n);
+
+  ++self->psd_iters;
+
+  self->frame_state = SUSCAN_SPECTSRC_FRAME_STATE_IDLE;
+
+  if (!last)
+    return SU_TRUE;
+
+  if (self->psd_iters > 1) {
+    k = 1. / self->psd_iters;
+    for (i = 0; i < n; ++i)
+      self->psd[i] *= k;
+  }
+
+  self->psd_iters = 0;
+
+  return (self->on_spectrum) (self->userdata, self->psd, n);
+}
+
+/*
+ * The frame flagged as last completes the average. If it has to be
+ * dropped, the next one takes its place.
+ */
+SUPRIVATE SUBOOL
+suscan_spectsrc_run_psd(suscan_spectsrc_t *self, SUBOOL last)
+{
+  last = last || self->last_pending;
+
+  if (self->deferred) {
+    /* Previous frame not transformed yet: drop this one */
+    if (self->frame_state != SUSCAN_SPECTSRC_FRAME_STATE_IDLE) {
+      self->last_pending = last;
+      return SU_TRUE;
+    }
+
+    suscan_spectsrc_make_frame(self);
+    self->frame_last   = last;
+    self->last_pending = SU_FALSE;
+    self->frame_state  = SUSCAN_SPECTSRC_FRAME_STATE_READY;
+    return SU_TRUE;
+  }
+
+  suscan_spectsrc_make_frame(self);
+  self->frame_last   = last;
+  self->last_pending = SU_FALSE;
+  SU_FFTW(_execute_dft)(self->fft_plan, self->frame, self->frame);
+
+  return suscan_spectsrc_deliver_psd(self, (const SUCOMPLEX *) self->frame);
+}
+
+SUPRIVATE SUBOOL
+suscan_spectsrc_feed_psd(
+    suscan_spectsrc_t *self,
+    const SUCOMPLEX *data,
+    SUSCOUNT size)
+{
+  SUSCOUNT chunk;
+  SUBOOL due;
+
+  while (size > 0) {
+    chunk = SU_MIN(size, self->fft_size - self->history_ptr);
+    if (self->psd_ptr < self->psd_period)
+      chunk = SU_MIN(chunk, self->psd_period - self->psd_ptr);
+    if (self->frame_ptr < self->frame_hop)
+      chunk = SU_MIN(chunk, self->frame_hop - self->frame_ptr);
+
+    if (self->classptr->preproc != NULL) {
+      SU_TRYCATCH(
+          (self->classptr->preproc) (
+              self,
+              self->privdata,
+              data,
+              self->history + self->history_ptr,
+              chunk),
+          return SU_FALSE);
+    } else {
+      memcpy(
+          self->history + self->history_ptr,
+          data,
+          chunk * sizeof(SUCOMPLEX));
+    }
+
+    self->history_ptr += chunk;
+    if (self->history_ptr == self->fft_size)
+      self->history_ptr = 0;
+
+    self->history_fill = SU_MIN(self->history_fill + chunk, self->fft_size);
+    self->psd_ptr   += chunk;
+    self->frame_ptr += chunk;
+
+    /* Refreshes always transform the latest samples */
+    due = self->psd_ptr >= self->psd_period;
+    if (due || self->frame_ptr >= self->frame_hop) {
+      if (due)
+        self->psd_ptr = 0;
+      self->frame_ptr = 0;
+
+      if (self->history_fill == self->fft_size)
+        SU_TRYCATCH(suscan_spectsrc_run_psd(self, due), return SU_FALSE);
+    }
+
+    data += chunk;
+    size -= chunk;
+  }
+
+  return SU_TRUE;
+}
 
 SUSCOUNT
 suscan_spectsrc_feed(
@@ -153,28 +291,7 @@ suscan_spectsrc_feed(
     const SUCOMPLEX *data,
     SUSCOUNT size)
 {
-  if (self->classptr->preproc != NULL) {
-    /* Spectrum source has a preprocessing routine. Apply data to it */
-    if (size > self->buffer_size)
-      size = self->buffer_size;
-
-    memcpy(self->buffer, data, size * sizeof(SUCOMPLEX));
-    SU_TRYCATCH(
-        (self->classptr->preproc) (
-            self,
-            self->privdata,
-            self->buffer,
-            size),
-        return SU_FALSE);
-
-    SU_TRYCATCH(
-        su_smoothpsd_feed(self->smooth_psd, self->buffer, size),
-        return -1);
-  } else {
-    SU_TRYCATCH(
-        su_smoothpsd_feed(self->smooth_psd, data, size),
-        return -1);
-  }
+  SU_TRYCATCH(suscan_spectsrc_feed_psd(self, data, size), return -1);
 
   return size;
 }
@@ -185,11 +302,20 @@ suscan_spectsrc_destroy(suscan_spectsrc_t *self)
   if (self->privdata != NULL)
     (self->classptr->dtor) (self->privdata);
 
-  if (self->buffer != NULL)
-    free(self->buffer);
+  if (self->fft_plan != NULL)
+    suscan_fft_cache_release_plan(self->fft_plan);
+
+  if (self->window != NULL)
+    suscan_fft_cache_release_window(self->window);
 
-  if (self->smooth_psd != NULL)
-    su_smoothpsd_destroy(self->smooth_psd);
+  if (self->frame != NULL)
+    SU_FFTW(_free)(self->frame);
+
+  if (self->history != NULL)
+    free(self->history);
+
+  if (self->psd != NULL)
+    free(self->psd);
 
   free(self);
 }
@@ -203,6 +329,8 @@ suscan_spectsrcs_initialized(void)
 SUBOOL
 suscan_init_spectsrcs(void)
 {
+  SU_TRYCATCH(suscan_spectsrc_kernels_init(), return SU_FALSE);
+
   SU_TRYCATCH(suscan_spectsrc_psd_register(), return SU_FALSE);
   SU_TRYCATCH(suscan_spectsrc_cyclo_register(), return SU_FALSE);
   SU_TRYCATCH(suscan_spectsrc_fmcyclo_register(), return SU_FALSE);
@@ -30,16 +30,37 @@ extern "C" {
 
 struct suscan_spectsrc;
 
+/*
+ * PSDs are Welch estimates: windowed frames overlapping by half are
+ * transformed and their periodograms averaged until the next refresh.
+ *
+ * In deferred mode, the spectrum source only produces windowed frames. The
+ * owner transforms them (usually in batches, see inspsched.c) and hands the
+ * result back with suscan_spectsrc_deliver_psd. New frames are dropped
+ * until the pending one is delivered.
+ */
+enum suscan_spectsrc_frame_state {
+  SUSCAN_SPECTSRC_FRAME_STATE_IDLE,
+  SUSCAN_SPECTSRC_FRAME_STATE_READY,
+  SUSCAN_SPECTSRC_FRAME_STATE_QUEUED
+};
+
 struct suscan_spectsrc_class {
   const char *name;
   const char *desc;
 
   void * (*ctor) (struct suscan_spectsrc *src);
 
+  /*
+   * Writes straight into the PSD input. Output never aliases input, and
+   * kernels should read previous samples from the input rather than
+   * carrying them across iterations, so that loops vectorize.
+   */
   SUBOOL (*preproc)  (
       struct suscan_spectsrc *src,
       void *privdata,
-      SUCOMPLEX *buffer,
+      const SUCOMPLEX *input,
+      SUCOMPLEX *output,
       SUSCOUNT size);
 
   void (*dtor) (void *privdata);
@@ -55,13 +76,29 @@ struct suscan_spectsrc {
   const struct suscan_spectsrc_class *classptr;
   void *privdata;
   
+  SUFLOAT         samp_rate;
   SUFLOAT         refresh_rate;
   SUFLOAT         throttle_factor;
-  SUSCOUNT        buffer_size;
-  SUCOMPLEX      *buffer;
 
-  struct sigutils_smoothpsd_params smooth_psd_params;
-  su_smoothpsd_t *smooth_psd;
+  /* PSD. Plan and window are shared, see fftcache.h */
+  SUSCOUNT           fft_size;
+  SU_FFTW(_plan)     fft_plan;
+  const SUFLOAT     *window;
+  SU_FFTW(_complex) *frame;      /* Windowed samples, transformed in place */
+  SUCOMPLEX         *history;    /* Last fft_size samples, circular */
+  SUSCOUNT           history_ptr;
+  SUSCOUNT           history_fill;
+  SUFLOAT           *psd;        /* Periodograms accumulated so far */
+  unsigned int       psd_iters;
+  SUSCOUNT           psd_period; /* Samples between PSD updates */
+  SUSCOUNT           psd_ptr;
+  SUSCOUNT           frame_hop;  /* Samples between frames */
+  SUSCOUNT           frame_ptr;
+  SUBOOL             frame_last; /* Frame closes the current average */
+  SUBOOL             last_pending;
+
+  SUBOOL             deferred;
+  volatile enum suscan_spectsrc_frame_state frame_state;
 
   SUBOOL (*on_spectrum) (void *userdata, const SUFLOAT *data, SUSCOUNT size);
   void *userdata;
@@ -69,6 +106,30 @@ struct suscan_spectsrc {
 
 typedef struct suscan_spectsrc suscan_spectsrc_t;
 
+SUINLINE SUSCOUNT
+suscan_spectsrc_get_fft_size(const suscan_spectsrc_t *self)
+{
+  return self->fft_size;
+}
+
+SUINLINE SUBOOL
+suscan_spectsrc_frame_ready(const suscan_spectsrc_t *self)
+{
+  return self->frame_state == SUSCAN_SPECTSRC_FRAME_STATE_READY;
+}
+
+SUINLINE const SUCOMPLEX *
+suscan_spectsrc_get_frame(const suscan_spectsrc_t *self)
+{
+  return (const SUCOMPLEX *) self->frame;
+}
+
+SUINLINE void
+suscan_spectsrc_set_deferred(suscan_spectsrc_t *self, SUBOOL deferred)
+{
+  self->deferred = deferred;
+}
+
 suscan_spectsrc_t *suscan_spectsrc_new(
     const struct suscan_spectsrc_class *classdef,
     SUFLOAT  samp_rate,
@@ -87,6 +148,11 @@ SUSCOUNT suscan_spectsrc_feed(
     const SUCOMPLEX *data,
     SUSCOUNT size);
 
+/* fft: transform of the last frame. Releases the frame. */
+SUBOOL suscan_spectsrc_deliver_psd(
+    suscan_spectsrc_t *src,
+    const SUCOMPLEX *fft);
+
 void suscan_spectsrc_destroy(suscan_spectsrc_t *src);
 
 SUBOOL suscan_spectsrc_psd_register(void);
@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "cyclo-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
 
 #define SU_CYCLO_GAIN 1e6
 
@@ -35,21 +36,23 @@ SUBOOL
 suscan_spectsrc_cyclo_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] * SU_C_CONJ(prev);
-    prev = buffer[i];
-    buffer[i] = SU_CYCLO_GAIN * diff;
-  }
+  if (size == 0)
+    return SU_TRUE;
 
-  *last = prev;
+  suscan_spectsrc_kernels_get()->conj_prod(
+    output,
+    input,
+    *last,
+    SU_CYCLO_GAIN,
+    size);
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "exp_4-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
 
 void *
 suscan_spectsrc_exp_4_ctor(suscan_spectsrc_t *src)
@@ -33,13 +34,13 @@ SUBOOL
 suscan_spectsrc_exp_4_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
-  SUSCOUNT i;
+  SUFLOAT k = 1. / suscan_spectsrc_get_fft_size(src);
 
-  for (i = 0; i < size; ++i)
-    buffer[i] = cpow(buffer[i] / (SU_C_ABS(buffer[i]) + 1e-8), 4) / size;
+  suscan_spectsrc_kernels_get()->exp_pow2(output, input, 2, k, size);
 
   return SU_TRUE;
 }
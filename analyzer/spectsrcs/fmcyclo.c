@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "fmcyclo-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
 
 #define FMCYCLO_GAIN 1e-5
 
@@ -40,24 +41,36 @@ SUBOOL
 suscan_spectsrc_fmcyclo_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
   struct fmcyclo_ctx *ctx = (struct fmcyclo_ctx *) private;
-  SUCOMPLEX fm_prev = ctx->fm_prev;
-  SUFLOAT   pd_prev = ctx->pd_prev;
-  SUFLOAT   phase_diff;
+  SUFLOAT pd_last;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    phase_diff = SU_C_ARG(buffer[i] * SU_C_CONJ(fm_prev));
-    fm_prev = buffer[i];
-    buffer[i] = FMCYCLO_GAIN * SU_ABS(phase_diff - pd_prev);
-    pd_prev = phase_diff;
-  }
+  if (size == 0)
+    return SU_TRUE;
 
-  ctx->fm_prev = fm_prev;
-  ctx->pd_prev = pd_prev;
+  /* First pass: phase differences, stored in the output */
+  suscan_spectsrc_kernels_get()->phase_diff(
+    output,
+    input,
+    ctx->fm_prev,
+    1,
+    size);
+
+  pd_last = SU_C_REAL(output[size - 1]);
+
+  /* Second pass, backwards so that the previous difference is still there */
+  for (i = size - 1; i > 0; --i)
+    output[i] = FMCYCLO_GAIN
+      * SU_ABS(SU_C_REAL(output[i]) - SU_C_REAL(output[i - 1]));
+
+  output[0] = FMCYCLO_GAIN * SU_ABS(SU_C_REAL(output[0]) - ctx->pd_prev);
+
+  ctx->fm_prev = input[size - 1];
+  ctx->pd_prev = pd_last;
 
   return SU_TRUE;
 }
@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "fmspect-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
 
 #define FMSPECT_GAIN 1e-5
 
@@ -35,21 +36,23 @@ SUBOOL
 suscan_spectsrc_fmspect_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = SU_C_ARG(buffer[i] * SU_C_CONJ(prev));
-    prev = buffer[i];
-    buffer[i] = FMSPECT_GAIN * diff;
-  }
+  if (size == 0)
+    return SU_TRUE;
 
-  *last = prev;
+  suscan_spectsrc_kernels_get()->phase_diff(
+    output,
+    input,
+    *last,
+    FMSPECT_GAIN,
+    size);
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -0,0 +1,433 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SU_LOG_DOMAIN "spectsrc-kernels"
+
+#include <sigutils/log.h>
+#include "kernels.h"
+
+#ifdef SU_USE_VOLK
+#  include <volk/volk.h>
+#endif /* SU_USE_VOLK */
+
+/******************************* Scalar kernels *******************************/
+SUPRIVATE void
+suscan_spectsrc_scalar_conj_prod(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (len == 0)
+    return;
+
+  y[0] = k * (x[0] * SU_C_CONJ(prev));
+
+  for (i = 1; i < len; ++i)
+    y[i] = k * (x[i] * SU_C_CONJ(x[i - 1]));
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_phase_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (len == 0)
+    return;
+
+  y[0] = k * SU_C_ARG(x[0] * SU_C_CONJ(prev));
+
+  for (i = 1; i < len; ++i)
+    y[i] = k * SU_C_ARG(x[i] * SU_C_CONJ(x[i - 1]));
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_phase(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    y[i] = k * SU_C_ARG(x[i]);
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (len == 0)
+    return;
+
+  y[0] = x[0] - prev;
+
+  for (i = 1; i < len; ++i)
+    y[i] = x[i] - x[i - 1];
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_abs_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUSCOUNT len)
+{
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  if (len == 0)
+    return;
+
+  diff = x[0] - prev;
+  y[0] = diff * SU_C_CONJ(diff);
+
+  for (i = 1; i < len; ++i) {
+    diff = x[i] - x[i - 1];
+    y[i] = diff * SU_C_CONJ(diff);
+  }
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_exp_pow2(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  unsigned int order,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  SUCOMPLEX z;
+  SUSCOUNT i;
+  unsigned int j;
+
+  for (i = 0; i < len; ++i) {
+    z = x[i] / (SU_C_ABS(x[i]) + 1e-8);
+    for (j = 0; j < order; ++j)
+      z *= z;
+    y[i] = k * z;
+  }
+}
+
+SUPRIVATE void
+suscan_spectsrc_scalar_psd(
+  SUFLOAT *psd,
+  const SUCOMPLEX *x,
+  SUFLOAT k,
+  SUBOOL accum,
+  SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (accum)
+    for (i = 0; i < len; ++i)
+      psd[i] += k * SU_C_REAL(x[i] * SU_C_CONJ(x[i]));
+  else
+    for (i = 0; i < len; ++i)
+      psd[i] = k * SU_C_REAL(x[i] * SU_C_CONJ(x[i]));
+}
+
+SUPRIVATE const struct suscan_spectsrc_kernels g_scalar_kernels = {
+  .name       = SUSCAN_SPECTSRC_KERNELS_SCALAR,
+  .conj_prod  = suscan_spectsrc_scalar_conj_prod,
+  .phase_diff = suscan_spectsrc_scalar_phase_diff,
+  .phase      = suscan_spectsrc_scalar_phase,
+  .diff       = suscan_spectsrc_scalar_diff,
+  .abs_diff   = suscan_spectsrc_scalar_abs_diff,
+  .exp_pow2   = suscan_spectsrc_scalar_exp_pow2,
+  .psd        = suscan_spectsrc_scalar_psd
+};
+
+/******************************** VOLK kernels ********************************/
+/*
+ * VOLK kernels work on 32-bit floats only. VOLK picks the best machine
+ * (SSE, AVX, NEON...) for each kernel at runtime, so there is no need to
+ * dispatch on CPU features here. Real-valued intermediates go through a
+ * small scratch buffer in the stack, one block at a time.
+ */
+#if defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION)
+SUPRIVATE void
+suscan_spectsrc_volk_conj_prod(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  if (len == 0)
+    return;
+
+  y[0] = x[0] * SU_C_CONJ(prev);
+
+  if (len > 1)
+    volk_32fc_x2_multiply_conjugate_32fc(
+      (lv_32fc_t *) y + 1,
+      (const lv_32fc_t *) x + 1,
+      (const lv_32fc_t *) x,
+      len - 1);
+
+  if (k != 1)
+    volk_32f_s32f_multiply_32f((float *) y, (const float *) y, k, 2 * len);
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_phase(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  float scratch[SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE];
+  SUSCOUNT chunk, i;
+
+  /* Note that x and y may be the same here (see phase_diff) */
+  while (len > 0) {
+    chunk = SU_MIN(len, SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE);
+
+    /* atan2 output is divided by the normalization factor */
+    volk_32fc_s32f_atan2_32f(scratch, (const lv_32fc_t *) x, 1.f / k, chunk);
+
+    for (i = 0; i < chunk; ++i)
+      y[i] = scratch[i];
+
+    x   += chunk;
+    y   += chunk;
+    len -= chunk;
+  }
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_phase_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  /* Conjugate products in the output, then their phases in place */
+  suscan_spectsrc_volk_conj_prod(y, x, prev, 1, len);
+  suscan_spectsrc_volk_phase(y, y, k, len);
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUSCOUNT len)
+{
+  if (len == 0)
+    return;
+
+  y[0] = x[0] - prev;
+
+  if (len > 1)
+    volk_32f_x2_subtract_32f(
+      (float *) (y + 1),
+      (const float *) (x + 1),
+      (const float *) x,
+      2 * (len - 1));
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_abs_diff(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUCOMPLEX prev,
+  SUSCOUNT len)
+{
+  float scratch[SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE];
+  SUSCOUNT chunk, i;
+
+  suscan_spectsrc_volk_diff(y, x, prev, len);
+
+  while (len > 0) {
+    chunk = SU_MIN(len, SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE);
+
+    volk_32fc_magnitude_squared_32f(scratch, (const lv_32fc_t *) y, chunk);
+
+    for (i = 0; i < chunk; ++i)
+      y[i] = scratch[i];
+
+    y   += chunk;
+    len -= chunk;
+  }
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_exp_pow2(
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  unsigned int order,
+  SUFLOAT k,
+  SUSCOUNT len)
+{
+  float scratch[SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE];
+  SUSCOUNT chunk, i;
+  unsigned int j;
+
+  while (len > 0) {
+    chunk = SU_MIN(len, SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE);
+
+    volk_32fc_magnitude_32f(scratch, (const lv_32fc_t *) x, chunk);
+
+    for (i = 0; i < chunk; ++i)
+      scratch[i] = 1.f / (scratch[i] + 1e-8f);
+
+    volk_32fc_32f_multiply_32fc(
+      (lv_32fc_t *) y,
+      (const lv_32fc_t *) x,
+      scratch,
+      chunk);
+
+    for (j = 0; j < order; ++j)
+      volk_32fc_x2_multiply_32fc(
+        (lv_32fc_t *) y,
+        (const lv_32fc_t *) y,
+        (const lv_32fc_t *) y,
+        chunk);
+
+    volk_32f_s32f_multiply_32f((float *) y, (const float *) y, k, 2 * chunk);
+
+    x   += chunk;
+    y   += chunk;
+    len -= chunk;
+  }
+}
+
+SUPRIVATE void
+suscan_spectsrc_volk_psd(
+  SUFLOAT *psd,
+  const SUCOMPLEX *x,
+  SUFLOAT k,
+  SUBOOL accum,
+  SUSCOUNT len)
+{
+  float scratch[SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE];
+  SUSCOUNT chunk;
+
+  if (!accum) {
+    volk_32fc_magnitude_squared_32f(psd, (const lv_32fc_t *) x, len);
+    volk_32f_s32f_multiply_32f(psd, psd, k, len);
+    return;
+  }
+
+  while (len > 0) {
+    chunk = SU_MIN(len, SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE);
+
+    volk_32fc_magnitude_squared_32f(scratch, (const lv_32fc_t *) x, chunk);
+    volk_32f_s32f_multiply_32f(scratch, scratch, k, chunk);
+    volk_32f_x2_add_32f(psd, psd, scratch, chunk);
+
+    x   += chunk;
+    psd += chunk;
+    len -= chunk;
+  }
+}
+
+SUPRIVATE const struct suscan_spectsrc_kernels g_volk_kernels = {
+  .name       = "volk",
+  .conj_prod  = suscan_spectsrc_volk_conj_prod,
+  .phase_diff = suscan_spectsrc_volk_phase_diff,
+  .phase      = suscan_spectsrc_volk_phase,
+  .diff       = suscan_spectsrc_volk_diff,
+  .abs_diff   = suscan_spectsrc_volk_abs_diff,
+  .exp_pow2   = suscan_spectsrc_volk_exp_pow2,
+  .psd        = suscan_spectsrc_volk_psd
+};
+#endif /* defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION) */
+
+/****************************** Kernel selection ******************************/
+/* Ordered from least to most preferred */
+SUPRIVATE const struct suscan_spectsrc_kernels *g_kernel_list[] = {
+  &g_scalar_kernels,
+#if defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION)
+  &g_volk_kernels,
+#endif /* defined(SU_USE_VOLK) && defined(_SU_SINGLE_PRECISION) */
+};
+
+SUPRIVATE const struct suscan_spectsrc_kernels *g_kernels = &g_scalar_kernels;
+
+const struct suscan_spectsrc_kernels *
+suscan_spectsrc_kernels_get(void)
+{
+  return g_kernels;
+}
+
+const struct suscan_spectsrc_kernels *
+suscan_spectsrc_kernels_get_nth(unsigned int index)
+{
+  if (index >= sizeof(g_kernel_list) / sizeof(g_kernel_list[0]))
+    return NULL;
+
+  return g_kernel_list[index];
+}
+
+const struct suscan_spectsrc_kernels *
+suscan_spectsrc_kernels_lookup(const char *name)
+{
+  const struct suscan_spectsrc_kernels *kernels;
+  unsigned int i = 0;
+
+  while ((kernels = suscan_spectsrc_kernels_get_nth(i++)) != NULL)
+    if (strcmp(kernels->name, name) == 0)
+      return kernels;
+
+  return NULL;
+}
+
+SUBOOL
+suscan_spectsrc_kernels_init(void)
+{
+  const struct suscan_spectsrc_kernels *kernels = NULL;
+  const char *name = getenv("SUSCAN_SPECTSRC_KERNELS");
+  unsigned int count = sizeof(g_kernel_list) / sizeof(g_kernel_list[0]);
+
+  if (name != NULL) {
+    if ((kernels = suscan_spectsrc_kernels_lookup(name)) == NULL)
+      SU_WARNING(
+        "Spectrum source kernels `%s' not available, using defaults\n",
+        name);
+  }
+
+  if (kernels == NULL)
+    kernels = g_kernel_list[count - 1];
+
+  g_kernels = kernels;
+
+  SU_INFO("Spectrum source kernels: %s\n", g_kernels->name);
+
+  return SU_TRUE;
+}
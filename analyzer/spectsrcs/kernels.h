@@ -0,0 +1,117 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _ANALYZER_SPECTSRCS_KERNELS_H
+#define _ANALYZER_SPECTSRCS_KERNELS_H
+
+#include <sigutils/types.h>
+#include <sigutils/defs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Preprocessing and PSD kernels of the spectrum sources. Every kernel exists
+ * in a scalar implementation, and in SIMD implementations where available.
+ * The implementation used by the spectrum sources is chosen once, by
+ * suscan_spectsrc_kernels_init. It can be forced with the environment
+ * variable SUSCAN_SPECTSRC_KERNELS (e.g. SUSCAN_SPECTSRC_KERNELS=scalar).
+ *
+ * Output buffers never alias input buffers. Kernels that need the sample
+ * before the first one of the block take it as an argument (prev).
+ */
+
+#define SUSCAN_SPECTSRC_KERNELS_SCALAR     "scalar"
+#define SUSCAN_SPECTSRC_KERNELS_BLOCK_SIZE 512
+
+struct suscan_spectsrc_kernels {
+  const char *name;
+
+  /* y[n] = k * x[n] * conj(x[n - 1]) */
+  void (*conj_prod) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUCOMPLEX prev,
+    SUFLOAT k,
+    SUSCOUNT len);
+
+  /* y[n] = k * arg(x[n] * conj(x[n - 1])) */
+  void (*phase_diff) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUCOMPLEX prev,
+    SUFLOAT k,
+    SUSCOUNT len);
+
+  /* y[n] = k * arg(x[n]) */
+  void (*phase) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUFLOAT k,
+    SUSCOUNT len);
+
+  /* y[n] = x[n] - x[n - 1] */
+  void (*diff) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUCOMPLEX prev,
+    SUSCOUNT len);
+
+  /* y[n] = |x[n] - x[n - 1]|^2 */
+  void (*abs_diff) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUCOMPLEX prev,
+    SUSCOUNT len);
+
+  /* y[n] = k * (x[n] / |x[n]|)^(2^order) */
+  void (*exp_pow2) (
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    unsigned int order,
+    SUFLOAT k,
+    SUSCOUNT len);
+
+  /* psd[n] = k * |x[n]|^2, added to psd[n] if accum is set */
+  void (*psd) (
+    SUFLOAT *psd,
+    const SUCOMPLEX *x,
+    SUFLOAT k,
+    SUBOOL accum,
+    SUSCOUNT len);
+};
+
+/* Kernels chosen by suscan_spectsrc_kernels_init (scalar before that) */
+const struct suscan_spectsrc_kernels *suscan_spectsrc_kernels_get(void);
+
+/* Any of the available implementations, by name */
+const struct suscan_spectsrc_kernels *suscan_spectsrc_kernels_lookup(
+  const char *name);
+
+const struct suscan_spectsrc_kernels *suscan_spectsrc_kernels_get_nth(
+  unsigned int index);
+
+SUBOOL suscan_spectsrc_kernels_init(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ANALYZER_SPECTSRCS_KERNELS_H */
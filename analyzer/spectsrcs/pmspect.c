@@ -22,6 +22,8 @@
 #define SU_LOG_DOMAIN "pmspect-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
+
 #define PM_DEMOD_GAIN 1e-5
 
 void *
@@ -35,13 +37,11 @@ SUBOOL
 suscan_spectsrc_pmspect_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
-  SUSCOUNT i;
-
-  for (i = 0; i < size; ++i)
-    buffer[i] = PM_DEMOD_GAIN * SU_C_ARG(buffer[i]);
+  suscan_spectsrc_kernels_get()->phase(output, input, PM_DEMOD_GAIN, size);
 
   return SU_TRUE;
 }
@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "timediff-spectsrc"
 
 #include "spectsrc.h"
+#include "kernels.h"
 
 void *
 suscan_spectsrc_timediff_ctor(suscan_spectsrc_t *src)
@@ -33,21 +34,18 @@ SUBOOL
 suscan_spectsrc_timediff_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff;
-  }
+  if (size == 0)
+    return SU_TRUE;
 
-  *last = prev;
+  suscan_spectsrc_kernels_get()->diff(output, input, *last, size);
+
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -56,21 +54,18 @@ SUBOOL
 suscan_spectsrc_abstimediff_preproc(
     suscan_spectsrc_t *src,
     void *private,
-    SUCOMPLEX *buffer,
+    const SUCOMPLEX *input,
+    SUCOMPLEX *output,
     SUSCOUNT size)
 {
   SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff * SU_C_CONJ(diff);
-  }
+  if (size == 0)
+    return SU_TRUE;
+
+  suscan_spectsrc_kernels_get()->abs_diff(output, input, *last, size);
 
-  *last = prev;
+  *last = input[size - 1];
 
   return SU_TRUE;
 }
@@ -77,6 +77,9 @@ suscan_local_analyzer_process_end(suscan_local_analyzer_t *analyzer)
 
 
 /********************* Related channel analyzer funcs ************************/
+SUPRIVATE SUBOOL suscan_local_analyzer_feed_bin_channels(
+    suscan_local_analyzer_t *self);
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_feed_baseband_filters(
     suscan_local_analyzer_t *self,
@@ -85,6 +88,11 @@ suscan_local_analyzer_feed_baseband_filters(
 {
   struct rbtree_node *this;
   struct suscan_analyzer_baseband_filter *bbfilt;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->bbfilt_mutex));
+  mutex_acquired = SU_TRUE;
 
   this = rbtree_get_first(self->bbfilt_tree);
 
@@ -97,13 +105,43 @@ suscan_local_analyzer_feed_baseband_filters(
           samples,
           length,
           suscan_source_get_consumed_samples(self->source) - length))
-        return SU_FALSE;
+        goto done;
     }
 
     this = rbtree_node_next(this);
   }
 
-  return SU_TRUE;
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->bbfilt_mutex);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_pfb(
+    suscan_local_analyzer_t *self,
+    const SUCOMPLEX *data,
+    SUSCOUNT size)
+{
+  SUBOOL ok;
+
+  if (pthread_mutex_lock(&self->stuner_mutex) != 0)
+    return SU_FALSE;
+
+  ok = suscan_pfb_feed(self->pfb, data, size);
+
+  /* Channel buffers are reused in the next call. Wait for the inspectors. */
+  if (suscan_pfb_new_data(self->pfb)) {
+    suscan_inspector_factory_force_sync(self->insp_factory);
+    suscan_pfb_ack_data(self->pfb);
+  }
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  return ok;
 }
 
 SUPRIVATE SUBOOL
@@ -116,6 +154,13 @@ suscan_local_analyzer_feed_inspectors(
   SUSCOUNT size = suscan_sample_buffer_size(buffer);
   SUBOOL ok = SU_TRUE;
 
+  if (self->pfb != NULL && suscan_pfb_get_channel_count(self->pfb) > 0)
+    if (!suscan_local_analyzer_feed_pfb(
+      self,
+      data,
+      self->circularity ? size >> 1 : size))
+      return SU_FALSE;
+
   /*
    * No opened channels. We can avoid doing extra work. However, we
    * should clean the tuner in this case to keep it from having
@@ -124,7 +169,8 @@ suscan_local_analyzer_feed_inspectors(
    * On the other hand, if circularity is enabled, we want to
    * have the state in sync with the read buffer state.
    */
-  if (su_specttuner_get_channel_count(self->stuner) == 0)
+  if (su_specttuner_get_channel_count(self->stuner) == 0
+    && self->bin_chan_active == 0)
     return SU_TRUE;
 
   if (self->circularity) {
@@ -138,6 +184,9 @@ suscan_local_analyzer_feed_inspectors(
     ok = su_specttuner_trigger(
       self->stuner,
       suscan_sample_buffer_userdata(buffer));
+
+    if (ok)
+      ok = suscan_local_analyzer_feed_bin_channels(self);
     
     suscan_inspector_factory_force_sync(self->insp_factory);
       
@@ -161,6 +210,8 @@ suscan_local_analyzer_feed_inspectors(
         * ensure that all of them are done by issuing a barrier at the end
         * of the worker queue.
         */
+        if (!suscan_local_analyzer_feed_bin_channels(self))
+          ok = SU_FALSE;
 
         suscan_inspector_factory_force_sync(self->insp_factory);
 
@@ -180,6 +231,54 @@ suscan_local_analyzer_feed_inspectors(
   return ok;
 }
 
+/* Additional channels of multi-channel sources */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_streams(
+    suscan_local_analyzer_t *self,
+    SUSCOUNT length)
+{
+  su_specttuner_t *tuner;
+  SUCOMPLEX *data;
+  SUSCOUNT size;
+  SUSDIFF got;
+  unsigned int i;
+
+  for (i = 1; i < self->stream_count; ++i) {
+    tuner = self->stream_tuner[i];
+
+    if (su_specttuner_get_channel_count(tuner) == 0)
+      continue;
+
+    data = self->stream_buf[i];
+    size = length;
+
+    if (self->iq_rev)
+      suscan_analyzer_do_iq_rev(data, size);
+
+    while (size > 0) {
+      if (pthread_mutex_lock(&self->stuner_mutex) != 0)
+        return SU_FALSE;
+
+      got = su_specttuner_feed_bulk_single(tuner, data, size);
+
+      if (su_specttuner_new_data(tuner)) {
+        suscan_inspector_factory_force_sync(self->insp_factory);
+        su_specttuner_ack_data(tuner);
+      }
+
+      (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+      if (got == -1)
+        return SU_FALSE;
+
+      data += got;
+      size -= got;
+    }
+  }
+
+  return SU_TRUE;
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_on_channel_data(
     const struct sigutils_specttuner_channel *channel,
@@ -199,6 +298,25 @@ suscan_local_analyzer_on_channel_data(
     size);
 }
 
+SUPRIVATE SUBOOL
+suscan_local_analyzer_on_pfb_data(
+    const struct suscan_pfb_channel *channel,
+    void *userdata,
+    const SUCOMPLEX *data,
+    SUSCOUNT size)
+{
+  suscan_inspector_t *insp = (suscan_inspector_t *) userdata;
+
+  if (insp == NULL)
+    return SU_TRUE;
+
+  return suscan_inspector_factory_feed(
+    suscan_inspector_get_factory(insp),
+    insp,
+    data,
+    size);
+}
+
 SUPRIVATE void
 suscan_local_analyzer_on_new_freq(
     const struct sigutils_specttuner_channel *channel,
@@ -219,9 +337,27 @@ suscan_local_analyzer_on_new_freq(
 }
 
 /*********************** Channel opening and closing *************************/
-SUPRIVATE su_specttuner_channel_t *
-suscan_local_analyzer_open_channel_ex(
+SUINLINE su_specttuner_t *
+suscan_local_analyzer_get_stream_tuner(
     suscan_local_analyzer_t *self,
+    unsigned int stream)
+{
+  if (stream >= self->stream_count && stream > 0) {
+    SU_ERROR(
+      "Invalid source channel %d (source has %d)\n",
+      stream,
+      self->stream_count);
+    return NULL;
+  }
+
+  return stream == 0 ? self->stuner : self->stream_tuner[stream];
+}
+
+/* Channels of any of the coherent channels of the source */
+su_specttuner_channel_t *
+suscan_local_analyzer_open_stream_channel(
+    suscan_local_analyzer_t *self,
+    unsigned int stream,
     const struct sigutils_channel *chan_info,
     SUBOOL precise,
     su_specttuner_channel_data_func_t on_data,
@@ -229,10 +365,13 @@ suscan_local_analyzer_open_channel_ex(
     void *privdata)
 {
   SUBOOL mutex_acquired = SU_FALSE;
+  su_specttuner_t *tuner;
   su_specttuner_channel_t *channel = NULL;
   struct sigutils_specttuner_channel_params params =
       sigutils_specttuner_channel_params_INITIALIZER;
 
+  SU_TRY(tuner = suscan_local_analyzer_get_stream_tuner(self, stream));
+
   params.f0 =
       SU_NORM2ANG_FREQ(
           SU_ABS2NORM_FREQ(
@@ -259,7 +398,7 @@ suscan_local_analyzer_open_channel_ex(
   mutex_acquired = SU_TRUE;
 
   SU_TRYCATCH(
-      channel = su_specttuner_open_channel(self->stuner, &params),
+      channel = su_specttuner_open_channel(tuner, &params),
       goto done);
 
 done:
@@ -269,11 +408,193 @@ done:
   return channel;
 }
 
-/* TODO: Move this logic to factory impl */
-SUPRIVATE SUBOOL
-suscan_local_analyzer_close_channel(
+SUBOOL
+suscan_local_analyzer_close_stream_channel(
     suscan_local_analyzer_t *self,
+    unsigned int stream,
     su_specttuner_channel_t *channel)
+{
+  SUBOOL mutex_acquired = SU_FALSE;
+  su_specttuner_t *tuner;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(tuner = suscan_local_analyzer_get_stream_tuner(self, stream));
+
+  SU_TRYCATCH(pthread_mutex_lock(&self->stuner_mutex) == 0, goto done);
+  mutex_acquired = SU_TRUE;
+
+  ok = su_specttuner_close_channel(tuner, channel);
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  return ok;
+}
+
+/************************ Raster channelizer channels ************************/
+/*
+ * Inspectors are served by the raster channelizer if it exists, their
+ * channel fits in one raster spacing and they sit on the raster. The rest
+ * go to the spectral tuner. Raster channels are always delivered at twice
+ * the raster spacing, but they are filtered down to their bandwidth.
+ */
+#define SUSCAN_LOCAL_ANALYZER_RASTER_TOLERANCE 1e-2 /* In raster spacings */
+
+struct suscan_local_inspector_channel {
+  su_specttuner_channel_t *schan;
+  suscan_pfb_channel_t    *pchan;
+  suscan_inspector_t      *insp;
+  SUBOOL                   raster;
+  unsigned int             stream;  /* Source channel, spectral tuner only */
+
+  /* Raster channels only. Frequencies are relative to the tuner */
+  SUFREQ  freq;
+  SUFLOAT delta;
+  SUFLOAT bw;
+
+  /*
+   * Suspended channels are closed. Spectral tuner channels keep their
+   * parameters here until they are reopened.
+   */
+  SUBOOL  suspended;
+  struct sigutils_specttuner_channel_params sparams;
+  SUFLOAT suspended_f0;
+  SUFLOAT new_bw;  /* Requested while suspended, 0 if none */
+
+  /*
+   * Frequency-domain channels of the main tuner hold no tuner channel
+   * while in the frequency domain. They keep the bin count and the
+   * decimation of the tuner channel they were opened with.
+   */
+  SUBOOL       bins;
+  unsigned int bin_index;
+  SUSCOUNT     bin_width;
+  SUFLOAT      decimation;
+  SUCOMPLEX   *bin_buf;
+};
+
+SUINLINE SUFLOAT
+suscan_local_analyzer_get_raster_spacing(const suscan_local_analyzer_t *self)
+{
+  return SU_ASFLOAT(suscan_analyzer_get_samp_rate(self->parent))
+    / suscan_pfb_get_branches(self->pfb);
+}
+
+SUINLINE SUFLOAT
+suscan_local_analyzer_get_raster_rate(const suscan_local_analyzer_t *self)
+{
+  return SU_ASFLOAT(suscan_analyzer_get_samp_rate(self->parent))
+    / suscan_pfb_get_decimation(self->pfb);
+}
+
+/* Angular frequency at the channel rate, as the spectral tuner reports it */
+SUPRIVATE SUFLOAT
+suscan_local_analyzer_get_raster_angfreq(
+  const suscan_local_analyzer_t *self,
+  SUFREQ freq)
+{
+  if (freq < 0)
+    freq += suscan_analyzer_get_samp_rate(self->parent);
+
+  return SU_NORM2ANG_FREQ(
+    SU_ABS2NORM_FREQ(suscan_local_analyzer_get_raster_rate(self), freq));
+}
+
+/* Nearest raster bin. The remaining offset is left in residual */
+SUPRIVATE unsigned int
+suscan_local_analyzer_get_raster_bin(
+  const suscan_local_analyzer_t *self,
+  SUFREQ freq,
+  SUFLOAT *residual)
+{
+  int64_t branches = suscan_pfb_get_branches(self->pfb);
+  SUFLOAT spacing  = suscan_local_analyzer_get_raster_spacing(self);
+  int64_t k        = SU_FLOOR(freq / spacing + .5);
+
+  *residual = freq - k * spacing;
+
+  k %= branches;
+  if (k < 0)
+    k += branches;
+
+  return k;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_is_on_raster(
+  const suscan_local_analyzer_t *self,
+  const char *classname,
+  const struct sigutils_channel *channel)
+{
+  const struct suscan_inspector_interface *iface;
+  SUFLOAT spacing, residual;
+
+  if (self->pfb == NULL)
+    return SU_FALSE;
+
+  /* The channelizer only delivers time-domain samples */
+  iface = suscan_inspector_interface_lookup(classname);
+  if (iface == NULL || iface->frequency_domain)
+    return SU_FALSE;
+
+  spacing = suscan_local_analyzer_get_raster_spacing(self);
+  if (channel->f_hi - channel->f_lo > spacing)
+    return SU_FALSE;
+
+  (void) suscan_local_analyzer_get_raster_bin(
+    self,
+    channel->fc - channel->ft,
+    &residual);
+
+  return SU_ABS(residual) <= SUSCAN_LOCAL_ANALYZER_RASTER_TOLERANCE * spacing;
+}
+
+/* Must be called with the tuner mutex held */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_filter_raster_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  /* Suspended, filtered when reopened */
+  if (chan->pchan == NULL)
+    return SU_TRUE;
+
+  return suscan_pfb_set_channel_bandwidth(
+    self->pfb,
+    chan->pchan,
+    SU_ABS2NORM_FREQ(suscan_local_analyzer_get_raster_rate(self), chan->bw));
+}
+
+/* Must be called with the tuner mutex held */
+SUPRIVATE void
+suscan_local_analyzer_retune_raster_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  SUFLOAT residual;
+  unsigned int bin;
+
+  /* Suspended, retuned when reopened */
+  if (chan->pchan == NULL)
+    return;
+
+  bin = suscan_local_analyzer_get_raster_bin(self, chan->freq, &residual);
+
+  suscan_pfb_set_channel_freq(
+    self->pfb,
+    chan->pchan,
+    bin,
+    SU_NORM2ANG_FREQ(
+      SU_ABS2NORM_FREQ(
+        suscan_local_analyzer_get_raster_rate(self),
+        residual + chan->delta)));
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_open_raster_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
 {
   SUBOOL mutex_acquired = SU_FALSE;
   SUBOOL ok = SU_FALSE;
@@ -281,7 +602,17 @@ suscan_local_analyzer_close_channel(
   SU_TRYCATCH(pthread_mutex_lock(&self->stuner_mutex) == 0, goto done);
   mutex_acquired = SU_TRUE;
 
-  ok = su_specttuner_close_channel(self->stuner, channel);
+  SU_TRY(
+    chan->pchan = suscan_pfb_open_channel(
+      self->pfb,
+      0,
+      suscan_local_analyzer_on_pfb_data,
+      chan->insp));
+
+  suscan_local_analyzer_retune_raster_channel(self, chan);
+  SU_TRY(suscan_local_analyzer_filter_raster_channel(self, chan));
+
+  ok = SU_TRUE;
 
 done:
   if (mutex_acquired)
@@ -290,6 +621,141 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_local_analyzer_close_raster_channel(
+  suscan_local_analyzer_t *self,
+  suscan_pfb_channel_t *channel)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(pthread_mutex_lock(&self->stuner_mutex) == 0, return SU_FALSE);
+
+  ok = suscan_pfb_close_channel(self->pfb, channel);
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  return ok;
+}
+
+/************************ Frequency-domain bin channels **********************/
+/*
+ * Frequency-domain inspectors only need the bins of their channel, which
+ * are already in the forward FFT of the spectral tuner. Instead of opening
+ * a tuner channel (with its own buffers and inverse FFT plan), they copy
+ * them from there, once per tuner FFT. They are still opened as tuner
+ * channels, which fixes their sampling info, and give that channel up in
+ * the next loop of the source thread.
+ *
+ * Bins are scaled by the inverse of the window size. With this scaling,
+ * the energy of the bins of a channel in one FFT is its mean power times
+ * the power gain of the window (3/8 for the Hann window of early
+ * windowing, 1 otherwise), which is what the power inspector compensates
+ * in the frequency domain. Both domains then report the same power.
+ */
+
+/* Forward FFT of the last window, valid until the tuner data is acked */
+SUINLINE const SUCOMPLEX *
+suscan_local_analyzer_get_tuner_fft(const suscan_local_analyzer_t *self)
+{
+  return (const SUCOMPLEX *) self->stuner->fft;
+}
+
+SUINLINE SUSCOUNT
+suscan_local_analyzer_get_bin_start(
+  const suscan_local_analyzer_t *self,
+  const struct suscan_local_inspector_channel *chan)
+{
+  int64_t size = self->stuner->params.window_size;
+  int64_t k;
+
+  k = SU_FLOOR(
+      (chan->sparams.f0 + chan->sparams.delta_f) / (2 * PI) * size + .5);
+  k -= chan->bin_width >> 1;
+
+  k %= size;
+  if (k < 0)
+    k += size;
+
+  return k;
+}
+
+/* Must be called with the tuner mutex held, before the tuner data is acked */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_bin_channels(suscan_local_analyzer_t *self)
+{
+  struct suscan_local_inspector_channel *chan;
+  const SUCOMPLEX *fft;
+  SUSCOUNT size, i, k;
+  SUFLOAT gain;
+  unsigned int n;
+
+  if (self->bin_chan_active == 0)
+    return SU_TRUE;
+
+  fft  = suscan_local_analyzer_get_tuner_fft(self);
+  size = self->stuner->params.window_size;
+  gain = 1. / size;
+
+  for (n = 0; n < self->bin_chan_count; ++n) {
+    chan = self->bin_chan_list[n];
+    if (chan == NULL
+      || chan->insp == NULL
+      || !suscan_inspector_is_freq_domain(chan->insp))
+      continue;
+
+    k = suscan_local_analyzer_get_bin_start(self, chan);
+
+    for (i = 0; i < chan->bin_width; ++i) {
+      chan->bin_buf[i] = gain * fft[k];
+      if (++k == size)
+        k = 0;
+    }
+
+    /* Buffers are not touched until the next tuner FFT */
+    SU_TRYCATCH(
+      suscan_inspector_factory_feed(
+        suscan_inspector_get_factory(chan->insp),
+        chan->insp,
+        chan->bin_buf,
+        chan->bin_width),
+      return SU_FALSE);
+  }
+
+  return SU_TRUE;
+}
+
+/* Must be called with the tuner mutex held */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_attach_bin_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  int index;
+
+  if (chan->bin_buf == NULL)
+    SU_ALLOCATE_MANY_FAIL(chan->bin_buf, chan->bin_width, SUCOMPLEX);
+
+  SU_TRYC_FAIL(index = PTR_LIST_APPEND_CHECK(self->bin_chan, chan));
+
+  chan->bin_index = index;
+  ++self->bin_chan_active;
+
+  return SU_TRUE;
+
+fail:
+  return SU_FALSE;
+}
+
+/* Must be called with the tuner mutex held */
+SUPRIVATE void
+suscan_local_analyzer_detach_bin_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  self->bin_chan_list[chan->bin_index] = NULL;
+  --self->bin_chan_active;
+}
+
 /**************** Implementation of the local inspector factory **************/
 SUPRIVATE void *
 suscan_local_inspector_factory_ctor(suscan_inspector_factory_t *parent, va_list ap)
@@ -323,40 +789,83 @@ suscan_local_inspector_factory_open(
   unsigned int samp_rate = suscan_analyzer_get_samp_rate(self->parent);
   const char *classname;
   const struct sigutils_channel *channel;
+  struct suscan_local_inspector_channel *chan = NULL;
   su_specttuner_channel_t *schan;
+  unsigned int decimation;
+  SUFREQ f0;
   SUBOOL precise;
+  unsigned int stream;
 
   classname = va_arg(ap, const char *);
   channel   = va_arg(ap, const struct sigutils_channel *);
   precise   = va_arg(ap, SUBOOL);
+  stream    = va_arg(ap, unsigned int);
 
-  schan = suscan_local_analyzer_open_channel_ex(
-    self,
-    channel,
-    precise,
-    suscan_local_analyzer_on_channel_data,
-    suscan_local_analyzer_on_new_freq,
-    NULL);
-
-  if (schan == NULL) {
-    SU_ERROR("Local inspector factory: failed to open channel (invalid channel?)\n");
-    return NULL;
+  SU_ALLOCATE_FAIL(chan, struct suscan_local_inspector_channel);
+
+  /* The raster channelizer only sees the first source channel */
+  if (stream == 0
+    && suscan_local_analyzer_is_on_raster(self, classname, channel)) {
+    chan->raster = SU_TRUE;
+    chan->freq   = channel->fc - channel->ft;
+    chan->bw     = channel->f_hi - channel->f_lo;
+
+    SU_TRY_FAIL(suscan_local_analyzer_open_raster_channel(self, chan));
+
+    decimation = suscan_pfb_get_decimation(self->pfb);
+    f0 = chan->freq < 0 ? chan->freq + samp_rate : chan->freq;
+
+    samp_info->equiv_fs   = SU_ASFLOAT(samp_rate) / decimation;
+    samp_info->bw_bd      = SU_ABS2NORM_FREQ(samp_rate, chan->bw);
+    samp_info->bw         = .5 * decimation * samp_info->bw_bd;
+    samp_info->f0         = SU_ABS2NORM_FREQ(samp_rate, f0);
+    samp_info->fft_size   = suscan_pfb_get_branches(self->pfb);
+    samp_info->fft_bins   = 1;
+    samp_info->early_windowing = SU_FALSE;
+
+    samp_info->decimation = decimation;
+  } else {
+    schan = suscan_local_analyzer_open_stream_channel(
+      self,
+      stream,
+      channel,
+      precise,
+      suscan_local_analyzer_on_channel_data,
+      suscan_local_analyzer_on_new_freq,
+      NULL);
+
+    if (schan == NULL) {
+      SU_ERROR("Local inspector factory: failed to open channel (invalid channel?)\n");
+      goto fail;
+    }
+
+    chan->schan      = schan;
+    chan->stream     = stream;
+    chan->bin_width  = schan->width;
+    chan->decimation = schan->decimation;
+
+    /* Initialize sampling info */
+    samp_info->equiv_fs   = SU_ASFLOAT(samp_rate) / schan->decimation;
+    samp_info->bw_bd      = SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(schan));
+    samp_info->bw         = .5 * schan->decimation * samp_info->bw_bd;
+    samp_info->f0         = SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(schan));
+    samp_info->fft_size   = schan->size;
+    samp_info->fft_bins   = schan->width;
+    samp_info->early_windowing = su_specttuner_uses_early_windowing(self->stuner);
+
+    samp_info->decimation = schan->decimation;
   }
 
   /* Prepare output fields */
   *inspclass = classname;
 
-  /* Initialize sampling info */
-  samp_info->equiv_fs   = SU_ASFLOAT(samp_rate) / schan->decimation;
-  samp_info->bw_bd      = SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(schan));
-  samp_info->bw         = .5 * schan->decimation * samp_info->bw_bd;
-  samp_info->f0         = SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(schan));
-  samp_info->fft_size   = schan->size;
-  samp_info->fft_bins   = schan->width;
-  samp_info->early_windowing = su_specttuner_uses_early_windowing(self->stuner);
+  return chan;
+
+fail:
+  if (chan != NULL)
+    free(chan);
 
-  samp_info->decimation = schan->decimation;
-  return schan;
+  return NULL;
 }
 
 SUPRIVATE void
@@ -365,17 +874,23 @@ suscan_local_inspector_factory_bind(
   void *insp_self, 
   suscan_inspector_t *insp)
 {
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_self;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_self;
+
+  /* TODO: Assign inspector to channel and open a handle (use SU_REF) */
+  if (chan->raster)
+    chan->pchan->privdata = insp;
+  else
+    chan->schan->params.privdata = insp;
+
+  chan->insp = insp;
+
+  SU_REF(insp, specttuner);
 
   /* We need to do this here. */
   suscan_inspector_set_domain(
     insp,
     suscan_inspector_is_freq_domain(insp));
-
-  /* TODO: Assign inspector to channel and open a handle (use SU_REF) */
-  chan->params.privdata = insp;
-
-  SU_REF(insp, specttuner);
 }
 
 SUPRIVATE void
@@ -384,15 +899,32 @@ suscan_local_inspector_factory_close(
   void *insp_self)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_self;
-  suscan_inspector_t *insp      = (suscan_inspector_t *) chan->params.privdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_self;
 
   /* For channels created before binding */
-  if (insp != NULL)
-    SU_DEREF(insp, specttuner);
+  if (chan->insp != NULL)
+    SU_DEREF(chan->insp, specttuner);
+
+  if (chan->schan != NULL) {
+    if (!suscan_local_analyzer_close_stream_channel(
+      self,
+      chan->stream,
+      chan->schan))
+      SU_WARNING("Failed to close channel!\n");
+  } else if (chan->pchan != NULL) {
+    if (!suscan_local_analyzer_close_raster_channel(self, chan->pchan))
+      SU_WARNING("Failed to close raster channel!\n");
+  } else if (chan->bins && !chan->suspended) {
+    (void) pthread_mutex_lock(&self->stuner_mutex);
+    suscan_local_analyzer_detach_bin_channel(self, chan);
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+  }
+
+  if (chan->bin_buf != NULL)
+    free(chan->bin_buf);
 
-  if (!suscan_local_analyzer_close_channel(self, chan))
-    SU_WARNING("Failed to close channel!\n");
+  free(chan);
 }
 
 SUPRIVATE void
@@ -412,15 +944,43 @@ suscan_local_inspector_factory_set_bandwidth(
   SUFLOAT bandwidth)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
   SUFLOAT relbw;
+  SUBOOL ok;
+
+  /* Raster channels keep their rate, only their filter changes */
+  if (chan->raster) {
+    if (bandwidth > suscan_local_analyzer_get_raster_spacing(self))
+      SU_WARNING("Bandwidth exceeds the raster spacing, edges will be lost\n");
+
+    SU_TRYCATCH(
+      pthread_mutex_lock(&self->stuner_mutex) == 0,
+      return SU_FALSE);
+
+    chan->bw = bandwidth;
+    ok = suscan_local_analyzer_filter_raster_channel(self, chan);
+
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+    return ok;
+  }
 
   relbw = SU_NORM2ANG_FREQ(
     SU_ABS2NORM_FREQ(
       suscan_analyzer_get_samp_rate(self->parent),
       bandwidth));
 
-  (void) su_specttuner_set_channel_bandwidth(self->stuner, chan, relbw);
+  /* Bin channels keep their bin count, the bandwidth applies on reopen */
+  if (chan->schan == NULL) {
+    chan->new_bw = relbw;
+    return SU_TRUE;
+  }
+
+  (void) su_specttuner_set_channel_bandwidth(
+    suscan_local_analyzer_get_stream_tuner(self, chan->stream),
+    chan->schan,
+    relbw);
 
   return SU_TRUE;
 }
@@ -431,8 +991,17 @@ suscan_local_inspector_factory_get_bandwidth(
   void *insp_userdata)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
-  SUFLOAT relbw = su_specttuner_channel_get_bw(chan);
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
+  SUFLOAT relbw;
+
+  if (chan->raster)
+    return chan->bw;
+
+  if (chan->schan == NULL)
+    relbw = chan->new_bw > 0 ? chan->new_bw : chan->sparams.bw;
+  else
+    relbw = su_specttuner_channel_get_bw(chan->schan);
 
   return SU_NORM2ABS_FREQ(
     suscan_analyzer_get_samp_rate(self->parent),
@@ -446,8 +1015,36 @@ suscan_local_inspector_factory_set_frequency(
   SUFREQ frequency)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
-  SUFLOAT f0;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
+  SUFLOAT f0, prev_f0;
+
+  /*
+   * Raster channels move to the nearest bin and correct the rest with
+   * their own oscillator.
+   */
+  if (chan->raster) {
+    SU_TRYCATCH(
+      pthread_mutex_lock(&self->stuner_mutex) == 0,
+      return SU_FALSE);
+
+    prev_f0    = suscan_local_analyzer_get_raster_angfreq(self, chan->freq);
+    chan->freq = frequency;
+    f0         = suscan_local_analyzer_get_raster_angfreq(self, chan->freq);
+
+    suscan_local_analyzer_retune_raster_channel(self, chan);
+
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+    if (chan->insp != NULL)
+      suscan_inspector_factory_notify_freq(
+        suscan_inspector_get_factory(chan->insp),
+        chan->insp,
+        prev_f0,
+        f0);
+
+    return SU_TRUE;
+  }
 
   f0 = SU_NORM2ANG_FREQ(
         SU_ABS2NORM_FREQ(
@@ -457,7 +1054,37 @@ suscan_local_inspector_factory_set_frequency(
   if (f0 < 0)
     f0 += 2 * PI;
 
-  (void) su_specttuner_set_channel_freq(self->stuner, chan, f0);
+  /* The tuner reports nothing for bin channels, notify the retune here */
+  if (chan->bins && !chan->suspended) {
+    SU_TRYCATCH(
+      pthread_mutex_lock(&self->stuner_mutex) == 0,
+      return SU_FALSE);
+
+    prev_f0            = chan->sparams.f0;
+    chan->sparams.f0   = f0;
+    chan->suspended_f0 = f0;
+
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+    if (chan->insp != NULL)
+      suscan_inspector_factory_notify_freq(
+        suscan_inspector_get_factory(chan->insp),
+        chan->insp,
+        prev_f0 * chan->decimation,
+        f0 * chan->decimation);
+
+    return SU_TRUE;
+  }
+
+  if (chan->schan == NULL) {
+    chan->sparams.f0 = f0;
+    return SU_TRUE;
+  }
+
+  (void) su_specttuner_set_channel_freq(
+    suscan_local_analyzer_get_stream_tuner(self, chan->stream),
+    chan->schan,
+    f0);
 
   return SU_TRUE;
 }
@@ -468,10 +1095,36 @@ suscan_local_inspector_factory_set_domain(
   void *insp_userdata, 
   SUBOOL is_freq)
 {
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
-  
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
+
+  if (chan->raster) {
+    if (is_freq) {
+      SU_ERROR("Raster channels cannot deliver frequency-domain samples\n");
+      return SU_FALSE;
+    }
+
+    return SU_TRUE;
+  }
+
+  /*
+   * Channels of the main tuner switch between a tuner channel and its
+   * bins in the source thread, as this may be called from the workers
+   * while the tuner is locked. Until then, bin channels are skipped.
+   */
+  if (chan->stream == 0 && is_freq != chan->bins)
+    self->bin_sync_pending = SU_TRUE;
+
+  if (chan->schan == NULL) {
+    chan->sparams.domain = is_freq
+      ? SU_SPECTTUNER_CHANNEL_FREQUENCY_DOMAIN
+      : SU_SPECTTUNER_CHANNEL_TIME_DOMAIN;
+    return SU_TRUE;
+  }
+
   su_specttuner_channel_set_domain(
-    chan,
+    chan->schan,
     is_freq 
     ? SU_SPECTTUNER_CHANNEL_FREQUENCY_DOMAIN
     : SU_SPECTTUNER_CHANNEL_TIME_DOMAIN);    
@@ -485,13 +1138,22 @@ suscan_local_inspector_factory_get_abs_freq(
   void *insp_userdata)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
   unsigned int samp_rate = suscan_analyzer_get_samp_rate(self->parent);
   SUFREQ tuner_freq = self->source_info.frequency;
-  SUFREQ channel_freq = 
-    tuner_freq + SU_NORM2ABS_FREQ(
-      samp_rate,
-      SU_ANG2NORM_FREQ(su_specttuner_channel_get_f0(chan)));
+  SUFREQ channel_freq;
+  SUFLOAT f0;
+
+  if (chan->raster)
+    return tuner_freq + chan->freq;
+
+  f0 = chan->schan == NULL
+    ? chan->sparams.f0
+    : su_specttuner_channel_get_f0(chan->schan);
+
+  channel_freq =
+    tuner_freq + SU_NORM2ABS_FREQ(samp_rate, SU_ANG2NORM_FREQ(f0));
 
   return channel_freq;
 }
@@ -503,16 +1165,290 @@ suscan_local_inspector_factory_set_freq_correction(
   SUFLOAT delta)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
-  su_specttuner_channel_t *chan = (su_specttuner_channel_t *) insp_userdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
   unsigned int samp_rate = suscan_analyzer_get_samp_rate(self->parent);
+  SUFLOAT domega;
 
-  SUFLOAT domega = SU_NORM2ANG_FREQ(SU_ABS2NORM_FREQ(samp_rate, delta));
+  if (chan->raster) {
+    SU_TRYCATCH(
+      pthread_mutex_lock(&self->stuner_mutex) == 0,
+      return SU_FALSE);
+
+    chan->delta = delta;
+    suscan_local_analyzer_retune_raster_channel(self, chan);
+
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+    return SU_TRUE;
+  }
+
+  domega = SU_NORM2ANG_FREQ(SU_ABS2NORM_FREQ(samp_rate, delta));
+
+  if (chan->schan == NULL) {
+    SU_TRYCATCH(
+      pthread_mutex_lock(&self->stuner_mutex) == 0,
+      return SU_FALSE);
+
+    chan->sparams.delta_f = domega;
+
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+    return SU_TRUE;
+  }
   
-  su_specttuner_set_channel_delta_f(self->stuner, chan, domega);
+  su_specttuner_set_channel_delta_f(
+    suscan_local_analyzer_get_stream_tuner(self, chan->stream),
+    chan->schan,
+    domega);
+
+  return SU_TRUE;
+}
+
+/*
+ * Spectral tuner channels cannot be skipped, so suspended channels are
+ * closed and reopened with the same parameters. The bandwidth they were
+ * opened with is kept so the decimation (and hence the sampling info of
+ * the inspector) does not change.
+ */
+SUPRIVATE SUBOOL
+suscan_local_inspector_factory_suspend_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  if (chan->raster) {
+    SU_TRY_FAIL(suscan_local_analyzer_close_raster_channel(self, chan->pchan));
+    chan->pchan = NULL;
+  } else if (chan->bins) {
+    SU_TRYZ_FAIL(pthread_mutex_lock(&self->stuner_mutex));
+    suscan_local_analyzer_detach_bin_channel(self, chan);
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+  } else {
+    chan->sparams      = chan->schan->params;
+    chan->suspended_f0 = chan->sparams.f0;
+    chan->new_bw       = 0;
+
+    SU_TRY_FAIL(
+      suscan_local_analyzer_close_stream_channel(
+        self,
+        chan->stream,
+        chan->schan));
+    chan->schan = NULL;
+  }
+
+  chan->suspended = SU_TRUE;
+
+  return SU_TRUE;
+
+fail:
+  return SU_FALSE;
+}
+
+/* Opens a tuner channel for a channel that has none */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_reopen_stream_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  su_specttuner_channel_t *schan = NULL;
+  su_specttuner_t *tuner;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(tuner = suscan_local_analyzer_get_stream_tuner(self, chan->stream));
+
+  SU_TRYZ(pthread_mutex_lock(&self->stuner_mutex));
+  mutex_acquired = SU_TRUE;
+
+  SU_TRY(schan = su_specttuner_open_channel(tuner, &chan->sparams));
+
+  su_specttuner_channel_set_domain(schan, chan->sparams.domain);
+
+  if (chan->sparams.delta_f != 0)
+    su_specttuner_set_channel_delta_f(
+      tuner,
+      schan,
+      chan->sparams.delta_f);
+
+  if (chan->new_bw > 0)
+    (void) su_specttuner_set_channel_bandwidth(
+      tuner,
+      schan,
+      chan->new_bw);
+
+  chan->schan = schan;
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+  mutex_acquired = SU_FALSE;
+
+  /* The tuner does not report retunes of closed channels */
+  if (chan->sparams.f0 != chan->suspended_f0 && chan->insp != NULL)
+    suscan_inspector_factory_notify_freq(
+      suscan_inspector_get_factory(chan->insp),
+      chan->insp,
+      chan->suspended_f0 * schan->decimation,
+      chan->sparams.f0 * schan->decimation);
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_inspector_factory_resume_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  if (chan->raster) {
+    SU_TRY(suscan_local_analyzer_open_raster_channel(self, chan));
+  } else if (chan->bins) {
+    SU_TRYZ(pthread_mutex_lock(&self->stuner_mutex));
+    mutex_acquired = SU_TRUE;
+
+    SU_TRY(suscan_local_analyzer_attach_bin_channel(self, chan));
+
+    if (chan->sparams.f0 != chan->suspended_f0 && chan->insp != NULL)
+      suscan_inspector_factory_notify_freq(
+        suscan_inspector_get_factory(chan->insp),
+        chan->insp,
+        chan->suspended_f0 * chan->decimation,
+        chan->sparams.f0 * chan->decimation);
+
+    chan->suspended_f0 = chan->sparams.f0;
+  } else {
+    SU_TRY(suscan_local_analyzer_reopen_stream_channel(self, chan));
+  }
+
+  chan->suspended = SU_FALSE;
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_inspector_factory_set_suspended(
+  void *userdata,
+  void *insp_userdata,
+  SUBOOL suspended)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_local_inspector_channel *chan = 
+    (struct suscan_local_inspector_channel *) insp_userdata;
+
+  if (chan->suspended == suspended)
+    return SU_TRUE;
+
+  return suspended
+    ? suscan_local_inspector_factory_suspend_channel(self, chan)
+    : suscan_local_inspector_factory_resume_channel(self, chan);
+}
+
+/*
+ * Main tuner channels in the frequency domain give up their tuner channel
+ * and read their bins from the tuner FFT. Channels going back to the time
+ * domain get their tuner channel again. Suspended channels only remember
+ * what to do when they are resumed.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_sync_bin_channel(
+  suscan_local_analyzer_t *self,
+  struct suscan_local_inspector_channel *chan)
+{
+  SUBOOL is_freq;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->stuner_mutex));
+
+  is_freq = suscan_inspector_is_freq_domain(chan->insp);
+
+  if (chan->raster || chan->stream != 0 || is_freq == chan->bins) {
+    ok = SU_TRUE;
+  } else if (chan->suspended) {
+    chan->bins = is_freq;
+    ok = SU_TRUE;
+  } else if (is_freq) {
+    chan->sparams      = chan->schan->params;
+    chan->suspended_f0 = chan->sparams.f0;
+    chan->new_bw       = 0;
+
+    if (suscan_local_analyzer_attach_bin_channel(self, chan)) {
+      if (!suscan_local_analyzer_close_stream_channel(self, 0, chan->schan))
+        SU_WARNING("Failed to close channel!\n");
+
+      chan->schan = NULL;
+      chan->bins  = SU_TRUE;
+      ok = SU_TRUE;
+    }
+  } else {
+    suscan_local_analyzer_detach_bin_channel(self, chan);
+    chan->bins = SU_FALSE;
+
+    if (!(ok = suscan_local_analyzer_reopen_stream_channel(self, chan))) {
+      /* Keep it fed somehow */
+      if (suscan_local_analyzer_attach_bin_channel(self, chan))
+        chan->bins = SU_TRUE;
+    }
+  }
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_sync_bin_channel_cb(
+  void *userdata,
+  suscan_inspector_t *insp)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_local_inspector_channel *chan;
+
+  /* Subcarrier inspectors belong to their parent */
+  if (suscan_inspector_get_factory(insp) != self->insp_factory
+    || insp->state != SUSCAN_ASYNC_STATE_RUNNING)
+    return SU_TRUE;
+
+  chan = (struct suscan_local_inspector_channel *) insp->factory_userdata;
+  if (chan == NULL || chan->insp == NULL)
+    return SU_TRUE;
+
+  if (!suscan_local_analyzer_sync_bin_channel(self, chan))
+    SU_WARNING(
+      "Failed to move inspector 0x%x to the %s domain\n",
+      insp->inspector_id,
+      chan->bins ? "time" : "frequency");
 
   return SU_TRUE;
 }
 
+/* Must be called from the source thread, between feeds */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_sync_bin_channels(suscan_local_analyzer_t *self)
+{
+  if (!self->bin_sync_pending)
+    return SU_TRUE;
+
+  self->bin_sync_pending = SU_FALSE;
+
+  return suscan_inspector_factory_walk_inspectors(
+    self->insp_factory,
+    suscan_local_analyzer_sync_bin_channel_cb,
+    self);
+}
+
 SUPRIVATE SUBOOL
 suscan_local_inspector_factory_set_tuner_freq(void *userdata, SUFREQ freq)
 {
@@ -542,6 +1478,7 @@ static struct suscan_inspector_factory_class g_local_factory = {
   .set_domain          = suscan_local_inspector_factory_set_domain,
   .get_abs_freq        = suscan_local_inspector_factory_get_abs_freq,
   .set_freq_correction = suscan_local_inspector_factory_set_freq_correction,
+  .set_suspended       = suscan_local_inspector_factory_set_suspended,
   .set_tuner_freq      = suscan_local_inspector_factory_set_tuner_freq,
   .dtor                = suscan_local_inspector_factory_dtor
 };
@@ -580,7 +1517,111 @@ suscan_local_analyzer_parse_overridable(suscan_local_analyzer_t *self)
     suscan_local_analyzer_parse_seek_overridable(self),
     return SU_FALSE);
 
+  /* Move inspectors between tuner channels and tuner FFT bins */
+  SU_TRYCATCH(
+    suscan_local_analyzer_sync_bin_channels(self),
+    return SU_FALSE);
+
+  /* Release the channels of paused inspectors, reopen the resumed ones */
+  SU_TRYCATCH(
+    suscan_inspector_factory_sync_suspensions(self->insp_factory),
+    return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+/*
+ * Squelch. Inspectors are paused while the mean PSD level in their channel
+ * stays below their squelch level for a few PSD updates, and resumed as soon
+ * as it goes above it.
+ */
+#define SUSCAN_LOCAL_ANALYZER_SQUELCH_HYSTERESIS 3  /* dB */
+#define SUSCAN_LOCAL_ANALYZER_SQUELCH_HANG       4  /* PSD updates */
+
+struct suscan_local_analyzer_squelch_info {
+  suscan_local_analyzer_t *self;
+  const SUFLOAT *psd;
+  unsigned int size;
+};
+
+SUPRIVATE SUFLOAT
+suscan_local_analyzer_get_channel_power(
+  const struct suscan_local_analyzer_squelch_info *info,
+  SUFREQ freq,
+  SUFLOAT bw)
+{
+  SUFLOAT fs = suscan_analyzer_get_samp_rate(info->self->parent);
+  int64_t size = info->size;
+  int64_t lo, hi, k, n;
+  SUFLOAT sum = 0;
+
+  lo = SU_FLOOR((freq - .5 * bw) / fs * size + .5);
+  hi = SU_FLOOR((freq + .5 * bw) / fs * size + .5);
+
+  if (hi - lo >= size)
+    hi = lo + size - 1;
+
+  /* PSD bins are in FFT order */
+  for (k = lo; k <= hi; ++k) {
+    n = k % size;
+    if (n < 0)
+      n += size;
+    sum += info->psd[n];
+  }
+
+  return sum / (hi - lo + 1);
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_squelch_cb(void *userdata, suscan_inspector_t *insp)
+{
+  struct suscan_local_analyzer_squelch_info *info =
+    (struct suscan_local_analyzer_squelch_info *) userdata;
+  suscan_local_analyzer_t *self = info->self;
+  SUFREQ freq;
+  SUFLOAT bw, level;
+
+  /* Subcarrier inspectors are not in the PSD */
+  if (suscan_inspector_get_factory(insp) != self->insp_factory
+    || insp->state != SUSCAN_ASYNC_STATE_RUNNING
+    || !insp->squelch_enabled)
+    return SU_TRUE;
+
+  /* Channels may be reopened by the source thread */
+  SU_TRYZ_FAIL(pthread_mutex_lock(&self->stuner_mutex));
+
+  freq = suscan_inspector_factory_get_inspector_freq(self->insp_factory, insp)
+    - self->source_info.frequency;
+  bw   = (self->insp_factory->iface->get_bandwidth) (
+    self->insp_factory->userdata,
+    insp->factory_userdata);
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  level = SU_POWER_DB_RAW(
+    suscan_local_analyzer_get_channel_power(info, freq, bw));
+
+  if (level >= insp->squelch_level) {
+    insp->squelch_hang = SUSCAN_LOCAL_ANALYZER_SQUELCH_HANG;
+    suscan_inspector_factory_set_inspector_squelched(
+      self->insp_factory,
+      insp,
+      SU_FALSE);
+  } else if (level
+    < insp->squelch_level - SUSCAN_LOCAL_ANALYZER_SQUELCH_HYSTERESIS) {
+    if (insp->squelch_hang > 0)
+      --insp->squelch_hang;
+    else
+      suscan_inspector_factory_set_inspector_squelched(
+        self->insp_factory,
+        insp,
+        SU_TRUE);
+  }
+
   return SU_TRUE;
+
+fail:
+  return SU_FALSE;
 }
 
 SUPRIVATE SUBOOL
@@ -590,6 +1631,18 @@ suscan_local_analyzer_on_psd(
     unsigned int size)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_local_analyzer_squelch_info info;
+
+  info.self = self;
+  info.psd  = psd;
+  info.size = size;
+
+  SU_TRYCATCH(
+      suscan_inspector_factory_walk_inspectors(
+        self->insp_factory,
+        suscan_local_analyzer_squelch_cb,
+        &info),
+      return SU_FALSE);
 
   SU_TRYCATCH(
       suscan_analyzer_send_psd_from_smoothpsd(
@@ -700,7 +1753,46 @@ suscan_local_analyzer_read_circ(suscan_local_analyzer_t *self, SUSDIFF *got)
 
   suscan_sample_buffer_set_offset(buffer, offset);
 
-  SU_TRY(suscan_source_fill_buffer(self->source, buffer, read_size, got));
+  SU_TRY(
+    suscan_source_fill_buffer_multi(
+      self->source,
+      buffer,
+      self->stream_count > 1 ? self->stream_buf + 1 : NULL,
+      read_size,
+      got));
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok) {
+    if (buffer != NULL) {
+      if (!suscan_sample_buffer_pool_give(self->bufpool, buffer))
+        SU_ERROR("Failed to give buffer!\n");
+      buffer = NULL;
+    }
+  }
+
+  return buffer;
+}
+
+SUPRIVATE suscan_sample_buffer_t *
+suscan_local_analyzer_read_buffer(suscan_local_analyzer_t *self, SUSDIFF *got)
+{
+  suscan_sample_buffer_t *buffer = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->stream_count < 2)
+    return suscan_source_read_buffer(self->source, self->bufpool, got);
+
+  SU_TRY(buffer = suscan_sample_buffer_pool_acquire(self->bufpool));
+
+  SU_TRY(
+    suscan_source_fill_buffer_multi(
+      self->source,
+      buffer,
+      self->stream_buf + 1,
+      suscan_sample_buffer_size(buffer),
+      got));
 
   ok = SU_TRUE;
 
@@ -794,7 +1886,7 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
 
   /* Ready to read */
   suscan_local_analyzer_read_start(self);
-  buffer = suscan_source_read_buffer(self->source, self->bufpool, &got);
+  buffer = suscan_local_analyzer_read_buffer(self, &got);
   
   if (buffer == NULL) {
     suscan_local_analyzer_send_eos(self, got);
@@ -839,7 +1931,7 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
 
   /* Feed inspectors! */
   SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
-
+  SU_TRY(suscan_local_analyzer_feed_streams(self, got));
 
   /* Finish processing */
   suscan_local_analyzer_process_end(self);
@@ -925,6 +2017,7 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
 
   /* Feed inspectors! */
   SU_TRY(suscan_local_analyzer_feed_inspectors(self, buffer));
+  SU_TRY(suscan_local_analyzer_feed_streams(self, got));
 
   /* Finish processing */
   suscan_local_analyzer_process_end(self);
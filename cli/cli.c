@@ -23,6 +23,8 @@
 #include <analyzer/analyzer.h>
 #include <util/confdb.h>
 #include <util/compat.h>
+#include <util/startup.h>
+#include <analyzer/device/facade.h>
 #include <string.h>
 #include <inttypes.h>
 #include <suscan.h>
@@ -35,6 +37,10 @@ suscan_source_config_t *g_ui_config;
 PTR_LIST_PRIVATE(suscan_source_config_t, g_cli_config);
 
 SUPRIVATE uint32_t init_mask = 0;
+SUPRIVATE SUBOOL g_plugins_loaded = SU_FALSE;
+
+/* Scanned in parallel before sources are initialized */
+SUPRIVATE const char *g_suscli_contexts[] = {"sources", "qth", "uiconfig"};
 
 SUINLINE void *
 suscli_service_ctor(suscan_plugin_t *plugin)
@@ -433,10 +439,13 @@ fail:
   return result;
 }
 
-#define SUSCLI_ASSERT_INIT(flag, command)      \
-if ((init_mask & flag) ^ (cmd->flags &flag)) { \
-  SU_TRYCATCH(command, goto fail);             \
-  init_mask |= flag;                           \
+#define SUSCLI_ASSERT_INIT(flag, name, command)    \
+if ((init_mask & flag) ^ (cmd->flags &flag)) {     \
+  phase = suscan_startup_phase_begin(name);        \
+  SU_TRYCATCH(                                     \
+    suscan_startup_phase_end(phase, command),      \
+    goto fail);                                    \
+  init_mask |= flag;                               \
 }
 
 SUBOOL
@@ -506,39 +515,96 @@ suscli_register_sources(void)
   return suscan_source_config_walk(suscli_walk_all_sources, 0);
 }
 
+SUPRIVATE SUBOOL
+suscli_load_plugins(void)
+{
+  int phase;
+
+  if (g_plugins_loaded)
+    return SU_TRUE;
+
+  phase = suscan_startup_phase_begin("plugins");
+  g_plugins_loaded = suscan_startup_phase_end(phase, suscan_plugin_load_all());
+
+  return g_plugins_loaded;
+}
+
+/*
+ * Discovery runs in the background. Starting it before the config
+ * contexts are scanned overlaps SoapySDR module loading with parsing.
+ */
+SUPRIVATE SUBOOL
+suscli_start_device_discovery(void)
+{
+  suscan_device_facade_t *facade = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscan_source_init_source_types());
+  SU_TRY(facade = suscan_device_facade_instance());
+  SU_TRY(suscan_device_facade_discover_all(facade));
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 SUBOOL
 suscli_run_command(const char *name, const char **argv)
 {
   const struct suscli_command *cmd;
   hashlist_t *params = NULL;
+  int phase;
   SUBOOL ok = SU_FALSE;
 
-  if ((cmd = suscli_command_lookup(name)) == NULL) {
+  /* Plugins may provide the command */
+  if ((cmd = suscli_command_lookup(name)) == NULL && suscli_load_plugins())
+    cmd = suscli_command_lookup(name);
+
+  if (cmd == NULL) {
     fprintf(stderr, "%s: command does not exist\n", name);
     goto fail;
   }
 
+  /* Only commands that may use plugin-provided components load them */
+  if (cmd->flags & SUSCLI_COMMAND_REQ_PLUGINS)
+    SU_TRYCATCH(suscli_load_plugins(), goto fail);
+
+  SUSCLI_ASSERT_INIT(
+      SUSCLI_COMMAND_REQ_DEVICES,
+      "device discovery",
+      suscli_start_device_discovery());
+
   SUSCLI_ASSERT_INIT(
       SUSCLI_COMMAND_REQ_SOURCES,
-      suscan_init_sources()
-      && suscan_confdb_use("qth")
+      "sources",
+      suscan_confdb_use_many(
+        g_suscli_contexts,
+        sizeof(g_suscli_contexts) / sizeof(g_suscli_contexts[0]))
+      && suscan_init_sources_ex(SUSCAN_INIT_SOURCES_LAZY_DISCOVERY)
       && suscli_init_ui_source()
       && suscli_register_sources());
 
   SUSCLI_ASSERT_INIT(
       SUSCLI_COMMAND_REQ_ESTIMATORS,
+      "estimators",
       suscan_init_estimators());
 
   SUSCLI_ASSERT_INIT(
       SUSCLI_COMMAND_REQ_SPECTSRCS,
+      "spectrum sources",
       suscan_init_spectsrcs());
 
   SUSCLI_ASSERT_INIT(
       SUSCLI_COMMAND_REQ_INSPECTORS,
+      "inspectors",
       suscan_init_inspectors());
 
   SU_TRYCATCH(params = suscli_parse_params(argv), goto fail);
 
+  /* Startup ends here. Commands like devserv may never return. */
+  suscan_startup_profile_print(stderr);
+
   ok = (cmd->callback) (params);
 
 fail:
@@ -579,7 +645,7 @@ suscli_init(void)
       suscli_command_register(
           "list",
           "List all available commands",
-          0,
+          SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_list_cb) != -1);
 
 
@@ -594,14 +660,20 @@ suscli_init(void)
       suscli_command_register(
           "rms",
           "Perform different kinds of power measurements",
-          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_INSPECTORS,
+          SUSCLI_COMMAND_REQ_SOURCES
+          | SUSCLI_COMMAND_REQ_DEVICES
+          | SUSCLI_COMMAND_REQ_INSPECTORS
+          | SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_rms_cb) != -1);
 
   SU_TRY(
       suscli_command_register(
           "radio",
           "Listen to analog radio",
-          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_INSPECTORS,
+          SUSCLI_COMMAND_REQ_SOURCES
+          | SUSCLI_COMMAND_REQ_DEVICES
+          | SUSCLI_COMMAND_REQ_INSPECTORS
+          | SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_radio_cb) != -1);
 
   SU_TRY(
@@ -615,14 +687,16 @@ suscli_init(void)
       suscli_command_register(
           "devices",
           "Display detected devices",
-          SUSCLI_COMMAND_REQ_SOURCES,
+          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_DEVICES
+          | SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_devices_cb) != -1);
 
   SU_TRY(
       suscli_command_register(
           "makeprof",
           "Generate profiles from detected devices",
-          SUSCLI_COMMAND_REQ_SOURCES,
+          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_DEVICES
+          | SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_makeprof_cb) != -1);
 
   SU_TRY(
@@ -639,6 +713,13 @@ suscli_init(void)
           0,
           suscli_tleinfo_cb) != -1);
 
+  SU_TRY(
+      suscli_command_register(
+          "passes",
+          "Predict satellite passes over a site from a TLE catalog",
+          0,
+          suscli_passes_cb) != -1);
+
   SU_TRY(
       suscli_command_register(
           "snoop",
@@ -650,12 +731,36 @@ suscli_init(void)
       suscli_command_register(
           "spectrum",
           "Store spectrum data to a data saver object",
-          SUSCLI_COMMAND_REQ_SOURCES,
+          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_DEVICES
+          | SUSCLI_COMMAND_REQ_PLUGINS,
           suscli_spectrum_cb) != -1);
 
-  suscan_plugin_register_service(&g_suscli_service_desc);
+  SU_TRY(
+      suscli_command_register(
+          "overview",
+          "Precompute the overview waterfall of a capture file",
+          SUSCLI_COMMAND_REQ_SOURCES,
+          suscli_overview_cb) != -1);
 
-  SU_TRY(suscan_plugin_load_all());
+  SU_TRY(
+      suscli_command_register(
+          "inspbench",
+          "Measure the throughput of inspector implementations",
+          SUSCLI_COMMAND_REQ_ESTIMATORS
+          | SUSCLI_COMMAND_REQ_SPECTSRCS
+          | SUSCLI_COMMAND_REQ_INSPECTORS
+          | SUSCLI_COMMAND_REQ_PLUGINS,
+          suscli_inspbench_cb) != -1);
+
+  SU_TRY(
+      suscli_command_register(
+          "check",
+          "Check optimized code paths against their references",
+          SUSCLI_COMMAND_REQ_SOURCES | SUSCLI_COMMAND_REQ_SPECTSRCS,
+          suscli_check_cb) != -1);
+
+  /* Plugins are loaded on demand, by suscli_run_command */
+  suscan_plugin_register_service(&g_suscli_service_desc);
 
   ok = SU_TRUE;
 
@@ -29,6 +29,8 @@
 #define SUSCLI_COMMAND_REQ_ESTIMATORS 4
 #define SUSCLI_COMMAND_REQ_SPECTSRCS  8
 #define SUSCLI_COMMAND_REQ_INSPECTORS 16
+#define SUSCLI_COMMAND_REQ_DEVICES    32
+#define SUSCLI_COMMAND_REQ_PLUGINS    64
 
 #define SUSCLI_COMMAND_REQ_ALL        0xff
 
@@ -0,0 +1,474 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-check"
+
+#include <sigutils/log.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <analyzer/spectsrcs/kernels.h>
+#include <analyzer/source.h>
+#include <analyzer/device/spec.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+
+#define SUSCLI_CHECK_DEFAULT_TEST     "all"
+#define SUSCLI_CHECK_KERNEL_MAX_LEN   4099
+#define SUSCLI_CHECK_KERNEL_CHUNK     100
+#define SUSCLI_CHECK_KERNEL_TOLERANCE 1e-4
+
+#define SUSCLI_CHECK_SOAPY_DEFAULT_DEVICE  "local://soapysdr/?driver=null"
+#define SUSCLI_CHECK_SOAPY_DEFAULT_SAMPLES 65536
+#define SUSCLI_CHECK_SOAPY_SAMP_RATE       1000000
+#define SUSCLI_CHECK_SOAPY_TOLERANCE       1e-4
+
+/*
+ * Self-checks of the optimized code paths. Every check runs the optimized
+ * implementation and its plain reference against the same input, and fails
+ * if their outputs differ by more than a small tolerance.
+ */
+
+struct suscli_check {
+  const char *name;
+  const char *desc;
+  SUBOOL (*func) (const hashlist_t *params);
+};
+
+/************************** Spectrum source kernels ***************************/
+enum suscli_check_kernel {
+  SUSCLI_CHECK_KERNEL_CONJ_PROD,
+  SUSCLI_CHECK_KERNEL_PHASE_DIFF,
+  SUSCLI_CHECK_KERNEL_PHASE,
+  SUSCLI_CHECK_KERNEL_DIFF,
+  SUSCLI_CHECK_KERNEL_ABS_DIFF,
+  SUSCLI_CHECK_KERNEL_EXP_2,
+  SUSCLI_CHECK_KERNEL_EXP_4,
+  SUSCLI_CHECK_KERNEL_EXP_8,
+  SUSCLI_CHECK_KERNEL_PSD,
+  SUSCLI_CHECK_KERNEL_COUNT
+};
+
+SUPRIVATE const char *g_kernel_names[] = {
+  "conj_prod",
+  "phase_diff",
+  "phase",
+  "diff",
+  "abs_diff",
+  "exp_pow2(1)",
+  "exp_pow2(2)",
+  "exp_pow2(3)",
+  "psd"
+};
+
+/* Feeds x in chunks of `chunk' samples, carrying the previous sample */
+SUPRIVATE void
+suscli_check_kernel_run(
+  const struct suscan_spectsrc_kernels *kernels,
+  enum suscli_check_kernel kernel,
+  SUCOMPLEX *y,
+  const SUCOMPLEX *x,
+  SUSCOUNT len,
+  SUSCOUNT chunk)
+{
+  SUFLOAT psd[SUSCLI_CHECK_KERNEL_MAX_LEN];
+  SUCOMPLEX prev = 1;
+  SUSCOUNT p = 0, n, i;
+
+  while (p < len) {
+    n = SU_MIN(chunk, len - p);
+
+    switch (kernel) {
+      case SUSCLI_CHECK_KERNEL_CONJ_PROD:
+        (kernels->conj_prod) (y + p, x + p, prev, 1e6, n);
+        break;
+
+      case SUSCLI_CHECK_KERNEL_PHASE_DIFF:
+        (kernels->phase_diff) (y + p, x + p, prev, 1e-5, n);
+        break;
+
+      case SUSCLI_CHECK_KERNEL_PHASE:
+        (kernels->phase) (y + p, x + p, 1e-5, n);
+        break;
+
+      case SUSCLI_CHECK_KERNEL_DIFF:
+        (kernels->diff) (y + p, x + p, prev, n);
+        break;
+
+      case SUSCLI_CHECK_KERNEL_ABS_DIFF:
+        (kernels->abs_diff) (y + p, x + p, prev, n);
+        break;
+
+      case SUSCLI_CHECK_KERNEL_PSD:
+        /* Set, then accumulate on top */
+        (kernels->psd) (psd, x + p, 1. / 1024, SU_FALSE, n);
+        (kernels->psd) (psd, x + p, 1e-3, SU_TRUE, n);
+        for (i = 0; i < n; ++i)
+          y[p + i] = psd[i];
+        break;
+
+      case SUSCLI_CHECK_KERNEL_EXP_2:
+      case SUSCLI_CHECK_KERNEL_EXP_4:
+      case SUSCLI_CHECK_KERNEL_EXP_8:
+        (kernels->exp_pow2) (
+          y + p,
+          x + p,
+          kernel - SUSCLI_CHECK_KERNEL_EXP_2 + 1,
+          1. / 1024,
+          n);
+        break;
+
+      default:
+        break;
+    }
+
+    prev = x[p + n - 1];
+    p   += n;
+  }
+}
+
+/* Largest difference between both outputs, relative to the largest output */
+SUPRIVATE SUFLOAT
+suscli_check_kernel_error(
+  const SUCOMPLEX *ref,
+  const SUCOMPLEX *y,
+  SUSCOUNT len)
+{
+  SUFLOAT max_err = 0, max_ref = 0;
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i) {
+    max_err = SU_MAX(max_err, SU_C_ABS(ref[i] - y[i]));
+    max_ref = SU_MAX(max_ref, SU_C_ABS(ref[i]));
+  }
+
+  return max_ref > 0 ? max_err / max_ref : max_err;
+}
+
+SUPRIVATE SUBOOL
+suscli_check_kernels_against(
+  const struct suscan_spectsrc_kernels *kernels,
+  const SUCOMPLEX *x,
+  SUCOMPLEX *ref,
+  SUCOMPLEX *y)
+{
+  static const SUSCOUNT lengths[] = {
+    1, 2, 7, 511, 512, 513, SUSCLI_CHECK_KERNEL_MAX_LEN
+  };
+  const struct suscan_spectsrc_kernels *scalar;
+  enum suscli_check_kernel kernel;
+  SUFLOAT err, max_err;
+  unsigned int i;
+  SUBOOL ok = SU_TRUE;
+
+  scalar = suscan_spectsrc_kernels_lookup(SUSCAN_SPECTSRC_KERNELS_SCALAR);
+
+  for (kernel = 0; kernel < SUSCLI_CHECK_KERNEL_COUNT; ++kernel) {
+    max_err = 0;
+
+    for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+      /* Whole buffer at once */
+      suscli_check_kernel_run(scalar, kernel, ref, x, lengths[i], lengths[i]);
+      suscli_check_kernel_run(kernels, kernel, y, x, lengths[i], lengths[i]);
+      err = suscli_check_kernel_error(ref, y, lengths[i]);
+      max_err = SU_MAX(max_err, err);
+
+      /* Same buffer in short chunks, to check the state between calls */
+      suscli_check_kernel_run(
+        kernels,
+        kernel,
+        y,
+        x,
+        lengths[i],
+        SUSCLI_CHECK_KERNEL_CHUNK);
+      err = suscli_check_kernel_error(ref, y, lengths[i]);
+      max_err = SU_MAX(max_err, err);
+    }
+
+    printf(
+      "  %-8s %-12s max rel. error %.3e  %s\n",
+      kernels->name,
+      g_kernel_names[kernel],
+      max_err,
+      max_err <= SUSCLI_CHECK_KERNEL_TOLERANCE ? "OK" : "FAILED");
+
+    if (max_err > SUSCLI_CHECK_KERNEL_TOLERANCE)
+      ok = SU_FALSE;
+  }
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscli_check_spectsrc_kernels(const hashlist_t *params)
+{
+  const struct suscan_spectsrc_kernels *kernels;
+  const char *name = NULL;
+  SUCOMPLEX *x = NULL, *ref = NULL, *y = NULL;
+  unsigned int i, compared = 0;
+  SUBOOL all_ok = SU_TRUE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_string(params, "kernels", &name, NULL));
+
+  SU_ALLOCATE_MANY(x,   SUSCLI_CHECK_KERNEL_MAX_LEN, SUCOMPLEX);
+  SU_ALLOCATE_MANY(ref, SUSCLI_CHECK_KERNEL_MAX_LEN, SUCOMPLEX);
+  SU_ALLOCATE_MANY(y,   SUSCLI_CHECK_KERNEL_MAX_LEN, SUCOMPLEX);
+
+  /* Random samples, uniformly distributed over the unit square */
+  for (i = 0; i < SUSCLI_CHECK_KERNEL_MAX_LEN; ++i)
+    x[i] = ((SUFLOAT) rand() / RAND_MAX - .5)
+      + I * ((SUFLOAT) rand() / RAND_MAX - .5);
+
+  if (name != NULL) {
+    if ((kernels = suscan_spectsrc_kernels_lookup(name)) == NULL) {
+      SU_ERROR("Spectrum source kernels `%s' not available\n", name);
+      goto done;
+    }
+
+    all_ok = suscli_check_kernels_against(kernels, x, ref, y);
+  } else {
+    /* Every implementation but the reference */
+    i = 0;
+    while ((kernels = suscan_spectsrc_kernels_get_nth(i++)) != NULL) {
+      if (strcmp(kernels->name, SUSCAN_SPECTSRC_KERNELS_SCALAR) == 0)
+        continue;
+
+      if (!suscli_check_kernels_against(kernels, x, ref, y))
+        all_ok = SU_FALSE;
+
+      ++compared;
+    }
+
+    if (compared == 0)
+      printf("  Only scalar kernels in this build, nothing to compare\n");
+  }
+
+  ok = all_ok;
+
+done:
+  if (x != NULL)
+    free(x);
+
+  if (ref != NULL)
+    free(ref);
+
+  if (y != NULL)
+    free(y);
+
+  return ok;
+}
+
+/*************************** SoapySDR direct buffers **************************/
+/*
+ * Reads the first samples of a SoapySDR device, once through the direct
+ * buffers (integer samples converted by suscan) and once through the
+ * regular stream (converted by SoapySDR). The comparison is only
+ * meaningful with drivers that deliver the same samples every time the
+ * stream is opened, like the null driver or a loopback device.
+ */
+SUPRIVATE SUBOOL
+suscli_check_soapysdr_read(
+  const char *uri,
+  SUBOOL direct,
+  SUCOMPLEX *buf,
+  SUSCOUNT samples,
+  SUBOOL *native)
+{
+  suscan_source_config_t *config = NULL;
+  suscan_device_spec_t *spec = NULL;
+  suscan_source_t *source = NULL;
+  SUSCOUNT p = 0;
+  SUSDIFF got;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(spec = suscan_device_spec_from_uri(uri));
+  SU_TRY(config = suscan_source_config_new_default());
+  SU_TRY(suscan_source_config_set_device_spec(config, spec));
+  SU_TRY(
+    suscan_source_config_set_param(
+      config,
+      SUSCAN_SOAPY_SETTING_PREFIX "direct",
+      direct ? "true" : "false"));
+
+  suscan_source_config_set_samp_rate(config, SUSCLI_CHECK_SOAPY_SAMP_RATE);
+  suscan_source_config_set_dc_remove(config, SU_FALSE);
+  suscan_source_config_set_native_frontend(config, SU_TRUE);
+
+  SU_TRY(source = suscan_source_new(config));
+  SU_TRY(suscan_source_start_capture(source));
+
+  *native = suscan_source_get_native_format(source)
+    != SUSCAN_SOURCE_FORMAT_AUTO;
+
+  /* Direct access requested but not available: nothing to read */
+  if (direct && !*native) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  while (p < samples) {
+    if ((got = suscan_source_read(source, buf + p, samples - p)) < 1) {
+      SU_ERROR("Failed to read samples from `%s'\n", uri);
+      goto done;
+    }
+
+    p += got;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (source != NULL) {
+    (void) suscan_source_stop_capture(source);
+    suscan_source_destroy(source);
+  }
+
+  if (config != NULL)
+    suscan_source_config_destroy(config);
+
+  if (spec != NULL)
+    SU_DISPOSE(suscan_device_spec, spec);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscli_check_soapysdr_direct(const hashlist_t *params)
+{
+  const char *uri = SUSCLI_CHECK_SOAPY_DEFAULT_DEVICE;
+  int samples = SUSCLI_CHECK_SOAPY_DEFAULT_SAMPLES;
+  SUCOMPLEX *direct_buf = NULL, *stream_buf = NULL;
+  SUBOOL direct_native, stream_native;
+  SUFLOAT max_err = 0;
+  int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_string(params, "device", &uri, uri));
+  SU_TRY(suscli_param_read_int(params, "samples", &samples, samples));
+
+  if (samples <= 0) {
+    SU_ERROR("Invalid number of samples\n");
+    goto done;
+  }
+
+  SU_ALLOCATE_MANY(direct_buf, samples, SUCOMPLEX);
+  SU_ALLOCATE_MANY(stream_buf, samples, SUCOMPLEX);
+
+  SU_TRY(
+    suscli_check_soapysdr_read(
+      uri,
+      SU_TRUE,
+      direct_buf,
+      samples,
+      &direct_native));
+
+  if (!direct_native) {
+    printf("  `%s' offers no direct buffer access, nothing to compare\n", uri);
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_TRY(
+    suscli_check_soapysdr_read(
+      uri,
+      SU_FALSE,
+      stream_buf,
+      samples,
+      &stream_native));
+
+  if (stream_native) {
+    SU_ERROR("soapy:direct=false did not disable direct buffer access\n");
+    goto done;
+  }
+
+  for (i = 0; i < samples; ++i)
+    max_err = SU_MAX(max_err, SU_C_ABS(direct_buf[i] - stream_buf[i]));
+
+  printf(
+    "  %d samples, max abs. error %.3e  %s\n",
+    samples,
+    max_err,
+    max_err <= SUSCLI_CHECK_SOAPY_TOLERANCE ? "OK" : "FAILED");
+
+  ok = max_err <= SUSCLI_CHECK_SOAPY_TOLERANCE;
+
+done:
+  if (direct_buf != NULL)
+    free(direct_buf);
+
+  if (stream_buf != NULL)
+    free(stream_buf);
+
+  return ok;
+}
+
+/********************************* Entry point ********************************/
+SUPRIVATE const struct suscli_check g_checks[] = {
+  {
+    "spectsrc-kernels",
+    "Spectrum source kernels against their scalar reference",
+    suscli_check_spectsrc_kernels
+  },
+  {
+    "soapysdr-direct",
+    "SoapySDR direct buffer conversion against SoapySDR's own",
+    suscli_check_soapysdr_direct
+  },
+};
+
+SUBOOL
+suscli_check_cb(const hashlist_t *params)
+{
+  const char *test = SUSCLI_CHECK_DEFAULT_TEST;
+  unsigned int i, count = sizeof(g_checks) / sizeof(g_checks[0]);
+  unsigned int ran = 0, failed = 0;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_string(params, "test", &test, test));
+
+  for (i = 0; i < count; ++i) {
+    if (strcmp(test, "all") != 0 && strcmp(test, g_checks[i].name) != 0)
+      continue;
+
+    printf("%s: %s\n", g_checks[i].name, g_checks[i].desc);
+
+    if (!(g_checks[i].func) (params)) {
+      printf("%s: FAILED\n", g_checks[i].name);
+      ++failed;
+    } else {
+      printf("%s: OK\n", g_checks[i].name);
+    }
+
+    ++ran;
+  }
+
+  if (ran == 0) {
+    SU_ERROR("Unknown check `%s'. Available checks:\n", test);
+    for (i = 0; i < count; ++i)
+      SU_ERROR("  %-20s %s\n", g_checks[i].name, g_checks[i].desc);
+    goto done;
+  }
+
+  ok = failed == 0;
+
+done:
+  return ok;
+}
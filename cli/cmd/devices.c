@@ -30,6 +30,7 @@
 #include <inttypes.h>
 
 #define SUSCLI_DEVICE_DISCOVERY_TIMEOUT_SEC 2
+#define SUSCLI_DEVICE_EVENT_TIMEOUT_MS      1000
 
 SUPRIVATE char *
 suscli_ellipsis(const char *string, unsigned int size)
@@ -119,6 +120,54 @@ done:
   return ok;
 }
 
+/* Prints device changes as they happen, until interrupted */
+SUPRIVATE SUBOOL
+suscli_devices_watch(suscan_device_facade_t *facade, uint64_t cursor)
+{
+  struct suscan_device_event event;
+  suscan_device_properties_t *prop;
+  const char *label;
+  char sign;
+
+  for (;;) {
+    if (!suscan_device_facade_wait_for_event(
+      facade,
+      &event,
+      &cursor,
+      SUSCLI_DEVICE_EVENT_TIMEOUT_MS))
+      continue;
+
+    switch (event.type) {
+      case SUSCAN_DEVICE_EVENT_ADDED:
+        sign = '+';
+        break;
+
+      case SUSCAN_DEVICE_EVENT_REMOVED:
+        sign = '-';
+        break;
+
+      default:
+        sign = '*';
+    }
+
+    prop  = suscan_device_facade_get_device_by_uuid(facade, event.uuid);
+    label = prop != NULL ? prop->label : "(unknown device)";
+
+    printf(
+      "%c %-40s %-9s %016" PRIx64 "\n",
+      sign,
+      label,
+      event.discovery,
+      event.uuid);
+    fflush(stdout);
+
+    if (prop != NULL)
+      SU_DISPOSE(suscan_device_properties, prop);
+  }
+
+  return SU_TRUE;
+}
+
 SUBOOL
 suscli_devices_cb(const hashlist_t *params)
 {
@@ -126,7 +175,18 @@ suscli_devices_cb(const hashlist_t *params)
   char *dup = NULL;
   unsigned int timeout = SUSCLI_DEVICE_DISCOVERY_TIMEOUT_SEC;
   suscan_device_facade_t *facade = NULL;
-  
+  SUBOOL watch = SU_FALSE;
+  int refresh = 0;
+  uint64_t cursor;
+
+  SU_TRY(suscli_param_read_bool(params, "watch", &watch, SU_FALSE));
+  SU_TRY(suscli_param_read_int(params, "refresh", &refresh, 0));
+
+  if (refresh < 0) {
+    SU_ERROR("Invalid refresh interval\n");
+    goto done;
+  }
+
   SU_TRY(facade = suscan_device_facade_instance());
   SU_TRY(suscan_device_facade_discover_all(facade));
 
@@ -147,8 +207,21 @@ suscli_devices_cb(const hashlist_t *params)
   printf(
       "---------------------------------------------------------------------------------\n");
 
+  /* Changes after the list is taken are reported in watch mode */
+  cursor = suscan_device_facade_get_event_cursor(facade);
+
   SU_TRY(suscli_devices_print_all());
 
+  if (watch) {
+    if (refresh > 0)
+      suscan_device_facade_set_refresh_interval(facade, refresh);
+
+    printf("\nWatching for device changes (+ added, - removed, * updated)\n");
+    fflush(stdout);
+
+    SU_TRY(suscli_devices_watch(facade, cursor));
+  }
+
   ok = SU_TRUE;
 
 done:
@@ -179,7 +179,8 @@ SUPRIVATE struct suscli_devserv_ctx *
 suscli_devserv_ctx_new(
     const char *iface,
     const char *mcaddr,
-    size_t compress_threshold)
+    size_t compress_threshold,
+    SUFLOAT channel_spacing)
 {
   struct suscli_devserv_ctx *new = NULL;
   suscan_source_config_t *cfg;
@@ -253,6 +254,7 @@ suscli_devserv_ctx_new(
 
   params.compress_threshold = compress_threshold;
   params.ifname             = iface;
+  params.channel_spacing    = channel_spacing;
 
   /* Populate servers */
   for (i = 1; i <= suscli_get_source_count(); ++i) {
@@ -371,6 +373,7 @@ suscli_devserv_cb(const hashlist_t *params)
   struct suscli_devserv_ctx *ctx = NULL;
   const char *iface, *mc;
   int threshold = 0;
+  SUFLOAT spacing = 0;
 
   pthread_t thread;
   SUBOOL thread_running = SU_FALSE;
@@ -390,6 +393,15 @@ suscli_devserv_cb(const hashlist_t *params)
         0),
       goto done);
 
+  SU_TRYCATCH(
+      suscli_param_read_float(params, "channel_spacing", &spacing, 0),
+      goto done);
+
+  if (spacing < 0) {
+    fprintf(stderr, "devserv: channel_spacing cannot be negative\n");
+    goto done;
+  }
+
   if (iface == NULL) {
     fprintf(
         stderr,
@@ -443,7 +455,8 @@ suscli_devserv_cb(const hashlist_t *params)
       ctx = suscli_devserv_ctx_new(
         iface, 
         mc, 
-        threshold),
+        threshold,
+        spacing),
       goto done);
 
   SU_TRYCATCH(
@@ -0,0 +1,218 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-inspbench"
+
+#include <sigutils/log.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <analyzer/analyzer.h>
+#include <analyzer/mq.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/inspector/kernels.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+
+#define SUSCLI_INSPBENCH_DEFAULT_CLASSES "psk,fsk,ask"
+#define SUSCLI_INSPBENCH_DEFAULT_RATE    250000
+#define SUSCLI_INSPBENCH_DEFAULT_SAMPLES 10000000
+#define SUSCLI_INSPBENCH_DEFAULT_BLOCK   4096
+#define SUSCLI_INSPBENCH_SPS             8 /* Samples per symbol */
+
+/*
+ * Feeds a synthetic QPSK signal to inspectors of the given classes, the same
+ * way the inspector scheduler does, and reports their throughput. Every class
+ * runs twice: with the block kernels and with the per-sample reference path
+ * (see suscan_inspector_kernels_set_reference), and both figures are shown.
+ */
+
+SUPRIVATE void
+suscli_inspbench_make_signal(SUCOMPLEX *buf, SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX symbol = 0;
+  SUFLOAT noise_i, noise_q;
+
+  for (i = 0; i < len; ++i) {
+    if (i % SUSCLI_INSPBENCH_SPS == 0)
+      symbol = SU_C_EXP(I * (M_PI / 4 + (M_PI / 2) * (rand() & 3)));
+
+    noise_i = 1e-1 * ((SUFLOAT) rand() / RAND_MAX - .5);
+    noise_q = 1e-1 * ((SUFLOAT) rand() / RAND_MAX - .5);
+
+    buf[i] = symbol + noise_i + I * noise_q;
+  }
+}
+
+SUPRIVATE SUBOOL
+suscli_inspbench_run(
+  const char *class,
+  SUFLOAT samp_rate,
+  const SUCOMPLEX *signal,
+  SUSCOUNT signal_len,
+  SUSCOUNT samples,
+  SUSCOUNT block,
+  SUBOOL reference,
+  SUFLOAT *msps)
+{
+  struct suscan_inspector_sampling_info samp_info;
+  suscan_inspector_t *insp = NULL;
+  struct suscan_mq mq;
+  SUBOOL mq_init = SU_FALSE;
+  SUSCOUNT fed = 0, p = 0, len;
+  struct timeval t0, t1, elapsed;
+  SUFLOAT secs;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&samp_info, 0, sizeof(struct suscan_inspector_sampling_info));
+
+  samp_info.equiv_fs   = samp_rate;
+  samp_info.bw         = .25;
+  samp_info.bw_bd      = .25;
+  samp_info.fft_size   = 1024;
+  samp_info.fft_bins   = 256;
+  samp_info.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  suscan_inspector_kernels_set_reference(reference);
+
+  SU_TRY(insp = suscan_inspector_new(NULL, class, &samp_info, &mq, &mq, NULL));
+
+  gettimeofday(&t0, NULL);
+
+  while (fed < samples) {
+    len = SU_MIN(block, signal_len - p);
+    len = SU_MIN(len, samples - fed);
+
+    SU_TRY(suscan_inspector_sampler_loop(insp, signal + p, len));
+    suscan_analyzer_consume_mq(&mq);
+
+    fed += len;
+    p    = (p + len) % signal_len;
+  }
+
+  gettimeofday(&t1, NULL);
+
+  timersub(&t1, &t0, &elapsed);
+  secs = elapsed.tv_sec + 1e-6 * elapsed.tv_usec;
+
+  *msps = 1e-6 * fed / secs;
+
+  printf(
+    "%-12s %-10s %10.3f Msps  %8.1fx real time\n",
+    class,
+    reference ? "per-sample" : "block",
+    *msps,
+    fed / (secs * samp_rate));
+
+  ok = SU_TRUE;
+
+done:
+  suscan_inspector_kernels_set_reference(SU_FALSE);
+
+  if (insp != NULL)
+    suscan_inspector_destroy(insp);
+
+  if (mq_init) {
+    suscan_analyzer_consume_mq(&mq);
+    suscan_mq_finalize(&mq);
+  }
+
+  return ok;
+}
+
+SUBOOL
+suscli_inspbench_cb(const hashlist_t *params)
+{
+  const char *classes = SUSCLI_INSPBENCH_DEFAULT_CLASSES;
+  char *class_list = NULL;
+  char *class, *saveptr = NULL;
+  SUCOMPLEX *signal = NULL;
+  SUSCOUNT signal_len;
+  SUFLOAT block_msps, ref_msps;
+  int samp_rate = SUSCLI_INSPBENCH_DEFAULT_RATE;
+  int samples = SUSCLI_INSPBENCH_DEFAULT_SAMPLES;
+  int block = SUSCLI_INSPBENCH_DEFAULT_BLOCK;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_string(params, "classes", &classes, classes));
+  SU_TRY(suscli_param_read_int(params, "rate", &samp_rate, samp_rate));
+  SU_TRY(suscli_param_read_int(params, "samples", &samples, samples));
+  SU_TRY(suscli_param_read_int(params, "block", &block, block));
+
+  if (samp_rate <= 0 || samples <= 0 || block <= 0) {
+    SU_ERROR("Invalid benchmark parameters\n");
+    goto done;
+  }
+
+  /* A few seconds of signal, reused during the benchmark */
+  signal_len = SU_MAX(block, 4 * samp_rate);
+  SU_TRY(signal = calloc(signal_len, sizeof(SUCOMPLEX)));
+  suscli_inspbench_make_signal(signal, signal_len);
+
+  SU_TRY(class_list = strdup(classes));
+
+  printf(
+    "Feeding %d samples in blocks of %d (fs = %d sps)\n",
+    samples,
+    block,
+    samp_rate);
+
+  class = strtok_r(class_list, ",", &saveptr);
+  while (class != NULL) {
+    SU_TRY(
+      suscli_inspbench_run(
+        class,
+        samp_rate,
+        signal,
+        signal_len,
+        samples,
+        block,
+        SU_TRUE,
+        &ref_msps));
+    SU_TRY(
+      suscli_inspbench_run(
+        class,
+        samp_rate,
+        signal,
+        signal_len,
+        samples,
+        block,
+        SU_FALSE,
+        &block_msps));
+
+    printf("%-12s %-10s %10.2fx\n", class, "speedup", block_msps / ref_msps);
+    class = strtok_r(NULL, ",", &saveptr);
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (signal != NULL)
+    free(signal);
+
+  if (class_list != NULL)
+    free(class_list);
+
+  return ok;
+}
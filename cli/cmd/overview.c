@@ -0,0 +1,107 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-overview"
+
+#include <sigutils/log.h>
+#include <string.h>
+
+#include <analyzer/source.h>
+#include <analyzer/source/overview.h>
+#include <analyzer/source/impl/file.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+
+SUBOOL
+suscli_overview_cb(const hashlist_t *params)
+{
+  struct suscan_overview_params ov_params = suscan_overview_params_INITIALIZER;
+  suscan_source_config_t *config = NULL;
+  const char *file = NULL;
+  const char *output = NULL;
+  char *data_path = NULL;
+  char *ov_path = NULL;
+  int samp_rate = 0;
+  int bins = SUSCAN_OVERVIEW_DEFAULT_BINS;
+  int rows = SUSCAN_OVERVIEW_DEFAULT_MAX_ROWS;
+  int threads = 0;
+  struct timeval t0, t1, elapsed;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscli_param_read_string(params, "file", &file, NULL));
+  SU_TRY(suscli_param_read_string(params, "output", &output, NULL));
+  SU_TRY(suscli_param_read_int(params, "rate", &samp_rate, 0));
+  SU_TRY(suscli_param_read_int(params, "bins", &bins, bins));
+  SU_TRY(suscli_param_read_int(params, "rows", &rows, rows));
+  SU_TRY(suscli_param_read_int(params, "threads", &threads, 0));
+
+  if (file == NULL) {
+    SU_ERROR("Please specify a capture file with file=<path to capture>\n");
+    goto done;
+  }
+
+  if (bins < 2 || rows < 1 || threads < 0) {
+    SU_ERROR("Invalid overview parameters\n");
+    goto done;
+  }
+
+  SU_TRY(config = suscan_source_config_new("file", SUSCAN_SOURCE_FORMAT_AUTO));
+  SU_TRY(suscan_source_config_set_path(config, file));
+  if (samp_rate > 0)
+    suscan_source_config_set_samp_rate(config, samp_rate);
+
+  /* The file source looks for the overview next to the data file */
+  if (output == NULL) {
+    SU_TRY(data_path = suscan_source_config_file_get_data_path(config));
+    SU_TRY(ov_path = suscan_overview_path_for(data_path));
+    output = ov_path;
+  }
+
+  ov_params.bins     = bins;
+  ov_params.max_rows = rows;
+  ov_params.threads  = threads;
+
+  gettimeofday(&t0, NULL);
+  SU_TRY(suscan_overview_build(config, output, &ov_params));
+  gettimeofday(&t1, NULL);
+
+  timersub(&t1, &t0, &elapsed);
+
+  fprintf(
+    stderr,
+    "%s: overview saved to %s (%.3f s)\n",
+    file,
+    output,
+    elapsed.tv_sec + 1e-6 * elapsed.tv_usec);
+
+  ok = SU_TRUE;
+
+done:
+  if (config != NULL)
+    suscan_source_config_destroy(config);
+
+  if (data_path != NULL)
+    free(data_path);
+
+  if (ov_path != NULL)
+    free(ov_path);
+
+  return ok;
+}
@@ -0,0 +1,421 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "cli-passes"
+
+#include <sigutils/log.h>
+
+#include <cli/cli.h>
+#include <cli/cmds.h>
+#include <sgdp4/sgdp4.h>
+#include <util/passidx.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define SUSCLI_PASSES_DEFAULT_HOURS 24
+#define SUSCLI_PASSES_DEFAULT_STEP  20
+
+/* Orbits propagated at once. Bounds the size of the batch buffers. */
+#define SUSCLI_PASSES_BATCH_SIZE    64
+
+struct suscli_passes_catalog {
+  PTR_LIST(orbit_t, orbit);
+};
+
+SUPRIVATE void
+suscli_passes_catalog_finalize(struct suscli_passes_catalog *self)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->orbit_count; ++i) {
+    orbit_finalize(self->orbit_list[i]);
+    free(self->orbit_list[i]);
+  }
+
+  if (self->orbit_list != NULL)
+    free(self->orbit_list);
+}
+
+SUPRIVATE SUBOOL
+suscli_passes_catalog_load(
+  struct suscli_passes_catalog *self,
+  const char *file)
+{
+  struct stat sbuf;
+  const char *as_string;
+  orbit_t *orbit = NULL;
+  SUSCOUNT p = 0;
+  SUSDIFF got;
+  int fd = -1;
+  void *buffer = (void *) -1;
+  SUBOOL ok = SU_FALSE;
+
+  if (stat(file, &sbuf) == -1) {
+    SU_ERROR("Cannot stat `%s': %s\n", file, strerror(errno));
+    goto done;
+  }
+
+  if ((fd = open(file, O_RDONLY)) == -1) {
+    SU_ERROR("Cannot open `%s': %s\n", file, strerror(errno));
+    goto done;
+  }
+
+  if ((buffer = mmap(NULL, sbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0))
+    == (void *) -1) {
+    SU_ERROR("mmap failed: %s\n", strerror(errno));
+    goto done;
+  }
+
+  as_string = (const char *) buffer;
+
+  while (p < sbuf.st_size) {
+    SU_ALLOCATE_FAIL(orbit, orbit_t);
+
+    if ((got = orbit_init_from_data(
+      orbit,
+      as_string + p,
+      sbuf.st_size - p)) <= 0) {
+      /* Trailing garbage or an incomplete entry */
+      orbit_finalize(orbit);
+      free(orbit);
+      orbit = NULL;
+
+      if (got < 0)
+        SU_WARNING("Catalog parsing stopped at offset %lu\n", p);
+
+      break;
+    }
+
+    SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(self->orbit, orbit));
+    orbit = NULL;
+
+    p += got;
+  }
+
+  if (self->orbit_count == 0) {
+    SU_ERROR("`%s' contains no valid TLEs\n", file);
+    goto done;
+  }
+
+  ok = SU_TRUE;
+
+  goto done;
+
+fail:
+  if (orbit != NULL) {
+    orbit_finalize(orbit);
+    free(orbit);
+  }
+
+done:
+  if (buffer != (void *) -1)
+    munmap(buffer, sbuf.st_size);
+
+  if (fd != -1)
+    close(fd);
+
+  return ok;
+}
+
+/* Linear interpolation of the instant at which el crosses minel */
+SUPRIVATE SUDOUBLE
+suscli_passes_crossing(
+  const sgdp4_batch_t *batch,
+  const SUDOUBLE *el,
+  unsigned int t,
+  SUDOUBLE minel)
+{
+  SUDOUBLE frac = (minel - el[t]) / (el[t + 1] - el[t]);
+
+  return sgdp4_batch_get_time(batch, t) + frac * batch->step;
+}
+
+SUPRIVATE void
+suscli_passes_print_time(SUDOUBLE t)
+{
+  time_t secs = (time_t) t;
+  struct tm tm;
+  char buf[32];
+
+  gmtime_r(&secs, &tm);
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+
+  printf("%s", buf);
+}
+
+/* los = NAN for passes still in progress at the end of the window */
+SUPRIVATE void
+suscli_passes_print(
+  const char *name,
+  SUDOUBLE aos,
+  SUDOUBLE tca,
+  SUDOUBLE los,
+  SUDOUBLE maxel)
+{
+  printf("%-24.24s  ", name == NULL || *name == '\0' ? "(unnamed)" : name);
+  suscli_passes_print_time(aos);
+  printf("  ");
+  suscli_passes_print_time(tca);
+  printf("  ");
+
+  if (isnan(los))
+    printf("%-19s", "(ongoing)");
+  else
+    suscli_passes_print_time(los);
+
+  printf("  %5.1lfº\n", SU_RAD2DEG(maxel));
+}
+
+SUPRIVATE SUBOOL
+suscli_passes_index_cb(
+  const suscan_pass_index_t *index,
+  const struct suscan_pass *pass,
+  void *privdata)
+{
+  suscli_passes_print(
+    suscan_pass_index_get_name(index, pass),
+    pass->aos,
+    pass->tca,
+    pass->los,
+    pass->max_el);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscli_passes_report(
+  const sgdp4_batch_t *batch,
+  const orbit_t *orbit,
+  unsigned int index,
+  SUDOUBLE minel)
+{
+  const SUDOUBLE *el = sgdp4_batch_get_elevation(batch, index);
+  SUDOUBLE aos = -1, tca = 0, maxel = -INFINITY;
+  SUBOOL in_pass = SU_FALSE;
+  unsigned int i;
+
+  for (i = 0; i < batch->time_count; ++i) {
+    if (el[i] >= minel) {
+      if (!in_pass) {
+        in_pass = SU_TRUE;
+        aos = i > 0
+          ? suscli_passes_crossing(batch, el, i - 1, minel)
+          : sgdp4_batch_get_time(batch, 0);
+        maxel = -INFINITY;
+      }
+
+      if (el[i] > maxel) {
+        maxel = el[i];
+        tca   = sgdp4_batch_get_time(batch, i);
+      }
+    } else if (in_pass) {
+      in_pass = SU_FALSE;
+
+      suscli_passes_print(
+        orbit->name,
+        aos,
+        tca,
+        suscli_passes_crossing(batch, el, i - 1, minel),
+        maxel);
+    }
+  }
+
+  if (in_pass)
+    suscli_passes_print(orbit->name, aos, tca, NAN, maxel);
+}
+
+SUBOOL
+suscli_passes_cb(const hashlist_t *params)
+{
+  struct suscli_passes_catalog catalog;
+  sgdp4_batch_t batch = sgdp4_batch_INITIALIZER;
+  suscan_pass_index_t *index = NULL;
+  orbit_t *orbits = NULL;
+  struct timeval tv_now;
+  const char *file = NULL;
+  xyz_t site;
+  SUDOUBLE hours, step, minel, now;
+  int threads;
+  unsigned int i, n, first, count;
+  SUBOOL cache;
+  SUBOOL batch_init = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&catalog, 0, sizeof(struct suscli_passes_catalog));
+
+  SU_TRYCATCH(
+    suscli_param_read_string(params, "file", &file, NULL),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(params, "lat", &site.lat, INFINITY),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(params, "lon", &site.lon, INFINITY),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(params, "alt", &site.height, 0.),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(
+      params,
+      "hours",
+      &hours,
+      SUSCLI_PASSES_DEFAULT_HOURS),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(
+      params,
+      "step",
+      &step,
+      SUSCLI_PASSES_DEFAULT_STEP),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_double(params, "minel", &minel, 0),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_int(params, "threads", &threads, 0),
+    goto done);
+
+  SU_TRYCATCH(
+    suscli_param_read_bool(params, "cache", &cache, SU_TRUE),
+    goto done);
+
+  if (file == NULL) {
+    SU_ERROR("Please specify a TLE catalog with file=<path to TLEs>\n");
+    goto done;
+  }
+
+  if (isinf(site.lat) || isinf(site.lon)) {
+    SU_ERROR("Please specify the site location with lat=<deg> lon=<deg>\n");
+    goto done;
+  }
+
+  if (hours <= 0 || step <= 0 || threads < 0) {
+    SU_ERROR("Invalid time window or thread count\n");
+    goto done;
+  }
+
+  site.lat = SU_DEG2RAD(site.lat);
+  site.lon = SU_DEG2RAD(site.lon);
+  minel    = SU_DEG2RAD(minel);
+  count    = (unsigned int) ceil(hours * 3600 / step) + 1;
+
+  SU_TRYCATCH(suscli_passes_catalog_load(&catalog, file), goto done);
+
+  /* The batch takes a contiguous array of orbits */
+  SU_TRYCATCH(
+    orbits = calloc(catalog.orbit_count, sizeof(orbit_t)),
+    goto done);
+  for (i = 0; i < catalog.orbit_count; ++i)
+    orbits[i] = *catalog.orbit_list[i];
+
+  gettimeofday(&tv_now, NULL);
+  now = tv_now.tv_sec + 1e-6 * tv_now.tv_usec;
+
+  printf(
+    "%-24s  %-19s  %-19s  %-19s  %s\n",
+    "Name",
+    "AOS (UTC)",
+    "TCA (UTC)",
+    "LOS (UTC)",
+    "Max el");
+
+  /* Passes already in the index are not computed again */
+  if (cache) {
+    SU_TRYCATCH(
+      index = suscan_pass_index_new(&site, minel, step),
+      goto done);
+
+    SU_TRYCATCH(
+      suscan_pass_index_update(
+        index,
+        orbits,
+        catalog.orbit_count,
+        now,
+        now + hours * 3600),
+      goto done);
+
+    suscan_pass_index_walk(
+      index,
+      now,
+      now + hours * 3600,
+      suscli_passes_index_cb,
+      NULL);
+
+    SU_TRYCATCH(suscan_pass_index_save(index), goto done);
+
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  /* Passes are reported per satellite, so chunks keep the output order */
+  for (first = 0; first < catalog.orbit_count; first += n) {
+    n = SU_MIN(catalog.orbit_count - first, SUSCLI_PASSES_BATCH_SIZE);
+
+    SU_TRYCATCH(
+      sgdp4_batch_init(&batch, orbits + first, n, &site),
+      goto done);
+    batch_init = SU_TRUE;
+
+    SU_TRYCATCH(
+      sgdp4_batch_set_times(&batch, &tv_now, step, count),
+      goto done);
+
+    SU_TRYCATCH(sgdp4_batch_compute(&batch, threads), goto done);
+
+    for (i = 0; i < n; ++i) {
+      if (!batch.valid[i]) {
+        SU_WARNING(
+          "%s: propagation failed, skipped\n",
+          catalog.orbit_list[first + i]->name);
+        continue;
+      }
+
+      suscli_passes_report(&batch, catalog.orbit_list[first + i], i, minel);
+    }
+
+    sgdp4_batch_finalize(&batch);
+    batch_init = SU_FALSE;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (index != NULL)
+    suscan_pass_index_destroy(index);
+
+  if (batch_init)
+    sgdp4_batch_finalize(&batch);
+
+  if (orbits != NULL)
+    free(orbits);
+
+  suscli_passes_catalog_finalize(&catalog);
+
+  return ok;
+}
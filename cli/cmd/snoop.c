@@ -181,6 +181,7 @@ suscli_snoop_msg_debug_params(
   }
 
   JSON_MSG_SUFLOAT(psd_update_int);
+  JSON_MSG_SUFLOAT(channel_spacing);
 
   return SU_TRUE;
 }
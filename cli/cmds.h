@@ -31,7 +31,11 @@ SUBOOL suscli_radio_cb(const hashlist_t *params);
 SUBOOL suscli_devices_cb(const hashlist_t *params);
 SUBOOL suscli_makeprof_cb(const hashlist_t *params);
 SUBOOL suscli_tleinfo_cb(const hashlist_t *params);
+SUBOOL suscli_passes_cb(const hashlist_t *params);
 SUBOOL suscli_snoop_cb(const hashlist_t *params);
 SUBOOL suscli_spectrum_cb(const hashlist_t *params);
+SUBOOL suscli_overview_cb(const hashlist_t *params);
+SUBOOL suscli_inspbench_cb(const hashlist_t *params);
+SUBOOL suscli_check_cb(const hashlist_t *params);
 
 #endif /* _CLI_CMDS_H */
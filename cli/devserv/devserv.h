@@ -590,6 +590,7 @@ struct suscli_analyzer_server_params {
   uint16_t    port;
   const char *ifname;
   size_t      compress_threshold;
+  SUFLOAT     channel_spacing; /* Raster channelizer spacing, 0 disables */
 };
 
 #define SUSCLI_ANALYZER_DEFAULT_COMPRESS_THRESHOLD 1400
@@ -599,7 +600,8 @@ struct suscli_analyzer_server_params {
   NULL,        /* profile */                      \
   28001,       /* port */                         \
   NULL,        /* ifname */                       \
-  SUSCLI_ANALYZER_DEFAULT_COMPRESS_THRESHOLD      \
+  SUSCLI_ANALYZER_DEFAULT_COMPRESS_THRESHOLD,     \
+  0            /* channel_spacing */              \
 }
 
 struct suscli_analyzer_server {
@@ -26,6 +26,8 @@
 #include <sigutils/util/compat-fcntl.h>
 #include <sigutils/util/compat-socket.h>
 #include <analyzer/impl/multicast.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/fftcache.h>
 
 SUPRIVATE void suscli_analyzer_server_kick_client(
     suscli_analyzer_server_t *self,
@@ -34,6 +36,33 @@ SUPRIVATE void suscli_analyzer_server_kick_client_unsafe(
     suscli_analyzer_server_t *self,
     suscli_analyzer_client_t *client);
 
+SUPRIVATE void
+suscli_analyzer_server_log_inspector_memory(void)
+{
+  struct suscan_inspector_memory_stats stats;
+  struct suscan_fft_cache_stats fft_stats;
+
+  suscan_inspector_get_memory_stats(&stats);
+
+  SU_INFO(
+    "Inspector memory: %lu inspectors, %.1f KiB (sampler buffers: %.1f KiB, "
+    "buffer pool: %.1f KiB, %.1f KiB of them unused)\n",
+    (unsigned long) stats.inspectors,
+    (stats.object_bytes + stats.sampler_bytes) / 1024.,
+    stats.sampler_bytes / 1024.,
+    stats.pool_bytes / 1024.,
+    stats.pool_free_bytes / 1024.);
+
+  suscan_fft_cache_get_stats(&fft_stats);
+
+  SU_INFO(
+    "FFT cache: %u plans (%llu hits, %llu misses), %u windows, %.1f KiB\n",
+    fft_stats.plans,
+    (unsigned long long) fft_stats.plan_hits,
+    (unsigned long long) fft_stats.plan_misses,
+    fft_stats.windows,
+    fft_stats.window_bytes / 1024.);
+}
 
 struct suscli_user_entry *
 suscli_user_entry_new(const char *user, const char *password, uint64_t perm)
@@ -187,6 +216,7 @@ suscli_analyzer_server_intercept_message_unsafe(
               "%s: inspector (handle 0x%x) opened\n",
               suscli_analyzer_client_get_name(client),
               private_handle);
+          suscli_analyzer_server_log_inspector_memory();
 
           inspmsg->handle = private_handle;
           break;
@@ -224,6 +254,7 @@ suscli_analyzer_server_intercept_message_unsafe(
                 "%s: inspector (handle 0x%x) closed\n",
                 suscli_analyzer_client_get_name(client),
                 private_handle);
+            suscli_analyzer_server_log_inspector_memory();
           }
           break;
 
@@ -1324,6 +1355,7 @@ suscli_analyzer_server_new_with_params(
 
   new->params = *params;
   new->analyzer_params = analyzer_params;
+  new->analyzer_params.channel_spacing = params->channel_spacing;
 
   new->client_list.listen_fd = -1;
   new->client_list.cancel_fd = -1;
@@ -0,0 +1,482 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "sgdp4-batch"
+
+#include "sgdp4.h"
+#include <sigutils/log.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define SGDP4_BATCH_MAX_REASONABLE_RADIUS (EQRAD + 3.8e5)
+#define SGDP4_BATCH_EARTH_ROTATION \
+  (7.29211514670698e-05 * (1.0  - 0.0015563/86400.0))
+
+/*
+ * The SGP4/SDP4 propagator itself is full of branches (deep space terms,
+ * Kepler iterations), so it is run scalar, one time step after another,
+ * into a structure of arrays. Everything that follows (Keplerian to TEME,
+ * TEME to ECEF, ECEF to topocentric) is the same straight-line code for
+ * every time step and is done in separate loops over those arrays, which
+ * the compiler can vectorize. The time-dependent parts of the frame
+ * transformations are computed once per time step, for all orbits.
+ */
+
+struct sgdp4_batch_scratch {
+  SUDOUBLE *theta;
+  SUDOUBLE *ascn;
+  SUDOUBLE *eqinc;
+  SUDOUBLE *radius;
+  SUDOUBLE *rdotk;
+  SUDOUBLE *rfdotk;
+};
+
+struct sgdp4_batch_task {
+  sgdp4_batch_t *batch;
+  unsigned int   first;
+  unsigned int   last;
+  pthread_t      thread;
+  SUBOOL         started;
+};
+
+SUPRIVATE void
+sgdp4_batch_scratch_finalize(struct sgdp4_batch_scratch *self)
+{
+  if (self->theta != NULL)
+    free(self->theta);
+
+  memset(self, 0, sizeof(struct sgdp4_batch_scratch));
+}
+
+SUPRIVATE SUBOOL
+sgdp4_batch_scratch_init(struct sgdp4_batch_scratch *self, unsigned int size)
+{
+  SUDOUBLE *buf;
+
+  /* One allocation for the six arrays */
+  SU_TRYCATCH(buf = malloc(6 * size * sizeof(SUDOUBLE)), return SU_FALSE);
+
+  self->theta  = buf;
+  self->ascn   = buf + size;
+  self->eqinc  = buf + 2 * size;
+  self->radius = buf + 3 * size;
+  self->rdotk  = buf + 4 * size;
+  self->rfdotk = buf + 5 * size;
+
+  return SU_TRUE;
+}
+
+void
+sgdp4_batch_finalize(sgdp4_batch_t *self)
+{
+  if (self->ctx != NULL)
+    free(self->ctx);
+
+  if (self->epoch != NULL)
+    free(self->epoch);
+
+  if (self->valid != NULL)
+    free(self->valid);
+
+  if (self->cos_gmst != NULL)
+    free(self->cos_gmst);
+
+  if (self->sin_gmst != NULL)
+    free(self->sin_gmst);
+
+  if (self->pm != NULL)
+    free(self->pm);
+
+  if (self->azimuth != NULL)
+    free(self->azimuth);
+
+  if (self->elevation != NULL)
+    free(self->elevation);
+
+  if (self->range != NULL)
+    free(self->range);
+
+  if (self->range_rate != NULL)
+    free(self->range_rate);
+
+  memset(self, 0, sizeof(sgdp4_batch_t));
+}
+
+SUBOOL
+sgdp4_batch_init(
+  sgdp4_batch_t *self,
+  const orbit_t *orbits,
+  unsigned int count,
+  const xyz_t *geo)
+{
+  SUDOUBLE slon, clon, slat, clat;
+  unsigned int i;
+
+  memset(self, 0, sizeof(sgdp4_batch_t));
+
+  self->site        = *geo;
+  self->orbit_count = count;
+
+  xyz_geodetic_to_ecef(geo, &self->site_ecef);
+
+  /*
+   * Same as XYZ_ROT3(lon) followed by XYZ_ROT2(pi / 2 - lat), as in
+   * xyz_ecef_to_razel, in XYZ_MATMUL order.
+   */
+  slon = sin(geo->lon);
+  clon = cos(geo->lon);
+  slat = sin(geo->lat);
+  clat = cos(geo->lat);
+
+  self->sez[0][0] =  slat * clon;
+  self->sez[1][0] =  slat * slon;
+  self->sez[2][0] = -clat;
+  self->sez[0][1] = -slon;
+  self->sez[1][1] =  clon;
+  self->sez[2][1] =  0;
+  self->sez[0][2] =  clat * clon;
+  self->sez[1][2] =  clat * slon;
+  self->sez[2][2] =  slat;
+
+  SU_TRYCATCH(self->ctx   = calloc(count, sizeof(sgdp4_ctx_t)), goto fail);
+  SU_TRYCATCH(self->epoch = calloc(count, sizeof(SUDOUBLE)), goto fail);
+  SU_TRYCATCH(self->valid = calloc(count, sizeof(SUBOOL)), goto fail);
+
+  for (i = 0; i < count; ++i) {
+    self->valid[i] = 
+      sgdp4_ctx_init(&self->ctx[i], (orbit_t *) &orbits[i]) != SGDP4_ERROR;
+    self->epoch[i] = orbit_epoch_to_unix(&orbits[i]);
+  }
+
+  return SU_TRUE;
+
+fail:
+  sgdp4_batch_finalize(self);
+
+  return SU_FALSE;
+}
+
+SUBOOL
+sgdp4_batch_set_times(
+  sgdp4_batch_t *self,
+  const struct timeval *start,
+  SUDOUBLE step,
+  unsigned int count)
+{
+  SUSCOUNT total = (SUSCOUNT) self->orbit_count * count;
+  SUDOUBLE *cos_gmst = NULL, *sin_gmst = NULL;
+  SUDOUBLE (*pm)[3][3] = NULL;
+  SUDOUBLE *azimuth = NULL, *elevation = NULL;
+  SUDOUBLE *range = NULL, *range_rate = NULL;
+  SUDOUBLE gmst;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYCATCH(count > 0, return SU_FALSE);
+
+  /*
+   * Everything here is recomputed, so there is nothing to preserve. Fresh
+   * buffers replace the old ones only if all of them could be allocated,
+   * and the batch is left as it was otherwise.
+   */
+  if (count != self->time_count) {
+    SU_ALLOCATE_MANY(cos_gmst, count, SUDOUBLE);
+    SU_ALLOCATE_MANY(sin_gmst, count, SUDOUBLE);
+    SU_TRY(pm = calloc(count, sizeof(SUDOUBLE[3][3])));
+
+    SU_ALLOCATE_MANY(azimuth, total, SUDOUBLE);
+    SU_ALLOCATE_MANY(elevation, total, SUDOUBLE);
+    SU_ALLOCATE_MANY(range, total, SUDOUBLE);
+    SU_ALLOCATE_MANY(range_rate, total, SUDOUBLE);
+
+    if (self->cos_gmst != NULL)
+      free(self->cos_gmst);
+    self->cos_gmst = cos_gmst;
+    cos_gmst = NULL;
+
+    if (self->sin_gmst != NULL)
+      free(self->sin_gmst);
+    self->sin_gmst = sin_gmst;
+    sin_gmst = NULL;
+
+    if (self->pm != NULL)
+      free(self->pm);
+    self->pm = pm;
+    pm = NULL;
+
+    if (self->azimuth != NULL)
+      free(self->azimuth);
+    self->azimuth = azimuth;
+    azimuth = NULL;
+
+    if (self->elevation != NULL)
+      free(self->elevation);
+    self->elevation = elevation;
+    elevation = NULL;
+
+    if (self->range != NULL)
+      free(self->range);
+    self->range = range;
+    range = NULL;
+
+    if (self->range_rate != NULL)
+      free(self->range_rate);
+    self->range_rate = range_rate;
+    range_rate = NULL;
+
+    self->time_count = count;
+  }
+
+  self->t0   = start->tv_sec + 1e-6 * start->tv_usec;
+  self->step = step;
+
+  for (i = 0; i < count; ++i) {
+    xyz_teme_to_ecef_params(
+      time_unix_to_julian(sgdp4_batch_get_time(self, i)),
+      &gmst,
+      self->pm[i]);
+
+    self->cos_gmst[i] = cos(gmst);
+    self->sin_gmst[i] = sin(gmst);
+  }
+
+  ok = SU_TRUE;
+
+done:
+  /* Only set if we failed to allocate the rest */
+  if (cos_gmst != NULL)
+    free(cos_gmst);
+
+  if (sin_gmst != NULL)
+    free(sin_gmst);
+
+  if (pm != NULL)
+    free(pm);
+
+  if (azimuth != NULL)
+    free(azimuth);
+
+  if (elevation != NULL)
+    free(elevation);
+
+  if (range != NULL)
+    free(range);
+
+  if (range_rate != NULL)
+    free(range_rate);
+
+  return ok;
+}
+
+SUPRIVATE void
+sgdp4_batch_compute_orbit(
+  sgdp4_batch_t *self,
+  struct sgdp4_batch_scratch *scratch,
+  unsigned int orbit)
+{
+  const SUDOUBLE (*sez)[3] = (const SUDOUBLE (*)[3]) self->sez;
+  SUSCOUNT offset = (SUSCOUNT) orbit * self->time_count;
+  SUDOUBLE *az    = self->azimuth    + offset;
+  SUDOUBLE *el    = self->elevation  + offset;
+  SUDOUBLE *range = self->range      + offset;
+  SUDOUBLE *rate  = self->range_rate + offset;
+  SUDOUBLE tsince, w = SGDP4_BATCH_EARTH_ROTATION;
+  SUDOUBLE sT, cT, sI, cI, sS, cS, xmx, xmy;
+  SUDOUBLE ux, uy, uz, vx, vy, vz;
+  SUDOUBLE px, py, pz, qx, qy, qz;
+  SUDOUBLE rx, ry, rz, dx, dy, dz;
+  SUDOUBLE ex, ey, ez, fx, fy, fz;
+  const SUDOUBLE (*pm)[3];
+  unsigned int i, n = self->time_count;
+  kep_t kep;
+
+  if (!self->valid[orbit])
+    return;
+
+  /* Scalar part: propagation */
+  for (i = 0; i < n; ++i) {
+    tsince = (sgdp4_batch_get_time(self, i) - self->epoch[orbit]) / 60.;
+
+    if (sgdp4_ctx_compute(&self->ctx[orbit], tsince, SU_TRUE, &kep)
+      == SGDP4_ERROR
+      || kep.radius > SGDP4_BATCH_MAX_REASONABLE_RADIUS) {
+      self->valid[orbit] = SU_FALSE;
+      return;
+    }
+
+    scratch->theta[i]  = kep.theta;
+    scratch->ascn[i]   = kep.ascn;
+    scratch->eqinc[i]  = kep.eqinc;
+    scratch->radius[i] = kep.radius;
+    scratch->rdotk[i]  = kep.rdotk;
+    scratch->rfdotk[i] = kep.rfdotk;
+  }
+
+  /* Straight-line part: frame transformations */
+  for (i = 0; i < n; ++i) {
+    /* Keplerian to TEME, as in kep_get_pos_vel_teme */
+    sT = sin(scratch->theta[i]);
+    cT = cos(scratch->theta[i]);
+    sI = sin(scratch->eqinc[i]);
+    cI = cos(scratch->eqinc[i]);
+    sS = sin(scratch->ascn[i]);
+    cS = cos(scratch->ascn[i]);
+
+    xmx = -sS * cI;
+    xmy =  cS * cI;
+
+    ux = xmx * sT + cS * cT;
+    uy = xmy * sT + sS * cT;
+    uz = sI * sT;
+
+    vx = xmx * cT - cS * sT;
+    vy = xmy * cT - sS * sT;
+    vz = sI * cT;
+
+    px = scratch->radius[i] * ux;
+    py = scratch->radius[i] * uy;
+    pz = scratch->radius[i] * uz;
+
+    qx = scratch->rdotk[i] * ux + scratch->rfdotk[i] * vx;
+    qy = scratch->rdotk[i] * uy + scratch->rfdotk[i] * vy;
+    qz = scratch->rdotk[i] * uz + scratch->rfdotk[i] * vz;
+
+    /* TEME to PEF (sidereal rotation), as in xyz_teme_to_ecef */
+    rx =  self->cos_gmst[i] * px + self->sin_gmst[i] * py;
+    ry = -self->sin_gmst[i] * px + self->cos_gmst[i] * py;
+    rz =  pz;
+
+    dx =  self->cos_gmst[i] * qx + self->sin_gmst[i] * qy + w * ry;
+    dy = -self->sin_gmst[i] * qx + self->cos_gmst[i] * qy - w * rx;
+    dz =  qz;
+
+    /* PEF to ECEF (polar motion) */
+    pm = (const SUDOUBLE (*)[3]) self->pm[i];
+
+    ex = pm[0][0] * rx + pm[1][0] * ry + pm[2][0] * rz;
+    ey = pm[0][1] * rx + pm[1][1] * ry + pm[2][1] * rz;
+    ez = pm[0][2] * rx + pm[1][2] * ry + pm[2][2] * rz;
+
+    fx = pm[0][0] * dx + pm[1][0] * dy + pm[2][0] * dz;
+    fy = pm[0][1] * dx + pm[1][1] * dy + pm[2][1] * dz;
+    fz = pm[0][2] * dx + pm[1][2] * dy + pm[2][2] * dz;
+
+    /* ECEF to topocentric, as in xyz_ecef_to_razel */
+    ex -= self->site_ecef.x;
+    ey -= self->site_ecef.y;
+    ez -= self->site_ecef.z;
+
+    rx = sez[0][0] * ex + sez[1][0] * ey + sez[2][0] * ez;
+    ry = sez[0][1] * ex + sez[1][1] * ey + sez[2][1] * ez;
+    rz = sez[0][2] * ex + sez[1][2] * ey + sez[2][2] * ez;
+
+    dx = sez[0][0] * fx + sez[1][0] * fy + sez[2][0] * fz;
+    dy = sez[0][1] * fx + sez[1][1] * fy + sez[2][1] * fz;
+    dz = sez[0][2] * fx + sez[1][2] * fy + sez[2][2] * fz;
+
+    range[i] = sqrt(rx * rx + ry * ry + rz * rz);
+    rate[i]  = (rx * dx + ry * dy + rz * dz) / range[i];
+    el[i]    = asin(rz / range[i]);
+    az[i]    = atan2(ry, -rx);
+  }
+}
+
+SUPRIVATE void *
+sgdp4_batch_thread(void *userdata)
+{
+  struct sgdp4_batch_task *task = (struct sgdp4_batch_task *) userdata;
+  struct sgdp4_batch_scratch scratch;
+  unsigned int i;
+
+  if (!sgdp4_batch_scratch_init(&scratch, task->batch->time_count))
+    return NULL;
+
+  for (i = task->first; i < task->last; ++i)
+    sgdp4_batch_compute_orbit(task->batch, &scratch, i);
+
+  sgdp4_batch_scratch_finalize(&scratch);
+
+  return task;
+}
+
+SUBOOL
+sgdp4_batch_compute(sgdp4_batch_t *self, unsigned int threads)
+{
+  struct sgdp4_batch_task *tasks = NULL;
+  unsigned int i, per_thread;
+  void *result;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->time_count == 0) {
+    SU_ERROR("No time grid defined\n");
+    goto done;
+  }
+
+  if (threads == 0) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cores < 1 ? 1 : cores;
+  }
+
+  if (threads > self->orbit_count)
+    threads = self->orbit_count;
+
+  if (threads == 0) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_TRYCATCH(
+    tasks = calloc(threads, sizeof(struct sgdp4_batch_task)),
+    goto done);
+
+  per_thread = (self->orbit_count + threads - 1) / threads;
+
+  for (i = 0; i < threads; ++i) {
+    tasks[i].batch = self;
+    tasks[i].first = SU_MIN(i * per_thread, self->orbit_count);
+    tasks[i].last  = SU_MIN((i + 1) * per_thread, self->orbit_count);
+  }
+
+  /* The last slice runs in the calling thread */
+  for (i = 0; i < threads - 1; ++i) {
+    SU_TRYCATCH(
+      pthread_create(
+        &tasks[i].thread,
+        NULL,
+        sgdp4_batch_thread,
+        &tasks[i]) == 0,
+      goto done);
+    tasks[i].started = SU_TRUE;
+  }
+
+  ok = sgdp4_batch_thread(&tasks[threads - 1]) != NULL;
+
+done:
+  if (tasks != NULL) {
+    for (i = 0; i < threads; ++i)
+      if (tasks[i].started) {
+        if (pthread_join(tasks[i].thread, &result) != 0 || result == NULL)
+          ok = SU_FALSE;
+      }
+
+    free(tasks);
+  }
+
+  return ok;
+}
@@ -112,6 +112,13 @@ polarm(SUDOUBLE jdut1, SUDOUBLE pm[3][3])
   pm[2][2] = cos(xp) * cos(yp);
 }
 
+void
+xyz_teme_to_ecef_params(SUDOUBLE jdut1, SUDOUBLE *gmst, SUDOUBLE pm[3][3])
+{
+  *gmst = gstime(jdut1 + _SGDP4_LEAP_SECONDS / (3600. * 24.));
+  polarm(jdut1, pm);
+}
+
 /* Refer to https://github.com/Spacecraft-Code/Vallado/blob/master/Matlab/teme2ecef.m */
 void 
 xyz_teme_to_ecef(
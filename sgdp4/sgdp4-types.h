@@ -205,6 +205,40 @@ struct sgdp4_prediction {
 
 typedef struct sgdp4_prediction sgdp4_prediction_t;
 
+/*
+ * Batch propagation of many orbits over a common, evenly spaced time grid.
+ * Results are stored orbit by orbit in separate arrays (structure of
+ * arrays), indexed as [orbit * time_count + time].
+ */
+struct sgdp4_batch {
+  xyz_t         site;        /* Geodetic */
+  xyz_t         site_ecef;
+  SUDOUBLE      sez[3][3];   /* ECEF to topocentric (SEZ) rotation */
+
+  unsigned int  orbit_count;
+  sgdp4_ctx_t  *ctx;
+  SUDOUBLE     *epoch;       /* Orbit epochs (Unix time) */
+  SUBOOL       *valid;       /* Propagation did not fail */
+
+  /* Time grid */
+  SUDOUBLE      t0;          /* Unix time */
+  SUDOUBLE      step;        /* Seconds */
+  unsigned int  time_count;
+  SUDOUBLE     *cos_gmst;
+  SUDOUBLE     *sin_gmst;
+  SUDOUBLE    (*pm)[3][3];   /* Polar motion */
+
+  /* Results */
+  SUDOUBLE     *azimuth;
+  SUDOUBLE     *elevation;
+  SUDOUBLE     *range;
+  SUDOUBLE     *range_rate;
+};
+
+typedef struct sgdp4_batch sgdp4_batch_t;
+
+#define sgdp4_batch_INITIALIZER {{{0}}}
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
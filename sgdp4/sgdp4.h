@@ -177,6 +177,12 @@ void xyz_teme_to_ecef(
   xyz_t *ecef_pos,
   xyz_t *ecef_vel);
 
+/* Sidereal angle and polar motion matrix, as used by xyz_teme_to_ecef */
+void xyz_teme_to_ecef_params(
+  SUDOUBLE jdut1,
+  SUDOUBLE *gmst,
+  SUDOUBLE pm[3][3]);
+
 void xyz_sub(const xyz_t *a, const xyz_t *b, xyz_t *res);
 
 void xyz_mul_c(xyz_t *pos, SUDOUBLE k);
@@ -346,6 +352,44 @@ SUBOOL sgdp4_prediction_init(
   const orbit_t *orbit,
   const xyz_t *geo);
 
+/************** Batch propagation ***************/
+
+/* Orbits are only needed during initialization */
+SUBOOL sgdp4_batch_init(
+  sgdp4_batch_t *self,
+  const orbit_t *orbits,
+  unsigned int count,
+  const xyz_t *geo);
+
+SUBOOL sgdp4_batch_set_times(
+  sgdp4_batch_t *self,
+  const struct timeval *start,
+  SUDOUBLE step, /* In seconds */
+  unsigned int count);
+
+/* threads = 0 uses all online processors */
+SUBOOL sgdp4_batch_compute(sgdp4_batch_t *self, unsigned int threads);
+
+SUINLINE SUDOUBLE
+sgdp4_batch_get_time(const sgdp4_batch_t *self, unsigned int t)
+{
+  return self->t0 + t * self->step;
+}
+
+SUINLINE const SUDOUBLE *
+sgdp4_batch_get_elevation(const sgdp4_batch_t *self, unsigned int orbit)
+{
+  return self->elevation + (SUSCOUNT) orbit * self->time_count;
+}
+
+SUINLINE const SUDOUBLE *
+sgdp4_batch_get_range_rate(const sgdp4_batch_t *self, unsigned int orbit)
+{
+  return self->range_rate + (SUSCOUNT) orbit * self->time_count;
+}
+
+void sgdp4_batch_finalize(sgdp4_batch_t *self);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,9 +26,50 @@
 #include <util/sha256.h>
 #include <util/compat.h>
 #include <util/confdb.h>
+#include <util/startup.h>
 #include <sigutils/util/compat-stat.h>
 #include <string.h>
 #include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define SUSCAN_PLUGIN_HASH_CACHE        "plugin-hashes.cache"
+#define SUSCAN_PLUGIN_HASH_BLOCK_SIZE   (1 << 16)
+#define SUSCAN_PLUGIN_HASH_MAX_THREADS  8
+
+struct suscan_plugin_hash_cache_entry {
+  uint64_t size;
+  int64_t  mtime; /* Nanoseconds */
+  int64_t  ctime; /* Nanoseconds */
+  uint64_t inode;
+  char     hash[2 * SHA256_BLOCK_SIZE + 1];
+};
+
+struct suscan_plugin_hash_job {
+  const char *path;
+  struct suscan_plugin_hash_cache_entry stamp;
+  char        hash[2 * SHA256_BLOCK_SIZE + 1];
+  SUBOOL      ok;
+};
+
+struct suscan_plugin_hash_task {
+  struct suscan_plugin_hash_job *job_list;
+  unsigned int job_count;
+  unsigned int first;
+  unsigned int stride;
+  pthread_t    thread;
+  SUBOOL       started;
+};
+
+struct suscan_plugin_startup_stats {
+  SUFLOAT      discovery_ms;
+  SUFLOAT      hashing_ms;
+  SUFLOAT      loading_ms;
+  unsigned int cached;
+  unsigned int hashed;
+};
 
 /*
  * No function in this module is thread-safe. Plugin loading occurs
@@ -45,6 +86,14 @@ SUPRIVATE SUBOOL      g_custom_plugin_path = SU_FALSE;
 SUPRIVATE hashlist_t *g_hash_to_plugin     = NULL;
 SUPRIVATE hashlist_t *g_name_to_plugin     = NULL;
 SUPRIVATE hashlist_t *g_path_to_hash       = NULL;
+SUPRIVATE hashlist_t *g_hash_cache         = NULL;
+SUPRIVATE const char *g_hash_cache_path    = NULL;
+SUPRIVATE SUBOOL      g_hash_cache_dirty   = SU_FALSE;
+
+SUPRIVATE struct suscan_plugin_startup_stats g_startup_stats;
+
+SUPRIVATE void suscan_plugin_hash_cache_dtor(const char *, void *, void *);
+SUPRIVATE void suscan_plugin_hash_cache_load(void);
 
 /* Suscan plugin lifecycle is private to this module. */
 SUPRIVATE SU_INSTANCER(suscan_plugin, const char *);
@@ -63,6 +112,12 @@ suscan_plugin_ensure_init(void)
   
   if (g_path_to_hash == NULL)
     SU_MAKE(g_path_to_hash, hashlist);
+
+  if (g_hash_cache == NULL) {
+    SU_MAKE(g_hash_cache, hashlist);
+    hashlist_set_dtor(g_hash_cache, suscan_plugin_hash_cache_dtor);
+    suscan_plugin_hash_cache_load();
+  }
   
   ok = SU_TRUE;
 
@@ -70,53 +125,449 @@ done:
   return ok;
 }
 
+/*
+ * Hashing plugins on every startup is expensive (they tend to be large and
+ * our startup time budget is small), so hashes are remembered across runs.
+ * A cached hash is trusted only if the size, inode, and modification and
+ * status change times (in nanoseconds) of the file did not change since it
+ * was computed.
+ */
+SUPRIVATE void
+suscan_plugin_hash_cache_dtor(const char *key, void *value, void *userdata)
+{
+  if (value != NULL)
+    free(value);
+}
+
+SUPRIVATE SUBOOL
+suscan_plugin_hash_cache_stat(
+  const char *path,
+  struct suscan_plugin_hash_cache_entry *entry)
+{
+  struct stat sbuf;
+
+  if (stat(path, &sbuf) == -1)
+    return SU_FALSE;
+
+  entry->size  = sbuf.st_size;
+#if defined(__APPLE__)
+  entry->mtime = (int64_t) sbuf.st_mtimespec.tv_sec * 1000000000
+    + sbuf.st_mtimespec.tv_nsec;
+  entry->ctime = (int64_t) sbuf.st_ctimespec.tv_sec * 1000000000
+    + sbuf.st_ctimespec.tv_nsec;
+#elif defined(_WIN32)
+  entry->mtime = (int64_t) sbuf.st_mtime * 1000000000;
+  entry->ctime = (int64_t) sbuf.st_ctime * 1000000000;
+#else
+  entry->mtime = (int64_t) sbuf.st_mtim.tv_sec * 1000000000
+    + sbuf.st_mtim.tv_nsec;
+  entry->ctime = (int64_t) sbuf.st_ctim.tv_sec * 1000000000
+    + sbuf.st_ctim.tv_nsec;
+#endif /* defined(__APPLE__) */
+  entry->inode = sbuf.st_ino;
+
+  return SU_TRUE;
+}
+
+SUINLINE SUBOOL
+suscan_plugin_hash_cache_stamp_equal(
+  const struct suscan_plugin_hash_cache_entry *a,
+  const struct suscan_plugin_hash_cache_entry *b)
+{
+  return a->size == b->size
+    && a->mtime == b->mtime
+    && a->ctime == b->ctime
+    && a->inode == b->inode;
+}
+
 SUPRIVATE const char *
-suscan_plugin_hash_file(const char *path)
+suscan_plugin_hash_cache_get_path(void)
 {
-  const char *hash = NULL;
-  char *buffer = NULL;
+  const char *user_path;
+
+  if (g_hash_cache_path == NULL) {
+    SU_TRYCATCH(user_path = suscan_get_user_path(), return NULL);
+    SU_TRYCATCH(
+      g_hash_cache_path = strbuild("%s/" SUSCAN_PLUGIN_HASH_CACHE, user_path),
+      return NULL);
+  }
+
+  return g_hash_cache_path;
+}
+
+/*
+ * Cache lines are: <hash> <size> <mtime> <ctime> <inode> <path>. Lines of
+ * older caches have no ctime, and are skipped (their path is not a number).
+ */
+SUPRIVATE void
+suscan_plugin_hash_cache_load(void)
+{
+  struct suscan_plugin_hash_cache_entry *entry = NULL;
+  const char *cache_path;
+  unsigned long long size, inode;
+  long long mtime, ctime;
+  char line[PATH_MAX + 2 * SHA256_BLOCK_SIZE + 64];
+  char hash[2 * SHA256_BLOCK_SIZE + 1];
+  size_t len;
+  int offset;
   FILE *fp = NULL;
-  
-  if ((hash = hashlist_get(g_path_to_hash, path)) == NULL) {
-    uint8_t block[SHA256_BLOCK_SIZE];
-    SHA256_CTX ctx;
-    int32_t got;
-    unsigned int i;
-    
-    if ((fp = fopen(path, "rb")) == NULL)
-      goto done;
 
-    suscan_sha256_init(&ctx);
+  if ((cache_path = suscan_plugin_hash_cache_get_path()) == NULL)
+    goto done;
 
-    while ((got = fread(block, 1, SHA256_BLOCK_SIZE, fp)) > 0)
-      suscan_sha256_update(&ctx, block, got);
-    
-    if (got < 0)
-      SU_ERROR("sha256: cannot read `%s': %s\n", path, strerror(errno));
+  if ((fp = fopen(cache_path, "r")) == NULL)
+    goto done;
 
-    suscan_sha256_final(&ctx, block);
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    len = strlen(line);
+    if (len > 0 && line[len - 1] == '\n')
+      line[--len] = '\0';
+
+    if (sscanf(
+      line,
+      "%64s %llu %lld %lld %llu %n",
+      hash,
+      &size,
+      &mtime,
+      &ctime,
+      &inode,
+      &offset) < 5 || strlen(hash) != 2 * SHA256_BLOCK_SIZE)
+      continue;
 
-    SU_ALLOCATE_MANY(buffer, 2 * SHA256_BLOCK_SIZE + 1, char);
+    SU_ALLOCATE(entry, struct suscan_plugin_hash_cache_entry);
 
-    for (i = 0; i < SHA256_BLOCK_SIZE; ++i)
-      snprintf(buffer + 2 * i, 3, "%02x", block[i]);
-    
-    SU_TRY(hashlist_set(g_path_to_hash, path, buffer));
+    entry->size  = size;
+    entry->mtime = mtime;
+    entry->ctime = ctime;
+    entry->inode = inode;
+    memcpy(entry->hash, hash, sizeof(entry->hash));
+
+    SU_TRY(hashlist_set(g_hash_cache, line + offset, entry));
+    entry = NULL;
+  }
+
+done:
+  if (entry != NULL)
+    free(entry);
+
+  if (fp != NULL)
+    fclose(fp);
+}
+
+SUPRIVATE void
+suscan_plugin_hash_cache_save(void)
+{
+  const struct suscan_plugin_hash_cache_entry *entry;
+  const char *cache_path;
+  char *tmp_path = NULL;
+  hashlist_iterator_t it;
+  FILE *fp = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if (!g_hash_cache_dirty) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_TRY(cache_path = suscan_plugin_hash_cache_get_path());
+  SU_TRY(tmp_path = strbuild("%s.tmp", cache_path));
+
+  if ((fp = fopen(tmp_path, "w")) == NULL)
+    goto done;
+
+  for (
+    it = hashlist_begin(g_hash_cache);
+    !hashlist_iterator_end(&it);
+    hashlist_iterator_advance(&it)) {
+    entry = it.value;
+    if (entry == NULL)
+      continue;
 
-    hash = buffer;
-    buffer = NULL;
+    fprintf(
+      fp,
+      "%s %llu %lld %lld %llu %s\n",
+      entry->hash,
+      (unsigned long long) entry->size,
+      (long long) entry->mtime,
+      (long long) entry->ctime,
+      (unsigned long long) entry->inode,
+      it.name);
   }
 
+  SU_TRY(fclose(fp) == 0);
+  fp = NULL;
+
+  SU_TRY(rename(tmp_path, cache_path) == 0);
+
+  g_hash_cache_dirty = SU_FALSE;
+  ok = SU_TRUE;
+
 done:
+  if (!ok)
+    SU_WARNING("Cannot save plugin hash cache\n");
+
+  if (fp != NULL) {
+    fclose(fp);
+    unlink(tmp_path);
+  }
+
+  if (tmp_path != NULL)
+    free(tmp_path);
+}
+
+/* Thread-safe: no globals involved */
+SUPRIVATE SUBOOL
+suscan_plugin_compute_hash(const char *path, char *hash)
+{
+  uint8_t digest[SHA256_BLOCK_SIZE];
+  uint8_t *block = NULL;
+  SHA256_CTX ctx;
+  struct stat sbuf;
+  size_t got;
+  unsigned int i;
+  FILE *fp = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  /* Directories open fine, but fail on the first read */
+  if (stat(path, &sbuf) == -1 || !S_ISREG(sbuf.st_mode))
+    goto done;
+
+  if ((fp = fopen(path, "rb")) == NULL)
+    goto done;
+
+  SU_ALLOCATE_MANY(block, SUSCAN_PLUGIN_HASH_BLOCK_SIZE, uint8_t);
+
+  suscan_sha256_init(&ctx);
+
+  while ((got = fread(block, 1, SUSCAN_PLUGIN_HASH_BLOCK_SIZE, fp)) > 0)
+    suscan_sha256_update(&ctx, block, got);
+
+  if (ferror(fp)) {
+    SU_ERROR("sha256: cannot read `%s': %s\n", path, strerror(errno));
+    goto done;
+  }
+
+  suscan_sha256_final(&ctx, digest);
+
+  for (i = 0; i < SHA256_BLOCK_SIZE; ++i)
+    snprintf(hash + 2 * i, 3, "%02x", digest[i]);
+
+  ok = SU_TRUE;
+
+done:
+  if (block != NULL)
+    free(block);
+
   if (fp != NULL)
     fclose(fp);
 
-  if (buffer != NULL)
+  return ok;
+}
+
+/* Returns the cached hash of a file, if still valid */
+SUPRIVATE const char *
+suscan_plugin_hash_cache_lookup(
+  const char *path,
+  struct suscan_plugin_hash_cache_entry *stamp)
+{
+  const struct suscan_plugin_hash_cache_entry *entry;
+
+  memset(stamp, 0, sizeof(struct suscan_plugin_hash_cache_entry));
+
+  if (!suscan_plugin_hash_cache_stat(path, stamp))
+    return NULL;
+
+  if ((entry = hashlist_get(g_hash_cache, path)) == NULL)
+    return NULL;
+
+  if (!suscan_plugin_hash_cache_stamp_equal(entry, stamp))
+    return NULL;
+
+  return entry->hash;
+}
+
+SUPRIVATE SUBOOL
+suscan_plugin_hash_cache_update(
+  const char *path,
+  const struct suscan_plugin_hash_cache_entry *stamp,
+  const char *hash)
+{
+  struct suscan_plugin_hash_cache_entry *entry = NULL;
+  struct suscan_plugin_hash_cache_entry now;
+
+  /*
+   * The stamp was taken before hashing. If the file changed in the
+   * meantime, the hash may not match either version: do not cache it.
+   */
+  if (!suscan_plugin_hash_cache_stat(path, &now)
+    || !suscan_plugin_hash_cache_stamp_equal(stamp, &now))
+    return SU_TRUE;
+
+  SU_ALLOCATE_FAIL(entry, struct suscan_plugin_hash_cache_entry);
+
+  *entry = *stamp;
+  memcpy(entry->hash, hash, sizeof(entry->hash));
+
+  SU_TRY_FAIL(hashlist_set(g_hash_cache, path, entry));
+  g_hash_cache_dirty = SU_TRUE;
+
+  return SU_TRUE;
+
+fail:
+  if (entry != NULL)
+    free(entry);
+
+  return SU_FALSE;
+}
+
+SUPRIVATE SUBOOL
+suscan_plugin_set_file_hash(const char *path, const char *hash)
+{
+  char *buffer = NULL;
+
+  SU_TRYCATCH(buffer = strdup(hash), return SU_FALSE);
+
+  if (!hashlist_set(g_path_to_hash, path, buffer)) {
     free(buffer);
+    return SU_FALSE;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE const char *
+suscan_plugin_hash_file(const char *path)
+{
+  struct suscan_plugin_hash_cache_entry stamp;
+  const char *hash = NULL;
+  char buffer[2 * SHA256_BLOCK_SIZE + 1];
+
+  if ((hash = hashlist_get(g_path_to_hash, path)) == NULL) {
+    if ((hash = suscan_plugin_hash_cache_lookup(path, &stamp)) == NULL) {
+      if (!suscan_plugin_compute_hash(path, buffer))
+        goto done;
 
+      hash = buffer;
+      ++g_startup_stats.hashed;
+
+      if (!suscan_plugin_hash_cache_update(path, &stamp, hash))
+        SU_WARNING("%s: cannot cache plugin hash\n", path);
+    } else {
+      ++g_startup_stats.cached;
+    }
+
+    SU_TRYCATCH(suscan_plugin_set_file_hash(path, hash), return NULL);
+
+    hash = hashlist_get(g_path_to_hash, path);
+  }
+
+done:
   return hash;
 }
 
+/*
+ * Hashes all files not found in the cache in parallel. Only the
+ * hashing itself runs in the worker threads, every global is updated
+ * from the calling thread once they finish.
+ */
+SUPRIVATE void *
+suscan_plugin_hash_thread(void *userdata)
+{
+  struct suscan_plugin_hash_task *task = userdata;
+  unsigned int i;
+
+  for (i = task->first; i < task->job_count; i += task->stride)
+    task->job_list[i].ok = suscan_plugin_compute_hash(
+      task->job_list[i].path,
+      task->job_list[i].hash);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_plugin_hash_files(const char **paths, unsigned int count)
+{
+  struct suscan_plugin_hash_job *jobs = NULL;
+  struct suscan_plugin_hash_task *tasks = NULL;
+  struct suscan_plugin_hash_cache_entry stamp;
+  unsigned int i, job_count = 0, threads;
+  long cores;
+
+  SU_ALLOCATE_MANY(jobs, count, struct suscan_plugin_hash_job);
+
+  for (i = 0; i < count; ++i) {
+    if (hashlist_get(g_path_to_hash, paths[i]) != NULL)
+      continue;
+
+    if (suscan_plugin_hash_cache_lookup(paths[i], &stamp) != NULL) {
+      /* Fast path */
+      (void) suscan_plugin_hash_file(paths[i]);
+      continue;
+    }
+
+    jobs[job_count].path  = paths[i];
+    jobs[job_count].stamp = stamp;
+    ++job_count;
+  }
+
+  if (job_count == 0)
+    goto done;
+
+  cores   = sysconf(_SC_NPROCESSORS_ONLN);
+  threads = cores < 1 ? 1 : cores;
+  threads = SU_MIN(threads, SUSCAN_PLUGIN_HASH_MAX_THREADS);
+  threads = SU_MIN(threads, job_count);
+
+  SU_ALLOCATE_MANY(tasks, threads, struct suscan_plugin_hash_task);
+
+  for (i = 0; i < threads; ++i) {
+    tasks[i].job_list  = jobs;
+    tasks[i].job_count = job_count;
+    tasks[i].first     = i;
+    tasks[i].stride    = threads;
+
+    /* First task runs in the calling thread */
+    if (i > 0)
+      tasks[i].started = pthread_create(
+        &tasks[i].thread,
+        NULL,
+        suscan_plugin_hash_thread,
+        tasks + i) == 0;
+  }
+
+  suscan_plugin_hash_thread(tasks);
+
+  /* Tasks that failed to start are completed here */
+  for (i = 1; i < threads; ++i)
+    if (tasks[i].started)
+      pthread_join(tasks[i].thread, NULL);
+    else
+      suscan_plugin_hash_thread(tasks + i);
+
+  for (i = 0; i < job_count; ++i) {
+    if (!jobs[i].ok)
+      continue;
+
+    ++g_startup_stats.hashed;
+
+    if (!suscan_plugin_hash_cache_update(
+      jobs[i].path,
+      &jobs[i].stamp,
+      jobs[i].hash))
+      SU_WARNING("%s: cannot cache plugin hash\n", jobs[i].path);
+
+    if (!suscan_plugin_set_file_hash(jobs[i].path, jobs[i].hash))
+      SU_WARNING("%s: cannot register plugin hash\n", jobs[i].path);
+  }
+
+done:
+  if (tasks != NULL)
+    free(tasks);
+
+  if (jobs != NULL)
+    free(jobs);
+}
+
 SUPRIVATE const struct suscan_plugin_service_desc *
 suscan_plugin_service_desc_lookup(const char *name)
 {
@@ -478,44 +929,128 @@ done:
   return ok ? plugins : -1;
 }
 
-SUPRIVATE int
-suscan_plugin_load_all_iteration(void)
+SUPRIVATE SUFLOAT
+suscan_plugin_elapsed_ms(struct timeval *since)
 {
+  struct timeval now, diff;
+
+  gettimeofday(&now, NULL);
+  timersub(&now, since, &diff);
+  *since = now;
+
+  return diff.tv_sec * 1e3 + diff.tv_usec * 1e-3;
+}
+
+SUPRIVATE SUBOOL
+suscan_plugin_discover(struct strlist *candidates)
+{
+  DIR *dir = NULL;
+  char *full_path = NULL;
+  struct dirent *entry;
   unsigned int i;
-  int total_plugins = 0;
-  int ret;
   SUBOOL ok = SU_FALSE;
 
   for (i = 0; i < g_search_path_count; ++i) {
-    SU_TRYC(ret = suscan_plugin_load_from_dir(g_search_path_list[i]));
-    total_plugins += ret;
+    if ((dir = opendir(g_search_path_list[i])) == NULL)
+      continue;
+
+    while ((entry = readdir(dir)) != NULL) {
+      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        continue;
+
+      SU_TRY(
+        full_path = strbuild("%s/%s", g_search_path_list[i], entry->d_name));
+      SU_TRYC(strlist_append_string(candidates, full_path));
+
+      free(full_path);
+      full_path = NULL;
+    }
+
+    closedir(dir);
+    dir = NULL;
   }
 
   ok = SU_TRUE;
-  
+
 done:
-  return ok ? total_plugins : -1;
+  if (dir != NULL)
+    closedir(dir);
+
+  if (full_path != NULL)
+    free(full_path);
+
+  return ok;
 }
 
+/*
+ * Plugins are loaded in three phases: discovery (listing the search
+ * paths), hashing (in parallel, skipping files found in the hash cache)
+ * and loading. Loading is repeated until no new plugins show up, so
+ * plugins depending on others eventually find them.
+ */
 int
 suscan_plugin_load_all(void)
 {
+  struct strlist *candidates = NULL;
+  struct timeval tv;
+  int phase;
   int prev_plugins = 0;
   int total_plugins = 0;
   int iters = 0;
+  unsigned int i;
   SUBOOL ok = SU_FALSE;
 
+  SU_TRY(suscan_plugin_ensure_init());
+  SU_MAKE(candidates, strlist);
+
+  memset(&g_startup_stats, 0, sizeof(struct suscan_plugin_startup_stats));
+  gettimeofday(&tv, NULL);
+
+  phase = suscan_startup_phase_begin("plugin discovery");
+  SU_TRY(
+    suscan_startup_phase_end(phase, suscan_plugin_discover(candidates)));
+  g_startup_stats.discovery_ms = suscan_plugin_elapsed_ms(&tv);
+
+  phase = suscan_startup_phase_begin("plugin hashing");
+  suscan_plugin_hash_files(
+    (const char **) candidates->strings_list,
+    candidates->strings_count);
+  suscan_startup_phase_end(phase, SU_TRUE);
+  g_startup_stats.hashing_ms = suscan_plugin_elapsed_ms(&tv);
+
+  phase = suscan_startup_phase_begin("plugin loading");
   do {
     prev_plugins  = total_plugins;
-    SU_TRYC(total_plugins = suscan_plugin_load_all_iteration());
+    total_plugins = 0;
+
+    for (i = 0; i < candidates->strings_count; ++i)
+      if (candidates->strings_list[i] != NULL
+        && suscan_plugin_load(candidates->strings_list[i]))
+        ++total_plugins;
+
     ++iters;
   } while (total_plugins > prev_plugins);
+  suscan_startup_phase_end(phase, SU_TRUE);
+  g_startup_stats.loading_ms = suscan_plugin_elapsed_ms(&tv);
+
+  suscan_plugin_hash_cache_save();
   
   SU_INFO("%d plugins loaded (%d iterations)\n", total_plugins, iters);
+  SU_INFO(
+    "Plugin startup: discovery %.1f ms, hashing %.1f ms "
+    "(%u cached, %u hashed), loading %.1f ms\n",
+    g_startup_stats.discovery_ms,
+    g_startup_stats.hashing_ms,
+    g_startup_stats.cached,
+    g_startup_stats.hashed,
+    g_startup_stats.loading_ms);
 
   ok = SU_TRUE;
 
 done:
+  if (candidates != NULL)
+    strlist_destroy(candidates);
+
   return ok;
 }
 
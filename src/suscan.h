@@ -26,6 +26,7 @@ char *suscan_log_get_last_messages(struct timeval since, unsigned int max);
 SUBOOL suscan_sigutils_init(enum suscan_mode mode);
 
 SUBOOL suscan_init_sources(void);
+SUBOOL suscan_init_sources_ex(unsigned int flags);
 SUBOOL suscan_init_estimators(void);
 SUBOOL suscan_init_spectsrcs(void);
 SUBOOL suscan_init_inspectors(void);
@@ -21,10 +21,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <suscan.h>
 #include <cli/cli.h>
 #include <analyzer/version.h>
 #include <analyzer/device/facade.h>
+#include <util/startup.h>
 #ifdef __unix__
 #  include <signal.h>
 #endif /* __unix__ */
@@ -51,7 +53,10 @@ SUPRIVATE void
 help(const char *a0)
 {
   fprintf(stderr, "Usage:\n");
-  fprintf(stderr, "  %s command [param1=val [param2=val [...]]]\n\n", a0);
+  fprintf(
+      stderr,
+      "  %s [--startup-profile] command [param1=val [param2=val [...]]]\n\n",
+      a0);
 
   fprintf(
       stderr,
@@ -84,19 +89,28 @@ int
 main(int argc, const char *argv[], char *envp[])
 {
   int ret = EXIT_FAILURE;
+  int cmd = 1;
+  int phase;
+
+  if (argc > 1 && strcmp(argv[1], "--startup-profile") == 0) {
+    suscan_startup_profile_enable();
+    ++cmd;
+  }
 
-  if (argc < 2) {
+  if (argc < cmd + 1) {
     help(argv[0]);
     ret = EXIT_SUCCESS;
     goto done;
   }
 
-  if (!suscan_init(argv[0])) {
+  phase = suscan_startup_phase_begin("sigutils");
+  if (!suscan_startup_phase_end(phase, suscan_init(argv[0]))) {
     fprintf(stderr, "%s: required components could not be loaded\n", argv[0]);
     goto done;
   }
 
-  if (!suscli_init()) {
+  phase = suscan_startup_phase_begin("command line");
+  if (!suscan_startup_phase_end(phase, suscli_init())) {
     fprintf(stderr, "%s: Suscan command line failed to load\n", argv[0]);
     goto done;
   }
@@ -105,7 +119,7 @@ main(int argc, const char *argv[], char *envp[])
   signal(SIGINT, suscli_sigint_handler);
 #endif /* __unix__ */
 
-  if (suscli_run_command(argv[1], &argv[2]))
+  if (suscli_run_command(argv[cmd], &argv[cmd + 1]))
     ret = EXIT_SUCCESS;
 
 done:
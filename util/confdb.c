@@ -18,7 +18,9 @@
 */
 
 #include <string.h>
+#include <errno.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <sys/types.h>
 #include <sigutils/util/compat-mman.h>
@@ -30,12 +32,25 @@
 #include <sigutils/log.h>
 #include "confdb.h"
 #include "compat.h"
+#include "cbor.h"
+#include "startup.h"
+
+#define SUSCAN_CONFDB_SNAPSHOT_MAGIC   "suscan-confdb-snapshot"
+#define SUSCAN_CONFDB_SNAPSHOT_VERSION 2
+
+struct suscan_confdb_scan_task {
+  suscan_config_context_t *context;
+  pthread_t thread;
+  SUBOOL    started;
+  SUBOOL    ok;
+};
 
 PTR_LIST(SUPRIVATE suscan_config_context_t, context);
 
 SUPRIVATE const char *confdb_system_path;
 SUPRIVATE const char *confdb_local_path;
 SUPRIVATE const char *confdb_tle_path;
+SUPRIVATE const char *confdb_snapshot_path;
 
 #ifndef PKGDATADIR
 #  define PKGDATADIR ""
@@ -115,6 +130,31 @@ fail:
   return NULL;
 }
 
+const char *
+suscan_confdb_get_local_snapshot_path(void)
+{
+  const char *user_path;
+  char *tmp = NULL;
+
+  if (confdb_snapshot_path == NULL) {
+    SU_TRYCATCH(user_path = suscan_get_user_path(), goto fail);
+    SU_TRYCATCH(tmp = strbuild("%s/snapshots", user_path), goto fail);
+
+    if (access(tmp, F_OK) == -1)
+      SU_TRYCATCH(mkdir(tmp, 0700) != -1, goto fail);
+
+    confdb_snapshot_path = tmp;
+  }
+
+  return confdb_snapshot_path;
+
+fail:
+  if (tmp != NULL)
+    free(tmp);
+
+  return NULL;
+}
+
 SUPRIVATE void
 suscan_config_context_destroy(suscan_config_context_t *ctx)
 {
@@ -255,11 +295,302 @@ suscan_config_context_flush(suscan_config_context_t *context)
     SU_TRYCATCH(suscan_object_set_delete(context->list, i), return);
 }
 
+/* YAML files take precedence over XML files */
+SUPRIVATE char *
+suscan_config_context_get_source(
+  const suscan_config_context_t *context,
+  unsigned int index,
+  SUBOOL *xml)
+{
+  char *path = NULL;
+
+  *xml = SU_FALSE;
+  SU_TRYCATCH(
+      path = strbuild(
+        "%s/%s.yaml",
+        context->path_list[index],
+        context->save_file),
+      return NULL);
+
+  if (access(path, F_OK) == -1) {
+    free(path);
+    SU_TRYCATCH(
+        path = strbuild(
+          "%s/%s.xml",
+          context->path_list[index],
+          context->save_file),
+        return NULL);
+    *xml = SU_TRUE;
+  }
+
+  return path;
+}
+
+/*
+ * Binary snapshots
+ *
+ * Parsing YAML and XML is expensive, so the result of scanning a context
+ * is stored as CBOR in the local snapshot directory:
+ *
+ *   [magic, version, [[source, size, mtime, inode], ...], set]
+ *
+ * A snapshot is used only if the sources it was built from (one per
+ * search path, size 0 if missing) did not change. Modification times are
+ * in nanoseconds, as a source may be rewritten within the same second.
+ */
+SUINLINE int64_t
+suscan_config_context_get_mtime_ns(const struct stat *sbuf)
+{
+#if defined(__APPLE__)
+  return (int64_t) sbuf->st_mtimespec.tv_sec * 1000000000
+    + sbuf->st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  return (int64_t) sbuf->st_mtime * 1000000000;
+#else
+  return (int64_t) sbuf->st_mtim.tv_sec * 1000000000
+    + sbuf->st_mtim.tv_nsec;
+#endif /* defined(__APPLE__) */
+}
+
+SUPRIVATE SUBOOL
+suscan_config_context_pack_sources(
+  const suscan_config_context_t *context,
+  grow_buf_t *buffer)
+{
+  struct stat sbuf;
+  char *path = NULL;
+  unsigned int i;
+  SUBOOL xml;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(cbor_pack_array_start(buffer, context->path_count));
+
+  for (i = 0; i < context->path_count; ++i) {
+    SU_TRY(path = suscan_config_context_get_source(context, i, &xml));
+
+    if (stat(path, &sbuf) == -1)
+      memset(&sbuf, 0, sizeof(struct stat));
+
+    SU_TRYZ(cbor_pack_array_start(buffer, 4));
+    SU_TRYZ(cbor_pack_str(buffer, path));
+    SU_TRYZ(cbor_pack_uint(buffer, sbuf.st_size));
+    SU_TRYZ(cbor_pack_int(buffer, suscan_config_context_get_mtime_ns(&sbuf)));
+    SU_TRYZ(cbor_pack_uint(buffer, sbuf.st_ino));
+    SU_TRYZ(cbor_pack_array_end(buffer, 4));
+
+    free(path);
+    path = NULL;
+  }
+
+  SU_TRYZ(cbor_pack_array_end(buffer, context->path_count));
+
+  ok = SU_TRUE;
+
+done:
+  if (path != NULL)
+    free(path);
+
+  return ok;
+}
+
+SUPRIVATE char *
+suscan_config_context_get_snapshot_file(const suscan_config_context_t *context)
+{
+  const char *snapshot_path;
+
+  if ((snapshot_path = suscan_confdb_get_local_snapshot_path()) == NULL)
+    return NULL;
+
+  return strbuild("%s/%s.cbor", snapshot_path, context->name);
+}
+
+/* Called before the sources are modified */
+SUPRIVATE void
+suscan_config_context_drop_snapshot(const suscan_config_context_t *context)
+{
+  char *path;
+
+  if ((path = suscan_config_context_get_snapshot_file(context)) == NULL)
+    return;
+
+  if (unlink(path) == -1 && errno != ENOENT)
+    SU_WARNING("Cannot remove snapshot `%s': %s\n", path, strerror(errno));
+
+  free(path);
+}
+
+/* Objects from index `first` on are the ones that were just scanned */
+SUPRIVATE void
+suscan_config_context_save_snapshot(
+  const suscan_config_context_t *context,
+  unsigned int first)
+{
+  grow_buf_t buffer = grow_buf_INITIALIZER;
+  char *path = NULL;
+  char *tmp_path = NULL;
+  unsigned int i, count = 0;
+  int fd = -1;
+  size_t size;
+  SUBOOL ok = SU_FALSE;
+
+  for (i = first; i < context->list->object_count; ++i)
+    if (context->list->object_list[i] != NULL)
+      ++count;
+
+  SU_TRYZ(cbor_pack_array_start(&buffer, 4));
+  SU_TRYZ(cbor_pack_str(&buffer, SUSCAN_CONFDB_SNAPSHOT_MAGIC));
+  SU_TRYZ(cbor_pack_uint(&buffer, SUSCAN_CONFDB_SNAPSHOT_VERSION));
+  SU_TRY(suscan_config_context_pack_sources(context, &buffer));
+
+  /* Same encoding as suscan_object_to_cbor for a set */
+  SU_TRYZ(cbor_pack_array_start(&buffer, 4));
+  SU_TRYZ(cbor_pack_uint(&buffer, SUSCAN_OBJECT_TYPE_SET));
+  SU_TRYZ(cbor_pack_null(&buffer));
+  SU_TRYZ(cbor_pack_null(&buffer));
+  SU_TRYZ(cbor_pack_array_start(&buffer, count));
+
+  for (i = first; i < context->list->object_count; ++i)
+    if (context->list->object_list[i] != NULL)
+      SU_TRY(suscan_object_to_cbor(context->list->object_list[i], &buffer));
+
+  SU_TRYZ(cbor_pack_array_end(&buffer, count));
+  SU_TRYZ(cbor_pack_array_end(&buffer, 4));
+  SU_TRYZ(cbor_pack_array_end(&buffer, 4));
+
+  SU_TRY(path = suscan_config_context_get_snapshot_file(context));
+  SU_TRY(tmp_path = strbuild("%s.tmp", path));
+
+  SU_TRY((fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) != -1);
+
+  size = grow_buf_get_size(&buffer);
+  SU_TRY(write(fd, grow_buf_get_buffer(&buffer), size) == size);
+
+  close(fd);
+  fd = -1;
+
+  SU_TRY(rename(tmp_path, path) == 0);
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok)
+    SU_WARNING(
+        "Cannot save snapshot of configuration context `%s'\n",
+        context->name);
+
+  if (fd != -1) {
+    close(fd);
+    unlink(tmp_path);
+  }
+
+  if (tmp_path != NULL)
+    free(tmp_path);
+
+  if (path != NULL)
+    free(path);
+
+  grow_buf_finalize(&buffer);
+}
+
+SUPRIVATE SUBOOL
+suscan_config_context_load_snapshot(suscan_config_context_t *context)
+{
+  grow_buf_t buffer, sources = grow_buf_INITIALIZER;
+  suscan_object_t *set = NULL;
+  struct stat sbuf;
+  char *path = NULL;
+  char *magic = NULL;
+  void *stored_sources;
+  uint64_t nelem, version;
+  SUBOOL end_required;
+  unsigned int j;
+  int fd = -1;
+  void *mmap_base = (void *) -1;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(path = suscan_config_context_get_snapshot_file(context));
+
+  if (stat(path, &sbuf) == -1 || sbuf.st_size == 0)
+    goto done;
+
+  SU_TRY((fd = open(path, O_RDONLY)) != -1);
+  SU_TRY(
+      (mmap_base = mmap(
+          NULL,
+          sbuf.st_size,
+          PROT_READ,
+          MAP_PRIVATE,
+          fd,
+          0)) != (void *) -1);
+
+  grow_buf_init_loan(&buffer, mmap_base, sbuf.st_size, sbuf.st_size);
+
+  SU_TRYZ(cbor_unpack_array_start(&buffer, &nelem, &end_required));
+  SU_TRY(nelem == 4 && !end_required);
+  SU_TRYZ(cbor_unpack_str(&buffer, &magic));
+  SU_TRY(strcmp(magic, SUSCAN_CONFDB_SNAPSHOT_MAGIC) == 0);
+  SU_TRYZ(cbor_unpack_uint(&buffer, &version));
+
+  if (version != SUSCAN_CONFDB_SNAPSHOT_VERSION)
+    goto done;
+
+  /* Compare the stored source stamps with the current ones, byte-wise */
+  SU_TRY(suscan_config_context_pack_sources(context, &sources));
+
+  if (grow_buf_avail(&buffer) < grow_buf_get_size(&sources))
+    goto done;
+
+  stored_sources = grow_buf_current_data(&buffer);
+  if (memcmp(
+        stored_sources,
+        grow_buf_get_buffer(&sources),
+        grow_buf_get_size(&sources)) != 0)
+    goto done;
+
+  SU_TRY(
+      grow_buf_seek(
+        &buffer,
+        grow_buf_get_size(&sources),
+        SEEK_CUR) != -1);
+
+  SU_TRY(set = suscan_object_from_cbor(&buffer));
+  SU_TRY(set->type == SUSCAN_OBJECT_TYPE_SET);
+  SU_TRYZ(cbor_unpack_array_end(&buffer, end_required));
+
+  for (j = 0; j < set->object_count; ++j)
+    if (set->object_list[j] != NULL) {
+      SU_TRY(suscan_config_context_put(context, set->object_list[j]));
+      set->object_list[j] = NULL;
+    }
+
+  ok = SU_TRUE;
+
+done:
+  if (set != NULL)
+    suscan_object_destroy(set);
+
+  if (magic != NULL)
+    free(magic);
+
+  grow_buf_finalize(&sources);
+
+  if (mmap_base != (void *) -1)
+    munmap(mmap_base, sbuf.st_size);
+
+  if (fd != -1)
+    close(fd);
+
+  if (path != NULL)
+    free(path);
+
+  return ok;
+}
+
 SUBOOL
 suscan_config_context_scan(suscan_config_context_t *context)
 {
   char *path = NULL;
-  unsigned int i, j;
+  unsigned int i, j, first;
   int fd = -1;
   void *mmap_base = (void *) -1;
   suscan_object_t *set = NULL;
@@ -267,22 +598,15 @@ suscan_config_context_scan(suscan_config_context_t *context)
   SUBOOL xml;
   SUBOOL ok = SU_FALSE;
 
+  if (suscan_config_context_load_snapshot(context))
+    return SU_TRUE;
+
+  first = context->list->object_count;
+
   for (i = 0; i < context->path_count; ++i) {
-    /* Try to open as YAML */
-    xml = SU_FALSE;
     SU_TRYCATCH(
-        path = strbuild("%s/%s.yaml", context->path_list[i], context->save_file),
+        path = suscan_config_context_get_source(context, i, &xml),
         goto done);
-
-    if (access(path, F_OK) == -1) {
-      /* Nope, try to open as XML */
-      free(path);
-      SU_TRYCATCH(
-        path = strbuild("%s/%s.xml", context->path_list[i], context->save_file),
-        goto done);
-      xml = SU_TRUE;
-    }
-
     if (stat(path, &sbuf) != -1 && sbuf.st_size > 0) {
       SU_TRYCATCH((fd = open(path, O_RDONLY)) != -1, goto done);
 
@@ -327,9 +651,18 @@ suscan_config_context_scan(suscan_config_context_t *context)
     path = NULL;
   }
 
+  suscan_config_context_save_snapshot(context, first);
+
   ok = SU_TRUE;
 
 done:
+  /* Leave the context as it was, so it can be scanned again */
+  if (!ok) {
+    for (j = first; j < context->list->object_count; ++j)
+      (void) suscan_object_set_delete(context->list, j);
+    context->list->object_count = first;
+  }
+
   if (set != NULL)
     suscan_object_destroy(set);
 
@@ -376,6 +709,12 @@ suscan_config_context_save(suscan_config_context_t *context)
 
   SU_TRYCATCH(suscan_object_to_yaml(context->list, &data, &size), goto done);
 
+  /*
+   * The source is rewritten in place, and it may keep its size and inode.
+   * Make sure the next scan does not trust the old snapshot.
+   */
+  suscan_config_context_drop_snapshot(context);
+
   for (i = 0; i < context->path_count; ++i) {
     SU_TRYCATCH(
         path = strbuild("%s/%s.yaml", context->path_list[i], context->save_file),
@@ -446,23 +785,112 @@ suscan_confdb_save_all(void)
   return any_ok;
 }
 
+SUPRIVATE void *
+suscan_confdb_scan_thread(void *userdata)
+{
+  struct suscan_confdb_scan_task *task = userdata;
+  int phase = suscan_startup_phase_begin(task->context->name);
+
+  task->ok = suscan_startup_phase_end(
+    phase,
+    suscan_config_context_scan(task->context));
+
+  if (!task->ok)
+    SU_ERROR(
+      "Failed to scan configuration context `%s'\n",
+      task->context->name);
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscan_confdb_scan_task_find(
+  const struct suscan_confdb_scan_task *task_list,
+  unsigned int task_count,
+  const suscan_config_context_t *ctx)
+{
+  unsigned int i;
+
+  for (i = 0; i < task_count; ++i)
+    if (task_list[i].context == ctx)
+      return SU_TRUE;
+
+  return SU_FALSE;
+}
+
+/*
+ * Contexts are registered and their paths resolved in the calling
+ * thread. Scanning (the expensive part) happens in parallel, one
+ * thread per context. Contexts already in use are not scanned again.
+ */
 SUBOOL
-suscan_confdb_use(const char *name)
+suscan_confdb_use_many(const char *const *names, unsigned int count)
 {
+  struct suscan_confdb_scan_task *task_list = NULL;
   suscan_config_context_t *ctx = NULL;
+  unsigned int i, task_count = 0;
+  SUBOOL ok = SU_FALSE;
 
-  SU_TRYCATCH(ctx = suscan_config_context_assert(name), return SU_FALSE);
+  if (count == 0)
+    return SU_TRUE;
 
-  SU_TRYCATCH(
-      suscan_config_context_add_path(ctx, suscan_confdb_get_local_path()),
-      return SU_FALSE);
+  SU_ALLOCATE_MANY(task_list, count, struct suscan_confdb_scan_task);
 
-  SU_TRYCATCH(
-      suscan_config_context_add_path(ctx, suscan_confdb_get_system_path()),
-      return SU_FALSE);
+  /* Scan threads read this path, make sure it is already there */
+  (void) suscan_confdb_get_local_snapshot_path();
 
-  SU_TRYCATCH(suscan_config_context_scan(ctx), return SU_FALSE);
+  /* libxml2 initializes itself lazily, which is not thread-safe */
+  SU_TRY(suscan_object_xml_init());
 
-  return SU_TRUE;
+  for (i = 0; i < count; ++i) {
+    SU_TRY(ctx = suscan_config_context_assert(names[i]));
+
+    if (ctx->used || suscan_confdb_scan_task_find(task_list, task_count, ctx))
+      continue;
+
+    /* Contexts that failed to scan keep their paths */
+    if (ctx->path_count == 0) {
+      SU_TRY(
+        suscan_config_context_add_path(ctx, suscan_confdb_get_local_path()));
+      SU_TRY(
+        suscan_config_context_add_path(ctx, suscan_confdb_get_system_path()));
+    }
+
+    task_list[task_count++].context = ctx;
+  }
+
+  /* The first context is scanned in this thread */
+  for (i = 1; i < task_count; ++i)
+    task_list[i].started = pthread_create(
+      &task_list[i].thread,
+      NULL,
+      suscan_confdb_scan_thread,
+      task_list + i) == 0;
+
+  ok = SU_TRUE;
+
+  for (i = 0; i < task_count; ++i) {
+    if (task_list[i].started)
+      pthread_join(task_list[i].thread, NULL);
+    else
+      suscan_confdb_scan_thread(task_list + i);
+
+    /* Failed contexts are scanned again the next time they are used */
+    if (task_list[i].ok)
+      task_list[i].context->used = SU_TRUE;
+
+    ok = task_list[i].ok && ok;
+  }
+
+done:
+  if (task_list != NULL)
+    free(task_list);
+
+  return ok;
 }
 
+SUBOOL
+suscan_confdb_use(const char *name)
+{
+  return suscan_confdb_use_many(&name, 1);
+}
@@ -32,6 +32,7 @@ extern "C" {
 const char *suscan_confdb_get_system_path(void);
 const char *suscan_confdb_get_local_path(void);
 const char *suscan_confdb_get_local_tle_path(void);
+const char *suscan_confdb_get_local_snapshot_path(void);
 
 struct suscan_config_context {
   char *name;
@@ -41,6 +42,7 @@ struct suscan_config_context {
   PTR_LIST(char, path);
 
   suscan_object_t *list;
+  SUBOOL used; /* Paths added and scanned by suscan_confdb_use */
 
   void *userdata;
   SUBOOL (*on_save) (struct suscan_config_context *ctx, void *userdata);
@@ -98,6 +100,7 @@ SUBOOL suscan_confdb_scan_all(void);
 SUBOOL suscan_confdb_save_all(void);
 
 SUBOOL suscan_confdb_use(const char *name);
+SUBOOL suscan_confdb_use_many(const char *const *names, unsigned int count);
 
 #ifdef __cplusplus
 }
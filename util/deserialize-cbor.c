@@ -0,0 +1,103 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <string.h>
+
+#define SU_LOG_DOMAIN "object-cbor"
+
+#include <sigutils/log.h>
+#include "object.h"
+#include "cbor.h"
+
+SUPRIVATE SUBOOL
+suscan_object_unpack_nullable_str(grow_buf_t *buffer, char **str)
+{
+  enum cbor_major_type type;
+  uint8_t extra;
+
+  if (cbor_peek_type(buffer, &type, &extra) != 0)
+    return SU_FALSE;
+
+  if (type == CMT_FLOAT && extra == CBOR_ADDL_FLOAT_NULL) {
+    *str = NULL;
+    return cbor_unpack_null(buffer) == 0;
+  }
+
+  return cbor_unpack_str(buffer, str) == 0;
+}
+
+suscan_object_t *
+suscan_object_from_cbor(grow_buf_t *buffer)
+{
+  suscan_object_t *new = NULL;
+  suscan_object_t *child = NULL;
+  uint64_t type, i, nelem, nchildren;
+  SUBOOL end_required, children_end_required;
+
+  SU_TRYZ_FAIL(cbor_unpack_array_start(buffer, &nelem, &end_required));
+  SU_TRY_FAIL(nelem == 4 && !end_required);
+
+  SU_TRYZ_FAIL(cbor_unpack_uint(buffer, &type));
+  SU_TRY_FAIL(
+    type == SUSCAN_OBJECT_TYPE_OBJECT
+    || type == SUSCAN_OBJECT_TYPE_SET
+    || type == SUSCAN_OBJECT_TYPE_FIELD);
+
+  SU_MAKE_FAIL(new, suscan_object, type);
+
+  /* Strings are handed over to the object, no copies */
+  SU_TRY_FAIL(suscan_object_unpack_nullable_str(buffer, &new->name));
+  SU_TRY_FAIL(suscan_object_unpack_nullable_str(buffer, &new->class_name));
+
+  if (type == SUSCAN_OBJECT_TYPE_FIELD) {
+    SU_TRY_FAIL(suscan_object_unpack_nullable_str(buffer, &new->value));
+  } else {
+    SU_TRYZ_FAIL(
+      cbor_unpack_array_start(buffer, &nchildren, &children_end_required));
+    SU_TRY_FAIL(!children_end_required);
+
+    for (i = 0; i < nchildren; ++i) {
+      SU_TRY_FAIL(child = suscan_object_from_cbor(buffer));
+
+      if (type == SUSCAN_OBJECT_TYPE_SET) {
+        SU_TRY_FAIL(suscan_object_set_append(new, child));
+      } else {
+        SU_TRY_FAIL(child->name != NULL);
+        SU_TRY_FAIL(suscan_object_set_field(new, child->name, child));
+      }
+
+      child = NULL;
+    }
+
+    SU_TRYZ_FAIL(cbor_unpack_array_end(buffer, children_end_required));
+  }
+
+  SU_TRYZ_FAIL(cbor_unpack_array_end(buffer, end_required));
+
+  return new;
+
+fail:
+  if (child != NULL)
+    suscan_object_destroy(child);
+
+  if (new != NULL)
+    suscan_object_destroy(new);
+
+  return NULL;
+}
@@ -169,6 +169,8 @@ suscan_object_xml_init(void)
 {
   LIBXML_TEST_VERSION;
 
+  xmlInitParser();
+
   return SU_TRUE;
 }
 
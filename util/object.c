@@ -25,6 +25,81 @@
 #include "object.h"
 #include <inttypes.h>
 
+/************************** Field name index *********************************/
+SUPRIVATE uint32_t
+suscan_object_hash_name(const char *name)
+{
+  uint32_t hash = 2166136261u; /* FNV-1a */
+
+  while (*name != '\0') {
+    hash ^= (uint8_t) *name++;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+SUPRIVATE void
+suscan_object_index_insert(suscan_object_t *object, unsigned int pos)
+{
+  unsigned int mask = object->field_index_size - 1;
+  unsigned int i;
+
+  i = suscan_object_hash_name(object->field_list[pos]->name) & mask;
+
+  while (object->field_index[i] != 0)
+    i = (i + 1) & mask;
+
+  object->field_index[i] = pos + 1;
+}
+
+/*
+ * The index is just an accelerator: if it cannot be allocated, lookups
+ * fall back to linear search.
+ */
+SUPRIVATE void
+suscan_object_index_rebuild(suscan_object_t *object)
+{
+  unsigned int size = 32;
+  unsigned int i;
+
+  if (object->field_index != NULL) {
+    free(object->field_index);
+    object->field_index      = NULL;
+    object->field_index_size = 0;
+  }
+
+  if (object->field_count < SUSCAN_OBJECT_INDEX_THRESHOLD)
+    return;
+
+  /* Keep the load factor below 1/2 */
+  while (size < 2 * object->field_count)
+    size <<= 1;
+
+  if ((object->field_index = calloc(size, sizeof(unsigned int))) == NULL)
+    return;
+
+  object->field_index_size = size;
+
+  for (i = 0; i < object->field_count; ++i)
+    if (object->field_list[i] != NULL)
+      suscan_object_index_insert(object, i);
+}
+
+/*
+ * Called after appending a field. Appending may reuse a slot left by
+ * a removed field, so this is not necessarily the last one.
+ */
+SUPRIVATE void
+suscan_object_index_append(suscan_object_t *object, unsigned int slot)
+{
+  if (object->field_index == NULL
+    || 2 * object->field_count > object->field_index_size)
+    suscan_object_index_rebuild(object);
+  else
+    suscan_object_index_insert(object, slot);
+}
+
 void
 suscan_object_destroy(suscan_object_t *obj)
 {
@@ -39,6 +114,9 @@ suscan_object_destroy(suscan_object_t *obj)
       if (obj->field_list != NULL)
         free(obj->field_list);
 
+      if (obj->field_index != NULL)
+        free(obj->field_index);
+
       break;
 
     case SUSCAN_OBJECT_TYPE_SET:
@@ -110,6 +188,8 @@ suscan_object_copy(const suscan_object_t *object)
         SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(new->field, dup));
         dup = NULL;
       }
+
+      suscan_object_index_rebuild(new);
     break;
 
     case SUSCAN_OBJECT_TYPE_SET:
@@ -198,8 +278,23 @@ suscan_object_lookup(const suscan_object_t *object, const char *name)
 {
   unsigned int i;
 
+  unsigned int mask, pos;
+
   SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_OBJECT, return NULL);
 
+  if (object->field_index != NULL) {
+    mask = object->field_index_size - 1;
+    i    = suscan_object_hash_name(name) & mask;
+
+    while ((pos = object->field_index[i]) != 0) {
+      if (strcmp(object->field_list[pos - 1]->name, name) == 0)
+        return object->field_list + pos - 1;
+      i = (i + 1) & mask;
+    }
+
+    return NULL;
+  }
+
   for (i = 0; i < object->field_count; ++i)
     if (object->field_list[i] != NULL)
       if (strcmp(object->field_list[i]->name, name) == 0)
@@ -215,6 +310,7 @@ suscan_object_set_field(
     suscan_object_t *new)
 {
   suscan_object_t **entry = NULL;
+  int slot;
 
   SU_TRYCATCH(object->type == SUSCAN_OBJECT_TYPE_OBJECT, return SU_FALSE);
 
@@ -227,11 +323,17 @@ suscan_object_set_field(
     if (*entry != new) {
       suscan_object_destroy(*entry);
       *entry = new;
+
+      /* Removed fields must leave the index */
+      if (new == NULL && object->field_index != NULL)
+        suscan_object_index_rebuild(object);
     }
   } else if (new != NULL) {
     SU_TRYCATCH(
-        PTR_LIST_APPEND_CHECK(object->field, new) != -1,
+        (slot = PTR_LIST_APPEND_CHECK(object->field, new)) != -1,
         return SU_FALSE);
+
+    suscan_object_index_append(object, slot);
   }
 
   return SU_TRUE;
@@ -269,6 +371,8 @@ suscan_object_clear_fields(suscan_object_t *object)
   object->field_list = NULL;
   object->field_count = 0;
 
+  suscan_object_index_rebuild(object);
+
   return SU_TRUE;
 }
 
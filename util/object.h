@@ -29,6 +29,9 @@ extern "C" {
 
 #define SUSCAN_YAML_PFX "tag:actinid.org,2022:suscan:"
 
+/* Objects with at least this many fields get a field name index */
+#define SUSCAN_OBJECT_INDEX_THRESHOLD 16
+
 enum suscan_object_type {
   SUSCAN_OBJECT_TYPE_OBJECT,
   SUSCAN_OBJECT_TYPE_SET,
@@ -45,6 +48,10 @@ struct suscan_object {
     char *value;
     struct {
       PTR_LIST(struct suscan_object, field);
+
+      /* Open addressing table of field positions + 1 (0 = empty) */
+      unsigned int *field_index;
+      unsigned int  field_index_size;
     };
     struct {
       PTR_LIST(struct suscan_object, object);
@@ -54,6 +61,9 @@ struct suscan_object {
 
 typedef struct suscan_object suscan_object_t;
 
+/* Must be called once before parsing XML from more than one thread */
+SUBOOL suscan_object_xml_init(void);
+
 suscan_object_t *suscan_object_from_xml(
     const char *url,
     const void *data,
@@ -73,6 +83,12 @@ SUBOOL suscan_object_to_yaml(
     void **data,
     size_t *size);
 
+suscan_object_t *suscan_object_from_cbor(grow_buf_t *buffer);
+
+SUBOOL suscan_object_to_cbor(
+    const suscan_object_t *object,
+    grow_buf_t *buffer);
+
 suscan_object_t *suscan_object_new(enum suscan_object_type type);
 
 suscan_object_t *suscan_object_copy(const suscan_object_t *object);
@@ -0,0 +1,697 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "pass-index"
+
+#include <sigutils/log.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "passidx.h"
+#include "confdb.h"
+
+/* Orbits propagated at once. Bounds the size of the batch buffers. */
+#define SUSCAN_PASS_INDEX_BATCH_SIZE 64
+
+/*
+ * On-disk layout (native endianness, this is a local cache):
+ *
+ *   header
+ *   sat_count x (sat record, name)
+ *   pass_count x struct suscan_pass
+ */
+struct suscan_pass_index_header {
+  uint32_t magic;
+  uint32_t version;
+  SUDOUBLE lat;
+  SUDOUBLE lon;
+  SUDOUBLE height;
+  SUDOUBLE minel;
+  SUDOUBLE step;
+  SUDOUBLE max_duration;
+  uint32_t sat_count;
+  uint32_t name_size;   /* Total size of the satellite names */
+  uint64_t pass_count;
+};
+
+struct suscan_pass_index_sat_record {
+  int32_t  satno;
+  uint32_t name_len;
+  uint8_t  hash[SHA256_BLOCK_SIZE];
+  SUDOUBLE horizon;
+};
+
+/*************************** Satellite bookkeeping ****************************/
+SUPRIVATE void
+suscan_pass_sat_destroy(struct suscan_pass_sat *self)
+{
+  if (self->name != NULL)
+    free(self->name);
+
+  free(self);
+}
+
+SUPRIVATE void
+suscan_pass_index_hash_orbit(const orbit_t *orbit, uint8_t *hash)
+{
+  SHA256_CTX ctx;
+
+#define HASH_FIELD(field) \
+  suscan_sha256_update(&ctx, (const uint8_t *) &orbit->field, sizeof(orbit->field))
+
+  suscan_sha256_init(&ctx);
+
+  HASH_FIELD(satno);
+  HASH_FIELD(ep_year);
+  HASH_FIELD(ep_day);
+  HASH_FIELD(rev);
+  HASH_FIELD(drevdt);
+  HASH_FIELD(d2revdt2);
+  HASH_FIELD(bstar);
+  HASH_FIELD(eqinc);
+  HASH_FIELD(ecc);
+  HASH_FIELD(mnan);
+  HASH_FIELD(argp);
+  HASH_FIELD(ascn);
+
+#undef HASH_FIELD
+
+  suscan_sha256_final(&ctx, hash);
+}
+
+SUPRIVATE
+SU_METHOD(suscan_pass_index, struct suscan_pass_sat *, assert_sat,
+  const orbit_t *orbit,
+  uint32_t *index)
+{
+  struct suscan_pass_sat *sat = NULL;
+  const char *name = orbit->name == NULL ? "" : orbit->name;
+  unsigned int i;
+  int ndx;
+
+  for (i = 0; i < self->sat_count; ++i)
+    if (self->sat_list[i]->satno == orbit->satno
+      && strcmp(self->sat_list[i]->name, name) == 0) {
+      *index = i;
+      return self->sat_list[i];
+    }
+
+  SU_ALLOCATE_FAIL(sat, struct suscan_pass_sat);
+  SU_TRY_FAIL(sat->name = strdup(name));
+
+  sat->satno   = orbit->satno;
+  sat->horizon = -INFINITY;
+
+  SU_TRYC_FAIL(ndx = PTR_LIST_APPEND_CHECK(self->sat, sat));
+  *index = ndx;
+
+  return sat;
+
+fail:
+  if (sat != NULL)
+    suscan_pass_sat_destroy(sat);
+
+  return NULL;
+}
+
+/* Drops passes of a satellite, or old passes of all of them */
+SUPRIVATE
+SU_METHOD(suscan_pass_index, void, drop_passes, int32_t sat, SUDOUBLE before)
+{
+  SUSCOUNT i, p = 0;
+
+  for (i = 0; i < self->pass_count; ++i) {
+    if (sat >= 0 && self->pass_list[i].sat == (uint32_t) sat)
+      continue;
+
+    if (self->pass_list[i].los < before)
+      continue;
+
+    if (p != i)
+      self->pass_list[p] = self->pass_list[i];
+    ++p;
+  }
+
+  if (p != self->pass_count) {
+    self->pass_count = p;
+    self->dirty      = SU_TRUE;
+  }
+}
+
+SUPRIVATE
+SU_METHOD(suscan_pass_index, SUBOOL, push_pass, const struct suscan_pass *pass)
+{
+  struct suscan_pass *tmp;
+  SUSCOUNT new_alloc;
+
+  if (self->pass_count == self->pass_alloc) {
+    new_alloc = self->pass_alloc == 0 ? 64 : 2 * self->pass_alloc;
+
+    SU_TRYCATCH(
+      tmp = realloc(self->pass_list, new_alloc * sizeof(struct suscan_pass)),
+      return SU_FALSE);
+
+    self->pass_list  = tmp;
+    self->pass_alloc = new_alloc;
+  }
+
+  self->pass_list[self->pass_count++] = *pass;
+
+  if (pass->los - pass->aos > self->max_duration)
+    self->max_duration = pass->los - pass->aos;
+
+  self->dirty = SU_TRUE;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE int
+suscan_pass_index_cmp(const void *a, const void *b)
+{
+  const struct suscan_pass *pa = a, *pb = b;
+
+  if (pa->aos < pb->aos)
+    return -1;
+  else if (pa->aos > pb->aos)
+    return 1;
+
+  return (pa->sat > pb->sat) - (pa->sat < pb->sat);
+}
+
+/*********************************** Storage **********************************/
+SUPRIVATE
+SU_METHOD(suscan_pass_index, SUBOOL, load)
+{
+  struct suscan_pass_index_header header;
+  struct suscan_pass_index_sat_record record;
+  struct suscan_pass_sat *sat = NULL;
+  FILE *fp = NULL;
+  uint32_t i;
+  SUBOOL ok = SU_FALSE;
+
+  if ((fp = fopen(self->path, "rb")) == NULL) {
+    /* No index yet */
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  if (fread(&header, sizeof(header), 1, fp) < 1
+    || header.magic != SUSCAN_PASS_INDEX_MAGIC
+    || header.version != SUSCAN_PASS_INDEX_VERSION) {
+    SU_WARNING("%s: not a pass index, ignored\n", self->path);
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  if (header.lat != self->site.lat
+    || header.lon != self->site.lon
+    || header.height != self->site.height
+    || header.minel != self->minel
+    || header.step != self->step) {
+    SU_INFO("%s: index parameters changed, rebuilding\n", self->path);
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  for (i = 0; i < header.sat_count; ++i) {
+    SU_TRY(fread(&record, sizeof(record), 1, fp) == 1);
+    SU_TRY(record.name_len <= header.name_size);
+    SU_ALLOCATE(sat, struct suscan_pass_sat);
+    SU_ALLOCATE_MANY(sat->name, record.name_len + 1, char);
+    SU_TRY(record.name_len == 0 || fread(sat->name, record.name_len, 1, fp) == 1);
+
+    sat->satno   = record.satno;
+    sat->horizon = record.horizon;
+    memcpy(sat->hash, record.hash, SHA256_BLOCK_SIZE);
+
+    SU_TRYC(PTR_LIST_APPEND_CHECK(self->sat, sat));
+    sat = NULL;
+  }
+
+  if (header.pass_count > 0) {
+    SU_ALLOCATE_MANY(self->pass_list, header.pass_count, struct suscan_pass);
+    self->pass_alloc = header.pass_count;
+
+    SU_TRY(
+      fread(
+        self->pass_list,
+        sizeof(struct suscan_pass),
+        header.pass_count,
+        fp) == header.pass_count);
+
+    self->pass_count = header.pass_count;
+  }
+
+  for (i = 0; i < self->pass_count; ++i)
+    SU_TRY(self->pass_list[i].sat < self->sat_count);
+
+  self->max_duration = header.max_duration;
+
+  ok = SU_TRUE;
+
+done:
+  if (sat != NULL)
+    suscan_pass_sat_destroy(sat);
+
+  if (!ok) {
+    SU_WARNING("%s: truncated pass index, rebuilding\n", self->path);
+
+    for (i = 0; i < self->sat_count; ++i)
+      suscan_pass_sat_destroy(self->sat_list[i]);
+    if (self->sat_list != NULL)
+      free(self->sat_list);
+    self->sat_list  = NULL;
+    self->sat_count = 0;
+
+    self->pass_count   = 0;
+    self->max_duration = 0;
+    ok = SU_TRUE;
+  }
+
+  if (fp != NULL)
+    fclose(fp);
+
+  return ok;
+}
+
+SU_METHOD(suscan_pass_index, SUBOOL, save)
+{
+  struct suscan_pass_index_header header;
+  struct suscan_pass_index_sat_record record;
+  char *tmp_path = NULL;
+  FILE *fp = NULL;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  if (!self->dirty) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  memset(&header, 0, sizeof(header));
+
+  header.magic        = SUSCAN_PASS_INDEX_MAGIC;
+  header.version      = SUSCAN_PASS_INDEX_VERSION;
+  header.lat          = self->site.lat;
+  header.lon          = self->site.lon;
+  header.height       = self->site.height;
+  header.minel        = self->minel;
+  header.step         = self->step;
+  header.max_duration = self->max_duration;
+  header.sat_count    = self->sat_count;
+  header.pass_count   = self->pass_count;
+
+  for (i = 0; i < self->sat_count; ++i)
+    header.name_size += strlen(self->sat_list[i]->name);
+
+  /* Write aside and rename, so readers never see a partial index */
+  SU_TRY(tmp_path = strbuild("%s.tmp", self->path));
+
+  if ((fp = fopen(tmp_path, "wb")) == NULL) {
+    SU_ERROR("Cannot open `%s' for writing: %s\n", tmp_path, strerror(errno));
+    goto done;
+  }
+
+  SU_TRY(fwrite(&header, sizeof(header), 1, fp) == 1);
+
+  for (i = 0; i < self->sat_count; ++i) {
+    memset(&record, 0, sizeof(record));
+
+    record.satno    = self->sat_list[i]->satno;
+    record.name_len = strlen(self->sat_list[i]->name);
+    record.horizon  = self->sat_list[i]->horizon;
+    memcpy(record.hash, self->sat_list[i]->hash, SHA256_BLOCK_SIZE);
+
+    SU_TRY(fwrite(&record, sizeof(record), 1, fp) == 1);
+    if (record.name_len > 0)
+      SU_TRY(
+        fwrite(self->sat_list[i]->name, record.name_len, 1, fp) == 1);
+  }
+
+  if (self->pass_count > 0)
+    SU_TRY(
+      fwrite(
+        self->pass_list,
+        sizeof(struct suscan_pass),
+        self->pass_count,
+        fp) == self->pass_count);
+
+  SU_TRY(fclose(fp) == 0);
+  fp = NULL;
+
+  if (rename(tmp_path, self->path) == -1) {
+    SU_ERROR("Cannot rename `%s': %s\n", tmp_path, strerror(errno));
+    goto done;
+  }
+
+  self->dirty = SU_FALSE;
+
+  ok = SU_TRUE;
+
+done:
+  if (fp != NULL) {
+    fclose(fp);
+    unlink(tmp_path);
+  }
+
+  if (tmp_path != NULL)
+    free(tmp_path);
+
+  return ok;
+}
+
+/********************************* Propagation ********************************/
+SUPRIVATE
+SU_METHOD(suscan_pass_index, SUBOOL, extract_passes,
+  const sgdp4_batch_t *batch,
+  unsigned int orbit,
+  struct suscan_pass_sat *sat,
+  uint32_t sat_index,
+  SUDOUBLE start)
+{
+  const SUDOUBLE *el = sgdp4_batch_get_elevation(batch, orbit);
+  const SUDOUBLE *rr = sgdp4_batch_get_range_rate(batch, orbit);
+  struct suscan_pass pass;
+  SUDOUBLE maxel = 0, frac;
+  SUBOOL in_pass = SU_FALSE;
+  unsigned int i, i0, last_below;
+
+  /* Grids are aligned to the step, so are starts and horizons */
+  i0 = (unsigned int) round((start - batch->t0) / batch->step);
+  if (i0 >= batch->time_count)
+    i0 = batch->time_count - 1;
+
+  last_below = i0;
+
+  memset(&pass, 0, sizeof(struct suscan_pass));
+  pass.sat = sat_index;
+
+  for (i = i0; i < batch->time_count; ++i) {
+    if (el[i] >= self->minel) {
+      if (!in_pass) {
+        in_pass = SU_TRUE;
+
+        /* Passes in progress at a fresh start are truncated */
+        if (i > i0) {
+          frac     = (self->minel - el[i - 1]) / (el[i] - el[i - 1]);
+          pass.aos = sgdp4_batch_get_time(batch, i - 1) + frac * batch->step;
+        } else {
+          pass.aos = sgdp4_batch_get_time(batch, i);
+        }
+
+        maxel               = -INFINITY;
+        pass.min_range_rate = +INFINITY;
+        pass.max_range_rate = -INFINITY;
+      }
+
+      if (el[i] > maxel) {
+        maxel    = el[i];
+        pass.tca = sgdp4_batch_get_time(batch, i);
+      }
+
+      if (rr[i] < pass.min_range_rate)
+        pass.min_range_rate = rr[i];
+      if (rr[i] > pass.max_range_rate)
+        pass.max_range_rate = rr[i];
+    } else {
+      if (in_pass) {
+        in_pass     = SU_FALSE;
+        frac        = (self->minel - el[i - 1]) / (el[i] - el[i - 1]);
+        pass.los    = sgdp4_batch_get_time(batch, i - 1) + frac * batch->step;
+        pass.max_el = maxel;
+
+        SU_TRY_FAIL(suscan_pass_index_push_pass(self, &pass));
+      }
+
+      last_below = i;
+    }
+  }
+
+  if (in_pass && el[last_below] >= self->minel) {
+    /*
+     * Never below the horizon: permanently visible objects are
+     * reported as back-to-back passes covering each update window.
+     */
+    pass.los     = sgdp4_batch_get_time(batch, batch->time_count - 1);
+    pass.max_el  = maxel;
+    sat->horizon = pass.los;
+
+    SU_TRY_FAIL(suscan_pass_index_push_pass(self, &pass));
+  } else {
+    /* The pass in progress (if any) is computed in the next update */
+    sat->horizon = in_pass
+      ? sgdp4_batch_get_time(batch, last_below)
+      : sgdp4_batch_get_time(batch, batch->time_count - 1);
+  }
+
+  self->dirty = SU_TRUE;
+
+  return SU_TRUE;
+
+fail:
+  return SU_FALSE;
+}
+
+SUPRIVATE
+SU_METHOD(suscan_pass_index, SUBOOL, propagate,
+  const orbit_t *orbits,
+  const uint32_t *sat_indices,
+  const SUDOUBLE *starts,
+  unsigned int count,
+  SUDOUBLE to)
+{
+  sgdp4_batch_t batch = sgdp4_batch_INITIALIZER;
+  struct timeval tv;
+  SUDOUBLE t0 = INFINITY;
+  unsigned int i, time_count;
+  SUBOOL batch_init = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  for (i = 0; i < count; ++i)
+    if (starts[i] < t0)
+      t0 = starts[i];
+
+  t0 = floor(t0 / self->step) * self->step;
+
+  time_count = (unsigned int) ceil((to - t0) / self->step) + 1;
+  if (time_count < 2)
+    time_count = 2;
+
+  tv.tv_sec  = (time_t) floor(t0);
+  tv.tv_usec = (long) ((t0 - tv.tv_sec) * 1e6);
+
+  SU_TRY(sgdp4_batch_init(&batch, orbits, count, &self->site));
+  batch_init = SU_TRUE;
+
+  SU_TRY(sgdp4_batch_set_times(&batch, &tv, self->step, time_count));
+  SU_TRY(sgdp4_batch_compute(&batch, 0));
+
+  for (i = 0; i < count; ++i) {
+    if (!batch.valid[i]) {
+      SU_WARNING(
+        "%s: propagation failed, passes not indexed\n",
+        self->sat_list[sat_indices[i]]->name);
+      continue;
+    }
+
+    SU_TRY(
+      suscan_pass_index_extract_passes(
+        self,
+        &batch,
+        i,
+        self->sat_list[sat_indices[i]],
+        sat_indices[i],
+        starts[i]));
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (batch_init)
+    sgdp4_batch_finalize(&batch);
+
+  return ok;
+}
+
+SU_METHOD(
+  suscan_pass_index,
+  SUBOOL,
+  update,
+  const orbit_t *orbits,
+  unsigned int count,
+  SUDOUBLE from,
+  SUDOUBLE to)
+{
+  orbit_t  pending[SUSCAN_PASS_INDEX_BATCH_SIZE];
+  uint32_t indices[SUSCAN_PASS_INDEX_BATCH_SIZE];
+  SUDOUBLE starts[SUSCAN_PASS_INDEX_BATCH_SIZE];
+  uint8_t hash[SHA256_BLOCK_SIZE];
+  struct suscan_pass_sat *sat;
+  unsigned int i, n = 0;
+  uint32_t index;
+  SUBOOL propagated = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  suscan_pass_index_drop_passes(self, -1, from - SUSCAN_PASS_INDEX_RETENTION);
+
+  for (i = 0; i < self->sat_count; ++i)
+    self->sat_list[i]->active = SU_FALSE;
+
+  for (i = 0; i < count; ++i) {
+    SU_TRY(sat = suscan_pass_index_assert_sat(self, orbits + i, &index));
+    sat->active = SU_TRUE;
+
+    suscan_pass_index_hash_orbit(orbits + i, hash);
+
+    /* New elements, or a gap too large to bridge: start over */
+    if (memcmp(hash, sat->hash, SHA256_BLOCK_SIZE) != 0
+      || sat->horizon < from - SUSCAN_PASS_INDEX_LOOKBACK) {
+      memcpy(sat->hash, hash, SHA256_BLOCK_SIZE);
+      suscan_pass_index_drop_passes(self, index, -INFINITY);
+      sat->horizon = -INFINITY;
+    }
+
+    if (sat->horizon >= to)
+      continue;
+
+    pending[n] = orbits[i];
+    indices[n] = index;
+    starts[n]  = isinf(sat->horizon)
+      ? floor((from - SUSCAN_PASS_INDEX_LOOKBACK) / self->step) * self->step
+      : sat->horizon;
+
+    if (++n == SUSCAN_PASS_INDEX_BATCH_SIZE) {
+      SU_TRY(suscan_pass_index_propagate(self, pending, indices, starts, n, to));
+      propagated = SU_TRUE;
+      n = 0;
+    }
+  }
+
+  if (n > 0) {
+    SU_TRY(suscan_pass_index_propagate(self, pending, indices, starts, n, to));
+    propagated = SU_TRUE;
+  }
+
+  if (propagated)
+    qsort(
+      self->pass_list,
+      self->pass_count,
+      sizeof(struct suscan_pass),
+      suscan_pass_index_cmp);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/*********************************** Queries **********************************/
+SU_GETTER(
+  suscan_pass_index,
+  SUSCOUNT,
+  walk,
+  SUDOUBLE from,
+  SUDOUBLE to,
+  suscan_pass_index_walk_cb_t cb,
+  void *privdata)
+{
+  SUSCOUNT lo = 0, hi = self->pass_count, mid, i;
+  SUSCOUNT walked = 0;
+  SUDOUBLE first = from - self->max_duration;
+
+  /* First pass whose AOS can still overlap the window */
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    if (self->pass_list[mid].aos < first)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  for (i = lo; i < self->pass_count && self->pass_list[i].aos <= to; ++i) {
+    if (self->pass_list[i].los < from)
+      continue;
+
+    if (!self->sat_list[self->pass_list[i].sat]->active)
+      continue;
+
+    ++walked;
+    if (!(cb) (self, self->pass_list + i, privdata))
+      break;
+  }
+
+  return walked;
+}
+
+/**************************** Instancer / collector ***************************/
+SU_INSTANCER(
+  suscan_pass_index,
+  const xyz_t *site,
+  SUDOUBLE minel,
+  SUDOUBLE step)
+{
+  suscan_pass_index_t *new = NULL;
+  const char *tle_path;
+
+  SU_ALLOCATE_FAIL(new, suscan_pass_index_t);
+
+  new->site  = *site;
+  new->minel = minel;
+  new->step  = step > 0 ? step : SUSCAN_PASS_INDEX_DEFAULT_STEP;
+
+  SU_TRY_FAIL(tle_path = suscan_confdb_get_local_tle_path());
+  SU_TRY_FAIL(
+    new->path = strbuild(
+      "%s/passes_%+.4lf_%+.4lf_%.0lf.idx",
+      tle_path,
+      SU_RAD2DEG(site->lat),
+      SU_RAD2DEG(site->lon),
+      site->height * 1e3));
+
+  SU_TRY_FAIL(suscan_pass_index_load(new));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_pass_index_destroy(new);
+
+  return NULL;
+}
+
+SU_COLLECTOR(suscan_pass_index)
+{
+  unsigned int i;
+
+  for (i = 0; i < self->sat_count; ++i)
+    suscan_pass_sat_destroy(self->sat_list[i]);
+
+  if (self->sat_list != NULL)
+    free(self->sat_list);
+
+  if (self->pass_list != NULL)
+    free(self->pass_list);
+
+  if (self->path != NULL)
+    free(self->path);
+
+  free(self);
+}
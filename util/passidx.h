@@ -0,0 +1,141 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _UTIL_PASSIDX_H
+#define _UTIL_PASSIDX_H
+
+#include <sigutils/defs.h>
+#include <sigutils/types.h>
+#include <sigutils/util/util.h>
+#include <sgdp4/sgdp4.h>
+#include <stdint.h>
+
+#include "sha256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_PASS_INDEX_MAGIC         0x58444950 /* "PIDX" */
+#define SUSCAN_PASS_INDEX_VERSION       1
+#define SUSCAN_PASS_INDEX_DEFAULT_STEP  20.     /* Seconds */
+#define SUSCAN_PASS_INDEX_LOOKBACK      1800.   /* Seconds */
+#define SUSCAN_PASS_INDEX_RETENTION     86400.  /* Seconds */
+
+/*
+ * Passes are stored sorted by AOS. Times are Unix times, elevations
+ * in radians and range rates in km/s (Doppler extrema are obtained
+ * by multiplying these by -f / c)
+ */
+struct suscan_pass {
+  SUDOUBLE aos;
+  SUDOUBLE tca;
+  SUDOUBLE los;
+  SUFLOAT  max_el;
+  SUFLOAT  min_range_rate;
+  SUFLOAT  max_range_rate;
+  uint32_t sat;            /* Index in the satellite list */
+};
+
+struct suscan_pass_sat {
+  char    *name;
+  int32_t  satno;
+  uint8_t  hash[SHA256_BLOCK_SIZE]; /* Of the orbital elements */
+  SUDOUBLE horizon;                 /* Passes are complete up to here */
+  SUBOOL   active;                  /* In the last update. Not stored */
+};
+
+struct suscan_pass_index {
+  char    *path;
+  xyz_t    site;                    /* Geodetic, radians */
+  SUDOUBLE minel;
+  SUDOUBLE step;
+  SUDOUBLE max_duration;
+  SUBOOL   dirty;
+
+  PTR_LIST(struct suscan_pass_sat, sat);
+
+  struct suscan_pass *pass_list;
+  SUSCOUNT pass_count;
+  SUSCOUNT pass_alloc;
+};
+
+typedef struct suscan_pass_index suscan_pass_index_t;
+
+typedef SUBOOL (*suscan_pass_index_walk_cb_t) (
+  const suscan_pass_index_t *self,
+  const struct suscan_pass *pass,
+  void *privdata);
+
+/*
+ * Opens (or creates) the pass index of a given site in the local TLE
+ * directory. A stored index computed with a different minimum elevation
+ * or time step is discarded.
+ */
+SU_INSTANCER(
+  suscan_pass_index,
+  const xyz_t *site,
+  SUDOUBLE minel,
+  SUDOUBLE step);
+SU_COLLECTOR(suscan_pass_index);
+
+/*
+ * Makes sure the passes of all orbits are known up to `to`. Only
+ * satellites whose elements changed or whose horizon falls short are
+ * propagated. Passes of other satellites are kept, but not walked until
+ * they are passed to update again.
+ */
+SU_METHOD(
+  suscan_pass_index,
+  SUBOOL,
+  update,
+  const orbit_t *orbits,
+  unsigned int count,
+  SUDOUBLE from,
+  SUDOUBLE to);
+
+SU_METHOD(suscan_pass_index, SUBOOL, save);
+
+/*
+ * Walks all passes overlapping [from, to], in AOS order. Only satellites
+ * passed to the last update are considered.
+ */
+SU_GETTER(
+  suscan_pass_index,
+  SUSCOUNT,
+  walk,
+  SUDOUBLE from,
+  SUDOUBLE to,
+  suscan_pass_index_walk_cb_t cb,
+  void *privdata);
+
+SUINLINE SU_GETTER(
+  suscan_pass_index,
+  const char *,
+  get_name,
+  const struct suscan_pass *pass)
+{
+  return self->sat_list[pass->sat]->name;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _UTIL_PASSIDX_H */
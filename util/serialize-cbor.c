@@ -0,0 +1,89 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <string.h>
+
+#define SU_LOG_DOMAIN "object-cbor"
+
+#include <sigutils/log.h>
+#include "object.h"
+#include "cbor.h"
+
+/*
+ * Objects are encoded as 4-element arrays:
+ *
+ *   [type, name or null, class or null, value or children]
+ *
+ * Field objects carry their value (or null). Objects and sets carry the
+ * array of their non-null children.
+ */
+
+SUPRIVATE SUBOOL
+suscan_object_pack_nullable_str(grow_buf_t *buffer, const char *str)
+{
+  if (str == NULL)
+    return cbor_pack_null(buffer) == 0;
+
+  return cbor_pack_str(buffer, str) == 0;
+}
+
+SUBOOL
+suscan_object_to_cbor(const suscan_object_t *object, grow_buf_t *buffer)
+{
+  unsigned int i, count = 0;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(cbor_pack_array_start(buffer, 4));
+  SU_TRYZ(cbor_pack_uint(buffer, object->type));
+  SU_TRY(suscan_object_pack_nullable_str(buffer, object->name));
+  SU_TRY(suscan_object_pack_nullable_str(buffer, object->class_name));
+
+  switch (object->type) {
+    case SUSCAN_OBJECT_TYPE_FIELD:
+      SU_TRY(suscan_object_pack_nullable_str(buffer, object->value));
+      break;
+
+    case SUSCAN_OBJECT_TYPE_OBJECT:
+    case SUSCAN_OBJECT_TYPE_SET:
+      /* Same layout for fields and set elements */
+      for (i = 0; i < object->object_count; ++i)
+        if (object->object_list[i] != NULL)
+          ++count;
+
+      SU_TRYZ(cbor_pack_array_start(buffer, count));
+
+      for (i = 0; i < object->object_count; ++i)
+        if (object->object_list[i] != NULL)
+          SU_TRY(suscan_object_to_cbor(object->object_list[i], buffer));
+
+      SU_TRYZ(cbor_pack_array_end(buffer, count));
+      break;
+
+    default:
+      SU_ERROR("Invalid object type %d\n", object->type);
+      goto done;
+  }
+
+  SU_TRYZ(cbor_pack_array_end(buffer, 4));
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
@@ -0,0 +1,147 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "startup"
+
+#include <sigutils/log.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "startup.h"
+
+SUPRIVATE pthread_mutex_t g_startup_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE struct suscan_startup_phase g_phase_list[SUSCAN_STARTUP_MAX_PHASES];
+SUPRIVATE unsigned int g_phase_count = 0;
+SUPRIVATE struct timeval g_startup_epoch;
+SUPRIVATE SUBOOL g_startup_enabled = SU_FALSE;
+
+SUPRIVATE SUDOUBLE
+suscan_startup_now(void)
+{
+  struct timeval now, diff;
+
+  gettimeofday(&now, NULL);
+  timersub(&now, &g_startup_epoch, &diff);
+
+  return diff.tv_sec * 1e3 + diff.tv_usec * 1e-3;
+}
+
+void
+suscan_startup_profile_enable(void)
+{
+  pthread_mutex_lock(&g_startup_mutex);
+
+  if (!g_startup_enabled) {
+    gettimeofday(&g_startup_epoch, NULL);
+    g_phase_count     = 0;
+    g_startup_enabled = SU_TRUE;
+  }
+
+  pthread_mutex_unlock(&g_startup_mutex);
+}
+
+SUBOOL
+suscan_startup_profile_enabled(void)
+{
+  return g_startup_enabled;
+}
+
+int
+suscan_startup_phase_begin(const char *name)
+{
+  int phase = -1;
+
+  if (!g_startup_enabled)
+    return -1;
+
+  pthread_mutex_lock(&g_startup_mutex);
+
+  if (g_phase_count < SUSCAN_STARTUP_MAX_PHASES) {
+    phase = g_phase_count++;
+
+    g_phase_list[phase].name  = name;
+    g_phase_list[phase].start = suscan_startup_now();
+    g_phase_list[phase].end   = -1;
+    g_phase_list[phase].ok    = SU_FALSE;
+  }
+
+  pthread_mutex_unlock(&g_startup_mutex);
+
+  return phase;
+}
+
+SUBOOL
+suscan_startup_phase_end(int phase, SUBOOL ok)
+{
+  if (phase < 0)
+    return ok;
+
+  pthread_mutex_lock(&g_startup_mutex);
+
+  g_phase_list[phase].end = suscan_startup_now();
+  g_phase_list[phase].ok  = ok;
+
+  pthread_mutex_unlock(&g_startup_mutex);
+
+  return ok;
+}
+
+/* Phases are printed in the order they started */
+void
+suscan_startup_profile_print(FILE *fp)
+{
+  unsigned int i;
+  const struct suscan_startup_phase *phase;
+
+  if (!g_startup_enabled)
+    return;
+
+  pthread_mutex_lock(&g_startup_mutex);
+
+  fprintf(fp, "Startup profile (times in ms):\n");
+  fprintf(fp, "  %9s  %9s  %9s  %s\n", "Start", "End", "Elapsed", "Phase");
+
+  for (i = 0; i < g_phase_count; ++i) {
+    phase = g_phase_list + i;
+
+    if (phase->end < 0) {
+      fprintf(
+        fp,
+        "  %9.1lf  %9s  %9s  %s (unfinished)\n",
+        phase->start,
+        "-",
+        "-",
+        phase->name);
+    } else {
+      fprintf(
+        fp,
+        "  %9.1lf  %9.1lf  %9.1lf  %s%s\n",
+        phase->start,
+        phase->end,
+        phase->end - phase->start,
+        phase->name,
+        phase->ok ? "" : " (failed)");
+    }
+  }
+
+  fprintf(fp, "  Total: %.1lf ms\n", suscan_startup_now());
+
+  pthread_mutex_unlock(&g_startup_mutex);
+}
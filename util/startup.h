@@ -0,0 +1,62 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _UTIL_STARTUP_H
+#define _UTIL_STARTUP_H
+
+#include <sigutils/defs.h>
+#include <sigutils/types.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_STARTUP_MAX_PHASES 64
+
+struct suscan_startup_phase {
+  const char *name;
+  SUDOUBLE    start;  /* Milliseconds since the profile was enabled */
+  SUDOUBLE    end;
+  SUBOOL      ok;
+};
+
+/*
+ * Startup profiling. Phases can be recorded from any thread, and
+ * overlapping intervals in the report correspond to components that
+ * were initialized in parallel. Nothing is recorded unless profiling
+ * has been enabled.
+ */
+void   suscan_startup_profile_enable(void);
+SUBOOL suscan_startup_profile_enabled(void);
+void   suscan_startup_profile_print(FILE *fp);
+
+/*
+ * phase_begin returns a handle (-1 if profiling is disabled or the
+ * phase table is full) to be passed to phase_end, which returns `ok'
+ * unchanged so it can wrap the result of the phase.
+ */
+int    suscan_startup_phase_begin(const char *name);
+SUBOOL suscan_startup_phase_end(int phase, SUBOOL ok);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _UTIL_STARTUP_H */